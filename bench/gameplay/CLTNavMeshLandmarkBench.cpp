@@ -0,0 +1,209 @@
+/*
+ * ALT landmark benchmark on a maze, for whole and tiled worlds
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -pthread bench/gameplay/CLTNavMeshLandmarkBench.cpp \
+ *       src/gameplay/CLTNavMeshQuery.cpp src/gameplay/CLTNavMeshPath.cpp \
+ *       src/gameplay/CLTNavMeshData.cpp src/gameplay/CLTNavMeshNodeQueue.cpp \
+ *       src/gameplay/CLTNavMeshNodePool.cpp src/gameplay/CLTNavMeshTileCache.cpp \
+ *       src/gameplay/CLTNavMeshClusterGraph.cpp -o landmark_bench
+ *   ./landmark_bench [scratch directory]
+ *
+ * The maze is a 96x96 grid of unit quads split into 4x4 rooms, with walls
+ * between rooms except along a random spanning tree, so most paths wind
+ * far longer than the straight line. The same random queries run on the
+ * mesh without landmarks, with 8 landmarks, and on the snapshot the tile
+ * cache joins from tiles written with 8 landmarks. Expanded nodes should
+ * drop with landmarks, by the same amount for the whole and the tiled
+ * world, while path lengths stay about the same.
+ */
+
+#include "../../include/gameplay/CLTNavMeshData.h"
+#include "../../include/gameplay/CLTNavMeshPath.h"
+#include "../../include/gameplay/CLTNavMeshQuery.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+#include "../../include/gameplay/CLTNavMeshTileCache.h"
+#include "../../tests/gameplay/CLTNavMeshTestGrid.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static const int ROOMS = 24;
+static const int ROOM_SIZE = 4;
+static const int GRID_SIZE = ROOMS * ROOM_SIZE;
+static const uint32_t LANDMARK_COUNT = 8;
+static const uint32_t QUERY_COUNT = 300;
+
+static uint32_t s_seed = 4;
+
+static uint32_t Random()
+{
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return s_seed >> 8;
+}
+
+static std::vector<NavMeshPoly> BuildMaze()
+{
+    // Depth-first spanning tree over the rooms; tree edges get a doorway
+    std::vector<bool> visited(ROOMS * ROOMS, false);
+    std::set<std::pair<int, int> > doors;
+    std::vector<int> stack(1, 0);
+    visited[0] = true;
+    while (!stack.empty()) {
+        int room = stack.back();
+        int x = room % ROOMS, z = room / ROOMS;
+        std::vector<int> next;
+        if (x > 0 && !visited[room - 1]) next.push_back(room - 1);
+        if (x < ROOMS - 1 && !visited[room + 1]) next.push_back(room + 1);
+        if (z > 0 && !visited[room - ROOMS]) next.push_back(room - ROOMS);
+        if (z < ROOMS - 1 && !visited[room + ROOMS]) next.push_back(room + ROOMS);
+        if (next.empty()) {
+            stack.pop_back();
+            continue;
+        }
+        int chosen = next[Random() % next.size()];
+        visited[chosen] = true;
+        doors.insert(std::make_pair(std::min(room, chosen), std::max(room, chosen)));
+        stack.push_back(chosen);
+    }
+
+    auto roomOf = [](int x, int z) { return (z / ROOM_SIZE) * ROOMS + x / ROOM_SIZE; };
+    auto linked = [&](int x0, int z0, int x1, int z1) {
+        int a = roomOf(x0, z0), b = roomOf(x1, z1);
+        return a == b || doors.count(std::make_pair(std::min(a, b), std::max(a, b))) != 0;
+    };
+
+    return BuildGrid(GRID_SIZE, GRID_SIZE, std::vector<bool>(), linked);
+}
+
+// Join every tile through the cache, as a streamed world would
+static std::shared_ptr<CLTNavMeshData> LoadTiled(const std::vector<NavMeshPoly>& polygons, const std::string& manifest)
+{
+    if (!CLTNavMeshTileCache::WriteTiles(polygons, 16.0f, manifest.c_str(), LANDMARK_COUNT)) {
+        return std::shared_ptr<CLTNavMeshData>();
+    }
+
+    CLTNavMeshTileCache cache;
+    std::shared_ptr<CLTNavMeshData> pData;
+    if (cache.Open(manifest.c_str())) {
+        cache.SetStreamingRadius(static_cast<float>(GRID_SIZE));
+        const CLTVector center(GRID_SIZE * 0.5f, 0.0f, GRID_SIZE * 0.5f);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while ((!pData || cache.GetResidentTileCount() < cache.GetTileCount()) &&
+               std::chrono::steady_clock::now() < deadline) {
+            cache.Update(&center, 1);
+            std::shared_ptr<CLTNavMeshData> pNext = cache.TakeUpdatedData();
+            if (pNext) {
+                pData = pNext;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        for (uint32_t z = 0; z * 16 < GRID_SIZE; ++z) {
+            for (uint32_t x = 0; x * 16 < GRID_SIZE; ++x) {
+                char suffix[32];
+                snprintf(suffix, sizeof(suffix), ".%u_%u", x, z);
+                remove((manifest + suffix).c_str());
+            }
+        }
+    }
+    remove(manifest.c_str());
+    return pData;
+}
+
+struct RunStats {
+    uint64_t nodes;             ///< Nodes allocated over all queries
+    double seconds;             ///< Search time over all queries
+    std::vector<float> lengths; ///< Path length per query
+};
+
+static float PathLength(const CLTNavMeshPath& path)
+{
+    float length = 0.0f;
+    for (uint32_t i = 1; i < path.GetWaypointCount(); ++i) {
+        length += path.GetWaypoint(i - 1).Distance(path.GetWaypoint(i));
+    }
+    return length;
+}
+
+static RunStats Run(const std::shared_ptr<const CLTNavMeshData>& pData,
+                    const std::vector<std::pair<uint32_t, uint32_t> >& queries)
+{
+    CLTNavMeshSystem::PathFindOptions options = CLTNavMeshSystem::PathFindOptions();
+    options.maxNodes = GRID_SIZE * GRID_SIZE;
+    options.areaFlags = CLTNavMeshSystem::AREA_ALL;
+
+    RunStats stats = { 0, 0.0, std::vector<float>() };
+    CLTNavMeshSearchContext context;
+    CLTNavMeshQuery query;
+    CLTNavMeshPath path;
+    for (const auto& ids : queries) {
+        const uint32_t start = pData->GetIndex(ids.first);
+        const uint32_t end = pData->GetIndex(ids.second);
+        auto t0 = std::chrono::steady_clock::now();
+        query.Init(pData, nullptr, nullptr, pData->GetCenter(start), pData->GetCenter(end), start, end, options);
+        query.Update(&context, 0xFFFFFFFF);
+        stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        stats.nodes += query.GetNodeCount();
+        query.GetPath(&path);
+        stats.lengths.push_back(query.GetStatus() == CLTNavMeshSystem::PATHFIND_SUCCESS ? PathLength(path) : -1.0f);
+    }
+    return stats;
+}
+
+int main(int argc, char** argv)
+{
+    const std::vector<NavMeshPoly> polygons = BuildMaze();
+
+    std::shared_ptr<CLTNavMeshData> pPlain = std::make_shared<CLTNavMeshData>();
+    std::shared_ptr<CLTNavMeshData> pLandmarks = std::make_shared<CLTNavMeshData>();
+    if (!pPlain->Build(polygons) || !pLandmarks->Build(polygons, LANDMARK_COUNT)) {
+        printf("FAIL: could not build the maze\n");
+        return 1;
+    }
+    std::shared_ptr<CLTNavMeshData> pTiled = LoadTiled(polygons, std::string(argc > 1 ? argv[1] : ".") + "/landmark_bench.nav");
+    if (!pTiled || pTiled->GetPolyCount() != pPlain->GetPolyCount()) {
+        printf("FAIL: could not stream in the tiled maze\n");
+        return 1;
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t> > queries;
+    for (uint32_t q = 0; q < QUERY_COUNT; ++q) {
+        uint32_t start = Random() % (GRID_SIZE * GRID_SIZE) + 1;
+        uint32_t end = Random() % (GRID_SIZE * GRID_SIZE) + 1;
+        queries.push_back(std::make_pair(start, end));
+    }
+
+    // Paths of equal cost can pull to slightly different lengths, so lengths
+    // are compared as an average and a worst case rather than per query
+    const char* names[] = { "no landmarks", "8 landmarks", "8 landmarks, tiled" };
+    const std::shared_ptr<CLTNavMeshData> meshes[] = { pPlain, pLandmarks, pTiled };
+    RunStats results[3];
+    printf("%-20s %10s %12s %10s %12s %12s\n", "mesh", "landmarks", "nodes/query", "us/query",
+           "mean length", "worst ratio");
+    for (int i = 0; i < 3; ++i) {
+        results[i] = Run(meshes[i], queries);
+        double total = 0.0, worst = 0.0;
+        uint32_t found = 0;
+        for (uint32_t q = 0; q < QUERY_COUNT; ++q) {
+            if (results[i].lengths[q] > 0.0f && results[0].lengths[q] > 0.0f) {
+                total += results[i].lengths[q];
+                worst = std::max(worst, static_cast<double>(results[i].lengths[q] / results[0].lengths[q]));
+                ++found;
+            }
+        }
+        printf("%-20s %10u %12.1f %10.1f %12.2f %12.4f\n", names[i], meshes[i]->GetLandmarkCount(),
+               static_cast<double>(results[i].nodes) / QUERY_COUNT, results[i].seconds * 1e6 / QUERY_COUNT,
+               found > 0 ? total / found : 0.0, worst);
+    }
+
+    bool ok = pTiled->GetLandmarkCount() == LANDMARK_COUNT && results[2].nodes < results[0].nodes;
+    if (!ok) {
+        printf("FAIL: the tiled maze did not keep its landmarks\n");
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+/*
+ * A* open list benchmark: linear scan list against CLTNavMeshNodeQueue
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 bench/gameplay/CLTNavMeshOpenListBench.cpp \
+ *       src/gameplay/CLTNavMeshData.cpp src/gameplay/CLTNavMeshNodeQueue.cpp \
+ *       src/gameplay/CLTNavMeshNodePool.cpp -o open_list_bench
+ *   ./open_list_bench
+ *
+ * Both searches run the same A* over synthetic grids of unit quads, with
+ * and without random walls, and share the per-polygon state table. They
+ * only differ in the open list: the old one kept an unordered vector,
+ * took the cheapest node with min_element and erase, and found queued
+ * nodes by scanning; the new one is the indexed binary heap. Each query
+ * is checked to find the same path cost with both lists.
+ */
+
+#include "../../include/gameplay/CLTNavMeshData.h"
+#include "../../include/gameplay/CLTNavMeshNodePool.h"
+#include "../../include/gameplay/CLTNavMeshNodeQueue.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+#include "../../tests/gameplay/CLTNavMeshTestGrid.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static const uint32_t QUERY_COUNT = 200;
+
+// Old open list: unordered, cheapest node found by a full scan
+class LinearOpenList {
+public:
+    void Clear() { m_nodes.clear(); }
+    bool Empty() const { return m_nodes.empty(); }
+    uint32_t Size() const { return static_cast<uint32_t>(m_nodes.size()); }
+    void Push(NavMeshPathNode* pNode) { m_nodes.push_back(pNode); }
+    void Update(NavMeshPathNode*) {}
+
+    NavMeshPathNode* Pop() {
+        auto it = std::min_element(m_nodes.begin(), m_nodes.end(),
+            [](NavMeshPathNode* a, NavMeshPathNode* b) {
+                return a->totalCost < b->totalCost;
+            });
+        NavMeshPathNode* pNode = *it;
+        m_nodes.erase(it);
+        return pNode;
+    }
+
+    NavMeshPathNode* Find(uint32_t polyIndex) const {
+        for (NavMeshPathNode* pNode : m_nodes) {
+            if (pNode->polyIndex == polyIndex) {
+                return pNode;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    std::vector<NavMeshPathNode*> m_nodes;
+};
+
+// New open list: the heap, with queued nodes found through the state table
+class HeapOpenList {
+public:
+    explicit HeapOpenList(const std::vector<NavMeshPolyState>& states) : m_states(states), m_generation(0) {}
+    void SetGeneration(uint32_t generation) { m_generation = generation; }
+    void Clear() { m_queue.Clear(); }
+    bool Empty() const { return m_queue.Empty(); }
+    uint32_t Size() const { return m_queue.Size(); }
+    void Push(NavMeshPathNode* pNode) { m_queue.Push(pNode); }
+    void Update(NavMeshPathNode* pNode) { m_queue.Update(pNode); }
+    NavMeshPathNode* Pop() { return m_queue.Pop(); }
+
+    NavMeshPathNode* Find(uint32_t polyIndex) const {
+        const NavMeshPolyState& state = m_states[polyIndex];
+        return state.generation == m_generation && (state.flags & NavMeshPolyState::NODE_OPEN) ? state.pNode : nullptr;
+    }
+
+private:
+    const std::vector<NavMeshPolyState>& m_states;
+    uint32_t m_generation;
+    CLTNavMeshNodeQueue m_queue;
+};
+
+struct SearchStats {
+    float cost;             ///< Cost of the path found, or -1
+    uint32_t maxOpen;       ///< Largest open list size seen
+};
+
+template <typename OpenList>
+static SearchStats Search(const CLTNavMeshData& navData, uint32_t start, uint32_t goal, OpenList& openList,
+                          std::vector<NavMeshPolyState>& states, uint32_t generation, CLTNavMeshNodePool& pool)
+{
+    SearchStats stats = { -1.0f, 0 };
+    const CLTVector& goalPos = navData.GetCenter(goal);
+    pool.Reset();
+    openList.Clear();
+
+    NavMeshPathNode* pStart = pool.Allocate();
+    pStart->position = navData.GetCenter(start);
+    pStart->polyIndex = start;
+    pStart->cost = 0.0f;
+    pStart->heuristic = pStart->position.Distance(goalPos);
+    pStart->totalCost = pStart->heuristic;
+    states[start].generation = generation;
+    states[start].flags = NavMeshPolyState::NODE_OPEN;
+    states[start].pNode = pStart;
+    openList.Push(pStart);
+
+    while (!openList.Empty()) {
+        stats.maxOpen = std::max(stats.maxOpen, openList.Size());
+        NavMeshPathNode* pCurrent = openList.Pop();
+        states[pCurrent->polyIndex].flags = NavMeshPolyState::NODE_CLOSED;
+        if (pCurrent->polyIndex == goal) {
+            stats.cost = pCurrent->cost;
+            return stats;
+        }
+
+        uint32_t count;
+        const uint32_t* pNeighbors = navData.GetNeighbors(pCurrent->polyIndex, &count);
+        for (uint32_t n = 0; n < count; ++n) {
+            const uint32_t neighbor = pNeighbors[n];
+            NavMeshPolyState& state = states[neighbor];
+            if (state.generation == generation && (state.flags & NavMeshPolyState::NODE_CLOSED)) {
+                continue;
+            }
+
+            const CLTVector& pos = navData.GetCenter(neighbor);
+            float newCost = pCurrent->cost + pCurrent->position.Distance(pos);
+            NavMeshPathNode* pNode = openList.Find(neighbor);
+            if (pNode && pNode->cost <= newCost) {
+                continue;
+            }
+
+            const bool queued = pNode != nullptr;
+            if (!queued) {
+                pNode = pool.Allocate();
+                pNode->position = pos;
+                pNode->polyIndex = neighbor;
+                pNode->heuristic = pos.Distance(goalPos);
+                state.generation = generation;
+                state.flags = NavMeshPolyState::NODE_OPEN;
+                state.pNode = pNode;
+            }
+            pNode->cost = newCost;
+            pNode->totalCost = newCost + pNode->heuristic;
+            pNode->parent = pCurrent;
+
+            if (queued) {
+                openList.Update(pNode);
+            } else {
+                openList.Push(pNode);
+            }
+        }
+    }
+    return stats;
+}
+
+int main()
+{
+    printf("%-6s %-6s %8s %9s %12s %12s %8s\n", "grid", "walls", "polys", "max open", "linear us", "heap us", "speedup");
+
+    bool ok = true;
+    const uint32_t sizes[] = { 32, 64, 128, 256 };
+    for (uint32_t size : sizes) {
+        for (int walls = 0; walls < 2; ++walls) {
+            CLTNavMeshData navData;
+            if (!navData.Build(BuildGrid(size, size, walls ? MakeGridWalls(size, size) : std::vector<bool>()))) {
+                printf("FAIL: could not build a %ux%u grid\n", size, size);
+                return 1;
+            }
+            const uint32_t polyCount = navData.GetPolyCount();
+
+            // Queries between random polygon pairs, the same for both lists
+            uint32_t seed = 777;
+            std::vector<std::pair<uint32_t, uint32_t> > queries;
+            for (uint32_t q = 0; q < QUERY_COUNT; ++q) {
+                seed = seed * 1664525u + 1013904223u;
+                uint32_t a = (seed >> 8) % polyCount;
+                seed = seed * 1664525u + 1013904223u;
+                uint32_t b = (seed >> 8) % polyCount;
+                queries.push_back(std::make_pair(a, b));
+            }
+
+            std::vector<NavMeshPolyState> states(polyCount);
+            for (NavMeshPolyState& state : states) {
+                state.generation = 0;
+                state.flags = 0;
+                state.pNode = nullptr;
+            }
+            CLTNavMeshNodePool pool(polyCount, polyCount);
+            uint32_t generation = 0;
+
+            LinearOpenList linear;
+            std::vector<float> linearCosts;
+            uint32_t maxOpen = 0;
+            auto t0 = std::chrono::steady_clock::now();
+            for (const auto& query : queries) {
+                SearchStats stats = Search(navData, query.first, query.second, linear, states, ++generation, pool);
+                linearCosts.push_back(stats.cost);
+                maxOpen = std::max(maxOpen, stats.maxOpen);
+            }
+            double linearUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+
+            HeapOpenList heap(states);
+            t0 = std::chrono::steady_clock::now();
+            for (uint32_t q = 0; q < QUERY_COUNT; ++q) {
+                heap.SetGeneration(++generation);
+                SearchStats stats = Search(navData, queries[q].first, queries[q].second, heap, states, generation, pool);
+                if (std::fabs(stats.cost - linearCosts[q]) > 1e-3f) {
+                    printf("FAIL: query %u costs %f with the heap, %f with the linear list\n",
+                           q, stats.cost, linearCosts[q]);
+                    ok = false;
+                }
+            }
+            double heapUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+
+            printf("%-6u %-6s %8u %9u %12.1f %12.1f %7.1fx\n", size, walls ? "yes" : "no", polyCount, maxOpen,
+                   linearUs / QUERY_COUNT, heapUs / QUERY_COUNT, linearUs / heapUs);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+/*
+ * Path request queue benchmark: throughput and high-priority latency
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -pthread bench/gameplay/CLTNavMeshPathQueueBench.cpp \
+ *       src/gameplay/CLTNavMeshPathQueue.cpp src/gameplay/CLTNavMeshQuery.cpp \
+ *       src/gameplay/CLTNavMeshPath.cpp src/gameplay/CLTNavMeshData.cpp \
+ *       src/gameplay/CLTNavMeshNodeQueue.cpp src/gameplay/CLTNavMeshNodePool.cpp \
+ *       src/gameplay/CLTNavMeshClusterGraph.cpp -o path_queue_bench
+ *   ./path_queue_bench
+ *
+ * Searches run between random polygons of a 160x160 grid of unit quads
+ * with random walls, on 1, 4 and 16 workers. Throughput submits a batch
+ * of normal priority requests at once and times until all are fetched.
+ * Latency keeps a background load of low priority requests queued, and
+ * meanwhile submits high priority requests at a steady rate, timing each
+ * from Submit() until Fetch() returns its result. High priority requests
+ * should finish within about a slice of the background work however
+ * deep the background queue is. Every request must end in
+ * PATHFIND_SUCCESS or PATHFIND_NO_PATH.
+ */
+
+#include "../../include/gameplay/CLTNavMeshData.h"
+#include "../../include/gameplay/CLTNavMeshPathQueue.h"
+#include "../../include/gameplay/CLTNavMeshQuery.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+#include "../../tests/gameplay/CLTNavMeshTestGrid.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static const int GRID_SIZE = 160;
+static const uint32_t BATCH_SIZE = 2000;
+static const uint32_t BACKGROUND_REQUESTS = 64;
+static const uint32_t LATENCY_SAMPLES = 200;
+static const double HIGH_INTERVAL_US = 2000.0;
+
+typedef std::chrono::steady_clock Clock;
+
+static bool s_ok = true;
+
+class QueryMaker {
+public:
+    explicit QueryMaker(const std::shared_ptr<const CLTNavMeshData>& pData) : m_pData(pData), m_seed(777) {
+        m_options = CLTNavMeshSystem::PathFindOptions();
+        m_options.maxIterations = 0xFFFFFFFF;
+        m_options.maxNodes = pData->GetPolyCount();
+        m_options.areaFlags = CLTNavMeshSystem::AREA_ALL;
+    }
+
+    uint32_t Submit(CLTNavMeshPathQueue& queue, CLTNavMeshSystem::PathPriority priority) {
+        const uint32_t start = Next();
+        const uint32_t end = Next();
+        CLTNavMeshQuery* pQuery = new CLTNavMeshQuery();
+        pQuery->Init(m_pData, nullptr, nullptr, m_pData->GetCenter(start), m_pData->GetCenter(end),
+                     start, end, m_options);
+        return queue.Submit(pQuery, priority, m_options.maxIterations);
+    }
+
+private:
+    uint32_t Next() {
+        m_seed = m_seed * 1664525u + 1013904223u;
+        return (m_seed >> 8) % m_pData->GetPolyCount();
+    }
+
+    std::shared_ptr<const CLTNavMeshData> m_pData;
+    CLTNavMeshSystem::PathFindOptions m_options;
+    uint32_t m_seed;
+};
+
+// Fetches a request; true once it has finished
+static bool Collect(CLTNavMeshPathQueue& queue, uint32_t ticket)
+{
+    CLTNavMeshQuery* pQuery = nullptr;
+    CLTNavMeshSystem::PathFindResult result = queue.Fetch(ticket, &pQuery);
+    if (result == CLTNavMeshSystem::PATHFIND_PENDING) {
+        return false;
+    }
+    if (result != CLTNavMeshSystem::PATHFIND_SUCCESS && result != CLTNavMeshSystem::PATHFIND_NO_PATH) {
+        printf("FAIL: request %u finished with result %d\n", ticket, static_cast<int>(result));
+        s_ok = false;
+    }
+    delete pQuery;
+    return true;
+}
+
+static double Throughput(const std::shared_ptr<const CLTNavMeshData>& pData, uint32_t workers)
+{
+    CLTNavMeshPathQueue queue;
+    queue.Start(workers);
+    QueryMaker maker(pData);
+
+    const Clock::time_point t0 = Clock::now();
+    std::vector<uint32_t> tickets;
+    for (uint32_t i = 0; i < BATCH_SIZE; ++i) {
+        tickets.push_back(maker.Submit(queue, CLTNavMeshSystem::PATH_PRIORITY_NORMAL));
+    }
+    while (!tickets.empty()) {
+        tickets.erase(std::remove_if(tickets.begin(), tickets.end(),
+            [&queue](uint32_t ticket) { return Collect(queue, ticket); }), tickets.end());
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    return BATCH_SIZE / std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+struct LatencyStats {
+    double meanUs;
+    double p50Us;
+    double p99Us;
+    double maxUs;
+    double backgroundPerSecond;
+};
+
+static LatencyStats Latency(const std::shared_ptr<const CLTNavMeshData>& pData, uint32_t workers)
+{
+    CLTNavMeshPathQueue queue;
+    queue.Start(workers);
+    QueryMaker maker(pData);
+
+    std::vector<uint32_t> background;
+    for (uint32_t i = 0; i < BACKGROUND_REQUESTS; ++i) {
+        background.push_back(maker.Submit(queue, CLTNavMeshSystem::PATH_PRIORITY_LOW));
+    }
+
+    std::vector<std::pair<uint32_t, Clock::time_point> > high;
+    std::vector<double> latencies;
+    uint32_t backgroundDone = 0;
+    uint32_t submitted = 0;
+    const Clock::time_point t0 = Clock::now();
+    Clock::time_point nextHigh = t0;
+    while (latencies.size() < LATENCY_SAMPLES) {
+        Clock::time_point now = Clock::now();
+        if (submitted < LATENCY_SAMPLES && now >= nextHigh) {
+            high.push_back(std::make_pair(maker.Submit(queue, CLTNavMeshSystem::PATH_PRIORITY_HIGH), now));
+            nextHigh += std::chrono::microseconds(static_cast<int64_t>(HIGH_INTERVAL_US));
+            ++submitted;
+        }
+
+        for (size_t i = 0; i < high.size();) {
+            if (Collect(queue, high[i].first)) {
+                latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - high[i].second).count());
+                high[i] = high.back();
+                high.pop_back();
+            } else {
+                ++i;
+            }
+        }
+
+        // Keep the background queue full
+        for (uint32_t& ticket : background) {
+            if (Collect(queue, ticket)) {
+                ++backgroundDone;
+                ticket = maker.Submit(queue, CLTNavMeshSystem::PATH_PRIORITY_LOW);
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    LatencyStats stats;
+    stats.meanUs = 0.0;
+    for (double latency : latencies) {
+        stats.meanUs += latency / latencies.size();
+    }
+    stats.p50Us = latencies[latencies.size() / 2];
+    stats.p99Us = latencies[latencies.size() * 99 / 100];
+    stats.maxUs = latencies.back();
+    stats.backgroundPerSecond = backgroundDone / seconds;
+    return stats;
+}
+
+int main()
+{
+    std::shared_ptr<CLTNavMeshData> pData(new CLTNavMeshData());
+    if (!pData->Build(BuildGrid(GRID_SIZE, GRID_SIZE, MakeGridWalls(GRID_SIZE, GRID_SIZE)))) {
+        printf("FAIL: could not build the grid\n");
+        return 1;
+    }
+
+    printf("%u polygons, %u hardware threads, %u background requests queued during latency runs\n",
+           pData->GetPolyCount(), std::thread::hardware_concurrency(), BACKGROUND_REQUESTS);
+    printf("%-8s %12s %10s %10s %10s %10s %14s\n",
+           "workers", "requests/s", "high mean", "high p50", "high p99", "high max", "background/s");
+
+    const uint32_t workerCounts[] = { 1, 4, 16 };
+    for (uint32_t workers : workerCounts) {
+        double throughput = Throughput(pData, workers);
+        LatencyStats latency = Latency(pData, workers);
+        printf("%-8u %12.0f %8.0fus %8.0fus %8.0fus %8.0fus %14.0f\n", workers, throughput,
+               latency.meanUs, latency.p50Us, latency.p99Us, latency.maxUs, latency.backgroundPerSecond);
+    }
+    return s_ok ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+#ifndef _CLT_NAVMESH_BUILDER_H_
+#define _CLT_NAVMESH_BUILDER_H_
+
+#include "../CLTVector.h"
+#include <stdint.h>
+#include <vector>
+
+struct NavMeshPoly;
+
+/**
+ * @brief Parameters of a navmesh build
+ *
+ * Lengths are in world units. The defaults suit human-sized agents.
+ */
+struct NavMeshBuildConfig {
+    float cellSize;             ///< XZ edge length of a voxel
+    float cellHeight;           ///< Y size of a voxel
+    float agentHeight;          ///< Clearance an agent needs above the ground
+    float agentRadius;          ///< Distance kept from walls and ledges
+    float agentMaxClimb;        ///< Tallest step an agent can climb
+    float agentMaxSlope;        ///< Steepest walkable slope in degrees
+    int tileSize;               ///< Tile edge length in voxels
+    int minRegionArea;          ///< Islands with fewer voxels are dropped unless they reach a tile border
+    float maxEdgeError;         ///< Furthest a simplified wall may stray from the voxel outline
+    int maxVertsPerPoly;        ///< Vertex limit of the convex polygons (3 to MAX_VERTS_PER_POLY)
+    uint32_t threadCount;       ///< Worker threads, 0 for one per hardware thread
+
+    NavMeshBuildConfig()
+        : cellSize(0.3f)
+        , cellHeight(0.2f)
+        , agentHeight(2.0f)
+        , agentRadius(0.6f)
+        , agentMaxClimb(0.9f)
+        , agentMaxSlope(45.0f)
+        , tileSize(64)
+        , minRegionArea(8)
+        , maxEdgeError(1.3f)
+        , maxVertsPerPoly(6)
+        , threadCount(0)
+    {
+    }
+};
+
+/**
+ * @brief Builds navmesh polygons from world collision triangles
+ *
+ * The world is split into square tiles on the XZ plane, and each tile is
+ * built on its own, in parallel:
+ *
+ *  1. Triangles are voxelized into a heightfield of solid spans. Spans
+ *     on triangles steeper than the slope limit are not walkable.
+ *  2. Walkable spans without enough headroom, on ledges, or within the
+ *     agent radius of an obstacle are removed.
+ *  3. The remaining open spans are partitioned into monotone regions,
+ *     which never contain holes.
+ *  4. Each region's outline is traced and simplified into a contour.
+ *  5. Contours are triangulated and the triangles merged into convex
+ *     polygons, linked to their neighbours by shared edges.
+ *
+ * Tiles are voxelized with a border of neighbouring geometry, so both
+ * sides of a tile border see the same walkable area. Polygons on either
+ * side of a border are linked where their edges on it overlap.
+ *
+ * Built tiles are kept, so after world geometry changes only the tiles
+ * it touches need rebuilding (see BuildTiles()). Polygon IDs encode the
+ * tile, so IDs in untouched tiles stay valid.
+ *
+ * A builder is not thread-safe, but it does not depend on the navigation
+ * system, so builds can run offline or on a background thread. The
+ * result is passed to CLTNavMeshSystem::SetNavMeshData(), compiled with
+ * CLTNavMeshData::Build(), or split into streamed tiles with
+ * CLTNavMeshTileCache::WriteTiles().
+ */
+class CLTNavMeshBuilder {
+public:
+    static const int MAX_VERTS_PER_POLY = 12;           ///< Upper limit for maxVertsPerPoly
+    static const uint32_t MAX_TILES = 0x10000;          ///< Tiles a world may span (IDs keep 16 bits for the tile)
+    static const uint32_t MAX_TILE_POLYS = 0xFFFF;      ///< Polygons a tile may hold (and 16 bits for the polygon)
+
+    /**
+     * @brief Constructor (default configuration, no geometry)
+     */
+    CLTNavMeshBuilder();
+
+    /**
+     * @brief Destructor
+     */
+    ~CLTNavMeshBuilder();
+
+    /**
+     * @brief Set the build parameters
+     *
+     * Drops all built tiles.
+     *
+     * @param config Build parameters
+     * @return true if the parameters are valid, false otherwise
+     */
+    bool SetConfig(const NavMeshBuildConfig& config);
+
+    /**
+     * @brief Get the build parameters
+     */
+    const NavMeshBuildConfig& GetConfig() const { return m_config; }
+
+    /**
+     * @brief Set the world collision geometry
+     *
+     * The geometry is copied. Built tiles are kept if the new geometry
+     * covers the same tiles and has the same lowest point; otherwise they
+     * are dropped.
+     *
+     * @param pVertices Vertex positions
+     * @param vertexCount Number of vertices
+     * @param pIndices Three vertex indices per triangle; winding does not matter
+     * @param triangleCount Number of triangles
+     * @param pAreas Area type (CLTNavMeshSystem::AREA_* flags) per triangle, 0 for
+     *        surfaces that are never walkable, or nullptr for AREA_WALKABLE everywhere
+     * @return true if the geometry was accepted, false for invalid indices or
+     *         a world spanning more than MAX_TILES tiles
+     */
+    bool SetGeometry(const CLTVector* pVertices, uint32_t vertexCount,
+                     const uint32_t* pIndices, uint32_t triangleCount,
+                     const uint8_t* pAreas = nullptr);
+
+    /**
+     * @brief Get the number of tiles along X
+     */
+    int GetTilesX() const { return m_tilesX; }
+
+    /**
+     * @brief Get the number of tiles along Z
+     */
+    int GetTilesZ() const { return m_tilesZ; }
+
+    /**
+     * @brief Get the tile containing a position
+     *
+     * @param position World position
+     * @param pTileX Pointer to receive the tile column
+     * @param pTileZ Pointer to receive the tile row
+     * @return true if the position lies in a tile of the world
+     */
+    bool GetTileCoords(const CLTVector& position, int* pTileX, int* pTileZ) const;
+
+    /**
+     * @brief Build every tile and return the polygons
+     *
+     * @param pPolygons Pointer to receive the polygons of the whole world
+     * @return true on success, false without geometry or if a tile
+     *         exceeded MAX_TILE_POLYS
+     */
+    bool Build(std::vector<NavMeshPoly>* pPolygons);
+
+    /**
+     * @brief Rebuild a rectangle of tiles
+     *
+     * Tiles are built in parallel, then linked to each other and to the
+     * built tiles around them. Call GetPolygons() for the result.
+     *
+     * A tile sees geometry up to the agent radius plus three cells beyond
+     * its edges, so a change that close to an edge needs the tile across
+     * it rebuilt too.
+     *
+     * @param minTileX First tile column (inclusive)
+     * @param minTileZ First tile row (inclusive)
+     * @param maxTileX Last tile column (inclusive)
+     * @param maxTileZ Last tile row (inclusive)
+     * @return true on success, false without geometry or if a tile
+     *         exceeded MAX_TILE_POLYS (that tile is left empty)
+     */
+    bool BuildTiles(int minTileX, int minTileZ, int maxTileX, int maxTileZ);
+
+    /**
+     * @brief Get the polygons of all built tiles
+     *
+     * @param pPolygons Pointer to receive the polygons
+     */
+    void GetPolygons(std::vector<NavMeshPoly>* pPolygons) const;
+
+    /**
+     * @brief Drop all built tiles
+     */
+    void ClearTiles();
+
+private:
+    CLTNavMeshBuilder(const CLTNavMeshBuilder&) = delete;
+    CLTNavMeshBuilder& operator=(const CLTNavMeshBuilder&) = delete;
+
+    struct BuiltTile;
+
+    bool BuildTile(int tileX, int tileZ, BuiltTile* pTile) const;
+    void LinkTiles(uint32_t tileA, uint32_t tileB, int side);
+
+    NavMeshBuildConfig m_config;            ///< Build parameters
+
+    // Geometry
+    std::vector<CLTVector> m_vertices;      ///< Vertex positions
+    std::vector<uint32_t> m_indices;        ///< Three vertex indices per triangle
+    std::vector<uint8_t> m_areas;           ///< Area type per triangle
+    CLTVector m_boundsMin;                  ///< Tile grid origin: X/Z on a whole tile, Y at the lowest vertex
+    CLTVector m_boundsMax;                  ///< Maximum corner of the geometry
+
+    // Tiles
+    int m_tilesX;                           ///< Number of tiles along X
+    int m_tilesZ;                           ///< Number of tiles along Z
+    std::vector<uint32_t> m_tileTriStart;   ///< First entry of each tile in m_tileTris (tiles + 1 entries)
+    std::vector<uint32_t> m_tileTris;       ///< Triangles overlapping each tile and its border
+    std::vector<BuiltTile*> m_tiles;        ///< Built tiles, nullptr if not built
+};
+
+#endif // _CLT_NAVMESH_BUILDER_H_
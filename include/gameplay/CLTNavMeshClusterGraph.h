@@ -0,0 +1,153 @@
+#ifndef _CLT_NAVMESH_CLUSTER_GRAPH_H_
+#define _CLT_NAVMESH_CLUSTER_GRAPH_H_
+
+#include "CLTNavMeshData.h"
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Hierarchical (HPA*) abstraction of a navmesh
+ *
+ * Polygons are grouped into clusters: connected groups of polygons whose
+ * centers fall into the same square cell of a coarse XZ grid. Where two
+ * clusters touch, each contiguous run of border polygons contributes one
+ * transition per direction its links cross in, and both polygons of a
+ * transition become entrances. Links may be one-way. Entrances of the
+ * same cluster are linked by their precomputed travel cost inside the
+ * cluster.
+ *
+ * A long search then runs over the few entrances instead of every
+ * polygon, and is refined only inside the clusters the path crosses, so
+ * its cost grows with the number of clusters crossed rather than the
+ * number of polygons. Paths are near-optimal: they pass through one
+ * entrance per border run.
+ */
+class CLTNavMeshClusterGraph {
+public:
+    /**
+     * @brief Result of FindCorridor()
+     */
+    enum SearchResult {
+        SEARCH_FOUND,               ///< Corridor found
+        SEARCH_NO_PATH,             ///< Start and end are not connected
+        SEARCH_OUT_OF_NODES         ///< Abstract node limit reached
+    };
+
+    /**
+     * @brief Constructor (empty graph)
+     */
+    CLTNavMeshClusterGraph();
+
+    /**
+     * @brief Build the graph for a navmesh
+     *
+     * Cluster cells are anchored at the world origin, so a polygon falls
+     * into the same cell in every navmesh it is part of. Given the graph of
+     * an earlier navmesh with the same cluster size, clusters whose
+     * polygons and entrances are unchanged copy their entrance costs from
+     * it instead of searching again, so rebuilding after a few tiles were
+     * streamed in or out only searches the clusters around them.
+     *
+     * @param pNavData Navmesh to abstract; the graph keeps a reference
+     * @param clusterSize Edge length of a cluster cell in world units
+     * @param pPrevious Graph to reuse entrance costs from, or nullptr
+     * @return true if the graph was built, false for invalid parameters
+     */
+    bool Build(const std::shared_ptr<const CLTNavMeshData>& pNavData, float clusterSize = 32.0f,
+               const CLTNavMeshClusterGraph* pPrevious = nullptr);
+
+    /**
+     * @brief Get the navmesh the graph was built for
+     */
+    const std::shared_ptr<const CLTNavMeshData>& GetNavData() const { return m_pNavData; }
+
+    /**
+     * @brief Get the edge length of a cluster cell
+     */
+    float GetClusterSize() const { return m_clusterSize; }
+
+    /**
+     * @brief Get the memory held by the graph in bytes
+     */
+    size_t GetMemoryUsage() const;
+
+    /**
+     * @brief Get the number of clusters
+     */
+    uint32_t GetClusterCount() const { return static_cast<uint32_t>(m_clusterStart.size()) - 1; }
+
+    /**
+     * @brief Get the number of entrances (abstract graph nodes)
+     */
+    uint32_t GetEntranceCount() const { return static_cast<uint32_t>(m_entrancePoly.size()); }
+
+    /**
+     * @brief Get the cluster of a polygon
+     *
+     * @param polyIndex Dense polygon index
+     * @return Cluster index
+     */
+    uint32_t GetCluster(uint32_t polyIndex) const { return m_polyCluster[polyIndex]; }
+
+    /**
+     * @brief Get the union of the area types of all polygons
+     *
+     * Entrance costs are plain distances over every polygon, so the graph
+     * only serves searches whose area filter accepts all of these areas
+     * at unit cost.
+     */
+    uint32_t GetAreaMask() const { return m_areaMask; }
+
+    /**
+     * @brief Find a polygon corridor between two polygons
+     *
+     * Safe to call from several threads at once.
+     *
+     * @param startIndex Dense index of the start polygon
+     * @param endIndex Dense index of the end polygon
+     * @param maxNodes Maximum number of abstract nodes to expand
+     * @param pCorridor Pointer to receive dense polygon indices from start to end
+     * @return Search result
+     */
+    SearchResult FindCorridor(uint32_t startIndex, uint32_t endIndex, uint32_t maxNodes,
+                              std::vector<uint32_t>* pCorridor) const;
+
+private:
+    CLTNavMeshClusterGraph(const CLTNavMeshClusterGraph&) = delete;
+    CLTNavMeshClusterGraph& operator=(const CLTNavMeshClusterGraph&) = delete;
+
+    struct Edge {
+        uint32_t target;            ///< Entrance at the other end
+        float cost;                 ///< Travel cost
+    };
+
+    bool SearchCluster(uint32_t fromIndex, uint32_t toIndex,
+                       std::vector<float>* pCost, std::vector<uint32_t>* pParent, bool incoming = false) const;
+    void AppendClusterPath(uint32_t fromIndex, uint32_t toIndex, const std::vector<uint32_t>& parent,
+                           std::vector<uint32_t>* pCorridor) const;
+    float Distance(uint32_t a, uint32_t b) const;
+    bool CopyClusterEdges(uint32_t cluster, const CLTNavMeshClusterGraph& previous,
+                          const std::vector<uint32_t>& polyEntrance, std::vector<std::vector<Edge> >* pEdges) const;
+
+    std::shared_ptr<const CLTNavMeshData> m_pNavData;   ///< Navmesh the graph abstracts
+    float m_clusterSize;                                ///< Edge length of a cluster cell
+
+    // Clusters
+    std::vector<uint32_t> m_polyCluster;                ///< Cluster of each polygon
+    std::vector<uint32_t> m_polyLocal;                  ///< Index of each polygon within its cluster
+    std::vector<uint32_t> m_clusterStart;               ///< First entry of each cluster in m_clusterPolys (clusters + 1 entries)
+    std::vector<uint32_t> m_clusterPolys;               ///< Polygon indices by cluster
+    std::vector<uint32_t> m_incomingStart;              ///< First entry of each polygon in m_incoming (polygons + 1 entries)
+    std::vector<uint32_t> m_incoming;                   ///< Polygons linking to each polygon from inside its cluster
+
+    // Abstract graph
+    std::vector<uint32_t> m_entrancePoly;               ///< Polygon index of each entrance
+    std::vector<uint32_t> m_clusterEntranceStart;       ///< First entry of each cluster in m_clusterEntrances (clusters + 1 entries)
+    std::vector<uint32_t> m_clusterEntrances;           ///< Entrances by cluster
+    std::vector<uint32_t> m_edgeStart;                  ///< First edge of each entrance (entrances + 1 entries)
+    std::vector<Edge> m_edges;                          ///< Entrance edges
+    uint32_t m_areaMask;                                ///< Union of all polygon area types
+};
+
+#endif // _CLT_NAVMESH_CLUSTER_GRAPH_H_
@@ -0,0 +1,726 @@
+#ifndef _CLT_NAVMESH_DATA_H_
+#define _CLT_NAVMESH_DATA_H_
+
+#include "../CLTVector.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+struct NavMeshPoly;
+
+/**
+ * @brief Read-only view of one polygon in compiled navmesh data
+ *
+ * Views point straight into the navmesh arrays, so creating one never
+ * allocates. A view is valid until the navmesh it came from is rebuilt
+ * or unloaded.
+ */
+struct NavMeshPolyView {
+    uint32_t index;             ///< Dense polygon index
+    uint32_t id;                ///< Polygon ID
+    const CLTVector* vertices;  ///< Polygon vertices
+    uint32_t vertexCount;       ///< Number of vertices
+    const uint32_t* neighbors;  ///< Dense indices of neighbouring polygons
+    uint32_t neighborCount;     ///< Number of neighbours
+    CLTVector center;           ///< Polygon center point
+    float height;               ///< Polygon height (Y coordinate)
+    uint8_t flags;              ///< Polygon flags
+    uint8_t area;               ///< Area type
+};
+
+/**
+ * @brief Called for each polygon found by a region query
+ *
+ * @param poly View of the polygon
+ * @param pUserData Caller's pointer, passed through unchanged
+ * @return true to continue the query, false to stop it
+ */
+typedef bool (*NavMeshPolyVisitor)(const NavMeshPolyView& poly, void* pUserData);
+
+/**
+ * @brief Volume for region queries
+ *
+ * Polygons are tested as their XZ outline extruded over the vertical span
+ * of their vertices. Boxes and spheres are tested exactly against that
+ * shape. Capsules take the closest XZ distance and the closest vertical
+ * distance separately, so they may also accept polygons that are just
+ * outside their rounded ends.
+ */
+struct NavMeshRegion {
+    enum Shape {
+        SHAPE_BOX,                  ///< Axis-aligned box from a to b
+        SHAPE_SPHERE,               ///< Sphere around a
+        SHAPE_CAPSULE               ///< Segment from a to b, swept by radius
+    };
+
+    Shape shape;                ///< Kind of volume
+    CLTVector a;                ///< Box minimum, sphere center, or capsule start
+    CLTVector b;                ///< Box maximum or capsule end (unused for spheres)
+    float radius;               ///< Sphere or capsule radius (unused for boxes)
+
+    static NavMeshRegion Box(const CLTVector& min, const CLTVector& max) {
+        NavMeshRegion region = { SHAPE_BOX, min, max, 0.0f };
+        return region;
+    }
+
+    static NavMeshRegion Sphere(const CLTVector& center, float radius) {
+        NavMeshRegion region = { SHAPE_SPHERE, center, center, radius };
+        return region;
+    }
+
+    static NavMeshRegion Capsule(const CLTVector& start, const CLTVector& end, float radius) {
+        NavMeshRegion region = { SHAPE_CAPSULE, start, end, radius };
+        return region;
+    }
+};
+
+/**
+ * @brief Section entry in the binary navmesh file
+ *
+ * Offsets are relative to the start of the file, so the data is usable
+ * wherever the file is mapped.
+ */
+struct NavMeshFileSection {
+    uint32_t offset;            ///< Byte offset from the start of the file
+    uint32_t size;              ///< Size in bytes
+};
+
+/**
+ * @brief Header of the binary navmesh file
+ *
+ * The header is followed by sectionCount NavMeshFileSection entries, in
+ * CLTNavMeshData::FileSection order. Every section starts on a 16-byte
+ * boundary. All values are little-endian.
+ */
+struct NavMeshFileHeader {
+    uint32_t magic;             ///< CLTNavMeshData::FILE_MAGIC
+    uint32_t version;           ///< File format version
+    uint32_t fileSize;          ///< Total file size in bytes
+    uint32_t sectionCount;      ///< Number of section table entries
+    uint32_t polyCount;         ///< Number of polygons
+    uint32_t vertexCount;       ///< Number of vertices across all polygons
+    uint32_t neighborCount;     ///< Number of neighbour links across all polygons
+    uint32_t cellPolyCount;     ///< Number of grid cell entries
+    int32_t gridWidth;          ///< Grid cells along X
+    int32_t gridHeight;         ///< Grid cells along Z
+    float gridMinX;             ///< World X of the grid origin
+    float gridMinZ;             ///< World Z of the grid origin
+    float cellSize;             ///< Grid cell edge length
+    uint32_t externalLinkCount; ///< Number of links to polygons outside the mesh (version 2+)
+    uint32_t landmarkCount;     ///< Number of ALT landmarks (version 3+)
+    float sampleReach;          ///< Furthest any polygon extends beyond its sampling cell (version 5+)
+};
+
+/**
+ * @brief Neighbour link to a polygon that is not part of the mesh
+ *
+ * Tiles of a streamed world keep their links across tile borders this way,
+ * so they can be joined again when the neighbouring tile is loaded.
+ */
+struct NavMeshExternalLink {
+    uint32_t polyIndex;         ///< Dense index of the polygon owning the link
+    uint32_t neighborId;        ///< ID of the neighbouring polygon
+};
+
+/**
+ * @brief Compiled, flat navigation mesh
+ *
+ * Polygons are stored as structure-of-arrays indexed by a dense polygon
+ * index (0..GetPolyCount()-1). Vertices and neighbours live in shared arrays
+ * addressed through CSR-style start offsets, so a polygon's data is two
+ * contiguous ranges instead of two heap allocations. Polygons are ordered
+ * by ID, which makes ID to index lookup a binary search.
+ *
+ * Build() also creates a uniform 2D grid over the XZ plane. Each cell lists
+ * the polygons whose bounds overlap it, so point and proximity queries only
+ * visit a handful of polygons regardless of mesh size.
+ *
+ * All arrays, including the tables random sampling uses, live in a single
+ * relocatable image with the same layout as the navmesh file. Build()
+ * produces the image in memory; LoadFromFile() maps the file and uses it
+ * in place, so processes loading the same file share its pages.
+ */
+class CLTNavMeshData {
+public:
+    /**
+     * @brief Index value for polygons that do not exist
+     */
+    static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+    static const uint32_t FILE_MAGIC = 0x4D56414E;  ///< "NAVM"
+    static const uint32_t FILE_VERSION = 5;         ///< Current file format version
+    static const uint32_t MAX_LANDMARKS = 16;       ///< Upper limit for Build()'s landmarkCount
+    static const uint32_t MAX_POLY_VERTICES = 32;   ///< Most vertices a polygon may have; Build() and loading reject more
+
+    /**
+     * @brief Sections of the navmesh image, in section table order
+     */
+    enum FileSection {
+        SECTION_IDS,                ///< uint32_t per polygon
+        SECTION_CENTERS,            ///< CLTVector per polygon
+        SECTION_HEIGHTS,            ///< float per polygon
+        SECTION_FLAGS,              ///< uint8_t per polygon
+        SECTION_AREAS,              ///< uint8_t per polygon
+        SECTION_VERTEX_START,       ///< uint32_t per polygon + 1
+        SECTION_VERTICES,           ///< CLTVector per vertex
+        SECTION_NEIGHBOR_START,     ///< uint32_t per polygon + 1
+        SECTION_NEIGHBORS,          ///< uint32_t per neighbour link
+        SECTION_BOUNDS,             ///< 4 floats per polygon
+        SECTION_CELL_START,         ///< uint32_t per grid cell + 1
+        SECTION_CELL_POLYS,         ///< uint32_t per grid cell entry
+        SECTION_EXTERNAL_LINKS,     ///< NavMeshExternalLink per external link (version 2+)
+        SECTION_LANDMARKS,          ///< uint32_t polygon ID per landmark (polygon index in version 3)
+        SECTION_LANDMARK_DISTANCES, ///< float per polygon per landmark, by polygon (version 3+)
+        SECTION_FAN_AREAS,          ///< float per vertex, running fan triangle area (version 5+)
+        SECTION_SAMPLE_CELL_START,  ///< uint32_t per grid cell + 1 (version 5+)
+        SECTION_SAMPLE_POLYS,       ///< uint32_t per polygon, grouped by the cell holding its center (version 5+)
+        SECTION_SAMPLE_AREAS,       ///< float per polygon, running area within its cell (version 5+)
+        SECTION_CELL_AREA_SUMS,     ///< double per (grid width + 1) * (grid height + 1) (version 5+)
+        SECTION_LAYERED_CELL_SUMS,  ///< uint32_t per (grid width + 1) * (grid height + 1) (version 5+)
+        SECTION_COUNT
+    };
+
+    /**
+     * @brief Default constructor (empty mesh)
+     */
+    CLTNavMeshData();
+
+    /**
+     * @brief Destructor
+     */
+    ~CLTNavMeshData();
+
+    /**
+     * @brief Compile polygons into flat storage
+     *
+     * Neighbour IDs that do not refer to a polygon in the set are kept as
+     * external links rather than neighbours. Polygon ID 0 is reserved for "no polygon" and is rejected.
+     * So are polygons with more than MAX_POLY_VERTICES vertices, so
+     * queries can keep per-vertex scratch on the stack.
+     *
+     * With landmarkCount set, Build() also picks that many landmark
+     * polygons, spread out by farthest-point selection, and stores the
+     * travel distance through polygon centers from each landmark to every
+     * polygon, following links both ways. Searches use them for ALT lower
+     * bounds, which beat straight-line distance on meshes with many walls.
+     * Landmarks are opt-in: they cost one Dijkstra search per landmark here
+     * and landmarkCount floats per polygon in the image.
+     *
+     * @param polygons Source polygons
+     * @param landmarkCount Number of landmarks to precompute (at most MAX_LANDMARKS)
+     * @return true if the data was built, false if the input was invalid
+     */
+    bool Build(const std::vector<NavMeshPoly>& polygons, uint32_t landmarkCount = 0);
+
+    /**
+     * @brief Polygons taken from one navmesh by Join()
+     */
+    struct JoinSource {
+        const CLTNavMeshData* pData;    ///< Navmesh to take polygons from
+        const uint32_t* pIndices;       ///< Dense indices of the polygons to take, ascending
+        uint32_t count;                 ///< Number of indices
+    };
+
+    /**
+     * @brief Compile polygons taken from several navmeshes into one
+     *
+     * Polygon arrays are copied straight from the source images, so this
+     * costs far less than copying the polygons out and calling Build().
+     * Links to polygons that are not taken become external links, and
+     * external links to polygons that are taken become neighbours again,
+     * so tiles joined this way can be split and joined again.
+     *
+     * Landmark rows are copied when every source that gives polygons has
+     * the same landmarks, as tiles cut from one world do; otherwise the
+     * result has none. Distances measured on a larger mesh still bound the
+     * travel on a part of it, so the rows stay valid.
+     *
+     * @param sources Polygons to take
+     * @return true if the data was built, false if two polygons share an ID
+     */
+    bool Join(const std::vector<JoinSource>& sources);
+
+    /**
+     * @brief Map a binary navmesh file and use it in place
+     *
+     * @param pFilename Path to the navmesh file
+     * @return true if the file was mapped and validated, false otherwise
+     */
+    bool LoadFromFile(const char* pFilename);
+
+    /**
+     * @brief Write the navmesh image to a file
+     *
+     * @param pFilename Path of the file to write
+     * @return true if the file was written, false otherwise
+     */
+    bool SaveToFile(const char* pFilename) const;
+
+    /**
+     * @brief Use a navmesh image held in caller-owned memory
+     *
+     * The image is validated before use. The memory must stay valid and
+     * unchanged until the data is cleared or replaced, and must be at
+     * least 8-byte aligned.
+     *
+     * Images older than FILE_VERSION lack the sampling tables. They are
+     * upgraded into a copy held by this object, like LoadFromFile() does.
+     *
+     * @param pData Start of the image
+     * @param size Size of the image in bytes
+     * @return true if the image is a valid navmesh, false otherwise
+     */
+    bool AttachMemory(const void* pData, size_t size);
+
+    /**
+     * @brief Get the navmesh image
+     *
+     * @param pSize Pointer to receive the image size in bytes
+     * @return Start of the image
+     */
+    const void* GetImage(size_t* pSize) const { *pSize = m_imageSize; return m_pImage; }
+
+    /**
+     * @brief Get the memory held for the navmesh
+     *
+     * Every table lives in the image, so this is the image size.
+     */
+    size_t GetMemoryUsage() const { return m_imageSize; }
+
+    /**
+     * @brief Remove all polygons
+     */
+    void Clear();
+
+    /**
+     * @brief Get the number of polygons
+     */
+    uint32_t GetPolyCount() const { return m_polyCount; }
+
+    /**
+     * @brief Convert a polygon ID to its dense index
+     *
+     * @param polyId Polygon ID
+     * @return Dense index, or INVALID_INDEX if the polygon does not exist
+     */
+    uint32_t GetIndex(uint32_t polyId) const;
+
+    /**
+     * @brief Get a zero-copy view of a polygon
+     *
+     * @param index Dense polygon index (must be valid)
+     * @return View of the polygon
+     */
+    NavMeshPolyView GetPoly(uint32_t index) const;
+
+    /**
+     * @brief Copy a polygon out into the NavMeshPoly format
+     *
+     * The neighbour list includes external links, so passing the copies
+     * back to Build() reproduces the mesh.
+     *
+     * @param index Dense polygon index (must be valid)
+     * @param pPoly Pointer to receive the polygon
+     */
+    void CopyPoly(uint32_t index, NavMeshPoly* pPoly) const;
+
+    uint32_t GetId(uint32_t index) const { return m_pIds[index]; }
+    const CLTVector& GetCenter(uint32_t index) const { return m_pCenters[index]; }
+    float GetHeight(uint32_t index) const { return m_pHeights[index]; }
+    uint8_t GetFlags(uint32_t index) const { return m_pFlags[index]; }
+    uint8_t GetArea(uint32_t index) const { return m_pAreas[index]; }
+
+    const CLTVector* GetVertices(uint32_t index, uint32_t* pCount) const {
+        *pCount = m_pVertexStart[index + 1] - m_pVertexStart[index];
+        return m_pVertices + m_pVertexStart[index];
+    }
+
+    const uint32_t* GetNeighbors(uint32_t index, uint32_t* pCount) const {
+        *pCount = m_pNeighborStart[index + 1] - m_pNeighborStart[index];
+        return m_pNeighbors + m_pNeighborStart[index];
+    }
+
+    /**
+     * @brief Get the number of external links across all polygons
+     */
+    uint32_t GetExternalLinkCount() const { return m_externalLinkCount; }
+
+    /**
+     * @brief Get the external links of a polygon
+     *
+     * @param index Dense polygon index
+     * @param pCount Pointer to receive the number of links
+     * @return Links owned by the polygon
+     */
+    const NavMeshExternalLink* GetExternalLinks(uint32_t index, uint32_t* pCount) const;
+
+    /**
+     * @brief Get the number of landmarks stored in the image
+     */
+    uint32_t GetLandmarkCount() const { return m_landmarkCount; }
+
+    /**
+     * @brief Get the polygon ID of a landmark
+     *
+     * The landmark polygon itself may lie outside this mesh, e.g. in
+     * another tile of the same world.
+     *
+     * @param landmark Landmark number (less than GetLandmarkCount())
+     */
+    uint32_t GetLandmarkId(uint32_t landmark) const { return m_pLandmarks[landmark]; }
+
+    /**
+     * @brief Get the travel distance from every landmark to a polygon
+     *
+     * Unreachable polygons have FLT_MAX.
+     *
+     * @param index Dense polygon index
+     * @return GetLandmarkCount() distances
+     */
+    const float* GetLandmarkDistances(uint32_t index) const { return m_pLandmarkDistances + index * m_landmarkCount; }
+
+    /**
+     * @brief Get the ALT lower bound on the travel distance between two polygons
+     *
+     * By the triangle inequality, the distance between two polygons is at
+     * least the difference of their distances to any landmark.
+     *
+     * @param pFrom Landmark distances of the first polygon
+     * @param pTo Landmark distances of the second polygon
+     * @return Largest bound over all landmarks, 0 without landmarks
+     */
+    float GetLandmarkBound(const float* pFrom, const float* pTo) const {
+        float bound = 0.0f;
+        for (uint32_t i = 0; i < m_landmarkCount; ++i) {
+            // Landmarks that cannot reach both polygons give no bound
+            if (pFrom[i] != FLT_MAX && pTo[i] != FLT_MAX) {
+                bound = std::max(bound, std::fabs(pFrom[i] - pTo[i]));
+            }
+        }
+        return bound;
+    }
+
+    /**
+     * @brief Get the XZ bounds of a polygon
+     *
+     * @param index Dense polygon index
+     * @return Pointer to minX, minZ, maxX, maxZ
+     */
+    const float* GetBounds(uint32_t index) const { return m_pBounds + index * 4; }
+
+    /**
+     * @brief Squared XZ distance from a point to a polygon's outline
+     *
+     * @param index Dense polygon index
+     * @param x Point X coordinate
+     * @param z Point Z coordinate
+     * @return Squared distance to the closest edge
+     */
+    float DistanceSquaredToEdges(uint32_t index, float x, float z) const;
+
+    /**
+     * @brief Get the edge shared by two neighbouring polygons
+     *
+     * Finds the longest overlap between an edge of the first polygon and a
+     * collinear edge of the second, so T-junctions where edges only partly
+     * coincide are handled. Left and right are as seen from the first
+     * polygon's center looking across the portal.
+     *
+     * @param fromIndex Dense index of the polygon being left
+     * @param toIndex Dense index of the polygon being entered
+     * @param pLeft Pointer to receive the left end of the portal
+     * @param pRight Pointer to receive the right end of the portal
+     * @return true if the polygons share an edge, false otherwise
+     */
+    bool GetPortal(uint32_t fromIndex, uint32_t toIndex, CLTVector* pLeft, CLTVector* pRight) const;
+
+    /**
+     * @brief Exact XZ point-in-polygon test
+     *
+     * Uses the even-odd crossing rule, so concave polygons are handled too.
+     *
+     * @param index Dense polygon index
+     * @param x Point X coordinate
+     * @param z Point Z coordinate
+     * @return true if the point lies inside the polygon outline
+     */
+    bool ContainsPoint(uint32_t index, float x, float z) const {
+        uint32_t vertexCount;
+        const CLTVector* vertices = GetVertices(index, &vertexCount);
+        return PointInPolygon(vertices, vertexCount, x, z);
+    }
+
+    /**
+     * @brief Test one point against many polygons
+     *
+     * Candidates are processed four at a time with SSE where available,
+     * walking the edges of all four polygons in lockstep.
+     *
+     * @param x Point X coordinate
+     * @param z Point Z coordinate
+     * @param pIndices Dense indices of the candidate polygons
+     * @param count Number of candidates
+     * @param pInside Array of count entries; set to 1 for polygons containing the point, else 0
+     * @return Number of polygons containing the point
+     */
+    uint32_t ContainsPointBatch(float x, float z, const uint32_t* pIndices, uint32_t count,
+                                uint8_t* pInside) const;
+
+    /**
+     * @brief Even-odd point-in-polygon test on a raw vertex list (XZ plane)
+     *
+     * @param pVertices Polygon vertices
+     * @param vertexCount Number of vertices (fewer than 3 never contains anything)
+     * @param x Point X coordinate
+     * @param z Point Z coordinate
+     * @return true if the point lies inside the outline
+     */
+    static bool PointInPolygon(const CLTVector* pVertices, uint32_t vertexCount, float x, float z);
+
+    /**
+     * @brief Get the spatial grid cell size
+     */
+    float GetCellSize() const { return m_cellSize; }
+
+    /**
+     * @brief Get the number of grid cells along X
+     */
+    int GetGridWidth() const { return m_gridWidth; }
+
+    /**
+     * @brief Get the number of grid cells along Z
+     */
+    int GetGridHeight() const { return m_gridHeight; }
+
+    /**
+     * @brief Get the cell of a uniform grid holding a coordinate
+     *
+     * Shared by every grid over the XZ plane: the spatial index, cluster
+     * cells, path cache tiles and streamed tiles. Far-away values are
+     * clamped so the conversion to int stays defined.
+     *
+     * @param value Coordinate along one axis
+     * @param origin Coordinate where cell 0 starts
+     * @param cellSize Cell edge length
+     * @return Cell coordinate
+     */
+    static int32_t GridCoord(float value, float origin, float cellSize) {
+        const float LIMIT = 1.0e9f;
+        float cell = std::floor((value - origin) / cellSize);
+        return static_cast<int32_t>(std::max(-LIMIT, std::min(LIMIT, cell)));
+    }
+
+    /**
+     * @brief Get the grid cell coordinates of a point
+     *
+     * The coordinates are not clamped, so points outside the mesh bounds
+     * give cells outside 0..width-1 / 0..height-1.
+     *
+     * @param x Point X coordinate
+     * @param z Point Z coordinate
+     * @param pCellX Pointer to receive the cell X coordinate
+     * @param pCellZ Pointer to receive the cell Z coordinate
+     * @return true if the cell is inside the grid
+     */
+    bool GetCellCoords(float x, float z, int* pCellX, int* pCellZ) const;
+
+    /**
+     * @brief Get the polygons overlapping a grid cell
+     *
+     * @param cellX Cell X coordinate (must be inside the grid)
+     * @param cellZ Cell Z coordinate (must be inside the grid)
+     * @param pCount Pointer to receive the number of polygons
+     * @return Dense indices of the polygons in the cell
+     */
+    const uint32_t* GetCellPolys(int cellX, int cellZ, uint32_t* pCount) const {
+        uint32_t cell = static_cast<uint32_t>(cellZ * m_gridWidth + cellX);
+        *pCount = m_pCellStart[cell + 1] - m_pCellStart[cell];
+        return m_pCellPolys + m_pCellStart[cell];
+    }
+
+    /**
+     * @brief Check whether a polygon overlaps a region
+     *
+     * @param index Dense polygon index
+     * @param region Volume to test
+     * @return true if the polygon overlaps the region
+     */
+    bool OverlapsRegion(uint32_t index, const NavMeshRegion& region) const;
+
+    /**
+     * @brief Visit the polygons overlapping a region
+     *
+     * Walks the grid cells under the region's XZ bounds. A polygon listed
+     * in several of those cells is only tested in the first, so each is
+     * visited at most once and nothing is allocated.
+     *
+     * @param region Volume to query
+     * @param pVisitor Function called for each overlapping polygon
+     * @param pUserData Pointer passed to pVisitor
+     * @return Number of polygons visited
+     */
+    uint32_t QueryPolygons(const NavMeshRegion& region, NavMeshPolyVisitor pVisitor, void* pUserData) const;
+
+    /**
+     * @brief Visit the polygons whose bounds overlap an XZ rectangle
+     *
+     * The broadphase of QueryPolygons(), without the exact shape test.
+     *
+     * @param minX Rectangle minimum X
+     * @param minZ Rectangle minimum Z
+     * @param maxX Rectangle maximum X
+     * @param maxZ Rectangle maximum Z
+     * @param pVisitor Function called for each polygon
+     * @param pUserData Pointer passed to pVisitor
+     * @return Number of polygons visited
+     */
+    uint32_t QueryBounds(float minX, float minZ, float maxX, float maxZ,
+                         NavMeshPolyVisitor pVisitor, void* pUserData) const;
+
+    /**
+     * @brief Get the XZ area of a polygon
+     *
+     * @param index Dense polygon index
+     * @return Area of the polygon's outline seen from above
+     */
+    float GetPolyArea(uint32_t index) const {
+        uint32_t first = m_pVertexStart[index];
+        uint32_t last = m_pVertexStart[index + 1];
+        return last - first >= 3 ? m_pFanAreas[last - 1] : 0.0f;
+    }
+
+    /**
+     * @brief Map three random numbers to a point uniformly distributed over a polygon
+     *
+     * The polygon is split into a triangle fan; r0 picks a triangle by area
+     * and r1, r2 a point inside it. Distribution is uniform by XZ area for
+     * convex polygons. Y is interpolated from the triangle's vertices.
+     *
+     * @param index Dense polygon index
+     * @param r0 Random number in [0, 1)
+     * @param r1 Random number in [0, 1)
+     * @param r2 Random number in [0, 1)
+     * @return Point on the polygon (the center for degenerate polygons)
+     */
+    CLTVector GetPointInPoly(uint32_t index, float r0, float r1, float r2) const;
+
+    /**
+     * @brief Get the surface height of a polygon at an XZ position
+     *
+     * @param index Dense polygon index
+     * @param x Point X coordinate
+     * @param z Point Z coordinate
+     * @return Y interpolated over the fan triangle containing the point,
+     *         or the center's Y if no triangle contains it
+     */
+    float GetPointHeight(uint32_t index, float x, float z) const;
+
+    /**
+     * @brief Get the distance a polygon can reach beyond its sampling cell
+     *
+     * For sampling, every polygon belongs to exactly the one cell holding
+     * its center. A polygon touching a region therefore belongs to a cell
+     * within this distance (along X and Z) of the region.
+     */
+    float GetSampleReach() const { return m_sampleReach; }
+
+    /**
+     * @brief Total area of the polygons belonging to a rectangle of cells
+     *
+     * O(1) lookup in a summed-area table.
+     *
+     * @param x0 First cell X (inclusive, inside the grid)
+     * @param z0 First cell Z (inclusive, inside the grid)
+     * @param x1 Last cell X (inclusive, inside the grid)
+     * @param z1 Last cell Z (inclusive, inside the grid)
+     * @return Sum of GetPolyArea() over polygons whose center lies in the cells
+     */
+    double GetSampleArea(int x0, int z0, int x1, int z1) const;
+
+    /**
+     * @brief Check whether polygons overlap in XZ anywhere in a rectangle of cells
+     *
+     * True where floors are stacked above each other. O(1) lookup in a
+     * summed-area table.
+     *
+     * @param x0 First cell X (inclusive, inside the grid)
+     * @param z0 First cell Z (inclusive, inside the grid)
+     * @param x1 Last cell X (inclusive, inside the grid)
+     * @param z1 Last cell Z (inclusive, inside the grid)
+     * @return true if two polygons overlapping one of the cells overlap each other
+     */
+    bool HasOverlappingPolys(int x0, int z0, int x1, int z1) const;
+
+    /**
+     * @brief Pick a polygon from a rectangle of cells, weighted by area
+     *
+     * Binary searches over rows, then cells, then polygons, so the cost is
+     * O(log n) whatever the size of the rectangle.
+     *
+     * @param x0 First cell X (inclusive, inside the grid)
+     * @param z0 First cell Z (inclusive, inside the grid)
+     * @param x1 Last cell X (inclusive, inside the grid)
+     * @param z1 Last cell Z (inclusive, inside the grid)
+     * @param target Value in [0, GetSampleArea(x0, z0, x1, z1))
+     * @return Dense polygon index, or INVALID_INDEX if the cells hold no area
+     */
+    uint32_t PickPolygon(int x0, int z0, int x1, int z1, double target) const;
+
+private:
+    CLTNavMeshData(const CLTNavMeshData&) = delete;
+    CLTNavMeshData& operator=(const CLTNavMeshData&) = delete;
+
+    bool Attach(const uint8_t* pImage, size_t size);
+    bool AttachUpgraded(const NavMeshFileHeader& header, const uint8_t* const* sections);
+    void Release();
+
+    // Image storage: either m_ownedImage, a file mapping, or caller memory
+    std::vector<uint32_t> m_ownedImage;     ///< Image built in memory (uint32_t for alignment)
+    void* m_pMapping;                       ///< Base of the mapped file, if any
+    size_t m_mappingSize;                   ///< Size of the mapped file
+    void* m_hFile;                          ///< Platform file handle for the mapping
+    void* m_hMapping;                       ///< Platform mapping handle
+    const uint8_t* m_pImage;                ///< Image in use
+    size_t m_imageSize;                     ///< Size of the image in use
+
+    // Arrays inside the image
+    uint32_t m_polyCount;                   ///< Number of polygons
+    const uint32_t* m_pIds;                 ///< Polygon IDs, ascending
+    const CLTVector* m_pCenters;            ///< Polygon centers
+    const float* m_pHeights;                ///< Polygon heights
+    const uint8_t* m_pFlags;                ///< Polygon flags
+    const uint8_t* m_pAreas;                ///< Polygon area types
+    const uint32_t* m_pVertexStart;         ///< First vertex of each polygon (count + 1 entries)
+    const CLTVector* m_pVertices;           ///< All polygon vertices
+    const uint32_t* m_pNeighborStart;       ///< First neighbour of each polygon (count + 1 entries)
+    const uint32_t* m_pNeighbors;           ///< Neighbour polygon indices
+    const float* m_pBounds;                 ///< XZ bounds of each polygon (minX, minZ, maxX, maxZ)
+    const NavMeshExternalLink* m_pExternalLinks; ///< Links to polygons outside the mesh, by polyIndex
+    uint32_t m_externalLinkCount;           ///< Number of external links
+    const uint32_t* m_pLandmarks;           ///< Landmark polygon IDs
+    const float* m_pLandmarkDistances;      ///< Landmark distances by polygon (m_landmarkCount each)
+    uint32_t m_landmarkCount;               ///< Number of landmarks
+
+    // Spatial grid
+    float m_gridMinX;                       ///< World X of the grid origin
+    float m_gridMinZ;                       ///< World Z of the grid origin
+    float m_cellSize;                       ///< Edge length of a grid cell
+    int m_gridWidth;                        ///< Number of cells along X
+    int m_gridHeight;                       ///< Number of cells along Z
+    const uint32_t* m_pCellStart;           ///< First entry of each cell in m_pCellPolys (cells + 1 entries)
+    const uint32_t* m_pCellPolys;           ///< Polygon indices per cell
+
+    // Sampling tables inside the image
+    const float* m_pFanAreas;               ///< Cumulative fan triangle area within each polygon, by vertex
+    const uint32_t* m_pSampleCellStart;     ///< First entry of each cell in m_pSamplePolys (cells + 1 entries)
+    const uint32_t* m_pSamplePolys;         ///< Polygon indices grouped by the cell holding their center
+    const float* m_pSampleAreas;            ///< Cumulative polygon area within each cell, by entry
+    const double* m_pCellAreaSums;          ///< Summed-area table over cells ((width + 1) * (height + 1))
+    const uint32_t* m_pLayeredCellSums;     ///< Summed-area table of cells with overlapping polygons
+    float m_sampleReach;                    ///< Furthest any polygon extends beyond its center's cell
+};
+
+#endif // _CLT_NAVMESH_DATA_H_
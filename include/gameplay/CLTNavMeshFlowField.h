@@ -0,0 +1,119 @@
+#ifndef _CLT_NAVMESH_FLOW_FIELD_H_
+#define _CLT_NAVMESH_FLOW_FIELD_H_
+
+#include "../CLTVector.h"
+#include "CLTNavMeshData.h"
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Next-hop table towards one goal, shared by any number of agents
+ *
+ * Built by a single reverse Dijkstra search from the goal polygon over the
+ * whole navmesh, with the same area filter and area costs as a path search.
+ * Every reachable polygon stores the next polygon on its cheapest path to
+ * the goal and the point to steer for, so following the
+ * field costs one table lookup per step no matter how many agents use it.
+ *
+ * A field is immutable once built and keeps a reference to its navmesh
+ * snapshot.
+ */
+class CLTNavMeshFlowField {
+public:
+    /**
+     * @brief Constructor (empty field)
+     */
+    CLTNavMeshFlowField();
+
+    /**
+     * @brief Build the field
+     *
+     * @param pNavData Navmesh to build the field on
+     * @param goal Goal position
+     * @param goalIndex Dense index of the polygon containing the goal
+     * @param areaFlags Polygons must have one of these area flags
+     * @param excludedAreaFlags Polygons must have none of these area flags
+     * @param pAreaCosts Cost multiplier by area type, or nullptr for plain distance
+     * @param pBlocked Nonzero for polygons to route around, by dense index, or nullptr
+     * @return true if the field was built, false for an invalid or filtered goal polygon
+     */
+    bool Build(const std::shared_ptr<const CLTNavMeshData>& pNavData, const CLTVector& goal, uint32_t goalIndex,
+               uint32_t areaFlags, uint32_t excludedAreaFlags,
+               const std::vector<float>* pAreaCosts = nullptr, const std::vector<uint8_t>* pBlocked = nullptr);
+
+    /**
+     * @brief Get the navmesh the field was built on
+     */
+    const std::shared_ptr<const CLTNavMeshData>& GetNavData() const { return m_pNavData; }
+
+    /**
+     * @brief Get the goal position
+     */
+    const CLTVector& GetGoal() const { return m_goal; }
+
+    /**
+     * @brief Get the dense index of the goal polygon
+     */
+    uint32_t GetGoalIndex() const { return m_goalIndex; }
+
+    /**
+     * @brief Get the area flags a polygon needed to be part of the field
+     */
+    uint32_t GetAreaFlags() const { return m_areaFlags; }
+
+    /**
+     * @brief Get the area flags that kept a polygon out of the field
+     */
+    uint32_t GetExcludedAreaFlags() const { return m_excludedAreaFlags; }
+
+    /**
+     * @brief Check whether the goal can be reached from a polygon
+     *
+     * @param polyIndex Dense polygon index
+     */
+    bool IsReachable(uint32_t polyIndex) const { return m_distances[polyIndex] != FLT_MAX; }
+
+    /**
+     * @brief Get the next polygon towards the goal
+     *
+     * @param polyIndex Dense polygon index
+     * @return Dense index of the next polygon; INVALID_INDEX in the goal
+     *         polygon and in polygons that cannot reach the goal
+     */
+    uint32_t GetNextPolygon(uint32_t polyIndex) const { return m_next[polyIndex]; }
+
+    /**
+     * @brief Get the travel cost from a polygon center to the goal
+     *
+     * @param polyIndex Dense polygon index
+     * @return Distance times area costs, or FLT_MAX if the goal cannot be reached
+     */
+    float GetDistance(uint32_t polyIndex) const { return m_distances[polyIndex]; }
+
+    /**
+     * @brief Get the point to steer for from a polygon
+     *
+     * This is the middle of the portal into the next polygon, or the goal
+     * itself inside the goal polygon.
+     *
+     * @param polyIndex Dense polygon index of a reachable polygon
+     * @return Steering target
+     */
+    const CLTVector& GetTarget(uint32_t polyIndex) const { return m_targets[polyIndex]; }
+
+private:
+    CLTNavMeshFlowField(const CLTNavMeshFlowField&) = delete;
+    CLTNavMeshFlowField& operator=(const CLTNavMeshFlowField&) = delete;
+
+    std::shared_ptr<const CLTNavMeshData> m_pNavData;   ///< Navmesh the field was built on
+    CLTVector m_goal;                                   ///< Goal position
+    uint32_t m_goalIndex;                               ///< Dense index of the goal polygon
+    uint32_t m_areaFlags;                               ///< Area filter the field was built with
+    uint32_t m_excludedAreaFlags;                       ///< Excluded areas the field was built with
+    std::vector<uint32_t> m_next;                       ///< Next polygon towards the goal, by polygon
+    std::vector<float> m_distances;                     ///< Travel cost to the goal, by polygon
+    std::vector<CLTVector> m_targets;                   ///< Steering target, by polygon
+};
+
+#endif // _CLT_NAVMESH_FLOW_FIELD_H_
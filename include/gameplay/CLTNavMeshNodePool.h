@@ -0,0 +1,90 @@
+#ifndef _CLT_NAVMESH_NODE_POOL_H_
+#define _CLT_NAVMESH_NODE_POOL_H_
+
+#include <stdint.h>
+#include <vector>
+
+struct NavMeshPathNode;
+
+/**
+ * @brief Arena allocator for A* path nodes
+ *
+ * Nodes are handed out from fixed-size blocks with a bump pointer, so node
+ * addresses stay stable while the arena grows and a whole search's worth of
+ * nodes is released by Reset() in O(1). Blocks are kept between searches
+ * and only allocated when a search needs more nodes than any earlier one,
+ * up to the configured node limit.
+ */
+class CLTNavMeshNodePool {
+public:
+    /**
+     * @brief Number of nodes allocated per block
+     */
+    static const uint32_t BLOCK_SIZE = 256;
+
+    /**
+     * @brief Constructor
+     *
+     * @param initialCapacity Number of nodes to allocate up front
+     * @param maxNodes Maximum number of nodes the pool may hold
+     */
+    CLTNavMeshNodePool(uint32_t initialCapacity = BLOCK_SIZE, uint32_t maxNodes = 4096);
+
+    /**
+     * @brief Destructor
+     */
+    ~CLTNavMeshNodePool();
+
+    /**
+     * @brief Release all nodes at once
+     *
+     * Memory blocks are kept for the next search.
+     */
+    void Reset();
+
+    /**
+     * @brief Allocate a node
+     *
+     * The returned node has a null parent and is not queued.
+     *
+     * @return The new node, or nullptr if the node limit has been reached
+     */
+    NavMeshPathNode* Allocate();
+
+    /**
+     * @brief Set the maximum number of live nodes
+     *
+     * Already allocated blocks are kept even if they exceed the new limit.
+     *
+     * @param maxNodes Maximum number of nodes
+     */
+    void SetMaxNodes(uint32_t maxNodes) { m_maxNodes = maxNodes; }
+
+    /**
+     * @brief Get the maximum number of live nodes
+     */
+    uint32_t GetMaxNodes() const { return m_maxNodes; }
+
+    /**
+     * @brief Get the number of nodes handed out since the last Reset()
+     */
+    uint32_t GetUsedCount() const { return m_used; }
+
+    /**
+     * @brief Get a node handed out since the last Reset(), in allocation order
+     *
+     * @param index Allocation index (less than GetUsedCount())
+     * @return The node
+     */
+    NavMeshPathNode* GetAllocated(uint32_t index) const;
+
+private:
+    CLTNavMeshNodePool(const CLTNavMeshNodePool&) = delete;
+    CLTNavMeshNodePool& operator=(const CLTNavMeshNodePool&) = delete;
+
+    std::vector<NavMeshPathNode*> m_blocks; ///< Node blocks of BLOCK_SIZE nodes each
+    uint32_t m_used;                        ///< Bump index across all blocks
+    uint32_t m_maxNodes;                    ///< Node limit
+};
+
+#endif // _CLT_NAVMESH_NODE_POOL_H_
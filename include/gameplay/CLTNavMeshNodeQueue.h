@@ -0,0 +1,102 @@
+#ifndef _CLT_NAVMESH_NODE_QUEUE_H_
+#define _CLT_NAVMESH_NODE_QUEUE_H_
+
+#include <stdint.h>
+#include <vector>
+
+struct NavMeshPathNode;
+
+/**
+ * @brief Indexed binary min-heap used as the A* open list
+ *
+ * Nodes are ordered by NavMeshPathNode::totalCost. Each node remembers its
+ * slot in the heap (NavMeshPathNode::heapIndex), so a node whose cost has
+ * changed can be moved in O(log n) instead of being searched for and
+ * re-inserted. Finding the node for a polygon is left to the caller's
+ * per-polygon state table.
+ */
+class CLTNavMeshNodeQueue {
+public:
+    /**
+     * @brief Index value for nodes that are not in the queue
+     */
+    static const uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+    /**
+     * @brief Default constructor
+     */
+    CLTNavMeshNodeQueue();
+
+    /**
+     * @brief Remove all nodes from the queue
+     */
+    void Clear();
+
+    /**
+     * @brief Check if the queue is empty
+     *
+     * @return true if there are no nodes in the queue
+     */
+    bool Empty() const { return m_heap.empty(); }
+
+    /**
+     * @brief Get the number of nodes in the queue
+     *
+     * @return Number of queued nodes
+     */
+    uint32_t Size() const { return static_cast<uint32_t>(m_heap.size()); }
+
+    /**
+     * @brief Get the node with the lowest total cost without removing it
+     *
+     * @return The cheapest node, or nullptr if the queue is empty
+     */
+    NavMeshPathNode* Top() const { return m_heap.empty() ? nullptr : m_heap[0]; }
+
+    /**
+     * @brief Add a node to the queue
+     *
+     * @param pNode Node to add (must not already be queued)
+     */
+    void Push(NavMeshPathNode* pNode);
+
+    /**
+     * @brief Remove and return the node with the lowest total cost
+     *
+     * @return The cheapest node, or nullptr if the queue is empty
+     */
+    NavMeshPathNode* Pop();
+
+    /**
+     * @brief Restore heap order after a node's total cost changed
+     *
+     * A cheaper route can move a node's position and so its heuristic, so
+     * the total cost may go up as well as down.
+     *
+     * @param pNode Queued node whose cost was changed
+     */
+    void Update(NavMeshPathNode* pNode);
+
+    /**
+     * @brief Check that every node is ordered after its parent
+     *
+     * Walks the whole heap, so it is only asserted after each update when
+     * NAVMESH_DEBUG_HEAP is defined.
+     *
+     * @return true if the heap order holds
+     */
+    bool IsOrdered() const;
+
+    /**
+     * @brief Direct access to the heap array (unordered beyond heap order)
+     */
+    const std::vector<NavMeshPathNode*>& GetNodes() const { return m_heap; }
+
+private:
+    void SiftUp(uint32_t index);
+    void SiftDown(uint32_t index);
+
+    std::vector<NavMeshPathNode*> m_heap; ///< Heap storage
+};
+
+#endif // _CLT_NAVMESH_NODE_QUEUE_H_
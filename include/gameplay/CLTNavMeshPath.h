@@ -0,0 +1,103 @@
+#ifndef _CLT_NAVMESH_PATH_H_
+#define _CLT_NAVMESH_PATH_H_
+
+#include "../CLTVector.h"
+#include <stdint.h>
+#include <vector>
+
+class CLTNavMeshQuery;
+
+/**
+ * @brief Result of a path search
+ *
+ * Holds the waypoints found so far and, while the search is unfinished,
+ * the search itself, so CLTNavMeshSystem::ContinuePath() can pick it up
+ * where the previous call stopped.
+ */
+class CLTNavMeshPath {
+public:
+    /**
+     * @brief Default constructor (empty path)
+     */
+    CLTNavMeshPath();
+
+    /**
+     * @brief Destructor (releases any unfinished search)
+     */
+    ~CLTNavMeshPath();
+
+    /**
+     * @brief Remove all waypoints and release any unfinished search
+     */
+    void Clear();
+
+    /**
+     * @brief Get the number of waypoints
+     */
+    uint32_t GetWaypointCount() const { return static_cast<uint32_t>(m_waypoints.size()); }
+
+    /**
+     * @brief Get a waypoint
+     *
+     * @param index Waypoint index (less than GetWaypointCount())
+     * @return Waypoint position
+     */
+    const CLTVector& GetWaypoint(uint32_t index) const { return m_waypoints[index]; }
+
+    /**
+     * @brief Get all waypoints, from the start position onwards
+     */
+    const std::vector<CLTVector>& GetWaypoints() const { return m_waypoints; }
+
+    /**
+     * @brief Get the polygon ID of each waypoint
+     */
+    const std::vector<uint32_t>& GetPolygons() const { return m_polygons; }
+
+    /**
+     * @brief Get the polygons the path passes through, in order
+     *
+     * Unlike GetPolygons(), the corridor is not shortened by path
+     * optimization.
+     */
+    const std::vector<uint32_t>& GetCorridor() const { return m_corridor; }
+
+    /**
+     * @brief Get the requested start position
+     */
+    const CLTVector& GetStart() const { return m_start; }
+
+    /**
+     * @brief Get the requested end position
+     */
+    const CLTVector& GetEnd() const { return m_end; }
+
+    /**
+     * @brief Check whether the path reaches the end position
+     *
+     * Partial paths end at the explored polygon closest to the goal.
+     */
+    bool IsComplete() const { return m_complete; }
+
+    /**
+     * @brief Check whether the search can be resumed with ContinuePath()
+     */
+    bool IsPending() const { return m_pQuery != nullptr; }
+
+private:
+    friend class CLTNavMeshSystem;
+    friend class CLTNavMeshQuery;
+
+    CLTNavMeshPath(const CLTNavMeshPath&) = delete;
+    CLTNavMeshPath& operator=(const CLTNavMeshPath&) = delete;
+
+    std::vector<CLTVector> m_waypoints;     ///< Waypoint positions
+    std::vector<uint32_t> m_polygons;       ///< Polygon ID of each waypoint
+    std::vector<uint32_t> m_corridor;       ///< Polygon IDs from start to end
+    CLTVector m_start;                      ///< Requested start position
+    CLTVector m_end;                        ///< Requested end position
+    bool m_complete;                        ///< Path reaches m_end
+    CLTNavMeshQuery* m_pQuery;              ///< Unfinished search, owned by the path
+};
+
+#endif // _CLT_NAVMESH_PATH_H_
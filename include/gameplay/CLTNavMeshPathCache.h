@@ -0,0 +1,173 @@
+#ifndef _CLT_NAVMESH_PATH_CACHE_H_
+#define _CLT_NAVMESH_PATH_CACHE_H_
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+class CLTNavMeshData;
+
+/**
+ * @brief Key of a cached path corridor
+ */
+struct NavMeshPathCacheKey {
+    uint32_t startId;           ///< Polygon containing the start position
+    uint32_t endId;             ///< Polygon containing the end position
+    uint32_t areaFlags;         ///< Area flags the search considered
+    uint32_t excludedAreaFlags; ///< Area flags the search excluded
+    bool hierarchical;          ///< Search was allowed to use the cluster graph (near-optimal corridors)
+
+    bool operator<(const NavMeshPathCacheKey& other) const {
+        if (startId != other.startId) return startId < other.startId;
+        if (endId != other.endId) return endId < other.endId;
+        if (areaFlags != other.areaFlags) return areaFlags < other.areaFlags;
+        if (excludedAreaFlags != other.excludedAreaFlags) return excludedAreaFlags < other.excludedAreaFlags;
+        return hierarchical < other.hierarchical;
+    }
+};
+
+/**
+ * @brief Least recently used cache of complete path corridors
+ *
+ * Agents that travel between the same spawn points, vendors and objectives
+ * ask for the same polygon pairs over and over. The cache keeps the
+ * polygon corridor of recent complete paths, so a repeat request only
+ * rebuilds waypoints from the stored corridor.
+ *
+ * The world is divided into square invalidation tiles. Each entry records
+ * the tiles its corridor passes through; when the navmesh changes in a
+ * tile, every entry passing through it is dropped.
+ */
+class CLTNavMeshPathCache {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param capacity Maximum number of cached corridors
+     */
+    CLTNavMeshPathCache(uint32_t capacity = 256);
+
+    /**
+     * @brief Set the maximum number of cached corridors
+     *
+     * Least recently used entries are dropped to fit. 0 disables caching.
+     *
+     * @param capacity Maximum number of entries
+     */
+    void SetCapacity(uint32_t capacity);
+
+    /**
+     * @brief Get the maximum number of cached corridors
+     */
+    uint32_t GetCapacity() const { return m_capacity; }
+
+    /**
+     * @brief Get the number of cached corridors
+     */
+    uint32_t GetSize() const { return static_cast<uint32_t>(m_lookup.size()); }
+
+    /**
+     * @brief Set the invalidation tile grid and drop all entries
+     *
+     * @param tileSize Tile edge length in world units
+     * @param originX World X of tile (0, 0)
+     * @param originZ World Z of tile (0, 0)
+     */
+    void SetTileGrid(float tileSize, float originX, float originZ);
+
+    /**
+     * @brief Look up a corridor and count a hit or miss
+     *
+     * @param key Polygon pair and area filter
+     * @return Polygon IDs from start to end, or nullptr on a miss; valid
+     *         until the cache is next modified
+     */
+    const std::vector<uint32_t>* Find(const NavMeshPathCacheKey& key);
+
+    /**
+     * @brief Store the corridor of a complete path
+     *
+     * @param key Polygon pair and area filter
+     * @param corridor Polygon IDs from start to end
+     * @param navData Navmesh the corridor was found on, for tile lookups
+     */
+    void Insert(const NavMeshPathCacheKey& key, const std::vector<uint32_t>& corridor,
+                const CLTNavMeshData& navData);
+
+    /**
+     * @brief Drop an entry, e.g. one whose polygons no longer exist
+     *
+     * @param key Polygon pair and area filter
+     */
+    void Remove(const NavMeshPathCacheKey& key);
+
+    /**
+     * @brief Drop every entry passing through a tile
+     *
+     * @param tileX Tile column
+     * @param tileZ Tile row
+     */
+    void InvalidateTile(int32_t tileX, int32_t tileZ);
+
+    /**
+     * @brief Drop every entry passing through the tiles overlapping an XZ box
+     */
+    void InvalidateRegion(float minX, float minZ, float maxX, float maxZ);
+
+    /**
+     * @brief Drop all entries
+     */
+    void Clear();
+
+    /**
+     * @brief Get the number of lookups that found a corridor
+     */
+    uint64_t GetHitCount() const { return m_hits; }
+
+    /**
+     * @brief Get the number of lookups that found nothing
+     */
+    uint64_t GetMissCount() const { return m_misses; }
+
+    /**
+     * @brief Reset the hit and miss counters
+     */
+    void ResetCounters() { m_hits = 0; m_misses = 0; }
+
+private:
+    CLTNavMeshPathCache(const CLTNavMeshPathCache&) = delete;
+    CLTNavMeshPathCache& operator=(const CLTNavMeshPathCache&) = delete;
+
+    static const uint32_t INVALID_ENTRY = 0xFFFFFFFF;
+
+    struct Entry {
+        NavMeshPathCacheKey key;            ///< Key of the entry
+        std::vector<uint32_t> corridor;     ///< Polygon IDs from start to end
+        std::vector<uint64_t> tiles;        ///< Tiles the corridor passes through
+        uint32_t prev;                      ///< More recently used entry
+        uint32_t next;                      ///< Less recently used entry
+    };
+
+    static uint64_t TileKey(int32_t x, int32_t z) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(z)) << 32) | static_cast<uint32_t>(x);
+    }
+
+    void Unlink(uint32_t index);
+    void PushFront(uint32_t index);
+    void Erase(uint32_t index);
+
+    std::vector<Entry> m_entries;                           ///< Entry storage
+    std::vector<uint32_t> m_freeEntries;                    ///< Unused slots in m_entries
+    std::map<NavMeshPathCacheKey, uint32_t> m_lookup;       ///< Entry index by key
+    std::map<uint64_t, std::vector<uint32_t> > m_tileEntries; ///< Entries by tile they pass through
+    uint32_t m_head;                                        ///< Most recently used entry
+    uint32_t m_tail;                                        ///< Least recently used entry
+    uint32_t m_capacity;                                    ///< Maximum number of entries
+    float m_tileSize;                                       ///< Invalidation tile edge length
+    float m_originX;                                        ///< World X of tile (0, 0)
+    float m_originZ;                                        ///< World Z of tile (0, 0)
+    uint64_t m_hits;                                        ///< Lookups that found a corridor
+    uint64_t m_misses;                                      ///< Lookups that found nothing
+};
+
+#endif // _CLT_NAVMESH_PATH_CACHE_H_
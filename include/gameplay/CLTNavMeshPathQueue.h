@@ -0,0 +1,127 @@
+#ifndef _CLT_NAVMESH_PATH_QUEUE_H_
+#define _CLT_NAVMESH_PATH_QUEUE_H_
+
+#include "CLTNavMeshQuery.h"
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Path requests serviced by a pool of worker threads
+ *
+ * Requests are identified by tickets. Each worker owns its own search
+ * context, and queries own the rest of their state, so workers never share
+ * scratch memory. Workers always take the highest priority request first
+ * and run it for a slice of iterations before putting it back, so a long
+ * background search cannot hold up a player-visible one for more than a
+ * slice.
+ */
+class CLTNavMeshPathQueue {
+public:
+    typedef CLTNavMeshSystem::PathFindResult PathFindResult;
+    typedef CLTNavMeshSystem::PathPriority PathPriority;
+
+    /**
+     * @brief Iterations a worker runs on a request before re-checking priorities
+     */
+    static const uint32_t SLICE_ITERATIONS = 1024;
+
+    /**
+     * @brief Constructor
+     */
+    CLTNavMeshPathQueue();
+
+    /**
+     * @brief Destructor (stops the workers and drops all requests)
+     */
+    ~CLTNavMeshPathQueue();
+
+    /**
+     * @brief Start the worker threads
+     *
+     * Running workers are stopped first; queued requests are kept.
+     *
+     * @param workerCount Number of worker threads
+     */
+    void Start(uint32_t workerCount);
+
+    /**
+     * @brief Stop the worker threads and drop all requests
+     */
+    void Stop();
+
+    /**
+     * @brief Get the number of worker threads
+     */
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+    /**
+     * @brief Queue a search
+     *
+     * @param pQuery Initialised query; the queue takes ownership
+     * @param priority Priority class
+     * @param maxIterations Total iteration budget of the search
+     * @return Ticket of the request
+     */
+    uint32_t Submit(CLTNavMeshQuery* pQuery, PathPriority priority, uint32_t maxIterations);
+
+    /**
+     * @brief Record a request that failed before it could be queued
+     *
+     * @param result Result to report for the ticket
+     * @return Ticket of the request
+     */
+    uint32_t SubmitResult(PathFindResult result);
+
+    /**
+     * @brief Collect a finished request
+     *
+     * The ticket is released unless the request is still pending.
+     *
+     * @param ticket Ticket returned by Submit() or SubmitResult()
+     * @param ppQuery Pointer to receive the finished query (owned by the caller), or null
+     * @return Result of the request, PATHFIND_PENDING if it has not finished,
+     *         or PATHFIND_ERROR for unknown tickets
+     */
+    PathFindResult Fetch(uint32_t ticket, CLTNavMeshQuery** ppQuery);
+
+    /**
+     * @brief Cancel a request and release its ticket
+     *
+     * @param ticket Ticket of the request
+     * @return true if the ticket was known, false otherwise
+     */
+    bool Cancel(uint32_t ticket);
+
+private:
+    CLTNavMeshPathQueue(const CLTNavMeshPathQueue&) = delete;
+    CLTNavMeshPathQueue& operator=(const CLTNavMeshPathQueue&) = delete;
+
+    struct Request {
+        uint32_t ticket;            ///< Ticket handed to the caller
+        PathPriority priority;      ///< Priority class
+        CLTNavMeshQuery* pQuery;    ///< Search, null for requests that failed up front
+        uint32_t iterationsLeft;    ///< Remaining iteration budget
+        PathFindResult result;      ///< Result once finished
+        bool running;               ///< A worker is running a slice
+        bool cancelled;             ///< Cancelled while a worker was running it
+    };
+
+    void WorkerMain();
+    void StopWorkers();
+
+    std::vector<std::thread> m_workers;                             ///< Worker threads
+
+    // Guarded by m_mutex
+    std::mutex m_mutex;                                             ///< Guards the members below
+    std::condition_variable m_wake;                                 ///< Signals queued work or shutdown
+    std::deque<Request*> m_pending[CLTNavMeshSystem::PATH_PRIORITY_COUNT]; ///< Queued requests by priority
+    std::map<uint32_t, Request*> m_requests;                        ///< All requests by ticket
+    uint32_t m_nextTicket;                                          ///< Next ticket to hand out
+    bool m_stop;                                                    ///< Workers should exit
+};
+
+#endif // _CLT_NAVMESH_PATH_QUEUE_H_
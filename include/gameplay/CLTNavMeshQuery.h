@@ -0,0 +1,211 @@
+#ifndef _CLT_NAVMESH_QUERY_H_
+#define _CLT_NAVMESH_QUERY_H_
+
+#include "CLTNavMeshSystem.h"
+#include <memory>
+
+class CLTNavMeshPath;
+class CLTNavMeshQuery;
+
+/**
+ * @brief Per-polygon scratch state shared by the queries run on one thread
+ *
+ * The table has one entry per polygon and is far too large to keep per
+ * query. A query that finds the table was last used by another query
+ * re-stamps it from its own nodes (every node is either in the open list
+ * or closed), which is proportional to the search size rather than the
+ * mesh size.
+ */
+class CLTNavMeshSearchContext {
+public:
+    /**
+     * @brief Constructor
+     */
+    CLTNavMeshSearchContext();
+
+    /**
+     * @brief Destructor (deletes the spare query)
+     */
+    ~CLTNavMeshSearchContext();
+
+    /**
+     * @brief Get a query for a new search on this context's thread
+     *
+     * Returns the spare query, whose node blocks and open list storage are
+     * reused, or a new query if there is none.
+     *
+     * @return Query to Init(); give it back with ReleaseQuery() unless it
+     *         has to outlive the call
+     */
+    CLTNavMeshQuery* AcquireQuery();
+
+    /**
+     * @brief Give back a query that is no longer needed
+     *
+     * The query becomes the spare, after dropping its navmesh references,
+     * or is deleted if there already is one.
+     *
+     * @param pQuery Query from AcquireQuery() or new
+     */
+    void ReleaseQuery(CLTNavMeshQuery* pQuery);
+
+private:
+    friend class CLTNavMeshQuery;
+
+    CLTNavMeshSearchContext(const CLTNavMeshSearchContext&) = delete;
+    CLTNavMeshSearchContext& operator=(const CLTNavMeshSearchContext&) = delete;
+
+    void Begin(uint64_t owner, uint32_t polyCount);
+    NavMeshPolyState& GetPolyState(uint32_t polyIndex);
+
+    std::vector<NavMeshPolyState> m_polyState;  ///< Open/closed state by polygon index
+    uint32_t m_generation;                      ///< Generation stamp of the current owner
+    uint64_t m_owner;                           ///< Serial of the query the stamps belong to
+    CLTNavMeshQuery* m_pSpareQuery;             ///< Finished query kept for reuse, or nullptr
+};
+
+/**
+ * @brief Resumable A* search over a navmesh
+ *
+ * The query owns its open list and path nodes, so it can stop after any
+ * number of iterations and continue later with exactly the same result as
+ * an uninterrupted search. It keeps a reference to the navmesh snapshot it
+ * started on, so streaming in new tiles does not disturb it.
+ *
+ * The heuristic is the straight-line distance to the goal, raised to a
+ * third of the ALT landmark bound when the navmesh has landmarks. Landmark
+ * distances run between polygon centers, while search steps cut corners
+ * between them; the scaled bound is still a lower bound on the steps.
+ * Node positions depend on the expansion order, so a landmark search may
+ * settle on a path slightly longer or shorter than a plain one.
+ * Polygons rejected by the area filter or blocked by dynamic obstacles
+ * are never expanded, and step costs are scaled by the area cost table,
+ * whose multipliers are at least 1 so the heuristic stays admissible.
+ *
+ * Nodes whose cost plus straight-line distance to the goal exceeds
+ * maxDistance are pruned. Time spent in Update() adds up over all slices;
+ * once it passes the timeout the search stops with PATHFIND_TIMEOUT and
+ * GetPath() returns the best partial path.
+ */
+class CLTNavMeshQuery {
+public:
+    typedef CLTNavMeshSystem::PathFindResult PathFindResult;
+
+    /**
+     * @brief Constructor
+     */
+    CLTNavMeshQuery();
+
+    /**
+     * @brief Start a search
+     *
+     * @param pNavData Navmesh to search
+     * @param pAreaCosts Cost multiplier by polygon area type (256 entries), or null for plain distance
+     * @param pBlocked Nonzero for polygons blocked by obstacles, by dense index, or null if none are
+     * @param start Start position
+     * @param end End position
+     * @param startIndex Dense index of the polygon containing start
+     * @param endIndex Dense index of the polygon containing end
+     * @param options Path finding options; maxNodes limits the path nodes
+     * @return PATHFIND_PARTIAL if the search is ready to run, else an error;
+     *         PATHFIND_INVALID_START or PATHFIND_INVALID_END if the area
+     *         filter rejects the start or end polygon, or the end polygon
+     *         is blocked
+     */
+    PathFindResult Init(const std::shared_ptr<const CLTNavMeshData>& pNavData,
+                        const std::shared_ptr<const std::vector<float> >& pAreaCosts,
+                        const std::shared_ptr<const std::vector<uint8_t> >& pBlocked,
+                        const CLTVector& start, const CLTVector& end,
+                        uint32_t startIndex, uint32_t endIndex,
+                        const CLTNavMeshSystem::PathFindOptions& options);
+
+    /**
+     * @brief Drop the navmesh references and all nodes of the search
+     *
+     * Node blocks and open list storage are kept for the next Init().
+     */
+    void Release();
+
+    /**
+     * @brief Run up to maxIterations node expansions
+     *
+     * @param pContext Scratch state of the calling thread
+     * @param maxIterations Iteration budget for this call
+     * @return PATHFIND_PARTIAL if the budget ran out before the search
+     *         finished, otherwise the final result (PATHFIND_TIMEOUT once
+     *         the search has used up its time limit)
+     */
+    PathFindResult Update(CLTNavMeshSearchContext* pContext, uint32_t maxIterations);
+
+    /**
+     * @brief Write the path to the goal, or to the best node found so far
+     *
+     * @param pPath Path to fill in; its pending search is not touched
+     */
+    void GetPath(CLTNavMeshPath* pPath) const;
+
+    /**
+     * @brief Raise or lower the node limit of an unfinished search
+     *
+     * @param maxNodes Maximum number of path nodes
+     */
+    void SetMaxNodes(uint32_t maxNodes) { m_options.maxNodes = maxNodes; m_nodePool.SetMaxNodes(maxNodes); }
+
+    /**
+     * @brief Get the options the search was started with
+     */
+    const CLTNavMeshSystem::PathFindOptions& GetOptions() const { return m_options; }
+
+    /**
+     * @brief Get the navmesh the search runs on
+     */
+    const CLTNavMeshData& GetNavData() const { return *m_pNavData; }
+
+    /**
+     * @brief Get the current result of the search
+     */
+    PathFindResult GetStatus() const { return m_status; }
+
+    /**
+     * @brief Get the number of path nodes in use
+     */
+    uint32_t GetNodeCount() const { return m_nodePool.GetUsedCount(); }
+
+private:
+    CLTNavMeshQuery(const CLTNavMeshQuery&) = delete;
+    CLTNavMeshQuery& operator=(const CLTNavMeshQuery&) = delete;
+
+    void Restamp(CLTNavMeshSearchContext* pContext);
+    float Heuristic(const CLTVector& position, uint32_t polyIndex) const;
+
+    bool PassesFilter(uint32_t polyIndex) const {
+        uint8_t area = m_pNavData->GetArea(polyIndex);
+        return (area & m_options.areaFlags) != 0 && (area & m_options.excludedAreaFlags) == 0;
+    }
+
+    bool IsBlocked(uint32_t polyIndex) const {
+        return m_pBlocked && (*m_pBlocked)[polyIndex] != 0;
+    }
+
+    float GetAreaCost(uint32_t polyIndex) const {
+        return m_pAreaCosts ? (*m_pAreaCosts)[m_pNavData->GetArea(polyIndex)] : 1.0f;
+    }
+
+    std::shared_ptr<const CLTNavMeshData> m_pNavData;   ///< Navmesh the search runs on
+    std::shared_ptr<const std::vector<float> > m_pAreaCosts; ///< Cost multiplier by area type, null for plain distance
+    std::shared_ptr<const std::vector<uint8_t> > m_pBlocked; ///< Blocked flag by polygon, null if none are blocked
+    CLTNavMeshSystem::PathFindOptions m_options;        ///< Options the search was started with
+    CLTNavMeshNodePool m_nodePool;                      ///< Path nodes of this search
+    CLTNavMeshNodeQueue m_openList;                     ///< Open list for A*
+    CLTVector m_start;                                  ///< Start position
+    CLTVector m_end;                                    ///< End position
+    uint32_t m_endIndex;                                ///< Dense index of the goal polygon
+    const float* m_pEndLandmarks;                       ///< Landmark distances of the goal polygon, if any
+    NavMeshPathNode* m_pGoalNode;                       ///< Node that reached the goal, if any
+    NavMeshPathNode* m_pBestNode;                       ///< Expanded node closest to the goal
+    PathFindResult m_status;                            ///< Current result
+    double m_searchTime;                                ///< Seconds spent in Update() so far
+    uint64_t m_serial;                                  ///< Unique query serial for the search context
+};
+
+#endif // _CLT_NAVMESH_QUERY_H_
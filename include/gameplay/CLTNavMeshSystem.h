@@ -3,13 +3,23 @@
 
 #include "../CLTBaseClass.h"
 #include "../CLTVector.h"
+#include "CLTNavMeshNodeQueue.h"
+#include "CLTNavMeshNodePool.h"
+#include "CLTNavMeshData.h"
 #include <vector>
 #include <map>
+#include <memory>
 #include <string>
 
 // Forward declarations
+class CLTNavMeshClusterGraph;
 class CLTNavMeshController;
+class CLTNavMeshFlowField;
 class CLTNavMeshPath;
+class CLTNavMeshPathCache;
+class CLTNavMeshPathQueue;
+class CLTNavMeshQuery;
+class CLTNavMeshSearchContext;
 class CLTNavMeshTrigger;
 
 /**
@@ -25,16 +35,51 @@ struct NavMeshPoly {
     uint8_t area;               ///< Area type
 };
 
+/**
+ * @brief Per-object cache of the polygon an object was last found in
+ *
+ * Kept by whoever tracks the object and passed to the location queries of
+ * CLTNavMeshSystem. An object that is still inside the same polygon, or
+ * has stepped into a neighbour, is located without a spatial lookup.
+ */
+struct NavMeshLocation {
+    const CLTNavMeshData* pNavData;     ///< Navmesh of the last lookup, compared by identity only
+    uint32_t polyIndex;                 ///< Dense index of the last polygon in pNavData
+    uint32_t polyId;                    ///< ID of the last polygon, 0 if none
+
+    NavMeshLocation() : pNavData(nullptr), polyIndex(0), polyId(0) {}
+};
+
 /**
  * @brief Structure representing a path node
  */
 struct NavMeshPathNode {
     CLTVector position;     ///< Node position
     uint32_t polyId;        ///< Polygon ID containing this node
+    uint32_t polyIndex;     ///< Dense index of the polygon in the compiled navmesh
     float cost;             ///< Path cost to this node
     float heuristic;        ///< Heuristic cost to goal
     float totalCost;        ///< Total cost (cost + heuristic)
     NavMeshPathNode* parent; ///< Parent node in path
+    uint32_t heapIndex;     ///< Slot in the open list heap (CLTNavMeshNodeQueue::INVALID_INDEX if not queued)
+};
+
+/**
+ * @brief Per-polygon pathfinding state
+ *
+ * One entry exists for every dense polygon index. An entry is only meaningful when its
+ * generation matches the current search, so starting a new search is just a
+ * counter increment instead of clearing the table.
+ */
+struct NavMeshPolyState {
+    uint32_t generation;    ///< Search generation that last touched this entry
+    uint32_t flags;         ///< NODE_OPEN / NODE_CLOSED bits
+    NavMeshPathNode* pNode; ///< Path node allocated for this polygon
+
+    enum {
+        NODE_OPEN   = 0x01,  ///< Polygon is in the open list
+        NODE_CLOSED = 0x02   ///< Polygon has been expanded
+    };
 };
 
 /**
@@ -57,7 +102,18 @@ public:
         PATHFIND_INVALID_END,        ///< Invalid end position
         PATHFIND_OUT_OF_NODES,       ///< Ran out of path nodes
         PATHFIND_TIMEOUT,            ///< Operation timed out
-        PATHFIND_ERROR               ///< Other error
+        PATHFIND_ERROR,              ///< Other error
+        PATHFIND_PENDING             ///< Asynchronous request not finished yet
+    };
+    
+    /**
+     * @brief Priority classes of asynchronous path requests
+     */
+    enum PathPriority {
+        PATH_PRIORITY_HIGH,          ///< Player-visible characters
+        PATH_PRIORITY_NORMAL,        ///< Default
+        PATH_PRIORITY_LOW,           ///< Background characters
+        PATH_PRIORITY_COUNT
     };
     
     /**
@@ -71,7 +127,8 @@ public:
         AREA_STAIRS        = 0x10,   ///< Stairs
         AREA_INDOORS       = 0x20,   ///< Indoor area
         AREA_NO_NAVIGATION = 0x40,   ///< Area where navigation is not allowed
-        AREA_RESTRICTED    = 0x80    ///< Restricted area
+        AREA_RESTRICTED    = 0x80,   ///< Restricted area
+        AREA_ALL           = 0xFF    ///< Every area type
     };
     
     /**
@@ -80,12 +137,22 @@ public:
     struct PathFindOptions {
         uint32_t maxIterations;    ///< Maximum iterations for path finding
         uint32_t maxNodes;         ///< Maximum nodes to consider
-        float maxDistance;         ///< Maximum path distance
+        float maxDistance;         ///< Maximum path cost (distance times area costs), 0 for no limit (the default)
         float straightPathTolerance; ///< Tolerance for straight path optimization
         bool optimizePath;         ///< Whether to optimize the path
-        uint32_t areaFlags;        ///< Area flags to consider (bitfield)
-        uint32_t excludedAreaFlags; ///< Area flags to exclude (bitfield)
-        float timeout;             ///< Timeout in seconds
+        uint32_t areaFlags;        ///< Polygons must have one of these area flags (bitfield)
+        uint32_t excludedAreaFlags; ///< Polygons must have none of these area flags (bitfield)
+        float timeout;             ///< Search time limit in seconds over all slices, 0 for no limit; FindPathsBatch() ignores it
+        bool hierarchical;         ///< Search the cluster graph (HPA*); maxNodes limits abstract nodes
+    };
+    
+    /**
+     * @brief One request of FindPathsBatch()
+     */
+    struct PathRequest {
+        CLTVector start;                ///< Start position
+        CLTVector end;                  ///< End position
+        const PathFindOptions* pOptions; ///< Path finding options, or nullptr for the defaults
     };
     
     /**
@@ -98,6 +165,14 @@ public:
         float distance;         ///< Distance to hit
         uint32_t polyId;        ///< Polygon ID that was hit
     };
+    
+    /**
+     * @brief One ray of RayCastBatch()
+     */
+    struct RayCastRequest {
+        CLTVector start;        ///< Ray start position
+        CLTVector end;          ///< Ray end position
+    };
 
 public:
     /**
@@ -133,6 +208,11 @@ public:
     /**
      * @brief Load a navigation mesh from file
      * 
+     * The file is either a compiled navmesh image (see CLTNavMeshData),
+     * which is memory-mapped rather than parsed, or the manifest of a tiled
+     * world (see CLTNavMeshTileCache). A tiled world starts out empty and
+     * its tiles are streamed in around agents by UpdateStreaming().
+     * 
      * @param pFilename Path to the navigation mesh file
      * @param worldId Optional world ID
      * @return true if loaded successfully, false otherwise
@@ -147,9 +227,48 @@ public:
      */
     bool UnloadNavMesh(uint32_t worldId);
     
+    /**
+     * @brief Stream the tiles of a tiled world around its agents
+     * 
+     * Tiles near the agents are loaded on a background thread and tiles
+     * nobody has been near are evicted least recently used first once the
+     * world's memory budget is exceeded. Newly loaded tiles become visible
+     * to queries in a later call, once the worker has finished them. Does
+     * nothing for worlds that are not tiled.
+     * 
+     * @param pAgentPositions Positions of the agents in the world
+     * @param count Number of positions
+     * @param worldId World ID
+     */
+    void UpdateStreaming(const CLTVector* pAgentPositions, uint32_t count, uint32_t worldId = 0);
+    
+    /**
+     * @brief Set the streaming parameters of a tiled world
+     * 
+     * @param worldId World ID
+     * @param memoryBudget Bytes of navmesh data to keep resident
+     * @param streamingRadius Distance around agents within which tiles are always resident
+     * @return true if the world is loaded and tiled, false otherwise
+     */
+    bool SetStreamingParams(uint32_t worldId, size_t memoryBudget, float streamingRadius);
+    
+    /**
+     * @brief Get the amount of navmesh data resident for a world
+     * 
+     * @param worldId World ID
+     * @return Size of the world's navmesh data in bytes
+     */
+    size_t GetResidentNavMeshBytes(uint32_t worldId) const;
+    
     /**
      * @brief Get a path between two points
      * 
+     * With options.hierarchical set, the search runs over the cluster
+     * graph precomputed when the navmesh was loaded and always finishes in
+     * this call; its cost depends on the number of clusters crossed rather
+     * than the path length. The path may be slightly longer than the plain
+     * A* path.
+     * 
      * @param start Start position
      * @param end End position
      * @param pPath Pointer to receive the path
@@ -165,6 +284,12 @@ public:
      * This is the main pathfinding implementation that was reverse engineered
      * from the game client.
      * 
+     * If maxIterations runs out before the search finishes, the result is
+     * PATHFIND_PARTIAL: pPath holds the path to the explored polygon closest
+     * to the goal and keeps the search state, so ContinuePath() can resume
+     * it. Spreading a search over several calls gives the same path as
+     * running it in one.
+     * 
      * @param start Start position
      * @param end End position
      * @param maxIterations Maximum iterations allowed
@@ -179,13 +304,205 @@ public:
     /**
      * @brief Continue path finding from a previous partial result
      * 
+     * Resumes the search kept in a path returned with PATHFIND_PARTIAL. The
+     * search keeps using the navmesh it started on, even if the world's
+     * tiles have been streamed since.
+     * 
      * @param pPath Path to continue finding
-     * @param maxIterations Maximum iterations allowed
-     * @param maxNodeCount Maximum nodes to process
-     * @return Path finding result code
+     * @param maxIterations Maximum iterations allowed for this call
+     * @param maxNodeCount New node limit for the search, or 0 to keep the current one
+     * @return Path finding result code; PATHFIND_ERROR if the path has no pending search
      */
     PathFindResult ContinuePath(CLTNavMeshPath* pPath, int maxIterations, int maxNodeCount);
     
+    /**
+     * @brief Block or unblock a polygon of the active world
+     * 
+     * For doors, vehicles and spawned barriers. Searches started afterwards
+     * route around blocked polygons and cannot end in one; cached corridors
+     * and flow fields around the polygon are dropped. Blocks are kept per
+     * world by polygon ID, so they survive tile streaming.
+     * 
+     * @param polyId Polygon ID
+     * @param blocked true to block, false to unblock
+     * @return true if the polygon's state changed
+     */
+    bool SetPolygonBlocked(uint32_t polyId, bool blocked);
+    
+    /**
+     * @brief Check whether a polygon of the active world is blocked
+     * 
+     * @param polyId Polygon ID
+     */
+    bool IsPolygonBlocked(uint32_t polyId) const;
+    
+    /**
+     * @brief Repair a path after obstacles changed
+     * 
+     * The path is followed from the agent's polygon. If a polygon ahead is
+     * blocked or no longer loaded, a small search finds a way around it
+     * back onto the corridor, and the rest of the corridor is kept. Only
+     * when the detour is not found within a few hundred nodes, or the agent
+     * has left the corridor, is the whole path searched again from the
+     * agent's position. Paths with nothing blocked ahead are left as they
+     * are.
+     * 
+     * @param pPath Complete path to repair; partial paths are searched again
+     * @param position Current position of the agent following the path
+     * @param pOptions Path finding options, or nullptr for the defaults
+     * @return PATHFIND_SUCCESS if the path is usable, else the result of the new search;
+     *         PATHFIND_PARTIAL for paths whose search is still pending
+     */
+    PathFindResult RepairPath(CLTNavMeshPath* pPath, const CLTVector& position,
+                              const PathFindOptions* pOptions = nullptr);
+    
+    /**
+     * @brief Queue a path request for the worker threads
+     * 
+     * The start and end polygons are looked up immediately; the search runs
+     * on a worker thread against the navmesh as it was at the time of the
+     * call. Workers are started on the first request if SetPathWorkerCount()
+     * has not been called.
+     * 
+     * @param start Start position
+     * @param end End position
+     * @param priority Priority class of the request
+     * @param pOptions Optional path finding options
+     * @return Ticket to pass to GetPathResult() or CancelPathRequest()
+     */
+    uint32_t RequestPath(const CLTVector& start, const CLTVector& end,
+                         PathPriority priority = PATH_PRIORITY_NORMAL,
+                         const PathFindOptions* pOptions = nullptr);
+    
+    /**
+     * @brief Collect the result of a path request
+     * 
+     * Once a result other than PATHFIND_PENDING has been returned the ticket
+     * is released. A PATHFIND_PARTIAL result can be resumed with
+     * ContinuePath().
+     * 
+     * @param ticket Ticket returned by RequestPath()
+     * @param pPath Pointer to receive the path
+     * @return Path finding result code, PATHFIND_PENDING if the request is
+     *         still running, or PATHFIND_ERROR for unknown tickets
+     */
+    PathFindResult GetPathResult(uint32_t ticket, CLTNavMeshPath* pPath);
+    
+    /**
+     * @brief Cancel a path request
+     * 
+     * @param ticket Ticket returned by RequestPath()
+     * @return true if the request existed, false otherwise
+     */
+    bool CancelPathRequest(uint32_t ticket);
+    
+    /**
+     * @brief Set the number of path worker threads
+     * 
+     * Queued requests are kept when the workers are restarted.
+     * 
+     * @param count Number of worker threads
+     */
+    void SetPathWorkerCount(uint32_t count);
+    
+    /**
+     * @brief Find many paths at once
+     * 
+     * Behaves like calling FindPath() for each request, but positions are
+     * looked up once per distinct position, searches are ordered by goal
+     * and start polygon for locality, and the searches run on several
+     * threads, each with its own search context. Every path depends only
+     * on its own request, so the output is the same for any thread count.
+     * For that reason PathFindOptions::timeout is ignored here; searches
+     * are bounded by maxIterations and maxNodes alone.
+     * 
+     * @param pRequests Requests
+     * @param count Number of requests
+     * @param pPaths Array of count paths to receive the results
+     * @param pResults Array of count entries to receive the result codes
+     */
+    void FindPathsBatch(const PathRequest* pRequests, uint32_t count,
+                        CLTNavMeshPath* pPaths, PathFindResult* pResults);
+    
+    /**
+     * @brief Set the number of threads FindPathsBatch() uses
+     * 
+     * @param count Number of threads including the caller, or 0 for one per core
+     */
+    void SetBatchThreadCount(uint32_t count) { m_batchThreadCount = count; }
+    
+    /**
+     * @brief Set the traversal cost multiplier of an area type
+     * 
+     * Path searches scale the length of each step by the multiplier of the
+     * polygons it crosses. A polygon with several area flags uses the
+     * largest of their multipliers. Multipliers below 1 are rejected, as
+     * they would make the distance heuristic overestimate.
+     * 
+     * @param areaFlag A single AreaFlags value, e.g. AREA_WATER
+     * @param cost Multiplier, 1 for plain distance
+     * @return true if the cost was set, false for an invalid flag or cost
+     */
+    bool SetAreaCost(uint32_t areaFlag, float cost);
+    
+    /**
+     * @brief Get the traversal cost multiplier of an area type
+     * 
+     * @param areaFlag A single AreaFlags value
+     * @return Multiplier, 1 for unknown flags
+     */
+    float GetAreaCost(uint32_t areaFlag) const;
+    
+    /**
+     * @brief Set how many path corridors FindPath() and FindPathToo() cache
+     * 
+     * Complete paths are cached by start polygon, end polygon and area
+     * filter; a repeat request rebuilds its waypoints from the cached
+     * corridor instead of searching. Entries are dropped when the navmesh
+     * changes under them. 0 disables the cache.
+     * 
+     * @param capacity Maximum number of cached corridors
+     */
+    void SetPathCacheCapacity(uint32_t capacity);
+    
+    /**
+     * @brief Get the path cache counters
+     * 
+     * @param pHits Pointer to receive the number of lookups served from the cache
+     * @param pMisses Pointer to receive the number of lookups that had to search
+     */
+    void GetPathCacheStats(uint64_t* pHits, uint64_t* pMisses) const;
+    
+    /**
+     * @brief Get a flow field towards a goal shared by many agents
+     * 
+     * The field honors the area filter of the options and the current
+     * area costs. Recently built fields are kept. A cached field is reused
+     * while the goal stays in the same polygon and within reuseDistance of
+     * the goal it was built for, with the same area filter; otherwise a new
+     * field is built. Fields are never reused across navmesh or area cost
+     * changes.
+     * 
+     * @param goal Goal position
+     * @param reuseDistance How far the goal may move before the field is rebuilt
+     * @param pOptions Options supplying the area filter, or nullptr for the defaults
+     * @return The field, or null if the goal is not on the navmesh or is filtered out
+     */
+    std::shared_ptr<const CLTNavMeshFlowField> GetFlowField(const CLTVector& goal, float reuseDistance = 2.0f,
+                                                           const PathFindOptions* pOptions = nullptr);
+    
+    /**
+     * @brief Get the direction an agent should move to follow a flow field
+     * 
+     * @param field Field from GetFlowField()
+     * @param position Agent position
+     * @param pDirection Pointer to receive the unit direction in the XZ plane;
+     *        zero once the agent stands on the goal
+     * @return true if the position is on the navmesh and can reach the goal,
+     *         false otherwise or if the field is for an older navmesh
+     */
+    bool GetFlowDirection(const CLTNavMeshFlowField& field, const CLTVector& position, CLTVector* pDirection);
+    
     /**
      * @brief Find the nearest valid position on the navigation mesh
      * 
@@ -213,38 +530,151 @@ public:
      */
     bool IsIndoors(const CLTVector& position);
     
+    /**
+     * @brief Check if a moving object is indoors
+     * 
+     * Same as IsIndoors(position), but revalidates the object's cached
+     * polygon first; see LocatePolygon().
+     * 
+     * @param position Current position of the object
+     * @param pLocation The object's location cache
+     * @return true if the position is indoors, false otherwise
+     */
+    bool IsIndoors(const CLTVector& position, NavMeshLocation* pLocation);
+    
+    /**
+     * @brief Get the area flags under a moving object
+     * 
+     * @param position Current position of the object
+     * @param pLocation The object's location cache
+     * @return Area flags of the polygon, 0 if the position is not on the navmesh
+     */
+    uint8_t GetAreaFlags(const CLTVector& position, NavMeshLocation* pLocation);
+    
+    /**
+     * @brief Find the polygon under a moving object
+     * 
+     * The polygon in the cache is checked first, then its neighbours; only
+     * if the object has left both is the spatial grid searched. An object
+     * on stacked floors stays on its floor while it remains inside the
+     * cached polygon.
+     * 
+     * @param position Current position of the object
+     * @param pLocation The object's location cache, updated with the result
+     * @return Polygon ID, or 0 if the position is not on the navmesh
+     */
+    uint32_t LocatePolygon(const CLTVector& position, NavMeshLocation* pLocation);
+    
+    /**
+     * @brief Get the location cache counters
+     * 
+     * @param pHits Pointer to receive the number of lookups served by a cached polygon or its neighbours
+     * @param pMisses Pointer to receive the number of lookups that searched the spatial grid
+     */
+    void GetLocationCacheStats(uint64_t* pHits, uint64_t* pMisses) const;
+    
     /**
      * @brief Cast a ray against the navigation mesh
      * 
+     * Walks the ray across the polygon graph in the XZ plane, starting from
+     * the polygon containing the start position. Edges shared with a
+     * neighbour are crossed; the first edge without one is a wall and ends
+     * the ray. A ray that starts off the navmesh hits at its start.
+     * 
+     * On a hit the result holds the point on the wall, the wall normal
+     * (horizontal, facing the ray) and the ID of the polygon the wall
+     * belongs to. Otherwise it holds the end position and the ID of the
+     * polygon containing it.
+     * 
      * @param start Ray start position
      * @param end Ray end position
-     * @param pResult Pointer to receive the result
+     * @param pResult Pointer to receive the result, or nullptr
      * @return true if the ray hit something, false otherwise
      */
     bool RayCast(const CLTVector& start, const CLTVector& end, RayCastResult* pResult);
     
+    /**
+     * @brief Cast many rays, e.g. for an AI sensing pass
+     * 
+     * Same as calling RayCast() for each ray, but identical start positions
+     * are only looked up once.
+     * 
+     * @param pRays Rays to cast
+     * @param count Number of rays
+     * @param pResults Array of count entries to receive the results
+     * @return Number of rays that hit something
+     */
+    uint32_t RayCastBatch(const RayCastRequest* pRays, uint32_t count, RayCastResult* pResults);
+    
     /**
      * @brief Get a random position on the navigation mesh
      * 
+     * Positions are uniformly distributed by XZ area over the mesh within
+     * radius of center, anywhere inside a polygon, so large polygons are
+     * not underweighted. Polygons are picked from a precomputed area
+     * table in O(log n); where floors overlap, from the polygons that
+     * overlap the sphere, clipped to it. The call never allocates. Random
+     * numbers come from a per-thread generator; see SeedRandom().
+     * 
      * @param center Center position
      * @param radius Maximum distance from center
      * @param pResult Pointer to receive the random position
-     * @return true if a position was found, false otherwise
+     * @return true if a position was found, false if there is no mesh in
+     *         range or too little of it for sampling to find
+     */
+    bool GetRandomPosition(const CLTVector& center, float radius, CLTVector* pResult) const;
+    
+    /**
+     * @brief Seed the calling thread's GetRandomPosition() generator
+     * 
+     * Each thread starts with a seed derived from its thread ID. Seeding
+     * makes that thread's sequence of positions repeatable for a given
+     * navmesh.
+     * 
+     * @param seed Any value
+     */
+    static void SeedRandom(uint64_t seed);
+    
+    /**
+     * @brief Set the navigation mesh polygons of a world
+     * 
+     * The polygons are compiled into flat storage; the input is not referenced
+     * after the call returns. This replaces any mesh loaded for the world.
+     * 
+     * @param polygons Polygons to use
+     * @param worldId Optional world ID
+     * @return true if the polygons were valid, false otherwise
      */
-    bool GetRandomPosition(const CLTVector& center, float radius, CLTVector* pResult);
+    bool SetNavMeshData(const std::vector<NavMeshPoly>& polygons, uint32_t worldId = 0);
     
     /**
      * @brief Get polygon data
      * 
+     * This copies the polygon's vertex and neighbour lists; prefer
+     * GetPolygonView() in per-frame code.
+     * 
      * @param polyId Polygon ID
      * @param pPoly Pointer to receive polygon data
      * @return true if the polygon was found, false otherwise
      */
     bool GetPolygon(uint32_t polyId, NavMeshPoly* pPoly);
     
+    /**
+     * @brief Get a zero-copy view of polygon data
+     * 
+     * @param polyId Polygon ID
+     * @param pView Pointer to receive the view
+     * @return true if the polygon was found, false otherwise
+     */
+    bool GetPolygonView(uint32_t polyId, NavMeshPolyView* pView) const;
+    
     /**
      * @brief Get all polygons in a region
      * 
+     * Finds the polygons whose center lies within radius. Each polygon's
+     * vertex and neighbour lists are copied; prefer QueryPolygons() in
+     * per-frame code.
+     * 
      * @param center Center position
      * @param radius Radius around center
      * @param pPolygons Pointer to vector to receive polygons
@@ -252,11 +682,55 @@ public:
      */
     uint32_t GetPolygonsInRegion(const CLTVector& center, float radius, std::vector<NavMeshPoly>* pPolygons);
     
+    /**
+     * @brief Get views of all polygons in a region
+     * 
+     * Finds the polygons whose center lies within radius.
+     * 
+     * @param center Center position
+     * @param radius Radius around center
+     * @param pPolygons Pointer to vector to receive polygon views
+     * @return Number of polygons found
+     */
+    uint32_t GetPolygonsInRegion(const CLTVector& center, float radius, std::vector<NavMeshPolyView>* pPolygons) const;
+    
+    /**
+     * @brief Get views of the polygons overlapping a region
+     * 
+     * Walks the spatial grid and never allocates. When more polygons
+     * overlap than fit, the first maxCount are stored and the return value
+     * tells how large the array needs to be.
+     * 
+     * @param region Box, sphere or capsule to query
+     * @param pPolygons Array of maxCount entries to receive the views
+     * @param maxCount Capacity of pPolygons
+     * @return Number of overlapping polygons, which may exceed maxCount
+     */
+    uint32_t QueryPolygons(const NavMeshRegion& region, NavMeshPolyView* pPolygons, uint32_t maxCount) const;
+    
+    /**
+     * @brief Visit the polygons overlapping a region
+     * 
+     * Walks the spatial grid and never allocates. Each overlapping polygon
+     * is passed to the visitor once, in no particular order, until the
+     * visitor returns false.
+     * 
+     * @param region Box, sphere or capsule to query
+     * @param pVisitor Function called for each overlapping polygon
+     * @param pUserData Pointer passed to pVisitor
+     * @return Number of polygons visited
+     */
+    uint32_t QueryPolygons(const NavMeshRegion& region, NavMeshPolyVisitor pVisitor, void* pUserData) const;
+    
     /**
      * @brief Add a navigation mesh trigger
      * 
+     * The system takes ownership of the trigger and registers its volume in
+     * a spatial hash of XZ cells. Actors already inside receive their enter
+     * events on the next UpdateTriggers().
+     * 
      * @param pTrigger Trigger to add
-     * @return Trigger ID for future reference
+     * @return Trigger ID for future reference, 0 for a null trigger
      */
     uint32_t AddTrigger(CLTNavMeshTrigger* pTrigger);
     
@@ -268,10 +742,43 @@ public:
      */
     bool RemoveTrigger(uint32_t triggerId);
     
+    /**
+     * @brief Get a trigger, e.g. to drain its events
+     * 
+     * @param triggerId Trigger ID
+     * @return The trigger, or nullptr if there is none with this ID
+     */
+    CLTNavMeshTrigger* GetTrigger(uint32_t triggerId) const;
+    
+    /**
+     * @brief Report the position of an actor that can set off triggers
+     * 
+     * Unknown actors are added. Only actors whose position changed are
+     * tested by the next UpdateTriggers().
+     * 
+     * @param actorId Caller-chosen actor ID, e.g. a character's object ID
+     * @param position Current position
+     */
+    void SetTriggerActorPosition(uint32_t actorId, const CLTVector& position);
+    
+    /**
+     * @brief Stop tracking an actor
+     * 
+     * Queues exit events for every trigger the actor was inside.
+     * 
+     * @param actorId Actor ID
+     * @return true if the actor was tracked
+     */
+    bool RemoveTriggerActor(uint32_t actorId);
+    
     /**
      * @brief Update triggers
      * 
-     * Check if any characters have entered or exited trigger volumes.
+     * Check if any characters have entered or exited trigger volumes. Only
+     * actors that moved since the last update are tested, each against the
+     * triggers of its own spatial hash cell and those it was inside, so the
+     * cost grows with movement rather than actors times triggers. Events go
+     * to the queues of the triggers involved.
      */
     void UpdateTriggers();
     
@@ -296,28 +803,77 @@ public:
      * @return Pointer to the active controller
      */
     CLTNavMeshController* GetNavMeshController() const;
+    
+    /**
+     * @brief Get the peak number of path nodes used by a single search
+     * 
+     * @return High-water mark of the path node pool
+     */
+    uint32_t GetNodePoolHighWaterMark() const;
 
 private:
     // Internal helper methods
-    NavMeshPathNode* AllocateNode();
-    void FreeNode(NavMeshPathNode* pNode);
+    void AddController(uint32_t worldId, CLTNavMeshController* pController);
+    void SetActiveController(CLTNavMeshController* pController);
+    PathFindResult StartPath(const CLTVector& start, const CLTVector& end,
+                             const PathFindOptions& options, CLTNavMeshPath* pPath);
+    PathFindResult RunQuery(CLTNavMeshPath* pPath, uint32_t maxIterations);
+    void FinishPath(const CLTNavMeshQuery* pQuery, CLTNavMeshPath* pPath);
+    PathFindResult FindHierarchicalPath(uint32_t startIndex, uint32_t endIndex,
+                                        const PathFindOptions& options, CLTNavMeshPath* pPath);
+    void SetCorridorPath(const std::vector<uint32_t>& corridor, const PathFindOptions& options,
+                         CLTNavMeshPath* pPath);
+    void CachePath(const CLTNavMeshPath* pPath, const PathFindOptions& options);
+    bool FindCachedPath(uint32_t startIndex, uint32_t endIndex, const PathFindOptions& options,
+                        CLTNavMeshPath* pPath);
+    bool CanSearchClusters(const PathFindOptions& options) const;
+    void UpdateBlockedTable();
+    uint32_t LocatePolygonIndex(const CLTVector& position, NavMeshLocation* pLocation);
+    void RegisterTrigger(uint32_t triggerId, const CLTNavMeshTrigger* pTrigger, bool add);
+    bool IsPolygonUsable(uint32_t polyIndex) const;
+    PathFindResult SearchPath(uint32_t startIndex, uint32_t endIndex, const PathFindOptions& options,
+                              CLTNavMeshSearchContext* pContext, CLTNavMeshPath* pPath, uint32_t* pNodeCount);
+    bool RayCastFrom(uint32_t startIndex, const CLTVector& start, const CLTVector& end,
+                     RayCastResult* pResult) const;
     uint32_t FindPolygon(const CLTVector& position, float maxDistance = 2.0f);
-    bool IsPositionInPolygon(const CLTVector& position, const NavMeshPoly& poly);
-    float CalculateHeuristic(const CLTVector& position, const CLTVector& goal);
-    CLTNavMeshPath* ReconstructPath(NavMeshPathNode* pEndNode);
-    CLTNavMeshPath* GetBestPartialPath();
-    void OptimizePath(CLTNavMeshPath* pPath);
+    uint32_t FindPolygonIndex(const CLTVector& position, float maxDistance = 2.0f);
+    uint32_t FindNearestPolygonIndex(const CLTVector& position, float maxDistance);
+    bool IsWithinHeightBand(const CLTVector& position, uint32_t polyIndex) const;
+    bool IsPositionInPolygon(const CLTVector& position, const NavMeshPolyView& poly);
+    void OptimizePath(CLTNavMeshPath* pPath, const CLTNavMeshData& navData, float tolerance);
     
     // Navigation data
     std::map<uint32_t, CLTNavMeshController*> m_controllers; ///< NavMesh controllers by world ID
     CLTNavMeshController* m_pActiveController;              ///< Currently active controller
-    std::map<uint32_t, NavMeshPoly> m_polygons;             ///< NavMesh polygons by ID
+    std::shared_ptr<CLTNavMeshData> m_pNavData;             ///< Polygons of the active controller (empty if none)
+    std::shared_ptr<CLTNavMeshClusterGraph> m_pClusters;    ///< Cluster graph of m_pNavData (null if none)
     std::map<uint32_t, CLTNavMeshTrigger*> m_triggers;      ///< NavMesh triggers by ID
     
+    // Trigger broadphase
+    struct TriggerActor {
+        CLTVector position;                 ///< Last reported position
+        std::vector<uint32_t> triggers;     ///< IDs of the triggers the actor is inside, sorted
+        bool dirty;                         ///< Moved since the last UpdateTriggers()
+    };
+    std::map<uint64_t, std::vector<uint32_t> > m_triggerCells; ///< Trigger IDs by spatial hash cell
+    std::vector<uint32_t> m_largeTriggers;                  ///< Triggers covering too many cells to hash
+    std::map<uint32_t, TriggerActor> m_triggerActors;       ///< Tracked actors by ID
+    std::vector<uint32_t> m_dirtyActors;                    ///< Actors that moved since the last update
+    
     // Pathfinding data
-    std::vector<NavMeshPathNode*> m_nodePool;               ///< Pool of pre-allocated path nodes
-    std::vector<NavMeshPathNode*> m_openList;               ///< Open list for A* algorithm
-    std::vector<NavMeshPathNode*> m_closedList;             ///< Closed list for A* algorithm
+    CLTNavMeshSearchContext* m_pSearchContext;              ///< Per-polygon scratch state for searches
+    CLTNavMeshPathQueue* m_pPathQueue;                      ///< Asynchronous path requests
+    CLTNavMeshPathCache* m_pPathCache;                      ///< Recent corridors of the active world
+    std::vector<std::shared_ptr<const CLTNavMeshFlowField> > m_flowFields; ///< Recent flow fields, most recent first
+    uint32_t m_pathWorkerCount;                             ///< Worker threads started on the first request
+    uint32_t m_nodeHighWater;                               ///< Peak path nodes used by a single search
+    uint32_t m_batchThreadCount;                            ///< FindPathsBatch() threads, 0 for one per core
+    uint64_t m_locationHits;                                ///< Location lookups served by a cached polygon
+    uint64_t m_locationMisses;                              ///< Location lookups that searched the grid
+    float m_areaCosts[8];                                   ///< Cost multiplier by area flag bit
+    std::shared_ptr<const std::vector<float> > m_pAreaCostTable; ///< Cost multiplier by area type byte, null if all 1
+    std::shared_ptr<const std::vector<uint8_t> > m_pBlockedTable; ///< Blocked flag by dense polygon index, null if none
+    std::vector<CLTNavMeshSearchContext*> m_batchContexts;  ///< Search contexts of the extra batch threads
     uint32_t m_nextTriggerId;                               ///< Next trigger ID to assign
     
     // Navigation parameters
@@ -0,0 +1,257 @@
+#ifndef _CLT_NAVMESH_TILE_CACHE_H_
+#define _CLT_NAVMESH_TILE_CACHE_H_
+
+#include "../CLTVector.h"
+#include "CLTNavMeshClusterGraph.h"
+#include "CLTNavMeshData.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct NavMeshPoly;
+
+/**
+ * @brief Header of a tiled navmesh manifest file
+ *
+ * The header is followed by tileCount NavMeshTileEntry records. Each tile
+ * is an ordinary navmesh file (see CLTNavMeshData) stored next to the
+ * manifest as "<manifest>.<tileX>_<tileZ>".
+ */
+struct NavMeshTileManifestHeader {
+    uint32_t magic;             ///< CLTNavMeshTileCache::MANIFEST_MAGIC
+    uint32_t version;           ///< Manifest format version
+    uint32_t tileCount;         ///< Number of tile entries
+    float tileSize;             ///< Tile edge length in world units
+    float originX;              ///< World X of tile (0, 0)
+    float originZ;              ///< World Z of tile (0, 0)
+    uint32_t reserved[2];       ///< Must be zero
+};
+
+/**
+ * @brief Tile entry in a navmesh manifest
+ */
+struct NavMeshTileEntry {
+    int32_t tileX;              ///< Tile column
+    int32_t tileZ;              ///< Tile row
+    uint32_t imageSize;         ///< Size of the tile file in bytes
+    uint32_t polyCount;         ///< Number of polygons in the tile
+};
+
+/**
+ * @brief Streams the tiles of a large world in and out around agents
+ *
+ * A tiled world is split into square tiles on the XZ plane. Each polygon
+ * belongs to the tile containing its center, and links across tile borders
+ * are kept as external links in the tile files. The cache keeps the tiles
+ * near agents resident, plus as many recently used tiles as fit in the
+ * memory budget; the rest are evicted least recently used first.
+ *
+ * Tiles are mapped on a worker thread, which joins the resident tiles into
+ * a single CLTNavMeshData snapshot. Each new snapshot is joined from the
+ * arrays of the previous one and the newly mapped tile images, and its
+ * cluster graph only searches the clusters the change touched. The
+ * snapshot is immutable once published, so queries keep using the previous
+ * one until the main thread picks up the new one with TakeUpdatedData().
+ */
+class CLTNavMeshTileCache {
+public:
+    static const uint32_t MANIFEST_MAGIC = 0x5456414E;  ///< "NAVT"
+    static const uint32_t MANIFEST_VERSION = 1;         ///< Current manifest format version
+
+    /**
+     * @brief Constructor
+     */
+    CLTNavMeshTileCache();
+
+    /**
+     * @brief Destructor (stops the worker thread)
+     */
+    ~CLTNavMeshTileCache();
+
+    /**
+     * @brief Check whether a file is a tiled navmesh manifest
+     *
+     * @param pFilename Path to the file
+     * @return true if the file starts with the manifest magic
+     */
+    static bool IsManifest(const char* pFilename);
+
+    /**
+     * @brief Split polygons into tiles and write the tile files and manifest
+     *
+     * With landmarkCount set, landmarks are picked and measured on the
+     * whole world (see CLTNavMeshData::Build()) and each tile stores the
+     * distance rows of its own polygons, so joined snapshots keep ALT.
+     *
+     * @param polygons Polygons of the whole world
+     * @param tileSize Tile edge length in world units
+     * @param pManifestFile Path of the manifest; tile files are written next to it
+     * @param landmarkCount Number of landmarks to precompute (at most CLTNavMeshData::MAX_LANDMARKS)
+     * @return true if all files were written, false otherwise
+     */
+    static bool WriteTiles(const std::vector<NavMeshPoly>& polygons, float tileSize,
+                           const char* pManifestFile, uint32_t landmarkCount = 0);
+
+    /**
+     * @brief Open a manifest and start the worker thread
+     *
+     * No tiles are loaded until Update() reports agent positions.
+     *
+     * @param pManifestFile Path to the manifest
+     * @return true if the manifest was read, false otherwise
+     */
+    bool Open(const char* pManifestFile);
+
+    /**
+     * @brief Stop the worker thread and drop all tiles
+     */
+    void Close();
+
+    /**
+     * @brief Set the memory budget for resident tiles
+     *
+     * The budget covers what the resident tiles actually hold: the
+     * snapshot image, the tables derived from it and its cluster graph.
+     * Tiles are charged by polygon count at the rate measured on the
+     * latest snapshot. Tiles near agents are always kept, even if they
+     * exceed the budget.
+     *
+     * @param bytes Budget in bytes
+     */
+    void SetMemoryBudget(size_t bytes) { m_memoryBudget = bytes; }
+
+    /**
+     * @brief Get the memory budget for resident tiles
+     */
+    size_t GetMemoryBudget() const { return m_memoryBudget; }
+
+    /**
+     * @brief Set how far around an agent tiles are kept resident
+     *
+     * @param radius Distance in world units
+     */
+    void SetStreamingRadius(float radius) { m_streamingRadius = radius; }
+
+    /**
+     * @brief Get how far around an agent tiles are kept resident
+     */
+    float GetStreamingRadius() const { return m_streamingRadius; }
+
+    /**
+     * @brief Report agent positions and request tile loads and evictions
+     *
+     * Called from the main thread, typically once per frame. Never blocks
+     * on tile loading.
+     *
+     * @param pPositions Agent positions
+     * @param count Number of positions
+     */
+    void Update(const CLTVector* pPositions, uint32_t count);
+
+    /**
+     * @brief Take the snapshot published by the worker since the last call
+     *
+     * @param pClusters Optional pointer to receive the snapshot's cluster graph
+     * @param pResidentTiles Optional pointer to receive the (column, row) of
+     *        each tile in the snapshot, sorted
+     * @return The new snapshot, or null if nothing changed
+     */
+    std::shared_ptr<CLTNavMeshData> TakeUpdatedData(std::shared_ptr<CLTNavMeshClusterGraph>* pClusters = nullptr,
+                                                    std::vector<std::pair<int32_t, int32_t> >* pResidentTiles = nullptr);
+
+    /**
+     * @brief Get the tile edge length in world units
+     */
+    float GetTileSize() const { return m_tileSize; }
+
+    /**
+     * @brief Get the world X of tile (0, 0)
+     */
+    float GetOriginX() const { return m_originX; }
+
+    /**
+     * @brief Get the world Z of tile (0, 0)
+     */
+    float GetOriginZ() const { return m_originZ; }
+
+    /**
+     * @brief Get the number of tiles in the world
+     */
+    uint32_t GetTileCount() const { return static_cast<uint32_t>(m_tiles.size()); }
+
+    /**
+     * @brief Get the number of tiles in the latest snapshot
+     */
+    uint32_t GetResidentTileCount() const;
+
+    /**
+     * @brief Get the memory held by the latest snapshot and its cluster graph in bytes
+     */
+    size_t GetResidentBytes() const;
+
+private:
+    CLTNavMeshTileCache(const CLTNavMeshTileCache&) = delete;
+    CLTNavMeshTileCache& operator=(const CLTNavMeshTileCache&) = delete;
+
+    struct Tile {
+        int32_t x;              ///< Tile column
+        int32_t z;              ///< Tile row
+        uint32_t imageSize;     ///< Size of the tile file in bytes
+        uint32_t polyCount;     ///< Number of polygons in the tile
+        uint64_t lastUsed;      ///< Update() tick in which an agent was last near the tile
+    };
+
+    static uint64_t TileKey(int32_t x, int32_t z) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(z)) << 32) | static_cast<uint32_t>(x);
+    }
+
+    static std::string TileFilename(const std::string& manifest, int32_t x, int32_t z);
+    uint32_t FindTile(int32_t x, int32_t z) const;
+    void WorkerMain();
+    bool LoadTiles(const std::vector<uint32_t>& target, const CLTNavMeshData& current,
+                   const std::vector<uint32_t>& resident, std::vector<uint32_t>* pKept,
+                   std::vector<std::unique_ptr<CLTNavMeshData> >* pImages,
+                   std::vector<std::vector<uint32_t> >* pOwned, std::vector<uint32_t>* pLoaded);
+
+    // Manifest (immutable while the worker runs)
+    std::string m_manifestFile;                     ///< Path of the manifest
+    float m_tileSize;                               ///< Tile edge length
+    float m_originX;                                ///< World X of tile (0, 0)
+    float m_originZ;                                ///< World Z of tile (0, 0)
+    std::vector<Tile> m_tiles;                      ///< All tiles of the world
+    std::map<uint64_t, uint32_t> m_tileLookup;      ///< Tile index by TileKey()
+    int32_t m_minTileX;                             ///< Smallest tile column
+    int32_t m_minTileZ;                             ///< Smallest tile row
+    int32_t m_maxTileX;                             ///< Largest tile column
+    int32_t m_maxTileZ;                             ///< Largest tile row
+
+    // Main thread state
+    size_t m_memoryBudget;                          ///< Budget for resident tiles
+    float m_streamingRadius;                        ///< Distance around agents to keep loaded
+    uint64_t m_tick;                                ///< Update() counter used for LRU
+    std::vector<uint32_t> m_requested;              ///< Tile set last sent to the worker, sorted
+
+    // Shared with the worker, guarded by m_mutex
+    mutable std::mutex m_mutex;                     ///< Guards the members below
+    std::condition_variable m_wake;                 ///< Signals a new target or shutdown
+    std::vector<uint32_t> m_target;                 ///< Tiles the worker should make resident, sorted
+    bool m_targetChanged;                           ///< m_target not yet picked up by the worker
+    bool m_stop;                                    ///< Worker should exit
+    std::shared_ptr<CLTNavMeshData> m_pPublished;   ///< Latest snapshot
+    std::shared_ptr<CLTNavMeshClusterGraph> m_pPublishedClusters; ///< Cluster graph of m_pPublished
+    bool m_publishedChanged;                        ///< m_pPublished not yet taken
+    std::vector<uint32_t> m_resident;               ///< Tiles in m_pPublished, sorted
+    size_t m_residentBytes;                         ///< Memory held by m_pPublished and its cluster graph
+    uint32_t m_residentPolys;                       ///< Polygons in m_pPublished
+
+    std::thread m_worker;                           ///< Tile loading thread
+};
+
+#endif // _CLT_NAVMESH_TILE_CACHE_H_
@@ -0,0 +1,82 @@
+#ifndef _CLT_NAVMESH_TRIGGER_H_
+#define _CLT_NAVMESH_TRIGGER_H_
+
+#include "../CLTVector.h"
+#include <stdint.h>
+#include <deque>
+
+/**
+ * @brief Enter or exit event of a trigger volume
+ */
+struct NavMeshTriggerEvent {
+    uint32_t actorId;           ///< Actor that entered or left the volume
+    bool entered;               ///< true on entering, false on leaving
+};
+
+/**
+ * @brief Axis-aligned trigger volume with its own event queue
+ *
+ * CLTNavMeshSystem::UpdateTriggers() appends enter and exit events as
+ * actors move; the owner drains them in batches with DrainEvents().
+ */
+class CLTNavMeshTrigger {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param boxMin Minimum corner of the volume
+     * @param boxMax Maximum corner of the volume
+     */
+    CLTNavMeshTrigger(const CLTVector& boxMin, const CLTVector& boxMax);
+
+    /**
+     * @brief Get the minimum corner of the volume
+     */
+    const CLTVector& GetMin() const { return m_min; }
+
+    /**
+     * @brief Get the maximum corner of the volume
+     */
+    const CLTVector& GetMax() const { return m_max; }
+
+    /**
+     * @brief Check whether a position lies inside the volume
+     */
+    bool Contains(const CLTVector& position) const {
+        return position.x >= m_min.x && position.x <= m_max.x &&
+               position.y >= m_min.y && position.y <= m_max.y &&
+               position.z >= m_min.z && position.z <= m_max.z;
+    }
+
+    /**
+     * @brief Get the number of queued events
+     */
+    uint32_t GetEventCount() const { return static_cast<uint32_t>(m_events.size()); }
+
+    /**
+     * @brief Take the oldest queued events
+     *
+     * @param pEvents Array to receive the events
+     * @param maxEvents Size of the array
+     * @return Number of events written
+     */
+    uint32_t DrainEvents(NavMeshTriggerEvent* pEvents, uint32_t maxEvents);
+
+    /**
+     * @brief Queue an event
+     *
+     * @param actorId Actor that entered or left the volume
+     * @param entered true on entering, false on leaving
+     */
+    void PushEvent(uint32_t actorId, bool entered);
+
+private:
+    CLTNavMeshTrigger(const CLTNavMeshTrigger&) = delete;
+    CLTNavMeshTrigger& operator=(const CLTNavMeshTrigger&) = delete;
+
+    CLTVector m_min;                                ///< Minimum corner of the volume
+    CLTVector m_max;                                ///< Maximum corner of the volume
+    std::deque<NavMeshTriggerEvent> m_events;       ///< Queued events, oldest first
+};
+
+#endif // _CLT_NAVMESH_TRIGGER_H_
@@ -0,0 +1,1575 @@
+#include "../../include/gameplay/CLTNavMeshBuilder.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <set>
+#include <thread>
+#include <utility>
+
+static_assert(CLTNavMeshBuilder::MAX_VERTS_PER_POLY <= static_cast<int>(CLTNavMeshData::MAX_POLY_VERTICES),
+              "Built polygons must fit the navmesh vertex limit");
+
+namespace {
+
+const uint32_t NO_SPAN = 0xFFFFFFFF;
+const int SPAN_MAX_HEIGHT = 0xFFFF;         // Top of the heightfield, in cell heights
+const uint8_t NOT_CONNECTED = 0xFF;
+const uint16_t BORDER_REG = 0x8000;         // Flag of the regions in the tile's border
+const uint32_t REG_MASK = 0xFFFF;           // Neighbour region bits of a contour vertex
+const uint32_t AREA_BORDER = 0x20000;       // Contour vertex starts an edge between area types
+const int VERTEX_Y_TOLERANCE = 2;           // Cell heights within which polygon vertices are merged
+
+// Neighbour offsets by direction: -X, +Z, +X, -Z
+const int DIR_X[4] = { -1, 0, 1, 0 };
+const int DIR_Z[4] = { 0, 1, 0, -1 };
+
+// Solid span of a heightfield column, in cell heights
+struct Span {
+    uint16_t smin;
+    uint16_t smax;
+    uint8_t area;
+    uint32_t next;          // Next span up the column, or NO_SPAN
+};
+
+struct Heightfield {
+    int width;
+    int height;
+    std::vector<uint32_t> columns;  // Lowest span of each column, or NO_SPAN
+    std::vector<Span> spans;
+};
+
+// Open space above a walkable span
+struct CompactSpan {
+    uint16_t y;             // Floor
+    uint16_t h;             // Clearance
+    uint16_t reg;           // Region, BORDER_REG set in the tile border, 0 if none
+    uint8_t area;
+    uint8_t con[4];         // Layer of the connected span in each neighbour column, or NOT_CONNECTED
+};
+
+struct CompactField {
+    int width;
+    int height;
+    std::vector<uint32_t> cellStart;    // First span of each cell (cells + 1 entries)
+    std::vector<CompactSpan> spans;
+};
+
+// Corner of a region outline, in heightfield cells
+struct ContourVertex {
+    int x;
+    int y;
+    int z;
+    uint32_t r;             // Raw: neighbour region and AREA_BORDER; simplified: raw vertex index
+};
+
+// Voxel sizes of the configuration
+struct TileParams {
+    float cs;
+    float ch;
+    int walkableHeight;
+    int walkableClimb;
+    int walkableRadius;
+    int border;
+    float maxError;         // In cells
+    int maxVertsPerPoly;
+    int minRegionArea;
+    float minNormalY;
+};
+
+inline uint32_t NeighborSpan(const CompactField& cf, int x, int z, int dir, const CompactSpan& s)
+{
+    int nx = x + DIR_X[dir];
+    int nz = z + DIR_Z[dir];
+    return cf.cellStart[nz * cf.width + nx] + s.con[dir];
+}
+
+// Sutherland-Hodgman clip keeping the side of an axis-aligned plane
+int ClipPolygon(const CLTVector* pIn, int n, CLTVector* pOut, int axis, float value, bool keepAbove)
+{
+    int count = 0;
+    for (int i = 0, j = n - 1; i < n; j = i++) {
+        float dj = (&pIn[j].x)[axis] - value;
+        float di = (&pIn[i].x)[axis] - value;
+        if (!keepAbove) {
+            dj = -dj;
+            di = -di;
+        }
+        if ((dj >= 0.0f) != (di >= 0.0f)) {
+            float t = dj / (dj - di);
+            pOut[count++] = pIn[j] + (pIn[i] - pIn[j]) * t;
+        }
+        if (di >= 0.0f) {
+            pOut[count++] = pIn[i];
+        }
+    }
+    return count;
+}
+
+void AddSpan(Heightfield& hf, int x, int z, uint16_t smin, uint16_t smax, uint8_t area, int mergeClimb)
+{
+    Span s = { smin, smax, area, NO_SPAN };
+    uint32_t* pLink = &hf.columns[z * hf.width + x];
+
+    // Merge with every span the new one overlaps; the column stays sorted
+    while (*pLink != NO_SPAN) {
+        Span& current = hf.spans[*pLink];
+        if (current.smin > s.smax) {
+            break;
+        }
+        if (current.smax < s.smin) {
+            pLink = &current.next;
+            continue;
+        }
+
+        s.smin = std::min(s.smin, current.smin);
+        s.smax = std::max(s.smax, current.smax);
+        if (std::abs(static_cast<int>(s.smax) - static_cast<int>(current.smax)) <= mergeClimb) {
+            s.area = std::max(s.area, current.area);
+        }
+        *pLink = current.next;  // Unlinked; the slot is not reused
+    }
+
+    s.next = *pLink;
+    *pLink = static_cast<uint32_t>(hf.spans.size());
+    hf.spans.push_back(s);
+}
+
+void RasterizeTriangle(Heightfield& hf, const CLTVector& origin, const TileParams& params,
+                       const CLTVector& a, const CLTVector& b, const CLTVector& c, uint8_t area)
+{
+    const float cs = params.cs;
+    const float ch = params.ch;
+    float minX = std::min(a.x, std::min(b.x, c.x)) - origin.x;
+    float maxX = std::max(a.x, std::max(b.x, c.x)) - origin.x;
+    float minZ = std::min(a.z, std::min(b.z, c.z)) - origin.z;
+    float maxZ = std::max(a.z, std::max(b.z, c.z)) - origin.z;
+    if (maxX < 0.0f || minX > hf.width * cs || maxZ < 0.0f || minZ > hf.height * cs) {
+        return;
+    }
+
+    int z0 = std::max(0, static_cast<int>(std::floor(minZ / cs)));
+    int z1 = std::min(hf.height - 1, static_cast<int>(std::floor(maxZ / cs)));
+
+    // A triangle clipped by four planes has at most seven vertices
+    CLTVector tri[3] = { a - origin, b - origin, c - origin };
+    CLTVector buffer[8], row[8], cell[8];
+    for (int z = z0; z <= z1; ++z) {
+        int n = ClipPolygon(tri, 3, buffer, 2, z * cs, true);
+        n = ClipPolygon(buffer, n, row, 2, (z + 1) * cs, false);
+        if (n < 3) {
+            continue;
+        }
+
+        float rowMinX = row[0].x, rowMaxX = row[0].x;
+        for (int i = 1; i < n; ++i) {
+            rowMinX = std::min(rowMinX, row[i].x);
+            rowMaxX = std::max(rowMaxX, row[i].x);
+        }
+        int x0 = std::max(0, static_cast<int>(std::floor(rowMinX / cs)));
+        int x1 = std::min(hf.width - 1, static_cast<int>(std::floor(rowMaxX / cs)));
+
+        for (int x = x0; x <= x1; ++x) {
+            int m = ClipPolygon(row, n, buffer, 0, x * cs, true);
+            m = ClipPolygon(buffer, m, cell, 0, (x + 1) * cs, false);
+            if (m < 3) {
+                continue;
+            }
+
+            float smin = cell[0].y, smax = cell[0].y;
+            for (int i = 1; i < m; ++i) {
+                smin = std::min(smin, cell[i].y);
+                smax = std::max(smax, cell[i].y);
+            }
+            if (smax < 0.0f || smin > SPAN_MAX_HEIGHT * ch) {
+                continue;
+            }
+
+            int ismin = std::max(0, std::min(SPAN_MAX_HEIGHT - 1, static_cast<int>(std::floor(smin / ch))));
+            int ismax = std::max(ismin + 1, std::min(SPAN_MAX_HEIGHT, static_cast<int>(std::ceil(smax / ch))));
+            AddSpan(hf, x, z, static_cast<uint16_t>(ismin), static_cast<uint16_t>(ismax), area, params.walkableClimb);
+        }
+    }
+}
+
+void FilterHeightfield(Heightfield& hf, const TileParams& params)
+{
+    const int climb = params.walkableClimb;
+    const int height = params.walkableHeight;
+
+    // Low obstacles on walkable ground, like kerbs, become walkable
+    for (uint32_t first : hf.columns) {
+        bool previousWalkable = false;
+        uint8_t previousArea = 0;
+        int previousTop = 0;
+        for (uint32_t i = first; i != NO_SPAN; i = hf.spans[i].next) {
+            Span& s = hf.spans[i];
+            bool walkable = s.area != 0;
+            if (!walkable && previousWalkable && s.smax - previousTop <= climb) {
+                s.area = previousArea;
+            }
+            previousWalkable = walkable;
+            previousArea = s.area;
+            previousTop = s.smax;
+        }
+    }
+
+    // Ledges: a neighbour drops further than the agent can climb, or the
+    // reachable neighbours differ in height by more than a step
+    std::vector<uint8_t> ledge(hf.spans.size(), 0);
+    for (int z = 0; z < hf.height; ++z) {
+        for (int x = 0; x < hf.width; ++x) {
+            for (uint32_t i = hf.columns[z * hf.width + x]; i != NO_SPAN; i = hf.spans[i].next) {
+                const Span& s = hf.spans[i];
+                if (s.area == 0) {
+                    continue;
+                }
+
+                const int bot = s.smax;
+                const int top = s.next != NO_SPAN ? hf.spans[s.next].smin : SPAN_MAX_HEIGHT;
+                int minDrop = SPAN_MAX_HEIGHT;
+                int accessibleMin = bot, accessibleMax = bot;
+
+                for (int dir = 0; dir < 4; ++dir) {
+                    int nx = x + DIR_X[dir];
+                    int nz = z + DIR_Z[dir];
+                    if (nx < 0 || nz < 0 || nx >= hf.width || nz >= hf.height) {
+                        minDrop = std::min(minDrop, -climb - bot);
+                        continue;
+                    }
+
+                    // The space below the lowest span counts as a floor far down
+                    uint32_t n = hf.columns[nz * hf.width + nx];
+                    int nbot = -climb;
+                    int ntop = n != NO_SPAN ? hf.spans[n].smin : SPAN_MAX_HEIGHT;
+                    if (std::min(top, ntop) - std::max(bot, nbot) > height) {
+                        minDrop = std::min(minDrop, nbot - bot);
+                    }
+
+                    for (; n != NO_SPAN; n = hf.spans[n].next) {
+                        nbot = hf.spans[n].smax;
+                        ntop = hf.spans[n].next != NO_SPAN ? hf.spans[hf.spans[n].next].smin : SPAN_MAX_HEIGHT;
+                        if (std::min(top, ntop) - std::max(bot, nbot) > height) {
+                            minDrop = std::min(minDrop, nbot - bot);
+                            if (std::abs(nbot - bot) <= climb) {
+                                accessibleMin = std::min(accessibleMin, nbot);
+                                accessibleMax = std::max(accessibleMax, nbot);
+                            }
+                        }
+                    }
+                }
+
+                if (minDrop < -climb || accessibleMax - accessibleMin > climb) {
+                    ledge[i] = 1;
+                }
+            }
+        }
+    }
+
+    // Not enough headroom
+    for (uint32_t i = 0; i < hf.spans.size(); ++i) {
+        Span& s = hf.spans[i];
+        int top = s.next != NO_SPAN ? hf.spans[s.next].smin : SPAN_MAX_HEIGHT;
+        if (ledge[i] || top - s.smax < height) {
+            s.area = 0;
+        }
+    }
+}
+
+void BuildCompactField(const Heightfield& hf, const TileParams& params, CompactField* pField)
+{
+    CompactField& cf = *pField;
+    cf.width = hf.width;
+    cf.height = hf.height;
+    cf.cellStart.assign(hf.width * hf.height + 1, 0);
+    cf.spans.clear();
+
+    for (int c = 0; c < hf.width * hf.height; ++c) {
+        cf.cellStart[c] = static_cast<uint32_t>(cf.spans.size());
+        for (uint32_t i = hf.columns[c]; i != NO_SPAN; i = hf.spans[i].next) {
+            const Span& s = hf.spans[i];
+            if (s.area == 0) {
+                continue;
+            }
+            int top = s.next != NO_SPAN ? hf.spans[s.next].smin : SPAN_MAX_HEIGHT;
+            CompactSpan span;
+            span.y = s.smax;
+            span.h = static_cast<uint16_t>(std::min(top - s.smax, SPAN_MAX_HEIGHT));
+            span.reg = 0;
+            span.area = s.area;
+            std::fill(span.con, span.con + 4, NOT_CONNECTED);
+            cf.spans.push_back(span);
+        }
+    }
+    cf.cellStart[hf.width * hf.height] = static_cast<uint32_t>(cf.spans.size());
+
+    // Neighbours an agent can step to: enough shared headroom, small height change
+    for (int z = 0; z < cf.height; ++z) {
+        for (int x = 0; x < cf.width; ++x) {
+            const int c = z * cf.width + x;
+            for (uint32_t i = cf.cellStart[c]; i < cf.cellStart[c + 1]; ++i) {
+                CompactSpan& s = cf.spans[i];
+                for (int dir = 0; dir < 4; ++dir) {
+                    int nx = x + DIR_X[dir];
+                    int nz = z + DIR_Z[dir];
+                    if (nx < 0 || nz < 0 || nx >= cf.width || nz >= cf.height) {
+                        continue;
+                    }
+
+                    const int nc = nz * cf.width + nx;
+                    for (uint32_t k = cf.cellStart[nc]; k < cf.cellStart[nc + 1]; ++k) {
+                        const CompactSpan& ns = cf.spans[k];
+                        int bot = std::max(s.y, ns.y);
+                        int top = std::min(s.y + s.h, ns.y + ns.h);
+                        uint32_t layer = k - cf.cellStart[nc];
+                        if (top - bot >= params.walkableHeight && std::abs(ns.y - s.y) <= params.walkableClimb &&
+                            layer < NOT_CONNECTED) {
+                            s.con[dir] = static_cast<uint8_t>(layer);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Removes walkable spans within the agent radius of an edge, using a
+// two-pass chamfer distance transform (2 per straight step, 3 per diagonal)
+void ErodeWalkableArea(CompactField& cf, int radius)
+{
+    std::vector<uint8_t> dist(cf.spans.size(), 0xFF);
+    for (int z = 0; z < cf.height; ++z) {
+        for (int x = 0; x < cf.width; ++x) {
+            const int c = z * cf.width + x;
+            for (uint32_t i = cf.cellStart[c]; i < cf.cellStart[c + 1]; ++i) {
+                int connected = 0;
+                for (int dir = 0; dir < 4; ++dir) {
+                    if (cf.spans[i].con[dir] != NOT_CONNECTED) {
+                        ++connected;
+                    }
+                }
+                if (connected != 4) {
+                    dist[i] = 0;
+                }
+            }
+        }
+    }
+
+    struct Local {
+        static void Relax(const CompactField& cf, std::vector<uint8_t>& dist, int x, int z, uint32_t i,
+                          int dir, int diagonalDir) {
+            const CompactSpan& s = cf.spans[i];
+            if (s.con[dir] == NOT_CONNECTED) {
+                return;
+            }
+            uint32_t ai = NeighborSpan(cf, x, z, dir, s);
+            dist[i] = static_cast<uint8_t>(std::min<int>(dist[i], dist[ai] + 2));
+
+            const CompactSpan& as = cf.spans[ai];
+            if (as.con[diagonalDir] != NOT_CONNECTED) {
+                uint32_t aai = NeighborSpan(cf, x + DIR_X[dir], z + DIR_Z[dir], diagonalDir, as);
+                dist[i] = static_cast<uint8_t>(std::min<int>(dist[i], dist[aai] + 3));
+            }
+        }
+    };
+
+    for (int z = 0; z < cf.height; ++z) {
+        for (int x = 0; x < cf.width; ++x) {
+            const int c = z * cf.width + x;
+            for (uint32_t i = cf.cellStart[c]; i < cf.cellStart[c + 1]; ++i) {
+                Local::Relax(cf, dist, x, z, i, 0, 3);  // (-1, 0), then (-1, -1)
+                Local::Relax(cf, dist, x, z, i, 3, 2);  // (0, -1), then (1, -1)
+            }
+        }
+    }
+    for (int z = cf.height - 1; z >= 0; --z) {
+        for (int x = cf.width - 1; x >= 0; --x) {
+            const int c = z * cf.width + x;
+            for (uint32_t i = cf.cellStart[c]; i < cf.cellStart[c + 1]; ++i) {
+                Local::Relax(cf, dist, x, z, i, 2, 1);  // (1, 0), then (1, 1)
+                Local::Relax(cf, dist, x, z, i, 1, 0);  // (0, 1), then (-1, 1)
+            }
+        }
+    }
+
+    // Eroded spans stay in the field as unwalkable so the layer indices hold
+    const int threshold = radius * 2;
+    for (uint32_t i = 0; i < cf.spans.size(); ++i) {
+        if (dist[i] < threshold) {
+            cf.spans[i].area = 0;
+        }
+    }
+}
+
+// Partitions the walkable spans into regions that are monotone along X,
+// so no region has holes. Returns the number of regions (IDs 1..count).
+uint16_t BuildRegions(CompactField& cf, const TileParams& params)
+{
+    const int w = cf.width;
+    const int h = cf.height;
+    const int border = params.border;
+
+    for (int z = 0; z < h; ++z) {
+        for (int x = 0; x < w; ++x) {
+            const int c = z * w + x;
+            // Each side of the border is its own region, so contours keep
+            // a vertex where they turn a tile corner
+            uint16_t reg = 0;
+            if (z >= h - border) {
+                reg = BORDER_REG | 4;
+            } else if (z < border) {
+                reg = BORDER_REG | 3;
+            } else if (x >= w - border) {
+                reg = BORDER_REG | 2;
+            } else if (x < border) {
+                reg = BORDER_REG | 1;
+            }
+            for (uint32_t i = cf.cellStart[c]; i < cf.cellStart[c + 1]; ++i) {
+                cf.spans[i].reg = cf.spans[i].area != 0 ? reg : 0;
+            }
+        }
+    }
+
+    // Each row is swept into runs along X; a run continues the region of
+    // the row below if that is the only region it touches and nothing
+    // else in this row touches that region
+    struct Sweep {
+        uint16_t id;
+        uint16_t neighbor;      // Region below, 0 if none, NO_NEIGHBOR if several
+        uint32_t count;         // Spans of the run touching the region below
+    };
+    const uint16_t NO_NEIGHBOR = 0xFFFF;
+    std::vector<Sweep> sweeps;
+    std::vector<uint32_t> touching;
+    std::vector<uint16_t> sweepOf(cf.spans.size(), 0);
+    uint32_t nextId = 1;
+
+    for (int z = border; z < h - border; ++z) {
+        sweeps.assign(1, Sweep());
+        touching.assign(nextId, 0);
+
+        for (int x = border; x < w - border; ++x) {
+            const int c = z * w + x;
+            for (uint32_t i = cf.cellStart[c]; i < cf.cellStart[c + 1]; ++i) {
+                const CompactSpan& s = cf.spans[i];
+                if (s.area == 0) {
+                    continue;
+                }
+
+                // Continue the run from -X
+                uint16_t sweep = 0;
+                if (s.con[0] != NOT_CONNECTED) {
+                    uint32_t ai = NeighborSpan(cf, x, z, 0, s);
+                    if (!(cf.spans[ai].reg & BORDER_REG) && cf.spans[ai].area == s.area) {
+                        sweep = sweepOf[ai];
+                    }
+                }
+                if (sweep == 0) {
+                    sweep = static_cast<uint16_t>(sweeps.size());
+                    Sweep run = { 0, 0, 0 };
+                    sweeps.push_back(run);
+                }
+                sweepOf[i] = sweep;
+
+                // Region of the row below (-Z)
+                if (s.con[3] != NOT_CONNECTED) {
+                    uint32_t ai = NeighborSpan(cf, x, z, 3, s);
+                    uint16_t below = cf.spans[ai].reg;
+                    if (below != 0 && !(below & BORDER_REG) && cf.spans[ai].area == s.area) {
+                        Sweep& run = sweeps[sweep];
+                        if (run.neighbor == 0 || run.neighbor == below) {
+                            run.neighbor = below;
+                            ++run.count;
+                            ++touching[below];
+                        } else {
+                            run.neighbor = NO_NEIGHBOR;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (size_t r = 1; r < sweeps.size(); ++r) {
+            Sweep& run = sweeps[r];
+            if (run.neighbor != 0 && run.neighbor != NO_NEIGHBOR && touching[run.neighbor] == run.count) {
+                run.id = run.neighbor;
+            } else {
+                if (nextId >= BORDER_REG) {
+                    return 0;  // Out of region IDs
+                }
+                run.id = static_cast<uint16_t>(nextId++);
+            }
+        }
+
+        for (int x = border; x < w - border; ++x) {
+            const int c = z * w + x;
+            for (uint32_t i = cf.cellStart[c]; i < cf.cellStart[c + 1]; ++i) {
+                if (cf.spans[i].area != 0) {
+                    cf.spans[i].reg = sweeps[sweepOf[i]].id;
+                }
+            }
+        }
+    }
+
+    // Drop islands smaller than minRegionArea, unless they reach the
+    // border and may continue in the next tile
+    std::vector<uint32_t> parent(nextId);
+    std::vector<uint32_t> size(nextId, 0);
+    std::vector<uint8_t> reachesBorder(nextId, 0);
+    for (uint32_t r = 0; r < nextId; ++r) {
+        parent[r] = r;
+    }
+    struct UnionFind {
+        static uint32_t Find(std::vector<uint32_t>& parent, uint32_t r) {
+            while (parent[r] != r) {
+                parent[r] = parent[parent[r]];
+                r = parent[r];
+            }
+            return r;
+        }
+    };
+
+    for (int z = 0; z < h; ++z) {
+        for (int x = 0; x < w; ++x) {
+            const int c = z * w + x;
+            for (uint32_t i = cf.cellStart[c]; i < cf.cellStart[c + 1]; ++i) {
+                const CompactSpan& s = cf.spans[i];
+                if (s.reg == 0 || (s.reg & BORDER_REG)) {
+                    continue;
+                }
+                ++size[s.reg];
+                for (int dir = 0; dir < 4; ++dir) {
+                    if (s.con[dir] == NOT_CONNECTED) {
+                        continue;
+                    }
+                    uint16_t other = cf.spans[NeighborSpan(cf, x, z, dir, s)].reg;
+                    if (other & BORDER_REG) {
+                        reachesBorder[s.reg] = 1;
+                    } else if (other != 0) {
+                        parent[UnionFind::Find(parent, s.reg)] = UnionFind::Find(parent, other);
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<uint32_t> islandSize(nextId, 0);
+    std::vector<uint8_t> islandBorder(nextId, 0);
+    for (uint32_t r = 1; r < nextId; ++r) {
+        uint32_t root = UnionFind::Find(parent, r);
+        islandSize[root] += size[r];
+        islandBorder[root] |= reachesBorder[r];
+    }
+
+    // Compact the surviving IDs
+    std::vector<uint16_t> remap(nextId, 0);
+    uint16_t regionCount = 0;
+    for (uint32_t r = 1; r < nextId; ++r) {
+        uint32_t root = UnionFind::Find(parent, r);
+        if (size[r] > 0 && (islandBorder[root] || islandSize[root] >= static_cast<uint32_t>(params.minRegionArea))) {
+            remap[r] = ++regionCount;
+        }
+    }
+    for (CompactSpan& s : cf.spans) {
+        if (s.reg != 0 && !(s.reg & BORDER_REG)) {
+            s.reg = remap[s.reg];
+        }
+    }
+
+    return regionCount;
+}
+
+// Height of a cell corner: the highest floor among the spans sharing it
+int GetCornerHeight(const CompactField& cf, int x, int z, uint32_t i, int dir)
+{
+    const CompactSpan& s = cf.spans[i];
+    const int dirp = (dir + 1) & 3;
+    int height = s.y;
+
+    if (s.con[dir] != NOT_CONNECTED) {
+        uint32_t ai = NeighborSpan(cf, x, z, dir, s);
+        const CompactSpan& as = cf.spans[ai];
+        height = std::max<int>(height, as.y);
+        if (as.con[dirp] != NOT_CONNECTED) {
+            height = std::max<int>(height, cf.spans[NeighborSpan(cf, x + DIR_X[dir], z + DIR_Z[dir], dirp, as)].y);
+        }
+    }
+    if (s.con[dirp] != NOT_CONNECTED) {
+        uint32_t ai = NeighborSpan(cf, x, z, dirp, s);
+        const CompactSpan& as = cf.spans[ai];
+        height = std::max<int>(height, as.y);
+        if (as.con[dir] != NOT_CONNECTED) {
+            height = std::max<int>(height, cf.spans[NeighborSpan(cf, x + DIR_X[dirp], z + DIR_Z[dirp], dir, as)].y);
+        }
+    }
+
+    return height;
+}
+
+// Walks a region outline clockwise, clearing the edge flags it passes
+void WalkContour(const CompactField& cf, int x, int z, uint32_t i, std::vector<uint8_t>& flags,
+                 std::vector<ContourVertex>* pVertices)
+{
+    int dir = 0;
+    while (!(flags[i] & (1 << dir))) {
+        ++dir;
+    }
+
+    const int startDir = dir;
+    const uint32_t startIndex = i;
+    const uint8_t area = cf.spans[i].area;
+
+    // Bounded in case of a malformed outline
+    for (int iteration = 0; iteration < 40000; ++iteration) {
+        const CompactSpan& s = cf.spans[i];
+        if (flags[i] & (1 << dir)) {
+            ContourVertex v;
+            v.x = x;
+            v.y = GetCornerHeight(cf, x, z, i, dir);
+            v.z = z;
+            if (dir == 0) {
+                ++v.z;
+            } else if (dir == 1) {
+                ++v.x;
+                ++v.z;
+            } else if (dir == 2) {
+                ++v.x;
+            }
+
+            v.r = 0;
+            if (s.con[dir] != NOT_CONNECTED) {
+                const CompactSpan& as = cf.spans[NeighborSpan(cf, x, z, dir, s)];
+                v.r = as.area != 0 ? as.reg : 0;
+                if (as.area != area) {
+                    v.r |= AREA_BORDER;
+                }
+            }
+            pVertices->push_back(v);
+
+            flags[i] &= static_cast<uint8_t>(~(1 << dir));
+            dir = (dir + 1) & 3;    // Turn clockwise
+        } else {
+            if (s.con[dir] == NOT_CONNECTED) {
+                return;             // Cannot happen for a consistent field
+            }
+            i = NeighborSpan(cf, x, z, dir, s);
+            x += DIR_X[dir];
+            z += DIR_Z[dir];
+            dir = (dir + 3) & 3;    // Turn counter-clockwise
+        }
+
+        if (i == startIndex && dir == startDir) {
+            break;
+        }
+    }
+}
+
+float DistancePointSegmentSquared(int x, int z, int px, int pz, int qx, int qz)
+{
+    float dx = static_cast<float>(qx - px);
+    float dz = static_cast<float>(qz - pz);
+    float lenSq = dx * dx + dz * dz;
+    float t = lenSq > 0.0f ? ((x - px) * dx + (z - pz) * dz) / lenSq : 0.0f;
+    t = std::max(0.0f, std::min(1.0f, t));
+    float ex = px + t * dx - x;
+    float ez = pz + t * dz - z;
+    return ex * ex + ez * ez;
+}
+
+// Keeps the vertices where the neighbouring region or area changes, then
+// adds raw vertices until every wall stays within maxError of the outline
+void SimplifyContour(const std::vector<ContourVertex>& raw, float maxError,
+                     std::vector<ContourVertex>* pSimplified)
+{
+    std::vector<ContourVertex>& simplified = *pSimplified;
+    simplified.clear();
+    const size_t n = raw.size();
+
+    for (size_t i = 0; i < n; ++i) {
+        const ContourVertex& a = raw[i];
+        const ContourVertex& b = raw[(i + 1) % n];
+        if ((a.r & REG_MASK) != (b.r & REG_MASK) || (a.r & AREA_BORDER) != (b.r & AREA_BORDER)) {
+            ContourVertex v = a;
+            v.r = static_cast<uint32_t>(i);
+            simplified.push_back(v);
+        }
+    }
+    if (simplified.empty()) {
+        // An island: start from its lower-left and upper-right corners
+        size_t lowerLeft = 0, upperRight = 0;
+        for (size_t i = 1; i < n; ++i) {
+            const ContourVertex& v = raw[i];
+            if (v.x < raw[lowerLeft].x || (v.x == raw[lowerLeft].x && v.z < raw[lowerLeft].z)) {
+                lowerLeft = i;
+            }
+            if (v.x > raw[upperRight].x || (v.x == raw[upperRight].x && v.z > raw[upperRight].z)) {
+                upperRight = i;
+            }
+        }
+        ContourVertex v = raw[std::min(lowerLeft, upperRight)];
+        v.r = static_cast<uint32_t>(std::min(lowerLeft, upperRight));
+        simplified.push_back(v);
+        if (lowerLeft != upperRight) {
+            v = raw[std::max(lowerLeft, upperRight)];
+            v.r = static_cast<uint32_t>(std::max(lowerLeft, upperRight));
+            simplified.push_back(v);
+        }
+    }
+
+    const float maxErrorSq = maxError * maxError;
+    for (size_t i = 0; i < simplified.size();) {
+        const size_t ii = (i + 1) % simplified.size();
+        int ax = simplified[i].x, az = simplified[i].z;
+        int bx = simplified[ii].x, bz = simplified[ii].z;
+        uint32_t ai = simplified[i].r;
+        uint32_t bi = simplified[ii].r;
+
+        // Walk the raw segment in a fixed direction so shared edges simplify the same way
+        uint32_t ci, cinc, endi;
+        if (bx > ax || (bx == ax && bz > az)) {
+            cinc = 1;
+            ci = static_cast<uint32_t>((ai + cinc) % n);
+            endi = bi;
+        } else {
+            cinc = static_cast<uint32_t>(n - 1);
+            ci = static_cast<uint32_t>((bi + cinc) % n);
+            endi = ai;
+            std::swap(ax, bx);
+            std::swap(az, bz);
+        }
+
+        // Only walls and area borders are refined; edges to other regions stay straight
+        float maxDistance = 0.0f;
+        uint32_t maxIndex = NO_SPAN;
+        if ((raw[ci].r & REG_MASK) == 0 || (raw[ci].r & AREA_BORDER)) {
+            while (ci != endi) {
+                float d = DistancePointSegmentSquared(raw[ci].x, raw[ci].z, ax, az, bx, bz);
+                if (d > maxDistance) {
+                    maxDistance = d;
+                    maxIndex = ci;
+                }
+                ci = static_cast<uint32_t>((ci + cinc) % n);
+            }
+        }
+
+        if (maxIndex != NO_SPAN && maxDistance > maxErrorSq) {
+            ContourVertex v = raw[maxIndex];
+            v.r = maxIndex;
+            simplified.insert(simplified.begin() + i + 1, v);
+        } else {
+            ++i;
+        }
+    }
+
+    // Drop zero-length edges
+    for (size_t i = 0; i < simplified.size() && simplified.size() > 1;) {
+        const ContourVertex& a = simplified[i];
+        const ContourVertex& b = simplified[(i + 1) % simplified.size()];
+        if (a.x == b.x && a.z == b.z) {
+            simplified.erase(simplified.begin() + i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+// Twice the signed area of triangle a, b, c; negative when c lies left of a->b
+// in the contours' clockwise orientation
+inline int Area2(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c)
+{
+    return (b.x - a.x) * (c.z - a.z) - (c.x - a.x) * (b.z - a.z);
+}
+
+inline bool Left(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c) { return Area2(a, b, c) < 0; }
+inline bool LeftOn(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c) { return Area2(a, b, c) <= 0; }
+inline bool Collinear(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c) { return Area2(a, b, c) == 0; }
+inline bool SamePoint(const ContourVertex& a, const ContourVertex& b) { return a.x == b.x && a.z == b.z; }
+
+// Proper intersection: the segments cross at a point interior to both
+bool IntersectProp(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c, const ContourVertex& d)
+{
+    if (Collinear(a, b, c) || Collinear(a, b, d) || Collinear(c, d, a) || Collinear(c, d, b)) {
+        return false;
+    }
+    return (Left(a, b, c) != Left(a, b, d)) && (Left(c, d, a) != Left(c, d, b));
+}
+
+// c lies on the closed segment a-b
+bool Between(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c)
+{
+    if (!Collinear(a, b, c)) {
+        return false;
+    }
+    if (a.x != b.x) {
+        return (a.x <= c.x && c.x <= b.x) || (a.x >= c.x && c.x >= b.x);
+    }
+    return (a.z <= c.z && c.z <= b.z) || (a.z >= c.z && c.z >= b.z);
+}
+
+bool Intersect(const ContourVertex& a, const ContourVertex& b, const ContourVertex& c, const ContourVertex& d)
+{
+    return IntersectProp(a, b, c, d) || Between(a, b, c) || Between(a, b, d) ||
+           Between(c, d, a) || Between(c, d, b);
+}
+
+// Ear clipping over a simple clockwise polygon. Diagonal tests are exact on
+// integer cell coordinates. Returns false if it had to stop early.
+bool Triangulate(const std::vector<ContourVertex>& verts, std::vector<int>* pTriangles)
+{
+    const uint32_t EAR = 0x80000000;
+    const uint32_t INDEX_MASK = 0x7FFFFFFF;
+    int n = static_cast<int>(verts.size());
+    std::vector<uint32_t> indices(n);
+    for (int i = 0; i < n; ++i) {
+        indices[i] = static_cast<uint32_t>(i);
+    }
+
+    auto next = [&n](int i) { return i + 1 < n ? i + 1 : 0; };
+    auto prev = [&n](int i) { return i > 0 ? i - 1 : n - 1; };
+    auto vertex = [&](int i) -> const ContourVertex& { return verts[indices[i] & INDEX_MASK]; };
+
+    // The segment i-j crosses no other edge
+    auto diagonalie = [&](int i, int j) {
+        const ContourVertex& d0 = vertex(i);
+        const ContourVertex& d1 = vertex(j);
+        for (int k = 0; k < n; ++k) {
+            int k1 = next(k);
+            if (k == i || k1 == i || k == j || k1 == j) {
+                continue;
+            }
+            const ContourVertex& p0 = vertex(k);
+            const ContourVertex& p1 = vertex(k1);
+            if (SamePoint(d0, p0) || SamePoint(d1, p0) || SamePoint(d0, p1) || SamePoint(d1, p1)) {
+                continue;
+            }
+            if (Intersect(d0, d1, p0, p1)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // The segment i-j leaves vertex i into the polygon's interior
+    auto inCone = [&](int i, int j) {
+        const ContourVertex& pi = vertex(i);
+        const ContourVertex& pj = vertex(j);
+        const ContourVertex& pi1 = vertex(next(i));
+        const ContourVertex& pin1 = vertex(prev(i));
+        if (LeftOn(pin1, pi, pi1)) {
+            return Left(pi, pj, pin1) && Left(pj, pi, pi1);
+        }
+        return !(LeftOn(pi, pj, pi1) && LeftOn(pj, pi, pin1));
+    };
+
+    auto diagonal = [&](int i, int j) { return inCone(i, j) && diagonalie(i, j); };
+
+    for (int i = 0; i < n; ++i) {
+        int i2 = next(next(i));
+        if (diagonal(i, i2)) {
+            indices[next(i)] |= EAR;
+        }
+    }
+
+    while (n > 3) {
+        // Clip the ear with the shortest diagonal, which keeps triangles compact
+        int best = -1;
+        int bestLength = 0;
+        for (int i = 0; i < n; ++i) {
+            int i1 = next(i);
+            if (indices[i1] & EAR) {
+                const ContourVertex& p0 = vertex(i);
+                const ContourVertex& p2 = vertex(next(i1));
+                int dx = p2.x - p0.x;
+                int dz = p2.z - p0.z;
+                int length = dx * dx + dz * dz;
+                if (best < 0 || length < bestLength) {
+                    best = i;
+                    bestLength = length;
+                }
+            }
+        }
+        if (best < 0) {
+            return false;
+        }
+
+        int i = best;
+        int i1 = next(i);
+        int i2 = next(i1);
+        pTriangles->push_back(static_cast<int>(indices[i] & INDEX_MASK));
+        pTriangles->push_back(static_cast<int>(indices[i1] & INDEX_MASK));
+        pTriangles->push_back(static_cast<int>(indices[i2] & INDEX_MASK));
+
+        // Remove vertex i1 and update the ears around it
+        --n;
+        for (int k = i1; k < n; ++k) {
+            indices[k] = indices[k + 1];
+        }
+        if (i1 >= n) {
+            i1 = 0;
+        }
+        i = prev(i1);
+        if (diagonal(prev(i), i1)) {
+            indices[i] |= EAR;
+        } else {
+            indices[i] &= INDEX_MASK;
+        }
+        if (diagonal(i, next(i1))) {
+            indices[i1] |= EAR;
+        } else {
+            indices[i1] &= INDEX_MASK;
+        }
+    }
+
+    pTriangles->push_back(static_cast<int>(indices[0] & INDEX_MASK));
+    pTriangles->push_back(static_cast<int>(indices[1] & INDEX_MASK));
+    pTriangles->push_back(static_cast<int>(indices[2] & INDEX_MASK));
+    return true;
+}
+
+// Polygon under construction: indices into the tile's vertices
+struct BuildPoly {
+    int verts[CLTNavMeshBuilder::MAX_VERTS_PER_POLY];
+    int count;
+    uint8_t area;
+};
+
+// Squared length of the edge two polygons share, if merging them keeps the
+// result convex and within the vertex limit; otherwise -1
+int GetMergeValue(const BuildPoly& a, const BuildPoly& b, const std::vector<ContourVertex>& verts,
+                  int maxVerts, int* pEdgeA, int* pEdgeB)
+{
+    if (a.count + b.count - 2 > maxVerts) {
+        return -1;
+    }
+
+    *pEdgeA = -1;
+    *pEdgeB = -1;
+    for (int i = 0; i < a.count && *pEdgeA < 0; ++i) {
+        int va0 = a.verts[i];
+        int va1 = a.verts[(i + 1) % a.count];
+        for (int j = 0; j < b.count; ++j) {
+            if (va0 == b.verts[(j + 1) % b.count] && va1 == b.verts[j]) {
+                *pEdgeA = i;
+                *pEdgeB = j;
+                break;
+            }
+        }
+    }
+    if (*pEdgeA < 0) {
+        return -1;
+    }
+
+    // Both corners where the polygons join must stay convex
+    const int ea = *pEdgeA, eb = *pEdgeB;
+    if (!Left(verts[a.verts[(ea + a.count - 1) % a.count]], verts[a.verts[ea]], verts[b.verts[(eb + 2) % b.count]]) ||
+        !Left(verts[b.verts[(eb + b.count - 1) % b.count]], verts[b.verts[eb]], verts[a.verts[(ea + 2) % a.count]])) {
+        return -1;
+    }
+
+    const ContourVertex& p = verts[a.verts[ea]];
+    const ContourVertex& q = verts[a.verts[(ea + 1) % a.count]];
+    return (q.x - p.x) * (q.x - p.x) + (q.z - p.z) * (q.z - p.z);
+}
+
+void MergePolys(BuildPoly* pA, const BuildPoly& b, int ea, int eb)
+{
+    BuildPoly merged = *pA;
+    merged.count = 0;
+    for (int i = 0; i < pA->count - 1; ++i) {
+        merged.verts[merged.count++] = pA->verts[(ea + 1 + i) % pA->count];
+    }
+    for (int i = 0; i < b.count - 1; ++i) {
+        merged.verts[merged.count++] = b.verts[(eb + 1 + i) % b.count];
+    }
+    *pA = merged;
+}
+
+} // namespace
+
+/**
+ * @brief Output of one tile build
+ */
+struct CLTNavMeshBuilder::BuiltTile {
+    /**
+     * @brief Polygon edge lying on the tile's outer boundary
+     *
+     * Positions along the border are global cell coordinates, so both
+     * tiles at a border compute them identically.
+     */
+    struct BorderEdge {
+        uint32_t poly;          ///< Local polygon index
+        int side;               ///< Tile side, as a direction (0 -X, 1 +Z, 2 +X, 3 -Z)
+        int start;              ///< Lower end along the border, in cells
+        int end;                ///< Upper end along the border, in cells
+        float startY;           ///< World Y at start
+        float endY;             ///< World Y at end
+    };
+
+    std::vector<NavMeshPoly> polygons;
+    std::vector<BorderEdge> borderEdges;
+};
+
+CLTNavMeshBuilder::CLTNavMeshBuilder()
+    : m_boundsMin(0.0f, 0.0f, 0.0f)
+    , m_boundsMax(0.0f, 0.0f, 0.0f)
+    , m_tilesX(0)
+    , m_tilesZ(0)
+{
+}
+
+CLTNavMeshBuilder::~CLTNavMeshBuilder()
+{
+    ClearTiles();
+}
+
+bool CLTNavMeshBuilder::SetConfig(const NavMeshBuildConfig& config)
+{
+    if (!(config.cellSize > 0.0f) || !(config.cellHeight > 0.0f) || !(config.agentHeight > 0.0f) ||
+        !(config.agentRadius >= 0.0f) || !(config.agentMaxClimb >= 0.0f) ||
+        !(config.agentMaxSlope >= 0.0f && config.agentMaxSlope < 90.0f) || config.tileSize < 1 ||
+        !(config.maxEdgeError >= 0.0f) || config.maxVertsPerPoly < 3 || config.maxVertsPerPoly > MAX_VERTS_PER_POLY) {
+        return false;
+    }
+
+    m_config = config;
+    ClearTiles();
+
+    // The tile grid depends on the cell size, so re-bin the triangles
+    if (!m_indices.empty()) {
+        std::vector<CLTVector> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<uint8_t> areas;
+        vertices.swap(m_vertices);
+        indices.swap(m_indices);
+        areas.swap(m_areas);
+        return SetGeometry(vertices.data(), static_cast<uint32_t>(vertices.size()), indices.data(),
+                           static_cast<uint32_t>(indices.size() / 3), areas.data());
+    }
+    return true;
+}
+
+bool CLTNavMeshBuilder::SetGeometry(const CLTVector* pVertices, uint32_t vertexCount,
+                                    const uint32_t* pIndices, uint32_t triangleCount,
+                                    const uint8_t* pAreas)
+{
+    for (uint32_t i = 0; i < triangleCount * 3; ++i) {
+        if (pIndices[i] >= vertexCount) {
+            return false;
+        }
+    }
+
+    CLTVector boundsMin(FLT_MAX, FLT_MAX, FLT_MAX);
+    CLTVector boundsMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (uint32_t i = 0; i < triangleCount * 3; ++i) {
+        const CLTVector& v = pVertices[pIndices[i]];
+        boundsMin = CLTVector(std::min(boundsMin.x, v.x), std::min(boundsMin.y, v.y), std::min(boundsMin.z, v.z));
+        boundsMax = CLTVector(std::max(boundsMax.x, v.x), std::max(boundsMax.y, v.y), std::max(boundsMax.z, v.z));
+    }
+
+    // Tiles start on a whole tile from the origin, so geometry that grows
+    // or shrinks elsewhere leaves the tile grid where it was
+    const float tileWorldSize = m_config.tileSize * m_config.cellSize;
+    int tilesX = 0, tilesZ = 0;
+    CLTVector origin(0.0f, 0.0f, 0.0f);
+    if (triangleCount > 0) {
+        origin.x = std::floor(boundsMin.x / tileWorldSize) * tileWorldSize;
+        origin.z = std::floor(boundsMin.z / tileWorldSize) * tileWorldSize;
+        origin.y = boundsMin.y;
+        double spanX = std::ceil((static_cast<double>(boundsMax.x) - origin.x) / tileWorldSize);
+        double spanZ = std::ceil((static_cast<double>(boundsMax.z) - origin.z) / tileWorldSize);
+        if (spanX * spanZ > MAX_TILES) {
+            return false;
+        }
+        tilesX = std::max(1, static_cast<int>(spanX));
+        tilesZ = std::max(1, static_cast<int>(spanZ));
+        if (static_cast<uint32_t>(tilesX * tilesZ) > MAX_TILES) {
+            return false;
+        }
+    }
+
+    // Built tiles survive only if they line up with the new grid
+    if (tilesX != m_tilesX || tilesZ != m_tilesZ || origin.x != m_boundsMin.x || origin.y != m_boundsMin.y ||
+        origin.z != m_boundsMin.z) {
+        ClearTiles();
+    }
+
+    m_vertices.assign(pVertices, pVertices + vertexCount);
+    m_indices.assign(pIndices, pIndices + triangleCount * 3);
+    if (pAreas) {
+        m_areas.assign(pAreas, pAreas + triangleCount);
+    } else {
+        m_areas.assign(triangleCount, CLTNavMeshSystem::AREA_WALKABLE);
+    }
+    m_boundsMin = origin;
+    m_boundsMax = boundsMax;
+    m_tilesX = tilesX;
+    m_tilesZ = tilesZ;
+    m_tiles.resize(static_cast<size_t>(tilesX) * tilesZ, nullptr);
+
+    // Bin triangles by the tiles they touch, border included
+    const int border = static_cast<int>(std::ceil(m_config.agentRadius / m_config.cellSize)) + 3;
+    const float borderSize = border * m_config.cellSize;
+    const uint32_t tileCount = static_cast<uint32_t>(tilesX * tilesZ);
+    m_tileTriStart.assign(tileCount + 1, 0);
+    m_tileTris.clear();
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<uint32_t> cursor;
+        if (pass == 1) {
+            for (uint32_t t = 0; t < tileCount; ++t) {
+                m_tileTriStart[t + 1] += m_tileTriStart[t];
+            }
+            m_tileTris.resize(m_tileTriStart[tileCount]);
+            cursor.assign(m_tileTriStart.begin(), m_tileTriStart.end() - 1);
+        }
+
+        for (uint32_t tri = 0; tri < triangleCount; ++tri) {
+            const CLTVector& a = m_vertices[m_indices[tri * 3]];
+            const CLTVector& b = m_vertices[m_indices[tri * 3 + 1]];
+            const CLTVector& c = m_vertices[m_indices[tri * 3 + 2]];
+            float minX = std::min(a.x, std::min(b.x, c.x)) - origin.x;
+            float maxX = std::max(a.x, std::max(b.x, c.x)) - origin.x;
+            float minZ = std::min(a.z, std::min(b.z, c.z)) - origin.z;
+            float maxZ = std::max(a.z, std::max(b.z, c.z)) - origin.z;
+            int x0 = std::max(0, static_cast<int>(std::floor((minX - borderSize) / tileWorldSize)));
+            int x1 = std::min(tilesX - 1, static_cast<int>(std::floor((maxX + borderSize) / tileWorldSize)));
+            int z0 = std::max(0, static_cast<int>(std::floor((minZ - borderSize) / tileWorldSize)));
+            int z1 = std::min(tilesZ - 1, static_cast<int>(std::floor((maxZ + borderSize) / tileWorldSize)));
+
+            for (int tz = z0; tz <= z1; ++tz) {
+                for (int tx = x0; tx <= x1; ++tx) {
+                    uint32_t tile = static_cast<uint32_t>(tz * tilesX + tx);
+                    if (pass == 0) {
+                        ++m_tileTriStart[tile + 1];
+                    } else {
+                        m_tileTris[cursor[tile]++] = tri;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool CLTNavMeshBuilder::GetTileCoords(const CLTVector& position, int* pTileX, int* pTileZ) const
+{
+    const float tileWorldSize = m_config.tileSize * m_config.cellSize;
+    *pTileX = static_cast<int>(std::floor((position.x - m_boundsMin.x) / tileWorldSize));
+    *pTileZ = static_cast<int>(std::floor((position.z - m_boundsMin.z) / tileWorldSize));
+    return *pTileX >= 0 && *pTileX < m_tilesX && *pTileZ >= 0 && *pTileZ < m_tilesZ;
+}
+
+bool CLTNavMeshBuilder::Build(std::vector<NavMeshPoly>* pPolygons)
+{
+    pPolygons->clear();
+    if (m_tilesX == 0 || !BuildTiles(0, 0, m_tilesX - 1, m_tilesZ - 1)) {
+        return false;
+    }
+
+    GetPolygons(pPolygons);
+    return true;
+}
+
+bool CLTNavMeshBuilder::BuildTiles(int minTileX, int minTileZ, int maxTileX, int maxTileZ)
+{
+    minTileX = std::max(minTileX, 0);
+    minTileZ = std::max(minTileZ, 0);
+    maxTileX = std::min(maxTileX, m_tilesX - 1);
+    maxTileZ = std::min(maxTileZ, m_tilesZ - 1);
+    if (minTileX > maxTileX || minTileZ > maxTileZ) {
+        return false;
+    }
+
+    std::vector<uint32_t> tiles;
+    for (int tz = minTileZ; tz <= maxTileZ; ++tz) {
+        for (int tx = minTileX; tx <= maxTileX; ++tx) {
+            tiles.push_back(static_cast<uint32_t>(tz * m_tilesX + tx));
+        }
+    }
+
+    // Tiles share nothing while they build, so workers claim them in any order
+    std::vector<BuiltTile*> results(tiles.size(), nullptr);
+    std::vector<uint8_t> succeeded(tiles.size(), 0);
+    std::atomic<uint32_t> nextTile(0);
+    auto worker = [&]() {
+        for (uint32_t i = nextTile++; i < tiles.size(); i = nextTile++) {
+            BuiltTile* pTile = new BuiltTile();
+            succeeded[i] = BuildTile(static_cast<int>(tiles[i] % m_tilesX), static_cast<int>(tiles[i] / m_tilesX), pTile);
+            results[i] = pTile;
+        }
+    };
+
+    uint32_t threadCount = m_config.threadCount > 0 ? m_config.threadCount : std::thread::hardware_concurrency();
+    threadCount = std::max(1u, std::min(threadCount, static_cast<uint32_t>(tiles.size())));
+    std::vector<std::thread> threads;
+    for (uint32_t t = 1; t < threadCount; ++t) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        delete m_tiles[tiles[i]];
+        m_tiles[tiles[i]] = results[i];
+        ok = ok && succeeded[i];
+    }
+
+    // Relink every border of a rebuilt tile, once per pair
+    std::set<std::pair<uint32_t, int> > borders;
+    for (uint32_t tile : tiles) {
+        const int tx = static_cast<int>(tile % m_tilesX);
+        const int tz = static_cast<int>(tile / m_tilesX);
+        for (int side = 0; side < 4; ++side) {
+            int nx = tx + DIR_X[side];
+            int nz = tz + DIR_Z[side];
+            if (nx < 0 || nz < 0 || nx >= m_tilesX || nz >= m_tilesZ) {
+                continue;
+            }
+            uint32_t neighbor = static_cast<uint32_t>(nz * m_tilesX + nx);
+
+            // Keyed by the -X / -Z tile and its side facing +X / +Z
+            if (side == 1 || side == 2) {
+                borders.insert(std::make_pair(tile, side));
+            } else {
+                borders.insert(std::make_pair(neighbor, (side + 2) & 3));
+            }
+        }
+    }
+    for (const std::pair<uint32_t, int>& border : borders) {
+        const int side = border.second;
+        uint32_t other = border.first + (side == 2 ? 1 : m_tilesX);
+        LinkTiles(border.first, other, side);
+    }
+
+    return ok;
+}
+
+void CLTNavMeshBuilder::GetPolygons(std::vector<NavMeshPoly>* pPolygons) const
+{
+    pPolygons->clear();
+    for (const BuiltTile* pTile : m_tiles) {
+        if (pTile) {
+            pPolygons->insert(pPolygons->end(), pTile->polygons.begin(), pTile->polygons.end());
+        }
+    }
+}
+
+void CLTNavMeshBuilder::ClearTiles()
+{
+    for (BuiltTile* pTile : m_tiles) {
+        delete pTile;
+    }
+    std::fill(m_tiles.begin(), m_tiles.end(), nullptr);
+}
+
+void CLTNavMeshBuilder::LinkTiles(uint32_t tileA, uint32_t tileB, int side)
+{
+    BuiltTile* pA = m_tiles[tileA];
+    BuiltTile* pB = m_tiles[tileB];
+    if (!pA || !pB) {
+        return;
+    }
+
+    // Drop the old links across this border; IDs carry their tile in the high bits
+    for (NavMeshPoly& poly : pA->polygons) {
+        poly.neighbors.erase(std::remove_if(poly.neighbors.begin(), poly.neighbors.end(),
+            [tileB](uint32_t id) { return (id >> 16) == tileB; }), poly.neighbors.end());
+    }
+    for (NavMeshPoly& poly : pB->polygons) {
+        poly.neighbors.erase(std::remove_if(poly.neighbors.begin(), poly.neighbors.end(),
+            [tileA](uint32_t id) { return (id >> 16) == tileA; }), poly.neighbors.end());
+    }
+
+    // Edges on the shared border that overlap and meet within a step are linked
+    const int opposite = (side + 2) & 3;
+    for (const BuiltTile::BorderEdge& ea : pA->borderEdges) {
+        if (ea.side != side) {
+            continue;
+        }
+        for (const BuiltTile::BorderEdge& eb : pB->borderEdges) {
+            if (eb.side != opposite) {
+                continue;
+            }
+
+            int start = std::max(ea.start, eb.start);
+            int end = std::min(ea.end, eb.end);
+            if (end <= start) {
+                continue;
+            }
+
+            float mid = 0.5f * (start + end);
+            float ya = ea.startY + (ea.endY - ea.startY) * (mid - ea.start) / (ea.end - ea.start);
+            float yb = eb.startY + (eb.endY - eb.startY) * (mid - eb.start) / (eb.end - eb.start);
+            if (std::fabs(ya - yb) > m_config.agentMaxClimb) {
+                continue;
+            }
+
+            NavMeshPoly& polyA = pA->polygons[ea.poly];
+            NavMeshPoly& polyB = pB->polygons[eb.poly];
+            if (std::find(polyA.neighbors.begin(), polyA.neighbors.end(), polyB.id) == polyA.neighbors.end()) {
+                polyA.neighbors.push_back(polyB.id);
+                polyB.neighbors.push_back(polyA.id);
+            }
+        }
+    }
+}
+
+bool CLTNavMeshBuilder::BuildTile(int tileX, int tileZ, BuiltTile* pTile) const
+{
+    TileParams params;
+    params.cs = m_config.cellSize;
+    params.ch = m_config.cellHeight;
+    params.walkableHeight = static_cast<int>(std::ceil(m_config.agentHeight / params.ch));
+    params.walkableClimb = static_cast<int>(std::floor(m_config.agentMaxClimb / params.ch));
+    params.walkableRadius = static_cast<int>(std::ceil(m_config.agentRadius / params.cs));
+    params.border = params.walkableRadius + 3;
+    params.maxError = m_config.maxEdgeError / params.cs;
+    params.maxVertsPerPoly = m_config.maxVertsPerPoly;
+    params.minRegionArea = m_config.minRegionArea;
+    params.minNormalY = std::cos(m_config.agentMaxSlope * 3.14159265f / 180.0f);
+
+    const int tileSize = m_config.tileSize;
+    const int border = params.border;
+
+    // Heightfield covering the tile and its border
+    Heightfield hf;
+    hf.width = tileSize + border * 2;
+    hf.height = tileSize + border * 2;
+    hf.columns.assign(hf.width * hf.height, NO_SPAN);
+    const int cellX0 = tileX * tileSize - border;   // Global cell of the heightfield's first column
+    const int cellZ0 = tileZ * tileSize - border;
+    const CLTVector origin(m_boundsMin.x + cellX0 * params.cs, m_boundsMin.y, m_boundsMin.z + cellZ0 * params.cs);
+
+    const uint32_t tile = static_cast<uint32_t>(tileZ * m_tilesX + tileX);
+    for (uint32_t t = m_tileTriStart[tile]; t < m_tileTriStart[tile + 1]; ++t) {
+        const uint32_t tri = m_tileTris[t];
+        const CLTVector& a = m_vertices[m_indices[tri * 3]];
+        const CLTVector& b = m_vertices[m_indices[tri * 3 + 1]];
+        const CLTVector& c = m_vertices[m_indices[tri * 3 + 2]];
+
+        // Slope from the normal; either winding faces up
+        CLTVector normal = (b - a).Cross(c - a);
+        float length = normal.Length();
+        uint8_t area = m_areas[tri];
+        if (!(length > 0.0f) || std::fabs(normal.y) / length < params.minNormalY) {
+            area = 0;
+        }
+        RasterizeTriangle(hf, origin, params, a, b, c, area);
+    }
+
+    FilterHeightfield(hf, params);
+
+    CompactField cf;
+    BuildCompactField(hf, params, &cf);
+    ErodeWalkableArea(cf, params.walkableRadius);
+    BuildRegions(cf, params);
+
+    // Edges of each span that face another region, the border or a wall
+    std::vector<uint8_t> flags(cf.spans.size(), 0);
+    for (int z = 0; z < cf.height; ++z) {
+        for (int x = 0; x < cf.width; ++x) {
+            const int c = z * cf.width + x;
+            for (uint32_t i = cf.cellStart[c]; i < cf.cellStart[c + 1]; ++i) {
+                const CompactSpan& s = cf.spans[i];
+                if (s.area == 0 || s.reg == 0 || (s.reg & BORDER_REG)) {
+                    continue;
+                }
+                uint8_t same = 0;
+                for (int dir = 0; dir < 4; ++dir) {
+                    if (s.con[dir] != NOT_CONNECTED) {
+                        const CompactSpan& as = cf.spans[NeighborSpan(cf, x, z, dir, s)];
+                        if (as.area != 0 && as.reg == s.reg) {
+                            same |= static_cast<uint8_t>(1 << dir);
+                        }
+                    }
+                }
+                flags[i] = same ^ 0xF;
+            }
+        }
+    }
+
+    // Polygon vertices are shared within the tile, merged by cell and height
+    std::vector<ContourVertex> vertices;
+    std::multimap<std::pair<int, int>, int> vertexLookup;
+    auto addVertex = [&](const ContourVertex& v) {
+        auto range = vertexLookup.equal_range(std::make_pair(v.x, v.z));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (std::abs(vertices[it->second].y - v.y) <= VERTEX_Y_TOLERANCE) {
+                return it->second;
+            }
+        }
+        int index = static_cast<int>(vertices.size());
+        vertices.push_back(v);
+        vertexLookup.insert(std::make_pair(std::make_pair(v.x, v.z), index));
+        return index;
+    };
+
+    std::vector<BuildPoly> polys;
+    std::vector<ContourVertex> raw, simplified;
+    std::vector<int> contourVertices, triangles;
+    std::vector<BuildPoly> contourPolys;
+    bool ok = true;
+    for (int z = 0; z < cf.height; ++z) {
+        for (int x = 0; x < cf.width; ++x) {
+            const int c = z * cf.width + x;
+            for (uint32_t i = cf.cellStart[c]; i < cf.cellStart[c + 1]; ++i) {
+                // A lone cell enclosed on all four sides is too small to keep
+                if (flags[i] == 0 || flags[i] == 0xF) {
+                    flags[i] = 0;
+                    continue;
+                }
+
+                raw.clear();
+                WalkContour(cf, x, z, i, flags, &raw);
+                SimplifyContour(raw, params.maxError, &simplified);
+                if (simplified.size() < 3) {
+                    continue;
+                }
+
+                // Outlines run clockwise; anything else would be a hole
+                int area2 = 0;
+                for (size_t k = 0, j = simplified.size() - 1; k < simplified.size(); j = k++) {
+                    area2 += simplified[k].x * simplified[j].z - simplified[j].x * simplified[k].z;
+                }
+                if (area2 <= 0) {
+                    continue;
+                }
+
+                triangles.clear();
+                if (!Triangulate(simplified, &triangles)) {
+                    ok = false;     // Keep the triangles made so far
+                }
+
+                contourVertices.clear();
+                for (const ContourVertex& v : simplified) {
+                    contourVertices.push_back(addVertex(v));
+                }
+
+                contourPolys.clear();
+                for (size_t t = 0; t + 2 < triangles.size(); t += 3) {
+                    BuildPoly poly;
+                    poly.count = 3;
+                    poly.area = cf.spans[i].area;
+                    for (int k = 0; k < 3; ++k) {
+                        poly.verts[k] = contourVertices[triangles[t + k]];
+                    }
+                    if (poly.verts[0] != poly.verts[1] && poly.verts[1] != poly.verts[2] && poly.verts[0] != poly.verts[2]) {
+                        contourPolys.push_back(poly);
+                    }
+                }
+
+                // Greedily merge across the longest shared edge while the result stays convex
+                for (;;) {
+                    int bestValue = 0, bestA = -1, bestB = -1, bestEdgeA = 0, bestEdgeB = 0;
+                    for (size_t a = 0; a < contourPolys.size(); ++a) {
+                        for (size_t b = a + 1; b < contourPolys.size(); ++b) {
+                            int ea = -1, eb = -1;
+                            int value = GetMergeValue(contourPolys[a], contourPolys[b], vertices,
+                                                      params.maxVertsPerPoly, &ea, &eb);
+                            if (value > bestValue) {
+                                bestValue = value;
+                                bestA = static_cast<int>(a);
+                                bestB = static_cast<int>(b);
+                                bestEdgeA = ea;
+                                bestEdgeB = eb;
+                            }
+                        }
+                    }
+                    if (bestA < 0) {
+                        break;
+                    }
+                    MergePolys(&contourPolys[bestA], contourPolys[bestB], bestEdgeA, bestEdgeB);
+                    contourPolys.erase(contourPolys.begin() + bestB);
+                }
+
+                polys.insert(polys.end(), contourPolys.begin(), contourPolys.end());
+            }
+        }
+    }
+
+    if (polys.size() > MAX_TILE_POLYS) {
+        return false;
+    }
+
+    // Output in world units; positions come from global cells so that tiles
+    // agree on shared borders
+    auto toWorld = [&](const ContourVertex& v) {
+        return CLTVector(m_boundsMin.x + (cellX0 + v.x) * params.cs,
+                         m_boundsMin.y + v.y * params.ch,
+                         m_boundsMin.z + (cellZ0 + v.z) * params.cs);
+    };
+
+    const uint32_t idBase = tile << 16;
+    pTile->polygons.resize(polys.size());
+    for (size_t p = 0; p < polys.size(); ++p) {
+        const BuildPoly& poly = polys[p];
+        NavMeshPoly& out = pTile->polygons[p];
+        out.id = idBase | static_cast<uint32_t>(p + 1);
+        out.vertices.clear();
+        CLTVector sum(0.0f, 0.0f, 0.0f);
+        for (int k = 0; k < poly.count; ++k) {
+            out.vertices.push_back(toWorld(vertices[poly.verts[k]]));
+            sum = sum + out.vertices.back();
+        }
+        out.center = sum / static_cast<float>(poly.count);
+        out.height = out.center.y;
+        out.flags = 0;
+        out.area = poly.area;
+        out.neighbors.clear();
+    }
+
+    // Neighbours inside the tile share an edge's two vertices in opposite order
+    std::map<std::pair<int, int>, uint32_t> edges;
+    for (size_t p = 0; p < polys.size(); ++p) {
+        const BuildPoly& poly = polys[p];
+        for (int k = 0; k < poly.count; ++k) {
+            int v0 = poly.verts[k];
+            int v1 = poly.verts[(k + 1) % poly.count];
+            auto it = edges.find(std::make_pair(v1, v0));
+            if (it != edges.end()) {
+                NavMeshPoly& a = pTile->polygons[p];
+                NavMeshPoly& b = pTile->polygons[it->second];
+                if (std::find(a.neighbors.begin(), a.neighbors.end(), b.id) == a.neighbors.end()) {
+                    a.neighbors.push_back(b.id);
+                    b.neighbors.push_back(a.id);
+                }
+            } else {
+                edges[std::make_pair(v0, v1)] = static_cast<uint32_t>(p);
+            }
+
+            // Edges on the tile's outer boundary are linked to the next tile later
+            const ContourVertex& a = vertices[v0];
+            const ContourVertex& b = vertices[v1];
+            const int lo = border, hi = border + tileSize;
+            int side = -1;
+            if (a.x == b.x && (a.x == lo || a.x == hi)) {
+                side = a.x == lo ? 0 : 2;
+            } else if (a.z == b.z && (a.z == lo || a.z == hi)) {
+                side = a.z == lo ? 3 : 1;
+            }
+            if (side >= 0) {
+                bool alongZ = (side == 0 || side == 2);
+                int ta = alongZ ? cellZ0 + a.z : cellX0 + a.x;
+                int tb = alongZ ? cellZ0 + b.z : cellX0 + b.x;
+                float ya = m_boundsMin.y + a.y * params.ch;
+                float yb = m_boundsMin.y + b.y * params.ch;
+                BuiltTile::BorderEdge edge;
+                edge.poly = static_cast<uint32_t>(p);
+                edge.side = side;
+                edge.start = std::min(ta, tb);
+                edge.end = std::max(ta, tb);
+                edge.startY = ta < tb ? ya : yb;
+                edge.endY = ta < tb ? yb : ya;
+                pTile->borderEdges.push_back(edge);
+            }
+        }
+    }
+
+    return ok;
+}
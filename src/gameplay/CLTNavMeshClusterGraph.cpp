@@ -0,0 +1,580 @@
+#include "../../include/gameplay/CLTNavMeshClusterGraph.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <queue>
+#include <utility>
+
+namespace {
+
+const uint32_t INVALID_INDEX = CLTNavMeshData::INVALID_INDEX;
+
+// Open list entry shared by the cluster and abstract searches
+struct OpenEntry {
+    float total;        // Cost plus heuristic
+    float cost;         // Cost when queued; entries whose node has since improved are stale
+    uint32_t node;
+
+    bool operator>(const OpenEntry& other) const { return total > other.total; }
+};
+
+typedef std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry> > OpenQueue;
+
+// Adjacent border polygons of two clusters: first lies in the lower cluster
+typedef std::pair<uint32_t, uint32_t> BorderPair;
+
+uint32_t FindRoot(std::vector<uint32_t>& parent, uint32_t i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// True if a links to b (links may be one-way)
+bool AreAdjacent(const CLTNavMeshData& navData, uint32_t a, uint32_t b)
+{
+    if (a == b) {
+        return true;
+    }
+
+    uint32_t neighborCount;
+    const uint32_t* neighbors = navData.GetNeighbors(a, &neighborCount);
+    return std::find(neighbors, neighbors + neighborCount, b) != neighbors + neighborCount;
+}
+
+} // namespace
+
+CLTNavMeshClusterGraph::CLTNavMeshClusterGraph()
+    : m_clusterSize(0.0f)
+    , m_clusterStart(1, 0)
+    , m_clusterEntranceStart(1, 0)
+    , m_edgeStart(1, 0)
+    , m_areaMask(0)
+{
+}
+
+float CLTNavMeshClusterGraph::Distance(uint32_t a, uint32_t b) const
+{
+    return m_pNavData->GetCenter(a).Distance(m_pNavData->GetCenter(b));
+}
+
+size_t CLTNavMeshClusterGraph::GetMemoryUsage() const
+{
+    return (m_polyCluster.capacity() + m_polyLocal.capacity() + m_clusterStart.capacity() +
+            m_clusterPolys.capacity() + m_entrancePoly.capacity() + m_clusterEntranceStart.capacity() +
+            m_clusterEntrances.capacity() + m_edgeStart.capacity() + m_incomingStart.capacity() +
+            m_incoming.capacity()) * sizeof(uint32_t) +
+           m_edges.capacity() * sizeof(Edge);
+}
+
+bool CLTNavMeshClusterGraph::Build(const std::shared_ptr<const CLTNavMeshData>& pNavData, float clusterSize,
+                                   const CLTNavMeshClusterGraph* pPrevious)
+{
+    if (!pNavData || !(clusterSize > 0.0f)) {
+        return false;
+    }
+    if (pPrevious && (pPrevious == this || pPrevious->m_clusterSize != clusterSize || !pPrevious->m_pNavData)) {
+        pPrevious = nullptr;
+    }
+
+    m_pNavData = pNavData;
+    m_clusterSize = clusterSize;
+    const CLTNavMeshData& navData = *m_pNavData;
+    const uint32_t polyCount = navData.GetPolyCount();
+
+    m_polyCluster.assign(polyCount, INVALID_INDEX);
+    m_polyLocal.assign(polyCount, 0);
+    m_clusterStart.assign(1, 0);
+    m_clusterPolys.clear();
+    m_clusterPolys.reserve(polyCount);
+    m_entrancePoly.clear();
+    m_clusterEntranceStart.assign(1, 0);
+    m_clusterEntrances.clear();
+    m_edgeStart.assign(1, 0);
+    m_edges.clear();
+    m_incomingStart.assign(polyCount + 1, 0);
+    m_incoming.clear();
+
+    m_areaMask = 0;
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        m_areaMask |= navData.GetArea(i);
+    }
+
+    if (polyCount == 0) {
+        return true;
+    }
+
+    // Cell of each polygon center on the cluster grid, anchored at the world origin
+    std::vector<uint64_t> polyCell(polyCount);
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        const CLTVector& center = navData.GetCenter(i);
+        int32_t cellX = CLTNavMeshData::GridCoord(center.x, 0.0f, clusterSize);
+        int32_t cellZ = CLTNavMeshData::GridCoord(center.z, 0.0f, clusterSize);
+        polyCell[i] = (static_cast<uint64_t>(static_cast<uint32_t>(cellZ)) << 32) | static_cast<uint32_t>(cellX);
+    }
+
+    // Clusters are the connected pieces of each cell, stored contiguously
+    for (uint32_t seed = 0; seed < polyCount; ++seed) {
+        if (m_polyCluster[seed] != INVALID_INDEX) {
+            continue;
+        }
+
+        const uint32_t cluster = static_cast<uint32_t>(m_clusterStart.size()) - 1;
+        const uint32_t first = static_cast<uint32_t>(m_clusterPolys.size());
+        m_polyCluster[seed] = cluster;
+        m_clusterPolys.push_back(seed);
+
+        // The cluster's own slice of m_clusterPolys doubles as the BFS queue
+        for (uint32_t next = first; next < m_clusterPolys.size(); ++next) {
+            uint32_t poly = m_clusterPolys[next];
+            m_polyLocal[poly] = next - first;
+
+            uint32_t neighborCount;
+            const uint32_t* neighbors = navData.GetNeighbors(poly, &neighborCount);
+            for (uint32_t n = 0; n < neighborCount; ++n) {
+                uint32_t neighbor = neighbors[n];
+                if (m_polyCluster[neighbor] == INVALID_INDEX && polyCell[neighbor] == polyCell[seed]) {
+                    m_polyCluster[neighbor] = cluster;
+                    m_clusterPolys.push_back(neighbor);
+                }
+            }
+        }
+
+        m_clusterStart.push_back(static_cast<uint32_t>(m_clusterPolys.size()));
+    }
+
+    const uint32_t clusterCount = GetClusterCount();
+
+    // Links inside each cluster by target polygon, so searches towards a
+    // polygon can run against the link direction
+    for (uint32_t a = 0; a < polyCount; ++a) {
+        uint32_t neighborCount;
+        const uint32_t* neighbors = navData.GetNeighbors(a, &neighborCount);
+        for (uint32_t n = 0; n < neighborCount; ++n) {
+            if (m_polyCluster[neighbors[n]] == m_polyCluster[a]) {
+                m_incomingStart[neighbors[n] + 1]++;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        m_incomingStart[i + 1] += m_incomingStart[i];
+    }
+    m_incoming.resize(m_incomingStart[polyCount]);
+    std::vector<uint32_t> incomingFill(m_incomingStart.begin(), m_incomingStart.end() - 1);
+    for (uint32_t a = 0; a < polyCount; ++a) {
+        uint32_t neighborCount;
+        const uint32_t* neighbors = navData.GetNeighbors(a, &neighborCount);
+        for (uint32_t n = 0; n < neighborCount; ++n) {
+            if (m_polyCluster[neighbors[n]] == m_polyCluster[a]) {
+                m_incoming[incomingFill[neighbors[n]]++] = a;
+            }
+        }
+    }
+
+    // Collect the adjacent polygon pairs along each cluster border, linked in either direction
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<BorderPair> > borders;
+    for (uint32_t a = 0; a < polyCount; ++a) {
+        uint32_t neighborCount;
+        const uint32_t* neighbors = navData.GetNeighbors(a, &neighborCount);
+        for (uint32_t n = 0; n < neighborCount; ++n) {
+            uint32_t b = neighbors[n];
+            uint32_t clusterA = m_polyCluster[a];
+            uint32_t clusterB = m_polyCluster[b];
+            if (clusterA == clusterB) {
+                continue;
+            }
+
+            BorderPair pair = clusterA < clusterB ? BorderPair(a, b) : BorderPair(b, a);
+            std::vector<BorderPair>& border = borders[std::make_pair(std::min(clusterA, clusterB),
+                                                                     std::max(clusterA, clusterB))];
+            if (std::find(border.begin(), border.end(), pair) == border.end()) {
+                border.push_back(pair);
+            }
+        }
+    }
+
+    // One transition per contiguous run of each border, taken from the middle of the run
+    std::vector<uint32_t> polyEntrance(polyCount, INVALID_INDEX);
+    std::vector<std::pair<uint32_t, uint32_t> > transitions;
+    for (const auto& entry : borders) {
+        const std::vector<BorderPair>& border = entry.second;
+        const uint32_t pairCount = static_cast<uint32_t>(border.size());
+
+        std::vector<uint32_t> run(pairCount);
+        for (uint32_t i = 0; i < pairCount; ++i) {
+            run[i] = i;
+        }
+        for (uint32_t i = 0; i < pairCount; ++i) {
+            for (uint32_t j = i + 1; j < pairCount; ++j) {
+                if (AreAdjacent(navData, border[i].first, border[j].first) ||
+                    AreAdjacent(navData, border[j].first, border[i].first) ||
+                    AreAdjacent(navData, border[i].second, border[j].second) ||
+                    AreAdjacent(navData, border[j].second, border[i].second)) {
+                    run[FindRoot(run, i)] = FindRoot(run, j);
+                }
+            }
+        }
+
+        for (uint32_t root = 0; root < pairCount; ++root) {
+            if (FindRoot(run, root) != root) {
+                continue;
+            }
+
+            CLTVector middle(0.0f, 0.0f, 0.0f);
+            float members = 0.0f;
+            for (uint32_t i = 0; i < pairCount; ++i) {
+                if (FindRoot(run, i) == root) {
+                    middle = middle + navData.GetCenter(border[i].first) + navData.GetCenter(border[i].second);
+                    members += 2.0f;
+                }
+            }
+            middle = middle * (1.0f / members);
+
+            // One transition for each direction the run is crossed in, from
+            // the pair nearest its middle that links that way
+            for (int direction = 0; direction < 2; ++direction) {
+                uint32_t best = INVALID_INDEX;
+                float bestDistance = FLT_MAX;
+                for (uint32_t i = 0; i < pairCount; ++i) {
+                    const uint32_t from = direction == 0 ? border[i].first : border[i].second;
+                    const uint32_t to = direction == 0 ? border[i].second : border[i].first;
+                    if (FindRoot(run, i) != root || !AreAdjacent(navData, from, to)) {
+                        continue;
+                    }
+                    CLTVector center = (navData.GetCenter(from) + navData.GetCenter(to)) * 0.5f;
+                    float distance = center.Distance(middle);
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        best = i;
+                    }
+                }
+                if (best == INVALID_INDEX) {
+                    continue;
+                }
+
+                const uint32_t ends[2] = {
+                    direction == 0 ? border[best].first : border[best].second,
+                    direction == 0 ? border[best].second : border[best].first
+                };
+                for (uint32_t poly : ends) {
+                    if (polyEntrance[poly] == INVALID_INDEX) {
+                        polyEntrance[poly] = static_cast<uint32_t>(m_entrancePoly.size());
+                        m_entrancePoly.push_back(poly);
+                    }
+                }
+                transitions.push_back(std::make_pair(polyEntrance[ends[0]], polyEntrance[ends[1]]));
+            }
+        }
+    }
+
+    const uint32_t entranceCount = GetEntranceCount();
+
+    // Entrances by cluster
+    m_clusterEntranceStart.assign(clusterCount + 1, 0);
+    for (uint32_t e = 0; e < entranceCount; ++e) {
+        m_clusterEntranceStart[m_polyCluster[m_entrancePoly[e]] + 1]++;
+    }
+    for (uint32_t c = 0; c < clusterCount; ++c) {
+        m_clusterEntranceStart[c + 1] += m_clusterEntranceStart[c];
+    }
+    m_clusterEntrances.resize(entranceCount);
+    std::vector<uint32_t> fill(m_clusterEntranceStart.begin(), m_clusterEntranceStart.end() - 1);
+    for (uint32_t e = 0; e < entranceCount; ++e) {
+        m_clusterEntrances[fill[m_polyCluster[m_entrancePoly[e]]]++] = e;
+    }
+
+    // Edges: transitions cross between clusters in the direction of their
+    // link, the rest link entrances inside a cluster
+    std::vector<std::vector<Edge> > edges(entranceCount);
+    for (const auto& transition : transitions) {
+        Edge edge = { transition.second, Distance(m_entrancePoly[transition.first], m_entrancePoly[transition.second]) };
+        edges[transition.first].push_back(edge);
+    }
+
+    std::vector<float> cost;
+    std::vector<uint32_t> parent;
+    for (uint32_t c = 0; c < clusterCount; ++c) {
+        if (pPrevious && CopyClusterEdges(c, *pPrevious, polyEntrance, &edges)) {
+            continue;
+        }
+
+        for (uint32_t i = m_clusterEntranceStart[c]; i < m_clusterEntranceStart[c + 1]; ++i) {
+            uint32_t from = m_clusterEntrances[i];
+            SearchCluster(m_entrancePoly[from], INVALID_INDEX, &cost, &parent);
+
+            for (uint32_t j = m_clusterEntranceStart[c]; j < m_clusterEntranceStart[c + 1]; ++j) {
+                uint32_t to = m_clusterEntrances[j];
+                float travel = cost[m_polyLocal[m_entrancePoly[to]]];
+                if (to != from && travel < FLT_MAX) {
+                    Edge edge = { to, travel };
+                    edges[from].push_back(edge);
+                }
+            }
+        }
+    }
+
+    m_edgeStart.assign(1, 0);
+    for (uint32_t e = 0; e < entranceCount; ++e) {
+        m_edges.insert(m_edges.end(), edges[e].begin(), edges[e].end());
+        m_edgeStart.push_back(static_cast<uint32_t>(m_edges.size()));
+    }
+
+    return true;
+}
+
+bool CLTNavMeshClusterGraph::CopyClusterEdges(uint32_t cluster, const CLTNavMeshClusterGraph& previous,
+                                              const std::vector<uint32_t>& polyEntrance,
+                                              std::vector<std::vector<Edge> >* pEdges) const
+{
+    const CLTNavMeshData& navData = *m_pNavData;
+    const CLTNavMeshData& previousData = *previous.m_pNavData;
+    const uint32_t first = m_clusterStart[cluster];
+    const uint32_t count = m_clusterStart[cluster + 1] - first;
+
+    // Polygon data never changes for a given ID, so the same polygons give
+    // the same links and travel costs inside the cluster
+    uint32_t previousSeed = previousData.GetIndex(navData.GetId(m_clusterPolys[first]));
+    if (previousSeed == INVALID_INDEX) {
+        return false;
+    }
+    const uint32_t previousCluster = previous.m_polyCluster[previousSeed];
+    if (previous.m_clusterStart[previousCluster + 1] - previous.m_clusterStart[previousCluster] != count) {
+        return false;
+    }
+    for (uint32_t i = first; i < first + count; ++i) {
+        uint32_t previousIndex = previousData.GetIndex(navData.GetId(m_clusterPolys[i]));
+        if (previousIndex == INVALID_INDEX || previous.m_polyCluster[previousIndex] != previousCluster) {
+            return false;
+        }
+    }
+
+    // The entrances must be the same polygons too
+    const uint32_t entranceFirst = m_clusterEntranceStart[cluster];
+    const uint32_t entranceCount = m_clusterEntranceStart[cluster + 1] - entranceFirst;
+    const uint32_t previousEntranceFirst = previous.m_clusterEntranceStart[previousCluster];
+    if (previous.m_clusterEntranceStart[previousCluster + 1] - previousEntranceFirst != entranceCount) {
+        return false;
+    }
+    for (uint32_t i = previousEntranceFirst; i < previousEntranceFirst + entranceCount; ++i) {
+        uint32_t previousPoly = previous.m_entrancePoly[previous.m_clusterEntrances[i]];
+        uint32_t poly = navData.GetIndex(previousData.GetId(previousPoly));
+        if (poly == INVALID_INDEX || polyEntrance[poly] == INVALID_INDEX ||
+            m_polyCluster[poly] != cluster) {
+            return false;
+        }
+    }
+
+    // Copy the edges that stay inside the cluster; transitions are already in place
+    for (uint32_t i = previousEntranceFirst; i < previousEntranceFirst + entranceCount; ++i) {
+        uint32_t previousFrom = previous.m_clusterEntrances[i];
+        uint32_t from = polyEntrance[navData.GetIndex(previousData.GetId(previous.m_entrancePoly[previousFrom]))];
+        for (uint32_t e = previous.m_edgeStart[previousFrom]; e < previous.m_edgeStart[previousFrom + 1]; ++e) {
+            uint32_t previousTo = previous.m_edges[e].target;
+            uint32_t previousToPoly = previous.m_entrancePoly[previousTo];
+            if (previous.m_polyCluster[previousToPoly] != previousCluster) {
+                continue;
+            }
+            Edge edge = { polyEntrance[navData.GetIndex(previousData.GetId(previousToPoly))], previous.m_edges[e].cost };
+            (*pEdges)[from].push_back(edge);
+        }
+    }
+
+    return true;
+}
+
+bool CLTNavMeshClusterGraph::SearchCluster(uint32_t fromIndex, uint32_t toIndex,
+                                           std::vector<float>* pCost, std::vector<uint32_t>* pParent,
+                                           bool incoming) const
+{
+    const CLTNavMeshData& navData = *m_pNavData;
+    const uint32_t cluster = m_polyCluster[fromIndex];
+    const uint32_t first = m_clusterStart[cluster];
+    const uint32_t count = m_clusterStart[cluster + 1] - first;
+
+    // Costs and parents are indexed by position within the cluster
+    pCost->assign(count, FLT_MAX);
+    pParent->assign(count, INVALID_INDEX);
+
+    // A* towards toIndex, or Dijkstra over the whole cluster without a goal.
+    // Following incoming links gives the costs of reaching fromIndex instead.
+    const bool hasGoal = toIndex != INVALID_INDEX;
+    OpenQueue open;
+    (*pCost)[m_polyLocal[fromIndex]] = 0.0f;
+    OpenEntry start = { hasGoal ? Distance(fromIndex, toIndex) : 0.0f, 0.0f, m_polyLocal[fromIndex] };
+    open.push(start);
+
+    while (!open.empty()) {
+        OpenEntry current = open.top();
+        open.pop();
+        if (current.cost > (*pCost)[current.node]) {
+            continue;
+        }
+
+        uint32_t poly = m_clusterPolys[first + current.node];
+        if (poly == toIndex) {
+            return true;
+        }
+
+        uint32_t neighborCount;
+        const uint32_t* neighbors;
+        if (incoming) {
+            neighbors = m_incoming.data() + m_incomingStart[poly];
+            neighborCount = m_incomingStart[poly + 1] - m_incomingStart[poly];
+        } else {
+            neighbors = navData.GetNeighbors(poly, &neighborCount);
+        }
+        for (uint32_t n = 0; n < neighborCount; ++n) {
+            uint32_t neighbor = neighbors[n];
+            if (m_polyCluster[neighbor] != cluster) {
+                continue;
+            }
+
+            uint32_t local = m_polyLocal[neighbor];
+            float newCost = current.cost + Distance(poly, neighbor);
+            if (newCost < (*pCost)[local]) {
+                (*pCost)[local] = newCost;
+                (*pParent)[local] = current.node;
+                OpenEntry entry = { newCost + (hasGoal ? Distance(neighbor, toIndex) : 0.0f), newCost, local };
+                open.push(entry);
+            }
+        }
+    }
+
+    return !hasGoal;
+}
+
+void CLTNavMeshClusterGraph::AppendClusterPath(uint32_t fromIndex, uint32_t toIndex, const std::vector<uint32_t>& parent,
+                                               std::vector<uint32_t>* pCorridor) const
+{
+    // Walk back from toIndex, then reverse the appended part; fromIndex itself is already in the corridor
+    const uint32_t first = m_clusterStart[m_polyCluster[fromIndex]];
+    const size_t begin = pCorridor->size();
+    for (uint32_t local = m_polyLocal[toIndex]; local != m_polyLocal[fromIndex]; local = parent[local]) {
+        pCorridor->push_back(m_clusterPolys[first + local]);
+    }
+    std::reverse(pCorridor->begin() + begin, pCorridor->end());
+}
+
+CLTNavMeshClusterGraph::SearchResult CLTNavMeshClusterGraph::FindCorridor(uint32_t startIndex, uint32_t endIndex,
+                                                                          uint32_t maxNodes,
+                                                                          std::vector<uint32_t>* pCorridor) const
+{
+    pCorridor->clear();
+
+    std::vector<float> cost;
+    std::vector<uint32_t> parent;
+    const uint32_t startCluster = m_polyCluster[startIndex];
+    const uint32_t endCluster = m_polyCluster[endIndex];
+
+    // Short paths stay inside one cluster and never touch the abstract graph
+    if (startCluster == endCluster && SearchCluster(startIndex, endIndex, &cost, &parent)) {
+        pCorridor->push_back(startIndex);
+        AppendClusterPath(startIndex, endIndex, parent, pCorridor);
+        return SEARCH_FOUND;
+    }
+
+    // Connect the start and end polygons to the entrances of their clusters;
+    // the end costs are travel towards the end polygon, against the links
+    std::vector<float> startCost;
+    std::vector<uint32_t> startParent;
+    std::vector<float> endCost;
+    std::vector<uint32_t> endParent;
+    SearchCluster(startIndex, INVALID_INDEX, &startCost, &startParent);
+    SearchCluster(endIndex, INVALID_INDEX, &endCost, &endParent, true);
+
+    // Abstract A*; the start and end polygons are the two nodes after the entrances
+    const uint32_t entranceCount = GetEntranceCount();
+    const uint32_t startNode = entranceCount;
+    const uint32_t endNode = entranceCount + 1;
+    std::vector<float> nodeCost(entranceCount + 2, FLT_MAX);
+    std::vector<uint32_t> nodeParent(entranceCount + 2, INVALID_INDEX);
+
+    OpenQueue open;
+    nodeCost[startNode] = 0.0f;
+    OpenEntry start = { Distance(startIndex, endIndex), 0.0f, startNode };
+    open.push(start);
+
+    uint32_t expanded = 0;
+    while (!open.empty()) {
+        OpenEntry current = open.top();
+        open.pop();
+        if (current.cost > nodeCost[current.node]) {
+            continue;
+        }
+        if (current.node == endNode) {
+            break;
+        }
+        if (++expanded > maxNodes) {
+            return SEARCH_OUT_OF_NODES;
+        }
+
+        // Relax one edge of the abstract graph
+        auto relax = [&](uint32_t node, float edgeCost) {
+            float newCost = current.cost + edgeCost;
+            if (newCost < nodeCost[node]) {
+                nodeCost[node] = newCost;
+                nodeParent[node] = current.node;
+                uint32_t poly = node == endNode ? endIndex : m_entrancePoly[node];
+                OpenEntry entry = { newCost + Distance(poly, endIndex), newCost, node };
+                open.push(entry);
+            }
+        };
+
+        if (current.node == startNode) {
+            for (uint32_t i = m_clusterEntranceStart[startCluster]; i < m_clusterEntranceStart[startCluster + 1]; ++i) {
+                uint32_t entrance = m_clusterEntrances[i];
+                float travel = startCost[m_polyLocal[m_entrancePoly[entrance]]];
+                if (travel < FLT_MAX) {
+                    relax(entrance, travel);
+                }
+            }
+            continue;
+        }
+
+        for (uint32_t e = m_edgeStart[current.node]; e < m_edgeStart[current.node + 1]; ++e) {
+            relax(m_edges[e].target, m_edges[e].cost);
+        }
+
+        uint32_t poly = m_entrancePoly[current.node];
+        if (m_polyCluster[poly] == endCluster && endCost[m_polyLocal[poly]] < FLT_MAX) {
+            relax(endNode, endCost[m_polyLocal[poly]]);
+        }
+    }
+
+    if (nodeCost[endNode] == FLT_MAX) {
+        return SEARCH_NO_PATH;
+    }
+
+    // Polygons along the abstract path, start to end
+    std::vector<uint32_t> waypoints;
+    for (uint32_t node = endNode; node != INVALID_INDEX; node = nodeParent[node]) {
+        waypoints.push_back(node == endNode ? endIndex : node == startNode ? startIndex : m_entrancePoly[node]);
+    }
+    std::reverse(waypoints.begin(), waypoints.end());
+
+    // Refine: steps inside a cluster get a local search, steps across a border are direct links
+    pCorridor->push_back(startIndex);
+    for (size_t i = 1; i < waypoints.size(); ++i) {
+        uint32_t from = waypoints[i - 1];
+        uint32_t to = waypoints[i];
+        if (from == to) {
+            continue;
+        }
+
+        if (m_polyCluster[from] != m_polyCluster[to]) {
+            pCorridor->push_back(to);
+        } else if (i == 1) {
+            // startParent already holds the paths from the start polygon
+            AppendClusterPath(from, to, startParent, pCorridor);
+        } else {
+            SearchCluster(from, to, &cost, &parent);
+            AppendClusterPath(from, to, parent, pCorridor);
+        }
+    }
+
+    return SEARCH_FOUND;
+}
@@ -0,0 +1,1710 @@
+#include "../../include/gameplay/CLTNavMeshData.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NAVMESH_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// The image stores CLTVector arrays directly
+static_assert(sizeof(CLTVector) == 3 * sizeof(float), "CLTVector must be three packed floats");
+static_assert(sizeof(NavMeshFileHeader) == 64, "NavMeshFileHeader layout changed");
+
+const uint32_t CLTNavMeshData::INVALID_INDEX;
+
+static const uint32_t SECTION_ALIGNMENT = 16;
+
+/**
+ * @brief Intermediate arrays used while compiling polygons into an image
+ */
+struct NavMeshSource {
+    std::vector<uint32_t> ids;
+    std::vector<CLTVector> centers;
+    std::vector<float> heights;
+    std::vector<uint8_t> flags;
+    std::vector<uint8_t> areas;
+    std::vector<uint32_t> vertexStart;
+    std::vector<CLTVector> vertices;
+    std::vector<uint32_t> neighborStart;
+    std::vector<uint32_t> neighbors;
+    std::vector<float> bounds;
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> cellPolys;
+    std::vector<NavMeshExternalLink> externalLinks;
+    std::vector<uint32_t> landmarks;
+    std::vector<float> landmarkDistances;
+    std::vector<float> fanAreas;
+    std::vector<uint32_t> sampleCellStart;
+    std::vector<uint32_t> samplePolys;
+    std::vector<float> sampleAreas;
+    std::vector<double> cellAreaSums;
+    std::vector<uint32_t> layeredCellSums;
+    float sampleReach;
+    float gridMinX;
+    float gridMinZ;
+    float cellSize;
+    int gridWidth;
+    int gridHeight;
+};
+
+static void BuildGrid(NavMeshSource& src)
+{
+    const uint32_t polyCount = static_cast<uint32_t>(src.ids.size());
+
+    // An empty mesh has a single empty cell
+    src.gridMinX = 0.0f;
+    src.gridMinZ = 0.0f;
+    src.cellSize = 1.0f;
+    src.gridWidth = 1;
+    src.gridHeight = 1;
+    src.cellStart.assign(2, 0);
+    src.cellPolys.clear();
+    if (polyCount == 0) {
+        return;
+    }
+
+    // Overall bounds and average polygon size
+    float minX = FLT_MAX, minZ = FLT_MAX, maxX = -FLT_MAX, maxZ = -FLT_MAX;
+    float extentSum = 0.0f;
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        const float* b = &src.bounds[i * 4];
+        minX = std::min(minX, b[0]);
+        minZ = std::min(minZ, b[1]);
+        maxX = std::max(maxX, b[2]);
+        maxZ = std::max(maxZ, b[3]);
+        extentSum += std::max(b[2] - b[0], b[3] - b[1]);
+    }
+
+    // Cells about the size of an average polygon keep per-cell lists short.
+    // Very uneven meshes are capped at a few cells per polygon.
+    const float MIN_CELL_SIZE = 0.25f;
+    const float MAX_CELLS_PER_POLY = 4.0f;
+    float width = std::max(maxX - minX, MIN_CELL_SIZE);
+    float height = std::max(maxZ - minZ, MIN_CELL_SIZE);
+    float cellSize = std::max(extentSum / polyCount, MIN_CELL_SIZE);
+    float maxCells = MAX_CELLS_PER_POLY * polyCount;
+    if ((width / cellSize) * (height / cellSize) > maxCells) {
+        cellSize = std::sqrt(width * height / maxCells);
+    }
+
+    src.gridMinX = minX;
+    src.gridMinZ = minZ;
+    src.cellSize = cellSize;
+    src.gridWidth = std::max(1, static_cast<int>(std::ceil(width / cellSize)));
+    src.gridHeight = std::max(1, static_cast<int>(std::ceil(height / cellSize)));
+
+    const uint32_t cellCount = static_cast<uint32_t>(src.gridWidth * src.gridHeight);
+    src.cellStart.assign(cellCount + 1, 0);
+
+    // Two passes over the polygon bounds: count per cell, then fill
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<uint32_t> cursor;
+        if (pass == 1) {
+            for (uint32_t c = 0; c < cellCount; ++c) {
+                src.cellStart[c + 1] += src.cellStart[c];
+            }
+            src.cellPolys.resize(src.cellStart[cellCount]);
+            cursor.assign(src.cellStart.begin(), src.cellStart.end() - 1);
+        }
+
+        for (uint32_t i = 0; i < polyCount; ++i) {
+            const float* b = &src.bounds[i * 4];
+            int x0 = std::max(0, CLTNavMeshData::GridCoord(b[0], minX, cellSize));
+            int z0 = std::max(0, CLTNavMeshData::GridCoord(b[1], minZ, cellSize));
+            int x1 = std::min(src.gridWidth - 1, CLTNavMeshData::GridCoord(b[2], minX, cellSize));
+            int z1 = std::min(src.gridHeight - 1, CLTNavMeshData::GridCoord(b[3], minZ, cellSize));
+
+            for (int cz = z0; cz <= z1; ++cz) {
+                for (int cx = x0; cx <= x1; ++cx) {
+                    uint32_t cell = static_cast<uint32_t>(cz * src.gridWidth + cx);
+                    if (pass == 0) {
+                        ++src.cellStart[cell + 1];
+                    } else {
+                        src.cellPolys[cursor[cell]++] = i;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void FindTravelDistances(const NavMeshSource& src, const std::vector<uint32_t>& linkStart,
+                                const std::vector<uint32_t>& links, uint32_t source, std::vector<float>* pDistances)
+{
+    // Dijkstra over polygon centers
+    typedef std::pair<float, uint32_t> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+    pDistances->assign(src.ids.size(), FLT_MAX);
+    (*pDistances)[source] = 0.0f;
+    open.push(Entry(0.0f, source));
+
+    while (!open.empty()) {
+        Entry current = open.top();
+        open.pop();
+        if (current.first > (*pDistances)[current.second]) {
+            continue;  // Stale entry
+        }
+
+        const CLTVector& center = src.centers[current.second];
+        for (uint32_t n = linkStart[current.second]; n < linkStart[current.second + 1]; ++n) {
+            uint32_t neighbor = links[n];
+            float distance = current.first + center.Distance(src.centers[neighbor]);
+            if (distance < (*pDistances)[neighbor]) {
+                (*pDistances)[neighbor] = distance;
+                open.push(Entry(distance, neighbor));
+            }
+        }
+    }
+}
+
+static void BuildLandmarks(NavMeshSource& src, uint32_t landmarkCount)
+{
+    const uint32_t polyCount = static_cast<uint32_t>(src.ids.size());
+    if (polyCount == 0 || landmarkCount == 0) {
+        return;
+    }
+
+    // Links are followed both ways. Distances then form a symmetric metric
+    // that never exceeds the one-way distance, so |d(L, a) - d(L, b)| stays
+    // a lower bound even where a link only works in one direction.
+    std::vector<uint32_t> linkStart(polyCount + 1, 0);
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        for (uint32_t n = src.neighborStart[i]; n < src.neighborStart[i + 1]; ++n) {
+            ++linkStart[i + 1];
+            ++linkStart[src.neighbors[n] + 1];
+        }
+    }
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        linkStart[i + 1] += linkStart[i];
+    }
+    std::vector<uint32_t> links(linkStart[polyCount]);
+    std::vector<uint32_t> fill(linkStart.begin(), linkStart.end() - 1);
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        for (uint32_t n = src.neighborStart[i]; n < src.neighborStart[i + 1]; ++n) {
+            links[fill[i]++] = src.neighbors[n];
+            links[fill[src.neighbors[n]]++] = i;
+        }
+    }
+
+    // Farthest-point selection: start at the polygon farthest from an
+    // arbitrary one, then keep adding the polygon farthest from every
+    // landmark so far. Unreached polygons count as infinitely far, so each
+    // disconnected island gets a landmark while there are landmarks left.
+    std::vector<float> distances;
+    FindTravelDistances(src, linkStart, links, 0, &distances);
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        if (distances[i] != FLT_MAX && distances[i] > distances[next]) {
+            next = i;
+        }
+    }
+
+    std::vector<float> nearest(polyCount, FLT_MAX);
+    std::vector<std::vector<float> > table;
+    while (table.size() < landmarkCount) {
+        src.landmarks.push_back(src.ids[next]);
+        FindTravelDistances(src, linkStart, links, next, &distances);
+        table.push_back(distances);
+
+        for (uint32_t i = 0; i < polyCount; ++i) {
+            nearest[i] = std::min(nearest[i], distances[i]);
+        }
+        next = static_cast<uint32_t>(std::max_element(nearest.begin(), nearest.end()) - nearest.begin());
+        if (nearest[next] == 0.0f) {
+            break;  // Every polygon is a landmark
+        }
+    }
+
+    // Store by polygon so one bound reads one contiguous row
+    const uint32_t count = static_cast<uint32_t>(table.size());
+    src.landmarkDistances.resize(static_cast<size_t>(polyCount) * count);
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        for (uint32_t l = 0; l < count; ++l) {
+            src.landmarkDistances[static_cast<size_t>(i) * count + l] = table[l][i];
+        }
+    }
+}
+
+// Separating axis test between two convex polygons in the XZ plane. Shared
+// edges and overlaps thinner than the tolerance do not count.
+static bool ConvexPolysOverlapXZ(const CLTVector* a, uint32_t aCount, const CLTVector* b, uint32_t bCount)
+{
+    const float TOLERANCE = 0.01f;
+    for (int pass = 0; pass < 2; ++pass) {
+        const CLTVector* edges = pass == 0 ? a : b;
+        const uint32_t edgeCount = pass == 0 ? aCount : bCount;
+        for (uint32_t i = 0, j = edgeCount - 1; i < edgeCount; j = i++) {
+            float nx = edges[i].z - edges[j].z;
+            float nz = edges[j].x - edges[i].x;
+            float length = std::sqrt(nx * nx + nz * nz);
+            if (length <= 0.0f) {
+                continue;
+            }
+            nx /= length;
+            nz /= length;
+
+            float aMin = FLT_MAX, aMax = -FLT_MAX, bMin = FLT_MAX, bMax = -FLT_MAX;
+            for (uint32_t k = 0; k < aCount; ++k) {
+                float d = a[k].x * nx + a[k].z * nz;
+                aMin = std::min(aMin, d);
+                aMax = std::max(aMax, d);
+            }
+            for (uint32_t k = 0; k < bCount; ++k) {
+                float d = b[k].x * nx + b[k].z * nz;
+                bMin = std::min(bMin, d);
+                bMax = std::max(bMax, d);
+            }
+            if (std::min(aMax, bMax) - std::max(aMin, bMin) <= TOLERANCE) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void BuildSamplingTables(NavMeshSource& src)
+{
+    const uint32_t polyCount = static_cast<uint32_t>(src.ids.size());
+
+    // Fan triangle areas: vertex k of a polygon holds the area of the
+    // triangles (v0, v1, v2) .. (v0, vk-1, vk), so the last vertex holds
+    // the polygon's area. Join() copies them from its sources.
+    if (src.fanAreas.size() != src.vertices.size()) {
+        src.fanAreas.assign(src.vertices.size(), 0.0f);
+        for (uint32_t i = 0; i < polyCount; ++i) {
+            const uint32_t first = src.vertexStart[i];
+            const uint32_t last = src.vertexStart[i + 1];
+            if (last - first < 3) {
+                continue;
+            }
+
+            const CLTVector& v0 = src.vertices[first];
+            float sum = 0.0f;
+            for (uint32_t k = first + 2; k < last; ++k) {
+                const CLTVector& a = src.vertices[k - 1];
+                const CLTVector& b = src.vertices[k];
+                sum += 0.5f * std::fabs((a.x - v0.x) * (b.z - v0.z) - (a.z - v0.z) * (b.x - v0.x));
+                src.fanAreas[k] = sum;
+            }
+        }
+    }
+    auto polyArea = [&src](uint32_t i) {
+        const uint32_t first = src.vertexStart[i];
+        const uint32_t last = src.vertexStart[i + 1];
+        return last - first >= 3 ? src.fanAreas[last - 1] : 0.0f;
+    };
+
+    // Each polygon belongs to the cell holding its center, so no polygon is
+    // counted twice when cells are summed
+    const uint32_t cellCount = static_cast<uint32_t>(src.gridWidth * src.gridHeight);
+    std::vector<uint32_t> owner(polyCount);
+    src.sampleCellStart.assign(cellCount + 1, 0);
+    src.sampleReach = 0.0f;
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        const CLTVector& center = src.centers[i];
+        int cx = CLTNavMeshData::GridCoord(center.x, src.gridMinX, src.cellSize);
+        int cz = CLTNavMeshData::GridCoord(center.z, src.gridMinZ, src.cellSize);
+        cx = std::max(0, std::min(src.gridWidth - 1, cx));
+        cz = std::max(0, std::min(src.gridHeight - 1, cz));
+        owner[i] = static_cast<uint32_t>(cz * src.gridWidth + cx);
+        ++src.sampleCellStart[owner[i] + 1];
+
+        // Reach beyond the owning cell's edges
+        const float* b = &src.bounds[i * 4];
+        float cellMinX = src.gridMinX + cx * src.cellSize;
+        float cellMinZ = src.gridMinZ + cz * src.cellSize;
+        src.sampleReach = std::max(src.sampleReach, std::max(
+            std::max(cellMinX - b[0], b[2] - (cellMinX + src.cellSize)),
+            std::max(cellMinZ - b[1], b[3] - (cellMinZ + src.cellSize))));
+    }
+    for (uint32_t c = 0; c < cellCount; ++c) {
+        src.sampleCellStart[c + 1] += src.sampleCellStart[c];
+    }
+
+    src.samplePolys.resize(polyCount);
+    src.sampleAreas.resize(polyCount);
+    std::vector<uint32_t> cursor(src.sampleCellStart.begin(), src.sampleCellStart.end() - 1);
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        src.samplePolys[cursor[owner[i]]++] = i;
+    }
+
+    // Per-cell running sums stay small, so float keeps its precision; the
+    // summed-area table spans the whole world and uses double
+    const int stride = src.gridWidth + 1;
+    src.cellAreaSums.assign(static_cast<size_t>(stride) * (src.gridHeight + 1), 0.0);
+    for (int cz = 0; cz < src.gridHeight; ++cz) {
+        double rowSum = 0.0;
+        for (int cx = 0; cx < src.gridWidth; ++cx) {
+            uint32_t cell = static_cast<uint32_t>(cz * src.gridWidth + cx);
+            float sum = 0.0f;
+            for (uint32_t e = src.sampleCellStart[cell]; e < src.sampleCellStart[cell + 1]; ++e) {
+                sum += polyArea(src.samplePolys[e]);
+                src.sampleAreas[e] = sum;
+            }
+            rowSum += sum;
+            src.cellAreaSums[(cz + 1) * stride + cx + 1] = src.cellAreaSums[cz * stride + cx + 1] + rowSum;
+        }
+    }
+
+    // Cells where polygons overlap in XZ, such as floors stacked above each
+    // other, counted in a summed-area table of their own
+    src.layeredCellSums.assign(static_cast<size_t>(stride) * (src.gridHeight + 1), 0);
+    for (int cz = 0; cz < src.gridHeight; ++cz) {
+        uint32_t rowCount = 0;
+        for (int cx = 0; cx < src.gridWidth; ++cx) {
+            uint32_t cell = static_cast<uint32_t>(cz * src.gridWidth + cx);
+            const uint32_t* polys = src.cellPolys.data() + src.cellStart[cell];
+            const uint32_t count = src.cellStart[cell + 1] - src.cellStart[cell];
+            bool layered = false;
+            for (uint32_t i = 0; i < count && !layered; ++i) {
+                const float* bi = &src.bounds[polys[i] * 4];
+                const uint32_t iFirst = src.vertexStart[polys[i]];
+                const uint32_t iCount = src.vertexStart[polys[i] + 1] - iFirst;
+                for (uint32_t j = i + 1; j < count && !layered; ++j) {
+                    const float* bj = &src.bounds[polys[j] * 4];
+                    const uint32_t jFirst = src.vertexStart[polys[j]];
+                    const uint32_t jCount = src.vertexStart[polys[j] + 1] - jFirst;
+                    if (iCount < 3 || jCount < 3 ||
+                        bi[0] >= bj[2] || bj[0] >= bi[2] || bi[1] >= bj[3] || bj[1] >= bi[3]) {
+                        continue;
+                    }
+                    layered = ConvexPolysOverlapXZ(&src.vertices[iFirst], iCount, &src.vertices[jFirst], jCount);
+                }
+            }
+            rowCount += layered ? 1 : 0;
+            src.layeredCellSums[(cz + 1) * stride + cx + 1] = src.layeredCellSums[cz * stride + cx + 1] + rowCount;
+        }
+    }
+}
+
+static void WriteImage(const NavMeshSource& src, std::vector<uint32_t>* pImage)
+{
+    const void* data[CLTNavMeshData::SECTION_COUNT] = {
+        src.ids.data(), src.centers.data(), src.heights.data(), src.flags.data(),
+        src.areas.data(), src.vertexStart.data(), src.vertices.data(),
+        src.neighborStart.data(), src.neighbors.data(), src.bounds.data(),
+        src.cellStart.data(), src.cellPolys.data(), src.externalLinks.data(),
+        src.landmarks.data(), src.landmarkDistances.data(), src.fanAreas.data(),
+        src.sampleCellStart.data(), src.samplePolys.data(), src.sampleAreas.data(),
+        src.cellAreaSums.data(), src.layeredCellSums.data()
+    };
+    const size_t sizes[CLTNavMeshData::SECTION_COUNT] = {
+        src.ids.size() * sizeof(uint32_t), src.centers.size() * sizeof(CLTVector),
+        src.heights.size() * sizeof(float), src.flags.size(), src.areas.size(),
+        src.vertexStart.size() * sizeof(uint32_t), src.vertices.size() * sizeof(CLTVector),
+        src.neighborStart.size() * sizeof(uint32_t), src.neighbors.size() * sizeof(uint32_t),
+        src.bounds.size() * sizeof(float), src.cellStart.size() * sizeof(uint32_t),
+        src.cellPolys.size() * sizeof(uint32_t),
+        src.externalLinks.size() * sizeof(NavMeshExternalLink),
+        src.landmarks.size() * sizeof(uint32_t), src.landmarkDistances.size() * sizeof(float),
+        src.fanAreas.size() * sizeof(float), src.sampleCellStart.size() * sizeof(uint32_t),
+        src.samplePolys.size() * sizeof(uint32_t), src.sampleAreas.size() * sizeof(float),
+        src.cellAreaSums.size() * sizeof(double), src.layeredCellSums.size() * sizeof(uint32_t)
+    };
+
+    // Header, section table, then each section on an aligned boundary
+    NavMeshFileHeader header;
+    memset(&header, 0, sizeof(header));
+    NavMeshFileSection table[CLTNavMeshData::SECTION_COUNT];
+
+    size_t offset = sizeof(header) + sizeof(table);
+    for (int i = 0; i < CLTNavMeshData::SECTION_COUNT; ++i) {
+        offset = (offset + SECTION_ALIGNMENT - 1) & ~static_cast<size_t>(SECTION_ALIGNMENT - 1);
+        table[i].offset = static_cast<uint32_t>(offset);
+        table[i].size = static_cast<uint32_t>(sizes[i]);
+        offset += sizes[i];
+    }
+
+    header.magic = CLTNavMeshData::FILE_MAGIC;
+    header.version = CLTNavMeshData::FILE_VERSION;
+    header.fileSize = static_cast<uint32_t>(offset);
+    header.sectionCount = CLTNavMeshData::SECTION_COUNT;
+    header.polyCount = static_cast<uint32_t>(src.ids.size());
+    header.vertexCount = static_cast<uint32_t>(src.vertices.size());
+    header.neighborCount = static_cast<uint32_t>(src.neighbors.size());
+    header.cellPolyCount = static_cast<uint32_t>(src.cellPolys.size());
+    header.gridWidth = src.gridWidth;
+    header.gridHeight = src.gridHeight;
+    header.gridMinX = src.gridMinX;
+    header.gridMinZ = src.gridMinZ;
+    header.cellSize = src.cellSize;
+    header.externalLinkCount = static_cast<uint32_t>(src.externalLinks.size());
+    header.landmarkCount = static_cast<uint32_t>(src.landmarks.size());
+    header.sampleReach = src.sampleReach;
+
+    pImage->assign((offset + sizeof(uint32_t) - 1) / sizeof(uint32_t), 0);
+    uint8_t* pBytes = reinterpret_cast<uint8_t*>(pImage->data());
+    memcpy(pBytes, &header, sizeof(header));
+    memcpy(pBytes + sizeof(header), table, sizeof(table));
+    for (int i = 0; i < CLTNavMeshData::SECTION_COUNT; ++i) {
+        if (sizes[i] > 0) {
+            memcpy(pBytes + table[i].offset, data[i], sizes[i]);
+        }
+    }
+}
+
+CLTNavMeshData::CLTNavMeshData()
+    : m_pMapping(nullptr)
+    , m_mappingSize(0)
+    , m_hFile(nullptr)
+    , m_hMapping(nullptr)
+    , m_pImage(nullptr)
+    , m_imageSize(0)
+{
+    Clear();
+}
+
+CLTNavMeshData::~CLTNavMeshData()
+{
+    Release();
+}
+
+bool CLTNavMeshData::Build(const std::vector<NavMeshPoly>& polygons, uint32_t landmarkCount)
+{
+    if (landmarkCount > MAX_LANDMARKS) {
+        Clear();
+        return false;
+    }
+
+    // Order the polygons by ID so the dense index doubles as a sorted ID table
+    std::vector<const NavMeshPoly*> sorted;
+    sorted.reserve(polygons.size());
+    for (const NavMeshPoly& poly : polygons) {
+        sorted.push_back(&poly);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+        [](const NavMeshPoly* a, const NavMeshPoly* b) {
+            return a->id < b->id;
+        });
+
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        // ID 0 means "no polygon" throughout the system, and IDs must be unique
+        if (sorted[i]->id == 0 || (i > 0 && sorted[i]->id == sorted[i - 1]->id) ||
+            sorted[i]->vertices.size() > MAX_POLY_VERTICES) {
+            Clear();
+            return false;
+        }
+    }
+
+    const uint32_t polyCount = static_cast<uint32_t>(sorted.size());
+    NavMeshSource src;
+    src.ids.reserve(polyCount);
+    src.centers.reserve(polyCount);
+    src.heights.reserve(polyCount);
+    src.flags.reserve(polyCount);
+    src.areas.reserve(polyCount);
+    src.bounds.reserve(polyCount * 4);
+    src.vertexStart.reserve(polyCount + 1);
+    src.neighborStart.reserve(polyCount + 1);
+    src.vertexStart.push_back(0);
+    src.neighborStart.push_back(0);
+
+    for (const NavMeshPoly* poly : sorted) {
+        src.ids.push_back(poly->id);
+        src.centers.push_back(poly->center);
+        src.heights.push_back(poly->height);
+        src.flags.push_back(poly->flags);
+        src.areas.push_back(poly->area);
+        src.vertices.insert(src.vertices.end(), poly->vertices.begin(), poly->vertices.end());
+        src.vertexStart.push_back(static_cast<uint32_t>(src.vertices.size()));
+
+        // XZ bounds; polygons without vertices collapse to their center
+        float minX = poly->center.x, minZ = poly->center.z;
+        float maxX = minX, maxZ = minZ;
+        for (const CLTVector& v : poly->vertices) {
+            minX = std::min(minX, v.x);
+            minZ = std::min(minZ, v.z);
+            maxX = std::max(maxX, v.x);
+            maxZ = std::max(maxZ, v.z);
+        }
+        src.bounds.push_back(minX);
+        src.bounds.push_back(minZ);
+        src.bounds.push_back(maxX);
+        src.bounds.push_back(maxZ);
+    }
+
+    // Neighbours are resolved once all IDs are known; IDs outside the set
+    // become external links (e.g. across a tile border)
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        for (uint32_t neighborId : sorted[i]->neighbors) {
+            auto it = std::lower_bound(src.ids.begin(), src.ids.end(), neighborId);
+            if (it != src.ids.end() && *it == neighborId) {
+                uint32_t neighborIndex = static_cast<uint32_t>(it - src.ids.begin());
+                if (neighborIndex != i) {
+                    src.neighbors.push_back(neighborIndex);
+                }
+            } else if (neighborId != 0) {
+                NavMeshExternalLink link = { i, neighborId };
+                src.externalLinks.push_back(link);
+            }
+        }
+        src.neighborStart.push_back(static_cast<uint32_t>(src.neighbors.size()));
+    }
+
+    BuildGrid(src);
+    BuildSamplingTables(src);
+    BuildLandmarks(src, landmarkCount);
+
+    // Serialise into the file layout and use that image directly
+    std::vector<uint32_t> image;
+    WriteImage(src, &image);
+
+    Release();
+    m_ownedImage.swap(image);
+    return Attach(reinterpret_cast<const uint8_t*>(m_ownedImage.data()),
+                  m_ownedImage.size() * sizeof(uint32_t));
+}
+
+bool CLTNavMeshData::Join(const std::vector<JoinSource>& sources)
+{
+    // Every polygon taken, ordered by ID so the dense index stays a sorted ID table
+    struct Taken {
+        uint32_t id;
+        uint32_t source;
+        uint32_t index;
+    };
+    std::vector<Taken> taken;
+    for (uint32_t s = 0; s < sources.size(); ++s) {
+        for (uint32_t k = 0; k < sources[s].count; ++k) {
+            Taken entry = { sources[s].pData->GetId(sources[s].pIndices[k]), s, sources[s].pIndices[k] };
+            taken.push_back(entry);
+        }
+    }
+    std::sort(taken.begin(), taken.end(), [](const Taken& a, const Taken& b) { return a.id < b.id; });
+
+    const uint32_t polyCount = static_cast<uint32_t>(taken.size());
+    for (uint32_t i = 1; i < polyCount; ++i) {
+        if (taken[i].id == taken[i - 1].id) {
+            Clear();
+            return false;
+        }
+    }
+
+    // New dense index of each taken polygon, by source index
+    std::vector<std::vector<uint32_t> > remap(sources.size());
+    for (uint32_t s = 0; s < sources.size(); ++s) {
+        remap[s].assign(sources[s].pData->GetPolyCount(), INVALID_INDEX);
+    }
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        remap[taken[i].source][taken[i].index] = i;
+    }
+
+    NavMeshSource src;
+    src.ids.reserve(polyCount);
+    src.centers.reserve(polyCount);
+    src.heights.reserve(polyCount);
+    src.flags.reserve(polyCount);
+    src.areas.reserve(polyCount);
+    src.bounds.reserve(polyCount * 4);
+    src.vertexStart.reserve(polyCount + 1);
+    src.neighborStart.reserve(polyCount + 1);
+    src.vertexStart.push_back(0);
+    src.neighborStart.push_back(0);
+
+    for (const Taken& entry : taken) {
+        const CLTNavMeshData& data = *sources[entry.source].pData;
+        src.ids.push_back(entry.id);
+        src.centers.push_back(data.m_pCenters[entry.index]);
+        src.heights.push_back(data.m_pHeights[entry.index]);
+        src.flags.push_back(data.m_pFlags[entry.index]);
+        src.areas.push_back(data.m_pAreas[entry.index]);
+        src.bounds.insert(src.bounds.end(), data.GetBounds(entry.index), data.GetBounds(entry.index) + 4);
+
+        uint32_t vertexCount;
+        const CLTVector* vertices = data.GetVertices(entry.index, &vertexCount);
+        const float* fanAreas = data.m_pFanAreas + data.m_pVertexStart[entry.index];
+        src.vertices.insert(src.vertices.end(), vertices, vertices + vertexCount);
+        src.fanAreas.insert(src.fanAreas.end(), fanAreas, fanAreas + vertexCount);
+        src.vertexStart.push_back(static_cast<uint32_t>(src.vertices.size()));
+    }
+
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        const CLTNavMeshData& data = *sources[taken[i].source].pData;
+        const std::vector<uint32_t>& sourceRemap = remap[taken[i].source];
+
+        // Neighbours left behind in the source become external links
+        uint32_t neighborCount;
+        const uint32_t* neighbors = data.GetNeighbors(taken[i].index, &neighborCount);
+        for (uint32_t n = 0; n < neighborCount; ++n) {
+            uint32_t neighborIndex = sourceRemap[neighbors[n]];
+            if (neighborIndex == INVALID_INDEX) {
+                NavMeshExternalLink link = { i, data.m_pIds[neighbors[n]] };
+                src.externalLinks.push_back(link);
+            } else if (neighborIndex != i) {
+                src.neighbors.push_back(neighborIndex);
+            }
+        }
+
+        // External links to polygons now present become neighbours
+        uint32_t linkCount;
+        const NavMeshExternalLink* links = data.GetExternalLinks(taken[i].index, &linkCount);
+        for (uint32_t l = 0; l < linkCount; ++l) {
+            auto it = std::lower_bound(src.ids.begin(), src.ids.end(), links[l].neighborId);
+            if (it != src.ids.end() && *it == links[l].neighborId) {
+                uint32_t neighborIndex = static_cast<uint32_t>(it - src.ids.begin());
+                if (neighborIndex != i) {
+                    src.neighbors.push_back(neighborIndex);
+                }
+            } else {
+                NavMeshExternalLink link = { i, links[l].neighborId };
+                src.externalLinks.push_back(link);
+            }
+        }
+        src.neighborStart.push_back(static_cast<uint32_t>(src.neighbors.size()));
+    }
+
+    // Landmark rows carry over when all sources measured the same landmarks
+    const CLTNavMeshData* pLandmarkSource = nullptr;
+    bool sameLandmarks = true;
+    for (const JoinSource& source : sources) {
+        if (source.count == 0) {
+            continue;
+        }
+        if (!pLandmarkSource) {
+            pLandmarkSource = source.pData;
+            continue;
+        }
+        const CLTNavMeshData& data = *source.pData;
+        if (data.m_landmarkCount != pLandmarkSource->m_landmarkCount) {
+            sameLandmarks = false;
+        }
+        for (uint32_t l = 0; sameLandmarks && l < data.m_landmarkCount; ++l) {
+            sameLandmarks = data.GetLandmarkId(l) == pLandmarkSource->GetLandmarkId(l);
+        }
+    }
+    if (pLandmarkSource && sameLandmarks && pLandmarkSource->m_landmarkCount > 0) {
+        const uint32_t count = pLandmarkSource->m_landmarkCount;
+        for (uint32_t l = 0; l < count; ++l) {
+            src.landmarks.push_back(pLandmarkSource->GetLandmarkId(l));
+        }
+        src.landmarkDistances.reserve(static_cast<size_t>(polyCount) * count);
+        for (const Taken& entry : taken) {
+            const float* row = sources[entry.source].pData->GetLandmarkDistances(entry.index);
+            src.landmarkDistances.insert(src.landmarkDistances.end(), row, row + count);
+        }
+    }
+
+    BuildGrid(src);
+    BuildSamplingTables(src);
+
+    std::vector<uint32_t> image;
+    WriteImage(src, &image);
+
+    Release();
+    m_ownedImage.swap(image);
+    return Attach(reinterpret_cast<const uint8_t*>(m_ownedImage.data()),
+                  m_ownedImage.size() * sizeof(uint32_t));
+}
+
+bool CLTNavMeshData::LoadFromFile(const char* pFilename)
+{
+    Clear();
+    if (!pFilename) {
+        return false;
+    }
+
+    void* pBase = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA(pFilename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0 || fileSize.QuadPart > 0xFFFFFFFF) {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!hMapping) {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    pBase = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (!pBase) {
+        CloseHandle(hMapping);
+        CloseHandle(hFile);
+        return false;
+    }
+
+    size = static_cast<size_t>(fileSize.QuadPart);
+    m_hFile = hFile;
+    m_hMapping = hMapping;
+#else
+    int fd = open(pFilename, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || static_cast<uint64_t>(st.st_size) > 0xFFFFFFFFu) {
+        close(fd);
+        return false;
+    }
+
+    size = static_cast<size_t>(st.st_size);
+    pBase = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // The mapping keeps the file referenced
+    if (pBase == MAP_FAILED) {
+        return false;
+    }
+#endif
+
+    m_pMapping = pBase;
+    m_mappingSize = size;
+
+    if (!Attach(static_cast<const uint8_t*>(pBase), size)) {
+        Clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool CLTNavMeshData::SaveToFile(const char* pFilename) const
+{
+    if (!pFilename) {
+        return false;
+    }
+
+    FILE* pFile = fopen(pFilename, "wb");
+    if (!pFile) {
+        return false;
+    }
+
+    bool ok = fwrite(m_pImage, 1, m_imageSize, pFile) == m_imageSize;
+    ok = (fclose(pFile) == 0) && ok;
+    return ok;
+}
+
+bool CLTNavMeshData::AttachMemory(const void* pData, size_t size)
+{
+    Release();
+    if (!pData || (reinterpret_cast<uintptr_t>(pData) & 7) != 0 ||
+        !Attach(static_cast<const uint8_t*>(pData), size)) {
+        Clear();
+        return false;
+    }
+    return true;
+}
+
+void CLTNavMeshData::Clear()
+{
+    Release();
+
+    // An empty mesh is still a valid image, so accessors never see null arrays
+    NavMeshSource src;
+    src.vertexStart.assign(1, 0);
+    src.neighborStart.assign(1, 0);
+    BuildGrid(src);
+    BuildSamplingTables(src);
+    WriteImage(src, &m_ownedImage);
+    Attach(reinterpret_cast<const uint8_t*>(m_ownedImage.data()),
+           m_ownedImage.size() * sizeof(uint32_t));
+}
+
+void CLTNavMeshData::Release()
+{
+    if (m_pMapping) {
+#ifdef _WIN32
+        UnmapViewOfFile(m_pMapping);
+        CloseHandle(static_cast<HANDLE>(m_hMapping));
+        CloseHandle(static_cast<HANDLE>(m_hFile));
+#else
+        munmap(m_pMapping, m_mappingSize);
+#endif
+    }
+
+    m_pMapping = nullptr;
+    m_mappingSize = 0;
+    m_hFile = nullptr;
+    m_hMapping = nullptr;
+    m_ownedImage.clear();
+    m_pImage = nullptr;
+    m_imageSize = 0;
+    m_polyCount = 0;
+    m_externalLinkCount = 0;
+    m_pLandmarks = nullptr;
+    m_landmarkCount = 0;
+    m_sampleReach = 0.0f;
+}
+
+bool CLTNavMeshData::Attach(const uint8_t* pImage, size_t size)
+{
+    // Everything read from the image is checked before it is trusted, so a
+    // truncated or corrupt file fails to load instead of faulting later.
+    if (size < sizeof(NavMeshFileHeader)) {
+        return false;
+    }
+
+    NavMeshFileHeader header;
+    memcpy(&header, pImage, sizeof(header));
+    if (header.magic != FILE_MAGIC || header.version == 0 || header.version > FILE_VERSION ||
+        header.fileSize > size) {
+        return false;
+    }
+
+    // Version 1 files predate external links, version 2 files predate
+    // landmarks, versions 3 and 4 predate the sampling tables
+    const int requiredSections = header.version >= 5 ? SECTION_COUNT :
+                                 header.version >= 3 ? SECTION_FAN_AREAS :
+                                 header.version == 2 ? SECTION_LANDMARKS : SECTION_EXTERNAL_LINKS;
+    if (header.sectionCount < static_cast<uint32_t>(requiredSections) ||
+        (header.version < 2 && header.externalLinkCount != 0) ||
+        (header.version < 3 && header.landmarkCount != 0) ||
+        header.landmarkCount > MAX_LANDMARKS) {
+        return false;
+    }
+
+    const uint64_t fileSize = header.fileSize;
+    const uint64_t tableEnd = sizeof(header) + static_cast<uint64_t>(header.sectionCount) * sizeof(NavMeshFileSection);
+    if (tableEnd > fileSize) {
+        return false;
+    }
+
+    if (header.gridWidth <= 0 || header.gridHeight <= 0 ||
+        !(header.cellSize > 0.0f) || header.cellSize > FLT_MAX ||
+        !(std::fabs(header.gridMinX) <= FLT_MAX) || !(std::fabs(header.gridMinZ) <= FLT_MAX)) {
+        return false;
+    }
+
+    const uint64_t polyCount = header.polyCount;
+    const uint64_t cellCount = static_cast<uint64_t>(header.gridWidth) * static_cast<uint64_t>(header.gridHeight);
+    const uint64_t sumCount = (static_cast<uint64_t>(header.gridWidth) + 1) * (static_cast<uint64_t>(header.gridHeight) + 1);
+    const uint64_t expected[SECTION_COUNT] = {
+        polyCount * sizeof(uint32_t),
+        polyCount * sizeof(CLTVector),
+        polyCount * sizeof(float),
+        polyCount,
+        polyCount,
+        (polyCount + 1) * sizeof(uint32_t),
+        static_cast<uint64_t>(header.vertexCount) * sizeof(CLTVector),
+        (polyCount + 1) * sizeof(uint32_t),
+        static_cast<uint64_t>(header.neighborCount) * sizeof(uint32_t),
+        polyCount * 4 * sizeof(float),
+        (cellCount + 1) * sizeof(uint32_t),
+        static_cast<uint64_t>(header.cellPolyCount) * sizeof(uint32_t),
+        static_cast<uint64_t>(header.externalLinkCount) * sizeof(NavMeshExternalLink),
+        static_cast<uint64_t>(header.landmarkCount) * sizeof(uint32_t),
+        polyCount * header.landmarkCount * sizeof(float),
+        static_cast<uint64_t>(header.vertexCount) * sizeof(float),
+        (cellCount + 1) * sizeof(uint32_t),
+        polyCount * sizeof(uint32_t),
+        polyCount * sizeof(float),
+        sumCount * sizeof(double),
+        sumCount * sizeof(uint32_t)
+    };
+
+    const uint8_t* sections[SECTION_COUNT] = {};
+    for (int i = 0; i < requiredSections; ++i) {
+        NavMeshFileSection section;
+        memcpy(&section, pImage + sizeof(header) + i * sizeof(NavMeshFileSection), sizeof(section));
+        const uint32_t alignMask = i == SECTION_CELL_AREA_SUMS ? 7 : 3;
+        if (section.size != expected[i] || (section.offset & alignMask) != 0 ||
+            section.offset < tableEnd ||
+            static_cast<uint64_t>(section.offset) + section.size > fileSize) {
+            return false;
+        }
+        sections[i] = pImage + section.offset;
+    }
+
+    const uint32_t* ids = reinterpret_cast<const uint32_t*>(sections[SECTION_IDS]);
+    const uint32_t* vertexStart = reinterpret_cast<const uint32_t*>(sections[SECTION_VERTEX_START]);
+    const uint32_t* neighborStart = reinterpret_cast<const uint32_t*>(sections[SECTION_NEIGHBOR_START]);
+    const uint32_t* neighbors = reinterpret_cast<const uint32_t*>(sections[SECTION_NEIGHBORS]);
+    const uint32_t* cellStart = reinterpret_cast<const uint32_t*>(sections[SECTION_CELL_START]);
+    const uint32_t* cellPolys = reinterpret_cast<const uint32_t*>(sections[SECTION_CELL_POLYS]);
+    const NavMeshExternalLink* externalLinks = reinterpret_cast<const NavMeshExternalLink*>(sections[SECTION_EXTERNAL_LINKS]);
+    const uint32_t* landmarks = reinterpret_cast<const uint32_t*>(sections[SECTION_LANDMARKS]);
+    const float* landmarkDistances = reinterpret_cast<const float*>(sections[SECTION_LANDMARK_DISTANCES]);
+
+    // IDs ascending and non-zero; offset tables monotonic and in range;
+    // polygons within the vertex limit
+    for (uint32_t i = 0; i < header.polyCount; ++i) {
+        if (ids[i] == 0 || (i > 0 && ids[i] <= ids[i - 1]) ||
+            vertexStart[i + 1] < vertexStart[i] || vertexStart[i + 1] - vertexStart[i] > MAX_POLY_VERTICES ||
+            neighborStart[i + 1] < neighborStart[i]) {
+            return false;
+        }
+    }
+    if (vertexStart[0] != 0 || vertexStart[header.polyCount] != header.vertexCount ||
+        neighborStart[0] != 0 || neighborStart[header.polyCount] != header.neighborCount) {
+        return false;
+    }
+    for (uint32_t i = 0; i < header.neighborCount; ++i) {
+        if (neighbors[i] >= header.polyCount) {
+            return false;
+        }
+    }
+    for (uint64_t c = 0; c < cellCount; ++c) {
+        if (cellStart[c + 1] < cellStart[c]) {
+            return false;
+        }
+    }
+    if (cellStart[0] != 0 || cellStart[cellCount] != header.cellPolyCount) {
+        return false;
+    }
+    for (uint32_t i = 0; i < header.cellPolyCount; ++i) {
+        if (cellPolys[i] >= header.polyCount) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header.externalLinkCount; ++i) {
+        if (externalLinks[i].polyIndex >= header.polyCount || externalLinks[i].neighborId == 0 ||
+            (i > 0 && externalLinks[i].polyIndex < externalLinks[i - 1].polyIndex)) {
+            return false;
+        }
+    }
+    // Version 3 stored landmark polygon indices, later versions store IDs
+    for (uint32_t i = 0; i < header.landmarkCount; ++i) {
+        if (header.version == 3 ? landmarks[i] >= header.polyCount : landmarks[i] == 0) {
+            return false;
+        }
+    }
+    const uint64_t landmarkDistanceCount = polyCount * header.landmarkCount;
+    for (uint64_t i = 0; i < landmarkDistanceCount; ++i) {
+        // Rejects NaN as well as negative distances
+        if (!(landmarkDistances[i] >= 0.0f)) {
+            return false;
+        }
+    }
+
+    // Older images get their sampling tables built into an owned copy
+    if (header.version < 5) {
+        return AttachUpgraded(header, sections);
+    }
+
+    const float* fanAreas = reinterpret_cast<const float*>(sections[SECTION_FAN_AREAS]);
+    const uint32_t* sampleCellStart = reinterpret_cast<const uint32_t*>(sections[SECTION_SAMPLE_CELL_START]);
+    const uint32_t* samplePolys = reinterpret_cast<const uint32_t*>(sections[SECTION_SAMPLE_POLYS]);
+    const float* sampleAreas = reinterpret_cast<const float*>(sections[SECTION_SAMPLE_AREAS]);
+    const double* cellAreaSums = reinterpret_cast<const double*>(sections[SECTION_CELL_AREA_SUMS]);
+    if (!(header.sampleReach >= 0.0f) || header.sampleReach > FLT_MAX) {
+        return false;
+    }
+    for (uint32_t i = 0; i < header.vertexCount; ++i) {
+        if (!(fanAreas[i] >= 0.0f) || fanAreas[i] > FLT_MAX) {
+            return false;
+        }
+    }
+    for (uint64_t c = 0; c < cellCount; ++c) {
+        if (sampleCellStart[c + 1] < sampleCellStart[c]) {
+            return false;
+        }
+    }
+    if (sampleCellStart[0] != 0 || sampleCellStart[cellCount] != header.polyCount) {
+        return false;
+    }
+    for (uint32_t i = 0; i < header.polyCount; ++i) {
+        if (samplePolys[i] >= header.polyCount || !(sampleAreas[i] >= 0.0f) || sampleAreas[i] > FLT_MAX) {
+            return false;
+        }
+    }
+    for (uint64_t i = 0; i < sumCount; ++i) {
+        if (!(cellAreaSums[i] >= 0.0) || cellAreaSums[i] > DBL_MAX) {
+            return false;
+        }
+    }
+
+    m_pImage = pImage;
+    m_imageSize = header.fileSize;
+    m_polyCount = header.polyCount;
+    m_pIds = ids;
+    m_pCenters = reinterpret_cast<const CLTVector*>(sections[SECTION_CENTERS]);
+    m_pHeights = reinterpret_cast<const float*>(sections[SECTION_HEIGHTS]);
+    m_pFlags = sections[SECTION_FLAGS];
+    m_pAreas = sections[SECTION_AREAS];
+    m_pVertexStart = vertexStart;
+    m_pVertices = reinterpret_cast<const CLTVector*>(sections[SECTION_VERTICES]);
+    m_pNeighborStart = neighborStart;
+    m_pNeighbors = neighbors;
+    m_pBounds = reinterpret_cast<const float*>(sections[SECTION_BOUNDS]);
+    m_pCellStart = cellStart;
+    m_pCellPolys = cellPolys;
+    m_pExternalLinks = externalLinks;
+    m_externalLinkCount = header.externalLinkCount;
+    m_pLandmarks = landmarks;
+    m_pLandmarkDistances = landmarkDistances;
+    m_landmarkCount = header.landmarkCount;
+    m_pFanAreas = fanAreas;
+    m_pSampleCellStart = sampleCellStart;
+    m_pSamplePolys = samplePolys;
+    m_pSampleAreas = sampleAreas;
+    m_pCellAreaSums = cellAreaSums;
+    m_pLayeredCellSums = reinterpret_cast<const uint32_t*>(sections[SECTION_LAYERED_CELL_SUMS]);
+    m_sampleReach = header.sampleReach;
+    m_gridMinX = header.gridMinX;
+    m_gridMinZ = header.gridMinZ;
+    m_cellSize = header.cellSize;
+    m_gridWidth = header.gridWidth;
+    m_gridHeight = header.gridHeight;
+    return true;
+}
+
+bool CLTNavMeshData::AttachUpgraded(const NavMeshFileHeader& header, const uint8_t* const* sections)
+{
+    // Copy everything out first: the sections may point into the mapping
+    // that Release() is about to unmap
+    const uint32_t polyCount = header.polyCount;
+    const uint32_t* ids = reinterpret_cast<const uint32_t*>(sections[SECTION_IDS]);
+    const CLTVector* centers = reinterpret_cast<const CLTVector*>(sections[SECTION_CENTERS]);
+    const float* heights = reinterpret_cast<const float*>(sections[SECTION_HEIGHTS]);
+    const uint32_t* vertexStart = reinterpret_cast<const uint32_t*>(sections[SECTION_VERTEX_START]);
+    const CLTVector* vertices = reinterpret_cast<const CLTVector*>(sections[SECTION_VERTICES]);
+    const uint32_t* neighborStart = reinterpret_cast<const uint32_t*>(sections[SECTION_NEIGHBOR_START]);
+    const uint32_t* neighbors = reinterpret_cast<const uint32_t*>(sections[SECTION_NEIGHBORS]);
+    const float* bounds = reinterpret_cast<const float*>(sections[SECTION_BOUNDS]);
+    const uint32_t cellCount = static_cast<uint32_t>(header.gridWidth * header.gridHeight);
+    const uint32_t* cellStart = reinterpret_cast<const uint32_t*>(sections[SECTION_CELL_START]);
+    const uint32_t* cellPolys = reinterpret_cast<const uint32_t*>(sections[SECTION_CELL_POLYS]);
+
+    NavMeshSource src;
+    src.ids.assign(ids, ids + polyCount);
+    src.centers.assign(centers, centers + polyCount);
+    src.heights.assign(heights, heights + polyCount);
+    src.flags.assign(sections[SECTION_FLAGS], sections[SECTION_FLAGS] + polyCount);
+    src.areas.assign(sections[SECTION_AREAS], sections[SECTION_AREAS] + polyCount);
+    src.vertexStart.assign(vertexStart, vertexStart + polyCount + 1);
+    src.vertices.assign(vertices, vertices + header.vertexCount);
+    src.neighborStart.assign(neighborStart, neighborStart + polyCount + 1);
+    src.neighbors.assign(neighbors, neighbors + header.neighborCount);
+    src.bounds.assign(bounds, bounds + polyCount * 4);
+    src.cellStart.assign(cellStart, cellStart + cellCount + 1);
+    src.cellPolys.assign(cellPolys, cellPolys + header.cellPolyCount);
+    if (header.externalLinkCount > 0) {
+        const NavMeshExternalLink* links = reinterpret_cast<const NavMeshExternalLink*>(sections[SECTION_EXTERNAL_LINKS]);
+        src.externalLinks.assign(links, links + header.externalLinkCount);
+    }
+    if (header.landmarkCount > 0) {
+        // Version 3 stored landmark polygon indices
+        const uint32_t* landmarks = reinterpret_cast<const uint32_t*>(sections[SECTION_LANDMARKS]);
+        const float* distances = reinterpret_cast<const float*>(sections[SECTION_LANDMARK_DISTANCES]);
+        for (uint32_t l = 0; l < header.landmarkCount; ++l) {
+            src.landmarks.push_back(header.version == 3 ? ids[landmarks[l]] : landmarks[l]);
+        }
+        src.landmarkDistances.assign(distances, distances + static_cast<size_t>(polyCount) * header.landmarkCount);
+    }
+    src.gridMinX = header.gridMinX;
+    src.gridMinZ = header.gridMinZ;
+    src.cellSize = header.cellSize;
+    src.gridWidth = header.gridWidth;
+    src.gridHeight = header.gridHeight;
+    BuildSamplingTables(src);
+
+    std::vector<uint32_t> image;
+    WriteImage(src, &image);
+    Release();
+    m_ownedImage.swap(image);
+    return Attach(reinterpret_cast<const uint8_t*>(m_ownedImage.data()), m_ownedImage.size() * sizeof(uint32_t));
+}
+
+uint32_t CLTNavMeshData::GetIndex(uint32_t polyId) const
+{
+    auto it = std::lower_bound(m_pIds, m_pIds + m_polyCount, polyId);
+    if (it == m_pIds + m_polyCount || *it != polyId) {
+        return INVALID_INDEX;
+    }
+    return static_cast<uint32_t>(it - m_pIds);
+}
+
+NavMeshPolyView CLTNavMeshData::GetPoly(uint32_t index) const
+{
+    NavMeshPolyView view;
+    view.index = index;
+    view.id = m_pIds[index];
+    view.vertices = GetVertices(index, &view.vertexCount);
+    view.neighbors = GetNeighbors(index, &view.neighborCount);
+    view.center = m_pCenters[index];
+    view.height = m_pHeights[index];
+    view.flags = m_pFlags[index];
+    view.area = m_pAreas[index];
+    return view;
+}
+
+void CLTNavMeshData::CopyPoly(uint32_t index, NavMeshPoly* pPoly) const
+{
+    NavMeshPolyView view = GetPoly(index);
+
+    pPoly->id = view.id;
+    pPoly->vertices.assign(view.vertices, view.vertices + view.vertexCount);
+    pPoly->center = view.center;
+    pPoly->height = view.height;
+    pPoly->flags = view.flags;
+    pPoly->area = view.area;
+
+    pPoly->neighbors.clear();
+    for (uint32_t i = 0; i < view.neighborCount; ++i) {
+        pPoly->neighbors.push_back(m_pIds[view.neighbors[i]]);
+    }
+
+    uint32_t linkCount;
+    const NavMeshExternalLink* links = GetExternalLinks(index, &linkCount);
+    for (uint32_t i = 0; i < linkCount; ++i) {
+        pPoly->neighbors.push_back(links[i].neighborId);
+    }
+}
+
+const NavMeshExternalLink* CLTNavMeshData::GetExternalLinks(uint32_t index, uint32_t* pCount) const
+{
+    const NavMeshExternalLink* begin = m_pExternalLinks;
+    const NavMeshExternalLink* end = m_pExternalLinks + m_externalLinkCount;
+    const NavMeshExternalLink* first = std::lower_bound(begin, end, index,
+        [](const NavMeshExternalLink& link, uint32_t value) {
+            return link.polyIndex < value;
+        });
+
+    const NavMeshExternalLink* last = first;
+    while (last != end && last->polyIndex == index) {
+        ++last;
+    }
+
+    *pCount = static_cast<uint32_t>(last - first);
+    return first;
+}
+
+float CLTNavMeshData::DistanceSquaredToEdges(uint32_t index, float x, float z) const
+{
+    uint32_t vertexCount;
+    const CLTVector* vertices = GetVertices(index, &vertexCount);
+
+    if (vertexCount == 0) {
+        float dx = x - m_pCenters[index].x;
+        float dz = z - m_pCenters[index].z;
+        return dx * dx + dz * dz;
+    }
+
+    float bestSq = FLT_MAX;
+    for (uint32_t i = 0, j = vertexCount - 1; i < vertexCount; j = i++) {
+        // Closest point on edge j->i
+        float ex = vertices[i].x - vertices[j].x;
+        float ez = vertices[i].z - vertices[j].z;
+        float px = x - vertices[j].x;
+        float pz = z - vertices[j].z;
+        float lenSq = ex * ex + ez * ez;
+        float t = lenSq > 0.0f ? (px * ex + pz * ez) / lenSq : 0.0f;
+        t = std::max(0.0f, std::min(1.0f, t));
+        float dx = px - ex * t;
+        float dz = pz - ez * t;
+        bestSq = std::min(bestSq, dx * dx + dz * dz);
+    }
+
+    return bestSq;
+}
+
+bool CLTNavMeshData::GetPortal(uint32_t fromIndex, uint32_t toIndex, CLTVector* pLeft, CLTVector* pRight) const
+{
+    // Distance (XZ) within which edges count as touching
+    const float PORTAL_EPSILON = 0.01f;
+
+    uint32_t fromCount, toCount;
+    const CLTVector* from = GetVertices(fromIndex, &fromCount);
+    const CLTVector* to = GetVertices(toIndex, &toCount);
+
+    float bestLength = PORTAL_EPSILON;
+    bool found = false;
+    for (uint32_t i = 0, j = fromCount - 1; i < fromCount; j = i++) {
+        const CLTVector& a = from[j];
+        const CLTVector& b = from[i];
+        float ex = b.x - a.x;
+        float ez = b.z - a.z;
+        float lenSq = ex * ex + ez * ez;
+        if (lenSq <= PORTAL_EPSILON * PORTAL_EPSILON) {
+            continue;
+        }
+        float len = std::sqrt(lenSq);
+
+        for (uint32_t k = 0, l = toCount - 1; k < toCount; l = k++) {
+            // Both ends of the other edge must lie on this edge's line
+            const CLTVector& c = to[l];
+            const CLTVector& d = to[k];
+            float distC = std::fabs(ex * (c.z - a.z) - ez * (c.x - a.x)) / len;
+            float distD = std::fabs(ex * (d.z - a.z) - ez * (d.x - a.x)) / len;
+            if (distC > PORTAL_EPSILON || distD > PORTAL_EPSILON) {
+                continue;
+            }
+
+            // Overlap of the two edges along this edge, as 0..1 parameters
+            float tc = (ex * (c.x - a.x) + ez * (c.z - a.z)) / lenSq;
+            float td = (ex * (d.x - a.x) + ez * (d.z - a.z)) / lenSq;
+            float t0 = std::max(0.0f, std::min(tc, td));
+            float t1 = std::min(1.0f, std::max(tc, td));
+            float overlap = (t1 - t0) * len;
+            if (overlap > bestLength) {
+                bestLength = overlap;
+                *pLeft = a + (b - a) * t0;
+                *pRight = a + (b - a) * t1;
+                found = true;
+            }
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    // Orient the portal: left is counter-clockwise of right seen from the center
+    const CLTVector& center = m_pCenters[fromIndex];
+    float cross = (pRight->x - center.x) * (pLeft->z - center.z) -
+                  (pRight->z - center.z) * (pLeft->x - center.x);
+    if (cross < 0.0f) {
+        std::swap(*pLeft, *pRight);
+    }
+
+    return true;
+}
+
+bool CLTNavMeshData::PointInPolygon(const CLTVector* pVertices, uint32_t vertexCount, float x, float z)
+{
+    if (vertexCount < 3) {
+        return false;
+    }
+
+    // Count crossings of a ray towards +X. The crossing comparison is the
+    // usual x < xi + dx * (z - zi) / dz, multiplied out by dz so there is
+    // no division; the comparison flips when dz is negative.
+    bool inside = false;
+    for (uint32_t i = 0, j = vertexCount - 1; i < vertexCount; j = i++) {
+        float zi = pVertices[i].z;
+        float zj = pVertices[j].z;
+        if ((zi > z) != (zj > z)) {
+            float dx = pVertices[j].x - pVertices[i].x;
+            float dz = zj - zi;
+            bool left = (x - pVertices[i].x) * dz < dx * (z - zi);
+            if (left == (dz > 0.0f)) {
+                inside = !inside;
+            }
+        }
+    }
+
+    return inside;
+}
+
+uint32_t CLTNavMeshData::ContainsPointBatch(float x, float z, const uint32_t* pIndices, uint32_t count,
+                                            uint8_t* pInside) const
+{
+    uint32_t insideCount = 0;
+    uint32_t k = 0;
+
+#ifdef NAVMESH_USE_SSE
+    const __m128 px = _mm_set1_ps(x);
+    const __m128 pz = _mm_set1_ps(z);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; k + 4 <= count; k += 4) {
+        const CLTVector* verts[4];
+        uint32_t vertCount[4];
+        uint32_t maxCount = 0;
+        for (int lane = 0; lane < 4; ++lane) {
+            verts[lane] = GetVertices(pIndices[k + lane], &vertCount[lane]);
+            maxCount = std::max(maxCount, vertCount[lane]);
+        }
+
+        // Lane mask of crossing parity; lanes run out of edges at different times
+        __m128 parity = zero;
+        for (uint32_t e = 0; e < maxCount; ++e) {
+            float xi[4], zi[4], xj[4], zj[4], live[4];
+            for (int lane = 0; lane < 4; ++lane) {
+                uint32_t n = vertCount[lane];
+                if (e < n && n >= 3) {
+                    const CLTVector& vi = verts[lane][e];
+                    const CLTVector& vj = verts[lane][e == 0 ? n - 1 : e - 1];
+                    xi[lane] = vi.x; zi[lane] = vi.z;
+                    xj[lane] = vj.x; zj[lane] = vj.z;
+                    live[lane] = 1.0f;
+                } else {
+                    xi[lane] = zi[lane] = xj[lane] = zj[lane] = 0.0f;
+                    live[lane] = 0.0f;
+                }
+            }
+
+            __m128 vxi = _mm_loadu_ps(xi);
+            __m128 vzi = _mm_loadu_ps(zi);
+            __m128 vxj = _mm_loadu_ps(xj);
+            __m128 vzj = _mm_loadu_ps(zj);
+            __m128 vlive = _mm_cmpgt_ps(_mm_loadu_ps(live), zero);
+
+            // Same test as PointInPolygon, four edges at a time
+            __m128 straddle = _mm_xor_ps(_mm_cmpgt_ps(vzi, pz), _mm_cmpgt_ps(vzj, pz));
+            __m128 dx = _mm_sub_ps(vxj, vxi);
+            __m128 dz = _mm_sub_ps(vzj, vzi);
+            __m128 lhs = _mm_mul_ps(_mm_sub_ps(px, vxi), dz);
+            __m128 rhs = _mm_mul_ps(dx, _mm_sub_ps(pz, vzi));
+            __m128 left = _mm_cmplt_ps(lhs, rhs);
+            __m128 dzPositive = _mm_cmpgt_ps(dz, zero);
+            // left == dzPositive  <=>  !(left ^ dzPositive)
+            __m128 crosses = _mm_andnot_ps(_mm_xor_ps(left, dzPositive), _mm_and_ps(straddle, vlive));
+            parity = _mm_xor_ps(parity, crosses);
+        }
+
+        int mask = _mm_movemask_ps(parity);
+        for (int lane = 0; lane < 4; ++lane) {
+            uint8_t inside = static_cast<uint8_t>((mask >> lane) & 1);
+            pInside[k + lane] = inside;
+            insideCount += inside;
+        }
+    }
+#endif
+
+    // Scalar path for the remainder (or everything without SSE)
+    for (; k < count; ++k) {
+        uint8_t inside = ContainsPoint(pIndices[k], x, z) ? 1 : 0;
+        pInside[k] = inside;
+        insideCount += inside;
+    }
+
+    return insideCount;
+}
+
+bool CLTNavMeshData::GetCellCoords(float x, float z, int* pCellX, int* pCellZ) const
+{
+    *pCellX = GridCoord(x, m_gridMinX, m_cellSize);
+    *pCellZ = GridCoord(z, m_gridMinZ, m_cellSize);
+    return *pCellX >= 0 && *pCellX < m_gridWidth && *pCellZ >= 0 && *pCellZ < m_gridHeight;
+}
+
+CLTVector CLTNavMeshData::GetPointInPoly(uint32_t index, float r0, float r1, float r2) const
+{
+    const uint32_t first = m_pVertexStart[index];
+    const uint32_t last = m_pVertexStart[index + 1];
+    const float area = GetPolyArea(index);
+    if (!(area > 0.0f)) {
+        return m_pCenters[index];
+    }
+
+    // Triangle (v0, vk-1, vk) with the first running sum above the target
+    const float* it = std::upper_bound(m_pFanAreas + first + 2, m_pFanAreas + last, r0 * area);
+    uint32_t k = std::min(static_cast<uint32_t>(it - m_pFanAreas), last - 1);
+
+    // Uniform point in the triangle
+    float s = std::sqrt(r1);
+    const CLTVector& a = m_pVertices[first];
+    const CLTVector& b = m_pVertices[k - 1];
+    const CLTVector& c = m_pVertices[k];
+    return a * (1.0f - s) + b * (s * (1.0f - r2)) + c * (s * r2);
+}
+
+float CLTNavMeshData::GetPointHeight(uint32_t index, float x, float z) const
+{
+    // Slack for points on a shared fan edge
+    const float EPSILON = 1.0e-4f;
+
+    const uint32_t first = m_pVertexStart[index];
+    const uint32_t last = m_pVertexStart[index + 1];
+    for (uint32_t k = first + 2; k < last; ++k) {
+        const CLTVector& a = m_pVertices[first];
+        const CLTVector& b = m_pVertices[k - 1];
+        const CLTVector& c = m_pVertices[k];
+        float det = (b.x - a.x) * (c.z - a.z) - (b.z - a.z) * (c.x - a.x);
+        if (det == 0.0f) {
+            continue;
+        }
+
+        // Barycentric weights of b and c
+        float u = ((x - a.x) * (c.z - a.z) - (z - a.z) * (c.x - a.x)) / det;
+        float v = ((b.x - a.x) * (z - a.z) - (b.z - a.z) * (x - a.x)) / det;
+        if (u >= -EPSILON && v >= -EPSILON && u + v <= 1.0f + EPSILON) {
+            return a.y + (b.y - a.y) * u + (c.y - a.y) * v;
+        }
+    }
+
+    return m_pCenters[index].y;
+}
+
+double CLTNavMeshData::GetSampleArea(int x0, int z0, int x1, int z1) const
+{
+    const int stride = m_gridWidth + 1;
+    const double* sums = m_pCellAreaSums;
+    return sums[(z1 + 1) * stride + x1 + 1] - sums[z0 * stride + x1 + 1] -
+           sums[(z1 + 1) * stride + x0] + sums[z0 * stride + x0];
+}
+
+bool CLTNavMeshData::HasOverlappingPolys(int x0, int z0, int x1, int z1) const
+{
+    const int stride = m_gridWidth + 1;
+    const uint32_t* sums = m_pLayeredCellSums;
+    return sums[(z1 + 1) * stride + x1 + 1] - sums[z0 * stride + x1 + 1] -
+           sums[(z1 + 1) * stride + x0] + sums[z0 * stride + x0] != 0;
+}
+
+uint32_t CLTNavMeshData::PickPolygon(int x0, int z0, int x1, int z1, double target) const
+{
+    // Row: the first whose rows z0..row hold more than the target
+    int lo = z0, hi = z1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (GetSampleArea(x0, z0, x1, mid) > target) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    const int cz = lo;
+    if (cz > z0) {
+        target -= GetSampleArea(x0, z0, x1, cz - 1);
+    }
+
+    // Cell within the row
+    lo = x0;
+    hi = x1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (GetSampleArea(x0, cz, mid, cz) > target) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    const int cx = lo;
+    if (cx > x0) {
+        target -= GetSampleArea(x0, cz, cx - 1, cz);
+    }
+
+    // Polygon within the cell; rounding may leave the target a hair past the end
+    const uint32_t cell = static_cast<uint32_t>(cz * m_gridWidth + cx);
+    const uint32_t first = m_pSampleCellStart[cell];
+    const uint32_t last = m_pSampleCellStart[cell + 1];
+    if (first == last) {
+        return INVALID_INDEX;
+    }
+    const float* it = std::upper_bound(m_pSampleAreas + first, m_pSampleAreas + last, static_cast<float>(target));
+    uint32_t entry = std::min(static_cast<uint32_t>(it - m_pSampleAreas), last - 1);
+    return m_pSamplePolys[entry];
+}
+
+// Squared XZ distance from a point to segment a-b
+static float PointSegmentDistanceSquaredXZ(const CLTVector& p, const CLTVector& a, const CLTVector& b)
+{
+    float ex = b.x - a.x, ez = b.z - a.z;
+    float lenSq = ex * ex + ez * ez;
+    float t = lenSq > 0.0f ? ((p.x - a.x) * ex + (p.z - a.z) * ez) / lenSq : 0.0f;
+    t = std::max(0.0f, std::min(1.0f, t));
+    float dx = p.x - a.x - ex * t;
+    float dz = p.z - a.z - ez * t;
+    return dx * dx + dz * dz;
+}
+
+// Squared XZ distance between segments p0-p1 and q0-q1, zero if they cross
+static float SegmentDistanceSquaredXZ(const CLTVector& p0, const CLTVector& p1,
+                                      const CLTVector& q0, const CLTVector& q1)
+{
+    float dpx = p1.x - p0.x, dpz = p1.z - p0.z;
+    float dqx = q1.x - q0.x, dqz = q1.z - q0.z;
+    float denom = dpx * dqz - dpz * dqx;
+    if (denom != 0.0f) {
+        float t = ((q0.x - p0.x) * dqz - (q0.z - p0.z) * dqx) / denom;
+        float u = ((q0.x - p0.x) * dpz - (q0.z - p0.z) * dpx) / denom;
+        if (t >= 0.0f && t <= 1.0f && u >= 0.0f && u <= 1.0f) {
+            return 0.0f;
+        }
+    }
+
+    // Otherwise the closest pair involves an endpoint
+    return std::min(std::min(PointSegmentDistanceSquaredXZ(p0, q0, q1), PointSegmentDistanceSquaredXZ(p1, q0, q1)),
+                    std::min(PointSegmentDistanceSquaredXZ(q0, p0, p1), PointSegmentDistanceSquaredXZ(q1, p0, p1)));
+}
+
+// Distance from a value to the range lo..hi, zero inside it
+static float RangeGap(float lo, float hi, float minValue, float maxValue)
+{
+    return std::max(0.0f, std::max(minValue - hi, lo - maxValue));
+}
+
+bool CLTNavMeshData::OverlapsRegion(uint32_t index, const NavMeshRegion& region) const
+{
+    uint32_t vertexCount;
+    const CLTVector* vertices = GetVertices(index, &vertexCount);
+
+    // Vertical span; polygons without vertices are their center point
+    float minY = m_pCenters[index].y, maxY = minY;
+    if (vertexCount > 0) {
+        minY = maxY = vertices[0].y;
+        for (uint32_t i = 1; i < vertexCount; ++i) {
+            minY = std::min(minY, vertices[i].y);
+            maxY = std::max(maxY, vertices[i].y);
+        }
+    }
+
+    const float* bounds = GetBounds(index);
+    switch (region.shape) {
+    case NavMeshRegion::SHAPE_BOX: {
+        const CLTVector& lo = region.a;
+        const CLTVector& hi = region.b;
+        if (maxY < lo.y || minY > hi.y ||
+            bounds[2] < lo.x || bounds[0] > hi.x || bounds[3] < lo.z || bounds[1] > hi.z) {
+            return false;
+        }
+        if (vertexCount < 3) {
+            return true;  // Bounds are the whole polygon
+        }
+
+        // The outline overlaps the box if an edge reaches into it or the
+        // box lies wholly inside the outline
+        for (uint32_t i = 0, j = vertexCount - 1; i < vertexCount; j = i++) {
+            // Liang-Barsky clip of edge j->i against the box
+            float x0 = vertices[j].x, z0 = vertices[j].z;
+            float dx = vertices[i].x - x0, dz = vertices[i].z - z0;
+            float t0 = 0.0f, t1 = 1.0f;
+            const float p[4] = { -dx, dx, -dz, dz };
+            const float q[4] = { x0 - lo.x, hi.x - x0, z0 - lo.z, hi.z - z0 };
+            bool inside = true;
+            for (int k = 0; k < 4 && inside; ++k) {
+                if (p[k] == 0.0f) {
+                    inside = q[k] >= 0.0f;
+                } else {
+                    float t = q[k] / p[k];
+                    if (p[k] < 0.0f) {
+                        t0 = std::max(t0, t);
+                    } else {
+                        t1 = std::min(t1, t);
+                    }
+                    inside = t0 <= t1;
+                }
+            }
+            if (inside) {
+                return true;
+            }
+        }
+        return ContainsPoint(index, lo.x, lo.z);
+    }
+
+    case NavMeshRegion::SHAPE_SPHERE: {
+        const CLTVector& center = region.a;
+        const float radiusSq = region.radius * region.radius;
+        float dy = RangeGap(center.y, center.y, minY, maxY);
+        if (dy * dy > radiusSq) {
+            return false;
+        }
+        float dxz = ContainsPoint(index, center.x, center.z) ? 0.0f : DistanceSquaredToEdges(index, center.x, center.z);
+        return dxz + dy * dy <= radiusSq;
+    }
+
+    case NavMeshRegion::SHAPE_CAPSULE: {
+        const CLTVector& start = region.a;
+        const CLTVector& end = region.b;
+        const float radiusSq = region.radius * region.radius;
+        float dy = RangeGap(std::min(start.y, end.y), std::max(start.y, end.y), minY, maxY);
+        if (dy * dy > radiusSq) {
+            return false;
+        }
+
+        float dxz = 0.0f;
+        if (vertexCount == 0) {
+            dxz = SegmentDistanceSquaredXZ(start, end, m_pCenters[index], m_pCenters[index]);
+        } else if (!ContainsPoint(index, start.x, start.z)) {
+            dxz = FLT_MAX;
+            for (uint32_t i = 0, j = vertexCount - 1; i < vertexCount && dxz > 0.0f; j = i++) {
+                dxz = std::min(dxz, SegmentDistanceSquaredXZ(start, end, vertices[j], vertices[i]));
+            }
+        }
+        return dxz + dy * dy <= radiusSq;
+    }
+    }
+
+    return false;
+}
+
+uint32_t CLTNavMeshData::QueryBounds(float minX, float minZ, float maxX, float maxZ,
+                                     NavMeshPolyVisitor pVisitor, void* pUserData) const
+{
+    if (!(minX <= maxX) || !(minZ <= maxZ)) {
+        return 0;
+    }
+
+    int x0 = std::max(0, GridCoord(minX, m_gridMinX, m_cellSize));
+    int z0 = std::max(0, GridCoord(minZ, m_gridMinZ, m_cellSize));
+    int x1 = std::min(m_gridWidth - 1, GridCoord(maxX, m_gridMinX, m_cellSize));
+    int z1 = std::min(m_gridHeight - 1, GridCoord(maxZ, m_gridMinZ, m_cellSize));
+
+    uint32_t visited = 0;
+    for (int cz = z0; cz <= z1; ++cz) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            uint32_t count;
+            const uint32_t* polys = GetCellPolys(cx, cz, &count);
+            for (uint32_t i = 0; i < count; ++i) {
+                const uint32_t index = polys[i];
+                const float* b = GetBounds(index);
+                if (b[2] < minX || b[0] > maxX || b[3] < minZ || b[1] > maxZ) {
+                    continue;
+                }
+
+                // Only the first cell of the query that lists the polygon reports it
+                int firstX = std::max(x0, GridCoord(b[0], m_gridMinX, m_cellSize));
+                int firstZ = std::max(z0, GridCoord(b[1], m_gridMinZ, m_cellSize));
+                if (cx != firstX || cz != firstZ) {
+                    continue;
+                }
+
+                ++visited;
+                if (!pVisitor(GetPoly(index), pUserData)) {
+                    return visited;
+                }
+            }
+        }
+    }
+
+    return visited;
+}
+
+namespace {
+
+// Forwards the polygons passing the exact test of a region query
+struct RegionFilter {
+    const CLTNavMeshData* pNavData;
+    const NavMeshRegion* pRegion;
+    NavMeshPolyVisitor pVisitor;
+    void* pUserData;
+    uint32_t visited;
+
+    static bool Visit(const NavMeshPolyView& poly, void* pUserData) {
+        RegionFilter* pFilter = static_cast<RegionFilter*>(pUserData);
+        if (!pFilter->pNavData->OverlapsRegion(poly.index, *pFilter->pRegion)) {
+            return true;
+        }
+        ++pFilter->visited;
+        return pFilter->pVisitor(poly, pFilter->pUserData);
+    }
+};
+
+}
+
+uint32_t CLTNavMeshData::QueryPolygons(const NavMeshRegion& region, NavMeshPolyVisitor pVisitor, void* pUserData) const
+{
+    float minX, minZ, maxX, maxZ;
+    if (region.shape == NavMeshRegion::SHAPE_BOX) {
+        minX = region.a.x;
+        minZ = region.a.z;
+        maxX = region.b.x;
+        maxZ = region.b.z;
+    } else {
+        minX = std::min(region.a.x, region.b.x) - region.radius;
+        minZ = std::min(region.a.z, region.b.z) - region.radius;
+        maxX = std::max(region.a.x, region.b.x) + region.radius;
+        maxZ = std::max(region.a.z, region.b.z) + region.radius;
+    }
+
+    RegionFilter filter = { this, &region, pVisitor, pUserData, 0 };
+    QueryBounds(minX, minZ, maxX, maxZ, &RegionFilter::Visit, &filter);
+    return filter.visited;
+}
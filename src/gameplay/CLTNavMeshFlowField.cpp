@@ -0,0 +1,108 @@
+#include "../../include/gameplay/CLTNavMeshFlowField.h"
+#include <functional>
+#include <queue>
+#include <utility>
+
+CLTNavMeshFlowField::CLTNavMeshFlowField()
+    : m_goal(0.0f, 0.0f, 0.0f)
+    , m_goalIndex(CLTNavMeshData::INVALID_INDEX)
+    , m_areaFlags(0)
+    , m_excludedAreaFlags(0)
+{
+}
+
+bool CLTNavMeshFlowField::Build(const std::shared_ptr<const CLTNavMeshData>& pNavData,
+                                const CLTVector& goal, uint32_t goalIndex,
+                                uint32_t areaFlags, uint32_t excludedAreaFlags,
+                                const std::vector<float>* pAreaCosts,
+                                const std::vector<uint8_t>* pBlocked)
+{
+    if (!pNavData || goalIndex >= pNavData->GetPolyCount()) {
+        return false;
+    }
+
+    const uint8_t goalArea = pNavData->GetArea(goalIndex);
+    if ((goalArea & areaFlags) == 0 || (goalArea & excludedAreaFlags) != 0) {
+        return false;
+    }
+
+    m_pNavData = pNavData;
+    m_goal = goal;
+    m_goalIndex = goalIndex;
+    m_areaFlags = areaFlags;
+    m_excludedAreaFlags = excludedAreaFlags;
+
+    const CLTNavMeshData& navData = *m_pNavData;
+    const uint32_t polyCount = navData.GetPolyCount();
+    m_next.assign(polyCount, CLTNavMeshData::INVALID_INDEX);
+    m_distances.assign(polyCount, FLT_MAX);
+    m_targets.assign(polyCount, goal);
+
+    // The search runs against the link direction, so gather incoming links first
+    std::vector<uint32_t> incomingStart(polyCount + 1, 0);
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        uint32_t neighborCount;
+        const uint32_t* neighbors = navData.GetNeighbors(i, &neighborCount);
+        for (uint32_t n = 0; n < neighborCount; ++n) {
+            incomingStart[neighbors[n] + 1]++;
+        }
+    }
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        incomingStart[i + 1] += incomingStart[i];
+    }
+    std::vector<uint32_t> incoming(incomingStart[polyCount]);
+    std::vector<uint32_t> fill(incomingStart.begin(), incomingStart.end() - 1);
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        uint32_t neighborCount;
+        const uint32_t* neighbors = navData.GetNeighbors(i, &neighborCount);
+        for (uint32_t n = 0; n < neighborCount; ++n) {
+            incoming[fill[neighbors[n]]++] = i;
+        }
+    }
+
+    // Reverse Dijkstra from the goal over polygon centers, costed like a path search
+    typedef std::pair<float, uint32_t> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+    m_distances[goalIndex] = 0.0f;
+    open.push(Entry(0.0f, goalIndex));
+
+    while (!open.empty()) {
+        Entry current = open.top();
+        open.pop();
+        if (current.first > m_distances[current.second]) {
+            continue;  // Stale entry
+        }
+
+        const CLTVector& center = navData.GetCenter(current.second);
+        const float currentCost = pAreaCosts ? (*pAreaCosts)[navData.GetArea(current.second)] : 1.0f;
+        for (uint32_t i = incomingStart[current.second]; i < incomingStart[current.second + 1]; ++i) {
+            uint32_t from = incoming[i];
+            const uint8_t area = navData.GetArea(from);
+            if ((area & areaFlags) == 0 || (area & excludedAreaFlags) != 0 || (pBlocked && (*pBlocked)[from])) {
+                continue;
+            }
+
+            // The step runs through both polygons, so it pays the mean of their costs
+            float fromCost = pAreaCosts ? (*pAreaCosts)[area] : 1.0f;
+            float distance = current.first + center.Distance(navData.GetCenter(from)) * 0.5f * (currentCost + fromCost);
+            if (distance < m_distances[from]) {
+                m_distances[from] = distance;
+                m_next[from] = current.second;
+                open.push(Entry(distance, from));
+            }
+        }
+    }
+
+    // Steer for the middle of the portal into the next polygon
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        uint32_t next = m_next[i];
+        if (next == CLTNavMeshData::INVALID_INDEX) {
+            continue;
+        }
+
+        CLTVector left, right;
+        m_targets[i] = navData.GetPortal(i, next, &left, &right) ? (left + right) * 0.5f : navData.GetCenter(next);
+    }
+
+    return true;
+}
@@ -0,0 +1,50 @@
+#include "../../include/gameplay/CLTNavMeshNodePool.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+
+CLTNavMeshNodePool::CLTNavMeshNodePool(uint32_t initialCapacity, uint32_t maxNodes)
+    : m_used(0)
+    , m_maxNodes(maxNodes)
+{
+    uint32_t blockCount = (initialCapacity + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    for (uint32_t i = 0; i < blockCount; ++i) {
+        m_blocks.push_back(new NavMeshPathNode[BLOCK_SIZE]);
+    }
+}
+
+CLTNavMeshNodePool::~CLTNavMeshNodePool()
+{
+    for (NavMeshPathNode* block : m_blocks) {
+        delete[] block;
+    }
+    m_blocks.clear();
+}
+
+void CLTNavMeshNodePool::Reset()
+{
+    m_used = 0;
+}
+
+NavMeshPathNode* CLTNavMeshNodePool::Allocate()
+{
+    if (m_used >= m_maxNodes) {
+        return nullptr;  // Node limit reached
+    }
+
+    // Grow by one block when the bump pointer reaches the end
+    uint32_t blockIndex = m_used / BLOCK_SIZE;
+    if (blockIndex >= m_blocks.size()) {
+        m_blocks.push_back(new NavMeshPathNode[BLOCK_SIZE]);
+    }
+
+    NavMeshPathNode* node = &m_blocks[blockIndex][m_used % BLOCK_SIZE];
+    ++m_used;
+
+    node->parent = nullptr;
+    node->heapIndex = CLTNavMeshNodeQueue::INVALID_INDEX;
+    return node;
+}
+
+NavMeshPathNode* CLTNavMeshNodePool::GetAllocated(uint32_t index) const
+{
+    return &m_blocks[index / BLOCK_SIZE][index % BLOCK_SIZE];
+}
@@ -0,0 +1,107 @@
+#include "../../include/gameplay/CLTNavMeshNodeQueue.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+
+CLTNavMeshNodeQueue::CLTNavMeshNodeQueue()
+{
+    m_heap.reserve(256);
+}
+
+void CLTNavMeshNodeQueue::Clear()
+{
+    for (NavMeshPathNode* node : m_heap) {
+        node->heapIndex = INVALID_INDEX;
+    }
+    m_heap.clear();
+}
+
+void CLTNavMeshNodeQueue::Push(NavMeshPathNode* pNode)
+{
+    pNode->heapIndex = static_cast<uint32_t>(m_heap.size());
+    m_heap.push_back(pNode);
+    SiftUp(pNode->heapIndex);
+}
+
+NavMeshPathNode* CLTNavMeshNodeQueue::Pop()
+{
+    if (m_heap.empty()) {
+        return nullptr;
+    }
+
+    NavMeshPathNode* top = m_heap[0];
+    NavMeshPathNode* last = m_heap.back();
+    m_heap.pop_back();
+
+    // Move the last node into the root slot and let it sink
+    if (!m_heap.empty()) {
+        m_heap[0] = last;
+        last->heapIndex = 0;
+        SiftDown(0);
+    }
+
+    top->heapIndex = INVALID_INDEX;
+    return top;
+}
+
+void CLTNavMeshNodeQueue::Update(NavMeshPathNode* pNode)
+{
+    if (pNode->heapIndex >= m_heap.size()) {
+        return;
+    }
+
+    // A node that did not rise may have to sink
+    uint32_t index = pNode->heapIndex;
+    SiftUp(index);
+    if (pNode->heapIndex == index) {
+        SiftDown(index);
+    }
+}
+
+bool CLTNavMeshNodeQueue::IsOrdered() const
+{
+    for (uint32_t i = 1; i < m_heap.size(); ++i) {
+        if (m_heap[(i - 1) / 2]->totalCost > m_heap[i]->totalCost || m_heap[i]->heapIndex != i) {
+            return false;
+        }
+    }
+    return m_heap.empty() || m_heap[0]->heapIndex == 0;
+}
+
+void CLTNavMeshNodeQueue::SiftUp(uint32_t index)
+{
+    NavMeshPathNode* node = m_heap[index];
+    while (index > 0) {
+        uint32_t parent = (index - 1) / 2;
+        if (m_heap[parent]->totalCost <= node->totalCost) {
+            break;
+        }
+        m_heap[index] = m_heap[parent];
+        m_heap[index]->heapIndex = index;
+        index = parent;
+    }
+    m_heap[index] = node;
+    node->heapIndex = index;
+}
+
+void CLTNavMeshNodeQueue::SiftDown(uint32_t index)
+{
+    const uint32_t count = static_cast<uint32_t>(m_heap.size());
+    NavMeshPathNode* node = m_heap[index];
+    for (;;) {
+        uint32_t child = index * 2 + 1;
+        if (child >= count) {
+            break;
+        }
+        // Pick the cheaper of the two children
+        if (child + 1 < count && m_heap[child + 1]->totalCost < m_heap[child]->totalCost) {
+            ++child;
+        }
+        if (node->totalCost <= m_heap[child]->totalCost) {
+            break;
+        }
+        m_heap[index] = m_heap[child];
+        m_heap[index]->heapIndex = index;
+        index = child;
+    }
+    m_heap[index] = node;
+    node->heapIndex = index;
+}
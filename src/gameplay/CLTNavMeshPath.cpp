@@ -0,0 +1,28 @@
+#include "../../include/gameplay/CLTNavMeshPath.h"
+#include "../../include/gameplay/CLTNavMeshQuery.h"
+
+CLTNavMeshPath::CLTNavMeshPath()
+    : m_start(0.0f, 0.0f, 0.0f)
+    , m_end(0.0f, 0.0f, 0.0f)
+    , m_complete(false)
+    , m_pQuery(nullptr)
+{
+}
+
+CLTNavMeshPath::~CLTNavMeshPath()
+{
+    Clear();
+}
+
+void CLTNavMeshPath::Clear()
+{
+    m_waypoints.clear();
+    m_polygons.clear();
+    m_corridor.clear();
+    m_complete = false;
+
+    if (m_pQuery) {
+        delete m_pQuery;
+        m_pQuery = nullptr;
+    }
+}
@@ -0,0 +1,222 @@
+#include "../../include/gameplay/CLTNavMeshPathCache.h"
+#include "../../include/gameplay/CLTNavMeshData.h"
+#include <algorithm>
+#include <cmath>
+
+CLTNavMeshPathCache::CLTNavMeshPathCache(uint32_t capacity)
+    : m_head(INVALID_ENTRY)
+    , m_tail(INVALID_ENTRY)
+    , m_capacity(capacity)
+    , m_tileSize(64.0f)
+    , m_originX(0.0f)
+    , m_originZ(0.0f)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+void CLTNavMeshPathCache::SetCapacity(uint32_t capacity)
+{
+    m_capacity = capacity;
+    while (m_lookup.size() > m_capacity) {
+        Erase(m_tail);
+    }
+}
+
+void CLTNavMeshPathCache::SetTileGrid(float tileSize, float originX, float originZ)
+{
+    Clear();
+    if (tileSize > 0.0f) {
+        m_tileSize = tileSize;
+        m_originX = originX;
+        m_originZ = originZ;
+    }
+}
+
+const std::vector<uint32_t>* CLTNavMeshPathCache::Find(const NavMeshPathCacheKey& key)
+{
+    auto it = m_lookup.find(key);
+    if (it == m_lookup.end()) {
+        m_misses++;
+        return nullptr;
+    }
+
+    m_hits++;
+    Unlink(it->second);
+    PushFront(it->second);
+    return &m_entries[it->second].corridor;
+}
+
+void CLTNavMeshPathCache::Insert(const NavMeshPathCacheKey& key, const std::vector<uint32_t>& corridor,
+                                 const CLTNavMeshData& navData)
+{
+    if (m_capacity == 0 || corridor.empty()) {
+        return;
+    }
+
+    Remove(key);
+    if (m_lookup.size() >= m_capacity) {
+        Erase(m_tail);
+    }
+
+    uint32_t index;
+    if (!m_freeEntries.empty()) {
+        index = m_freeEntries.back();
+        m_freeEntries.pop_back();
+    } else {
+        index = static_cast<uint32_t>(m_entries.size());
+        m_entries.push_back(Entry());
+    }
+
+    Entry& entry = m_entries[index];
+    entry.key = key;
+    entry.corridor = corridor;
+    entry.tiles.clear();
+
+    // Every tile a corridor polygon overlaps, so edits anywhere under the
+    // corridor invalidate it
+    for (uint32_t polyId : corridor) {
+        uint32_t polyIndex = navData.GetIndex(polyId);
+        if (polyIndex == CLTNavMeshData::INVALID_INDEX) {
+            continue;
+        }
+
+        const float* bounds = navData.GetBounds(polyIndex);
+        int32_t minX = CLTNavMeshData::GridCoord(bounds[0], m_originX, m_tileSize);
+        int32_t minZ = CLTNavMeshData::GridCoord(bounds[1], m_originZ, m_tileSize);
+        int32_t maxX = CLTNavMeshData::GridCoord(bounds[2], m_originX, m_tileSize);
+        int32_t maxZ = CLTNavMeshData::GridCoord(bounds[3], m_originZ, m_tileSize);
+        for (int32_t z = minZ; z <= maxZ; ++z) {
+            for (int32_t x = minX; x <= maxX; ++x) {
+                entry.tiles.push_back(TileKey(x, z));
+            }
+        }
+    }
+    std::sort(entry.tiles.begin(), entry.tiles.end());
+    entry.tiles.erase(std::unique(entry.tiles.begin(), entry.tiles.end()), entry.tiles.end());
+
+    for (uint64_t tile : entry.tiles) {
+        m_tileEntries[tile].push_back(index);
+    }
+    m_lookup[key] = index;
+    PushFront(index);
+}
+
+void CLTNavMeshPathCache::Remove(const NavMeshPathCacheKey& key)
+{
+    auto it = m_lookup.find(key);
+    if (it != m_lookup.end()) {
+        Erase(it->second);
+    }
+}
+
+void CLTNavMeshPathCache::InvalidateTile(int32_t tileX, int32_t tileZ)
+{
+    auto it = m_tileEntries.find(TileKey(tileX, tileZ));
+    if (it == m_tileEntries.end()) {
+        return;
+    }
+
+    // Erase() edits the tile lists, so work from a copy
+    std::vector<uint32_t> entries;
+    entries.swap(it->second);
+    for (uint32_t index : entries) {
+        Erase(index);
+    }
+}
+
+void CLTNavMeshPathCache::InvalidateRegion(float minX, float minZ, float maxX, float maxZ)
+{
+    int32_t tileMinX = CLTNavMeshData::GridCoord(minX, m_originX, m_tileSize);
+    int32_t tileMinZ = CLTNavMeshData::GridCoord(minZ, m_originZ, m_tileSize);
+    int32_t tileMaxX = CLTNavMeshData::GridCoord(maxX, m_originX, m_tileSize);
+    int32_t tileMaxZ = CLTNavMeshData::GridCoord(maxZ, m_originZ, m_tileSize);
+
+    // Only tiles that have entries matter, so huge regions stay cheap
+    const uint64_t tileCount = static_cast<uint64_t>(static_cast<int64_t>(tileMaxX) - tileMinX + 1) *
+                               static_cast<uint64_t>(static_cast<int64_t>(tileMaxZ) - tileMinZ + 1);
+    if (tileCount > m_tileEntries.size()) {
+        std::vector<uint64_t> tiles;
+        for (const auto& pair : m_tileEntries) {
+            int32_t x = static_cast<int32_t>(static_cast<uint32_t>(pair.first));
+            int32_t z = static_cast<int32_t>(static_cast<uint32_t>(pair.first >> 32));
+            if (x >= tileMinX && x <= tileMaxX && z >= tileMinZ && z <= tileMaxZ) {
+                tiles.push_back(pair.first);
+            }
+        }
+        for (uint64_t tile : tiles) {
+            InvalidateTile(static_cast<int32_t>(static_cast<uint32_t>(tile)),
+                           static_cast<int32_t>(static_cast<uint32_t>(tile >> 32)));
+        }
+        return;
+    }
+
+    for (int32_t z = tileMinZ; z <= tileMaxZ; ++z) {
+        for (int32_t x = tileMinX; x <= tileMaxX; ++x) {
+            InvalidateTile(x, z);
+        }
+    }
+}
+
+void CLTNavMeshPathCache::Clear()
+{
+    m_entries.clear();
+    m_freeEntries.clear();
+    m_lookup.clear();
+    m_tileEntries.clear();
+    m_head = INVALID_ENTRY;
+    m_tail = INVALID_ENTRY;
+}
+
+void CLTNavMeshPathCache::Unlink(uint32_t index)
+{
+    Entry& entry = m_entries[index];
+    if (entry.prev != INVALID_ENTRY) {
+        m_entries[entry.prev].next = entry.next;
+    } else {
+        m_head = entry.next;
+    }
+
+    if (entry.next != INVALID_ENTRY) {
+        m_entries[entry.next].prev = entry.prev;
+    } else {
+        m_tail = entry.prev;
+    }
+}
+
+void CLTNavMeshPathCache::PushFront(uint32_t index)
+{
+    Entry& entry = m_entries[index];
+    entry.prev = INVALID_ENTRY;
+    entry.next = m_head;
+    if (m_head != INVALID_ENTRY) {
+        m_entries[m_head].prev = index;
+    } else {
+        m_tail = index;
+    }
+    m_head = index;
+}
+
+void CLTNavMeshPathCache::Erase(uint32_t index)
+{
+    Entry& entry = m_entries[index];
+    Unlink(index);
+    m_lookup.erase(entry.key);
+
+    for (uint64_t tile : entry.tiles) {
+        auto it = m_tileEntries.find(tile);
+        if (it == m_tileEntries.end()) {
+            continue;
+        }
+
+        std::vector<uint32_t>& entries = it->second;
+        entries.erase(std::remove(entries.begin(), entries.end(), index), entries.end());
+        if (entries.empty()) {
+            m_tileEntries.erase(it);
+        }
+    }
+
+    entry.corridor.clear();
+    entry.tiles.clear();
+    m_freeEntries.push_back(index);
+}
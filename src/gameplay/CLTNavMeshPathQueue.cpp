@@ -0,0 +1,213 @@
+#include "../../include/gameplay/CLTNavMeshPathQueue.h"
+#include <algorithm>
+
+const uint32_t CLTNavMeshPathQueue::SLICE_ITERATIONS;
+
+CLTNavMeshPathQueue::CLTNavMeshPathQueue()
+    : m_nextTicket(1)
+    , m_stop(false)
+{
+}
+
+CLTNavMeshPathQueue::~CLTNavMeshPathQueue()
+{
+    Stop();
+}
+
+void CLTNavMeshPathQueue::Start(uint32_t workerCount)
+{
+    StopWorkers();
+
+    m_stop = false;
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        m_workers.push_back(std::thread(&CLTNavMeshPathQueue::WorkerMain, this));
+    }
+}
+
+void CLTNavMeshPathQueue::Stop()
+{
+    StopWorkers();
+
+    for (auto& pair : m_requests) {
+        delete pair.second->pQuery;
+        delete pair.second;
+    }
+    m_requests.clear();
+    for (std::deque<Request*>& queue : m_pending) {
+        queue.clear();
+    }
+}
+
+void CLTNavMeshPathQueue::StopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+uint32_t CLTNavMeshPathQueue::Submit(CLTNavMeshQuery* pQuery, PathPriority priority, uint32_t maxIterations)
+{
+    Request* pRequest = new Request();
+    pRequest->priority = priority;
+    pRequest->pQuery = pQuery;
+    pRequest->iterationsLeft = maxIterations;
+    pRequest->result = CLTNavMeshSystem::PATHFIND_PENDING;
+    pRequest->running = false;
+    pRequest->cancelled = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Ticket 0 is never handed out
+        if (m_nextTicket == 0) {
+            m_nextTicket = 1;
+        }
+        pRequest->ticket = m_nextTicket++;
+        m_requests[pRequest->ticket] = pRequest;
+        m_pending[priority].push_back(pRequest);
+    }
+    m_wake.notify_one();
+
+    return pRequest->ticket;
+}
+
+uint32_t CLTNavMeshPathQueue::SubmitResult(PathFindResult result)
+{
+    Request* pRequest = new Request();
+    pRequest->priority = CLTNavMeshSystem::PATH_PRIORITY_NORMAL;
+    pRequest->pQuery = nullptr;
+    pRequest->iterationsLeft = 0;
+    pRequest->result = result;
+    pRequest->running = false;
+    pRequest->cancelled = false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_nextTicket == 0) {
+        m_nextTicket = 1;
+    }
+    pRequest->ticket = m_nextTicket++;
+    m_requests[pRequest->ticket] = pRequest;
+    return pRequest->ticket;
+}
+
+CLTNavMeshPathQueue::PathFindResult CLTNavMeshPathQueue::Fetch(uint32_t ticket, CLTNavMeshQuery** ppQuery)
+{
+    if (ppQuery) {
+        *ppQuery = nullptr;
+    }
+
+    Request* pRequest;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_requests.find(ticket);
+        if (it == m_requests.end()) {
+            return CLTNavMeshSystem::PATHFIND_ERROR;
+        }
+
+        pRequest = it->second;
+        if (pRequest->result == CLTNavMeshSystem::PATHFIND_PENDING) {
+            return CLTNavMeshSystem::PATHFIND_PENDING;
+        }
+        m_requests.erase(it);
+    }
+
+    // Finished requests are no longer touched by the workers
+    PathFindResult result = pRequest->result;
+    if (ppQuery) {
+        *ppQuery = pRequest->pQuery;
+    } else {
+        delete pRequest->pQuery;
+    }
+    delete pRequest;
+    return result;
+}
+
+bool CLTNavMeshPathQueue::Cancel(uint32_t ticket)
+{
+    Request* pRequest;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_requests.find(ticket);
+        if (it == m_requests.end()) {
+            return false;
+        }
+
+        pRequest = it->second;
+        m_requests.erase(it);
+
+        // A worker running the request deletes it when its slice ends
+        if (pRequest->running) {
+            pRequest->cancelled = true;
+            return true;
+        }
+
+        std::deque<Request*>& queue = m_pending[pRequest->priority];
+        auto queued = std::find(queue.begin(), queue.end(), pRequest);
+        if (queued != queue.end()) {
+            queue.erase(queued);
+        }
+    }
+
+    delete pRequest->pQuery;
+    delete pRequest;
+    return true;
+}
+
+void CLTNavMeshPathQueue::WorkerMain()
+{
+    // Scratch state for every query this worker runs
+    CLTNavMeshSearchContext context;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        // Highest priority class first, oldest request first within a class
+        Request* pRequest = nullptr;
+        for (std::deque<Request*>& queue : m_pending) {
+            if (!queue.empty()) {
+                pRequest = queue.front();
+                queue.pop_front();
+                break;
+            }
+        }
+
+        if (!pRequest) {
+            if (m_stop) {
+                return;
+            }
+            m_wake.wait(lock);
+            continue;
+        }
+        if (m_stop) {
+            // Keep the request for a later Start()
+            m_pending[pRequest->priority].push_front(pRequest);
+            return;
+        }
+
+        pRequest->running = true;
+        uint32_t slice = std::min(pRequest->iterationsLeft, SLICE_ITERATIONS);
+        lock.unlock();
+
+        PathFindResult result = pRequest->pQuery->Update(&context, slice);
+
+        lock.lock();
+        pRequest->running = false;
+        pRequest->iterationsLeft -= slice;
+
+        if (pRequest->cancelled) {
+            delete pRequest->pQuery;
+            delete pRequest;
+        } else if (result == CLTNavMeshSystem::PATHFIND_PARTIAL && pRequest->iterationsLeft > 0) {
+            // Not done; go to the back of its class so equal-priority requests share workers
+            m_pending[pRequest->priority].push_back(pRequest);
+        } else {
+            pRequest->result = result;
+        }
+    }
+}
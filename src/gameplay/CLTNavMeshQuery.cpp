@@ -0,0 +1,356 @@
+#include "../../include/gameplay/CLTNavMeshQuery.h"
+#include "../../include/gameplay/CLTNavMeshPath.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+
+// Serials identify queries to search contexts; 0 means "no owner"
+static std::atomic<uint64_t> s_nextQuerySerial(1);
+
+// Node expansions between clock reads when a timeout is set
+static const uint32_t TIMEOUT_CHECK_INTERVAL = 64;
+
+// Share of the landmark bound that is a lower bound on the search's step costs
+static const float LANDMARK_BOUND_SCALE = 1.0f / 3.0f;
+
+CLTNavMeshSearchContext::CLTNavMeshSearchContext()
+    : m_generation(0)
+    , m_owner(0)
+    , m_pSpareQuery(nullptr)
+{
+}
+
+CLTNavMeshSearchContext::~CLTNavMeshSearchContext()
+{
+    delete m_pSpareQuery;
+}
+
+CLTNavMeshQuery* CLTNavMeshSearchContext::AcquireQuery()
+{
+    CLTNavMeshQuery* pQuery = m_pSpareQuery;
+    m_pSpareQuery = nullptr;
+    return pQuery ? pQuery : new CLTNavMeshQuery();
+}
+
+void CLTNavMeshSearchContext::ReleaseQuery(CLTNavMeshQuery* pQuery)
+{
+    if (m_pSpareQuery) {
+        delete pQuery;
+        return;
+    }
+
+    // A parked query must not keep an old navmesh snapshot alive
+    pQuery->Release();
+    m_pSpareQuery = pQuery;
+}
+
+void CLTNavMeshSearchContext::Begin(uint64_t owner, uint32_t polyCount)
+{
+    m_owner = owner;
+
+    // Make sure every polygon has a state entry
+    if (m_polyState.size() < polyCount) {
+        NavMeshPolyState empty = { 0, 0, nullptr };
+        m_polyState.resize(polyCount, empty);
+    }
+
+    // Bump the generation; on wrap-around, old stamps could alias so clear them
+    if (++m_generation == 0) {
+        for (NavMeshPolyState& state : m_polyState) {
+            state.generation = 0;
+        }
+        m_generation = 1;
+    }
+}
+
+NavMeshPolyState& CLTNavMeshSearchContext::GetPolyState(uint32_t polyIndex)
+{
+    // Entries from an older generation read as untouched
+    NavMeshPolyState& state = m_polyState[polyIndex];
+    if (state.generation != m_generation) {
+        state.generation = m_generation;
+        state.flags = 0;
+        state.pNode = nullptr;
+    }
+
+    return state;
+}
+
+CLTNavMeshQuery::CLTNavMeshQuery()
+    : m_endIndex(CLTNavMeshData::INVALID_INDEX)
+    , m_pEndLandmarks(nullptr)
+    , m_pGoalNode(nullptr)
+    , m_pBestNode(nullptr)
+    , m_status(CLTNavMeshSystem::PATHFIND_ERROR)
+    , m_searchTime(0.0)
+    , m_serial(s_nextQuerySerial++)
+{
+}
+
+CLTNavMeshQuery::PathFindResult CLTNavMeshQuery::Init(
+    const std::shared_ptr<const CLTNavMeshData>& pNavData,
+    const std::shared_ptr<const std::vector<float> >& pAreaCosts,
+    const std::shared_ptr<const std::vector<uint8_t> >& pBlocked,
+    const CLTVector& start, const CLTVector& end,
+    uint32_t startIndex, uint32_t endIndex,
+    const CLTNavMeshSystem::PathFindOptions& options)
+{
+    m_pNavData = pNavData;
+    m_pAreaCosts = pAreaCosts;
+    m_pBlocked = pBlocked;
+    m_options = options;
+    m_start = start;
+    m_end = end;
+    m_endIndex = endIndex;
+    m_pEndLandmarks = m_pNavData->GetLandmarkCount() > 0 ? m_pNavData->GetLandmarkDistances(endIndex) : nullptr;
+    m_pGoalNode = nullptr;
+    m_pBestNode = nullptr;
+    m_searchTime = 0.0;
+
+    // A reused query must not match the context stamps of its last search
+    m_serial = s_nextQuerySerial++;
+
+    m_openList.Clear();
+    m_nodePool.Reset();
+    m_nodePool.SetMaxNodes(options.maxNodes);
+
+    // Agents cannot start or end in areas they may not use; a blocked start
+    // is allowed so agents can walk out of an obstacle that appears on them
+    if (!PassesFilter(startIndex)) {
+        m_status = CLTNavMeshSystem::PATHFIND_INVALID_START;
+        return m_status;
+    }
+    if (!PassesFilter(endIndex) || IsBlocked(endIndex)) {
+        m_status = CLTNavMeshSystem::PATHFIND_INVALID_END;
+        return m_status;
+    }
+
+    // Initialize starting node
+    NavMeshPathNode* startNode = m_nodePool.Allocate();
+    if (!startNode) {
+        m_status = CLTNavMeshSystem::PATHFIND_OUT_OF_NODES;
+        return m_status;
+    }
+
+    startNode->position = start;
+    startNode->polyId = m_pNavData->GetId(startIndex);
+    startNode->polyIndex = startIndex;
+    startNode->cost = 0.0f;
+    startNode->heuristic = Heuristic(start, startIndex);
+    startNode->totalCost = startNode->heuristic;
+    startNode->parent = nullptr;
+
+    m_openList.Push(startNode);
+    m_pBestNode = startNode;
+    m_status = CLTNavMeshSystem::PATHFIND_PARTIAL;
+    return m_status;
+}
+
+void CLTNavMeshQuery::Release()
+{
+    m_pNavData.reset();
+    m_pAreaCosts.reset();
+    m_pBlocked.reset();
+    m_pEndLandmarks = nullptr;
+    m_pGoalNode = nullptr;
+    m_pBestNode = nullptr;
+    m_status = CLTNavMeshSystem::PATHFIND_ERROR;
+
+    m_openList.Clear();
+    m_nodePool.Reset();
+}
+
+float CLTNavMeshQuery::Heuristic(const CLTVector& position, uint32_t polyIndex) const
+{
+    float heuristic = position.Distance(m_end);
+    if (m_pEndLandmarks) {
+        // Landmark distances run center to center, but each step only goes
+        // half way from the node to the next center. Between consecutive
+        // centers c1, c2 that gives |c1 - c2| <= step1 + 2 * step2, so the
+        // steps left cover at least a third of the center distance, less
+        // the node's own offset from its center.
+        float bound = m_pNavData->GetLandmarkBound(m_pNavData->GetLandmarkDistances(polyIndex), m_pEndLandmarks);
+        float offset = position.Distance(m_pNavData->GetCenter(polyIndex));
+        heuristic = std::max(heuristic, (bound - offset) * LANDMARK_BOUND_SCALE);
+    }
+
+    return heuristic;
+}
+
+void CLTNavMeshQuery::Restamp(CLTNavMeshSearchContext* pContext)
+{
+    pContext->Begin(m_serial, m_pNavData->GetPolyCount());
+
+    // Queued nodes are open; every other node has been expanded
+    const uint32_t nodeCount = m_nodePool.GetUsedCount();
+    for (uint32_t i = 0; i < nodeCount; ++i) {
+        NavMeshPathNode* node = m_nodePool.GetAllocated(i);
+        NavMeshPolyState& state = pContext->GetPolyState(node->polyIndex);
+        state.pNode = node;
+        state.flags = node->heapIndex != CLTNavMeshNodeQueue::INVALID_INDEX ?
+            NavMeshPolyState::NODE_OPEN : NavMeshPolyState::NODE_CLOSED;
+    }
+}
+
+CLTNavMeshQuery::PathFindResult CLTNavMeshQuery::Update(CLTNavMeshSearchContext* pContext, uint32_t maxIterations)
+{
+    if (m_status != CLTNavMeshSystem::PATHFIND_PARTIAL) {
+        return m_status;
+    }
+
+    // Another query used the table since our last slice
+    if (pContext->m_owner != m_serial || pContext->m_polyState.size() < m_pNavData->GetPolyCount()) {
+        Restamp(pContext);
+    }
+
+    const CLTNavMeshData& navData = *m_pNavData;
+    const float maxDistance = m_options.maxDistance > 0.0f ? m_options.maxDistance : FLT_MAX;
+
+    // The time limit covers every slice, so this slice gets what is left
+    typedef std::chrono::steady_clock Clock;
+    const bool timed = m_options.timeout > 0.0f;
+    const Clock::time_point sliceStart = timed ? Clock::now() : Clock::time_point();
+    const double timeLeft = m_options.timeout - m_searchTime;
+
+    // A* main loop
+    uint32_t iterations = 0;
+    while (!m_openList.Empty() && iterations < maxIterations) {
+        if (timed && iterations % TIMEOUT_CHECK_INTERVAL == 0) {
+            double elapsed = std::chrono::duration<double>(Clock::now() - sliceStart).count();
+            if (elapsed >= timeLeft) {
+                m_searchTime += elapsed;
+                m_status = CLTNavMeshSystem::PATHFIND_TIMEOUT;
+                return m_status;
+            }
+        }
+
+        // Take the node with the lowest total cost off the heap
+        NavMeshPathNode* current = m_openList.Pop();
+
+        // Mark as closed
+        pContext->GetPolyState(current->polyIndex).flags = NavMeshPolyState::NODE_CLOSED;
+        if (current->heuristic < m_pBestNode->heuristic) {
+            m_pBestNode = current;
+        }
+
+        // Check if we've reached the destination
+        if (current->polyIndex == m_endIndex) {
+            m_pGoalNode = current;
+            m_status = CLTNavMeshSystem::PATHFIND_SUCCESS;
+            return m_status;
+        }
+
+        // Get the neighbors of the current polygon straight from the flat arrays
+        uint32_t neighborCount;
+        const uint32_t* neighbors = navData.GetNeighbors(current->polyIndex, &neighborCount);
+        const float currentCost = GetAreaCost(current->polyIndex);
+
+        // Process neighbors
+        for (uint32_t n = 0; n < neighborCount; ++n) {
+            uint32_t neighborIndex = neighbors[n];
+
+            // Skip polygons the agent may not enter before touching any search state
+            if (!PassesFilter(neighborIndex) || IsBlocked(neighborIndex)) {
+                continue;
+            }
+
+            // Skip if we've already processed this polygon
+            NavMeshPolyState& neighborState = pContext->GetPolyState(neighborIndex);
+            if (neighborState.flags & NavMeshPolyState::NODE_CLOSED) {
+                continue;
+            }
+
+            // Calculate the new position and cost; the step runs through both polygons
+            CLTVector newPos = (current->position + navData.GetCenter(neighborIndex)) * 0.5f;
+            float stepCost = 0.5f * (currentCost + GetAreaCost(neighborIndex));
+            float newCost = current->cost + current->position.Distance(newPos) * stepCost;
+
+            // Check if we already have this neighbor in the open list
+            NavMeshPathNode* existingNode =
+                (neighborState.flags & NavMeshPolyState::NODE_OPEN) ? neighborState.pNode : nullptr;
+
+            // If the neighbor is already in the open list with a lower cost, skip it
+            if (existingNode && existingNode->cost <= newCost) {
+                continue;
+            }
+
+            // No path through this node can stay within the distance limit. Only
+            // the straight-line distance is a bound every path respects.
+            if (newCost + newPos.Distance(m_end) > maxDistance) {
+                continue;
+            }
+            float heuristic = Heuristic(newPos, neighborIndex);
+
+            // Create or update the neighbor node
+            NavMeshPathNode* neighborNode;
+            if (existingNode) {
+                neighborNode = existingNode;
+            } else {
+                neighborNode = m_nodePool.Allocate();
+                if (!neighborNode) {
+                    m_status = CLTNavMeshSystem::PATHFIND_OUT_OF_NODES;
+                    return m_status;
+                }
+                neighborState.pNode = neighborNode;
+                neighborState.flags = NavMeshPolyState::NODE_OPEN;
+            }
+
+            // Update node data
+            neighborNode->position = newPos;
+            neighborNode->polyId = navData.GetId(neighborIndex);
+            neighborNode->polyIndex = neighborIndex;
+            neighborNode->cost = newCost;
+            neighborNode->heuristic = heuristic;
+            neighborNode->totalCost = neighborNode->cost + neighborNode->heuristic;
+            neighborNode->parent = current;
+
+            // Queue new nodes, or move an improved node to its new place in the heap
+            if (existingNode) {
+                m_openList.Update(neighborNode);
+#ifdef NAVMESH_DEBUG_HEAP
+                assert(m_openList.IsOrdered());
+#endif
+            } else {
+                m_openList.Push(neighborNode);
+            }
+        }
+
+        iterations++;
+    }
+
+    if (timed) {
+        m_searchTime += std::chrono::duration<double>(Clock::now() - sliceStart).count();
+    }
+
+    if (m_openList.Empty()) {
+        m_status = CLTNavMeshSystem::PATHFIND_NO_PATH;
+    }
+
+    return m_status;
+}
+
+void CLTNavMeshQuery::GetPath(CLTNavMeshPath* pPath) const
+{
+    pPath->m_waypoints.clear();
+    pPath->m_polygons.clear();
+    pPath->m_corridor.clear();
+    pPath->m_start = m_start;
+    pPath->m_end = m_end;
+    pPath->m_complete = (m_pGoalNode != nullptr);
+
+    // Follow the parent links back to the start, then reverse
+    for (const NavMeshPathNode* node = m_pGoalNode ? m_pGoalNode : m_pBestNode; node; node = node->parent) {
+        pPath->m_waypoints.push_back(node->position);
+        pPath->m_polygons.push_back(node->polyId);
+    }
+    std::reverse(pPath->m_waypoints.begin(), pPath->m_waypoints.end());
+    std::reverse(pPath->m_polygons.begin(), pPath->m_polygons.end());
+    pPath->m_corridor = pPath->m_polygons;
+
+    // A complete path ends exactly at the requested position
+    if (m_pGoalNode) {
+        pPath->m_waypoints.push_back(m_end);
+        pPath->m_polygons.push_back(m_pGoalNode->polyId);
+    }
+}
@@ -1,18 +1,119 @@
 #include "../../include/gameplay/CLTNavMeshSystem.h"
+#include "../../include/gameplay/CLTNavMeshClusterGraph.h"
+#include "../../include/gameplay/CLTNavMeshFlowField.h"
+#include "../../include/gameplay/CLTNavMeshPath.h"
+#include "../../include/gameplay/CLTNavMeshPathCache.h"
+#include "../../include/gameplay/CLTNavMeshPathQueue.h"
+#include "../../include/gameplay/CLTNavMeshQuery.h"
+#include "../../include/gameplay/CLTNavMeshTileCache.h"
+#include "../../include/gameplay/CLTNavMeshTrigger.h"
 #include <algorithm>
+#include <atomic>
+#include <cfloat>
 #include <cmath>
 #include <cstring>
+#include <iterator>
 #include <queue>
 #include <set>
+#include <thread>
 
-// Forward declaration for a required class
-class CLTNavMeshController {};
-class CLTNavMeshPath {};
-class CLTNavMeshTrigger {};
+// Console variable lookup, provided by the engine
+float GetParameter(const char* pName, float defaultValue);
+
+// Per-world navigation data
+class CLTNavMeshController {
+public:
+    CLTNavMeshController() : pNavData(std::make_shared<CLTNavMeshData>()) {}
+
+    std::shared_ptr<CLTNavMeshData> pNavData;       ///< Compiled polygons for the world
+    std::shared_ptr<CLTNavMeshClusterGraph> pClusters; ///< Cluster graph of pNavData, for hierarchical searches
+    std::unique_ptr<CLTNavMeshTileCache> pTileCache; ///< Tile streaming for tiled worlds, else null
+    std::vector<std::pair<int32_t, int32_t> > residentTiles; ///< Tiles in pNavData, sorted
+    std::set<uint32_t> blockedPolys;                ///< IDs of polygons blocked by obstacles
+};
+
+// Number of recent flow fields kept for reuse
+static const size_t MAX_FLOW_FIELDS = 8;
+
+// Distance at which an agent following a flow field has reached a portal
+static const float FLOW_ARRIVE_DISTANCE = 0.1f;
+
+// Node limit of the local search around an obstacle in RepairPath()
+static const uint32_t REPAIR_MAX_NODES = 256;
+
+// Edge length of a trigger broadphase cell
+static const float TRIGGER_CELL_SIZE = 16.0f;
+
+// Triggers covering more cells than this are tested against every moving actor
+static const int64_t MAX_TRIGGER_CELLS = 256;
+
+// Exact position, for looking up repeated batch and ray positions once
+struct PositionKey {
+    float x, y, z;
+
+    bool operator<(const PositionKey& other) const {
+        if (x != other.x) return x < other.x;
+        if (y != other.y) return y < other.y;
+        return z < other.z;
+    }
+};
+
+// Trigger broadphase cell of a coordinate, clamped so far-away points stay defined
+static int32_t TriggerCell(float value)
+{
+    const float LIMIT = 1.0e9f;
+    float cell = std::floor(value / TRIGGER_CELL_SIZE);
+    return static_cast<int32_t>(std::max(-LIMIT, std::min(LIMIT, cell)));
+}
+
+static uint64_t TriggerCellKey(int32_t x, int32_t z)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(z)) << 32) | static_cast<uint32_t>(x);
+}
+
+// Samples GetRandomPosition() draws before giving up
+static const int MAX_RANDOM_ATTEMPTS = 32;
+
+// Per-thread state of the GetRandomPosition() generator, seeded from the thread ID
+static uint64_t InitialRandomState()
+{
+    return static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) ^ 0x853C49E6748FEA9BULL;
+}
+
+static thread_local uint64_t s_randomState = InitialRandomState();
+
+// SplitMix64: every state is valid, so any seed works
+static uint64_t NextRandom()
+{
+    uint64_t z = (s_randomState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, 1)
+static float RandomFloat()
+{
+    return static_cast<float>(NextRandom() >> 40) * (1.0f / 16777216.0f);
+}
+
+static double RandomDouble()
+{
+    return static_cast<double>(NextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
 
 CLTNavMeshSystem::CLTNavMeshSystem()
     : CLTBaseClass()
     , m_pActiveController(nullptr)
+    , m_pNavData(std::make_shared<CLTNavMeshData>())
+    , m_pSearchContext(new CLTNavMeshSearchContext())
+    , m_pPathQueue(new CLTNavMeshPathQueue())
+    , m_pPathCache(new CLTNavMeshPathCache())
+    , m_pathWorkerCount(2)
+    , m_nodeHighWater(0)
+    , m_batchThreadCount(0)
+    , m_locationHits(0)
+    , m_locationMisses(0)
     , m_nextTriggerId(1)
     , m_checkNavMeshBottom(-50.0f)
     , m_checkNavMeshTop(50.0f)
@@ -24,23 +125,22 @@ CLTNavMeshSystem::CLTNavMeshSystem()
     // Initialize default options
     m_defaultOptions.maxIterations = 2000;
     m_defaultOptions.maxNodes = 4096;
-    m_defaultOptions.maxDistance = 1000.0f;
+    m_defaultOptions.maxDistance = 0.0f;   // No limit; the search is bounded by maxNodes and timeout
     m_defaultOptions.straightPathTolerance = 0.1f;
     m_defaultOptions.optimizePath = true;
-    m_defaultOptions.areaFlags = AREA_WALKABLE;
+    m_defaultOptions.areaFlags = AREA_ALL;
     m_defaultOptions.excludedAreaFlags = AREA_NO_NAVIGATION;
     m_defaultOptions.timeout = 1.0f;
-
-    // Pre-allocate path nodes
-    for (int i = 0; i < 4096; ++i) {
-        NavMeshPathNode* node = new NavMeshPathNode();
-        node->parent = nullptr;
-        m_nodePool.push_back(node);
-    }
+    m_defaultOptions.hierarchical = false;
+    
+    std::fill(m_areaCosts, m_areaCosts + 8, 1.0f);
 }
 
 CLTNavMeshSystem::~CLTNavMeshSystem()
 {
+    // Workers must stop before the navmesh data they search goes away
+    delete m_pPathQueue;
+    
     // Clean up all controllers
     for (auto& pair : m_controllers) {
         if (pair.second) {
@@ -56,14 +156,16 @@ CLTNavMeshSystem::~CLTNavMeshSystem()
         }
     }
     m_triggers.clear();
+    m_triggerCells.clear();
+    m_largeTriggers.clear();
+    m_triggerActors.clear();
+    m_dirtyActors.clear();
     
-    // Clean up all path nodes
-    for (auto& node : m_nodePool) {
-        if (node) {
-            delete node;
-        }
+    delete m_pPathCache;
+    for (CLTNavMeshSearchContext* pContext : m_batchContexts) {
+        delete pContext;
     }
-    m_nodePool.clear();
+    delete m_pSearchContext;
 }
 
 bool CLTNavMeshSystem::Init(void* pInitParams)
@@ -79,6 +181,9 @@ bool CLTNavMeshSystem::Init(void* pInitParams)
 
 void CLTNavMeshSystem::Term()
 {
+    // Drop outstanding path requests
+    m_pPathQueue->Stop();
+    
     // Clean up all controllers
     for (auto& pair : m_controllers) {
         if (pair.second) {
@@ -86,7 +191,7 @@ void CLTNavMeshSystem::Term()
         }
     }
     m_controllers.clear();
-    m_pActiveController = nullptr;
+    SetActiveController(nullptr);
     
     // Clean up all triggers
     for (auto& pair : m_triggers) {
@@ -95,6 +200,10 @@ void CLTNavMeshSystem::Term()
         }
     }
     m_triggers.clear();
+    m_triggerCells.clear();
+    m_largeTriggers.clear();
+    m_triggerActors.clear();
+    m_dirtyActors.clear();
     
     // Call the base class implementation
     CLTBaseClass::Term();
@@ -107,30 +216,82 @@ const char* CLTNavMeshSystem::GetClassName() const
 
 bool CLTNavMeshSystem::LoadNavMesh(const char* pFilename, uint32_t worldId)
 {
-    // Check if this world already has a controller
+    // Create a new controller
+    CLTNavMeshController* pController = new CLTNavMeshController();
+    
+    if (CLTNavMeshTileCache::IsManifest(pFilename)) {
+        // Tiled world: starts empty, tiles stream in via UpdateStreaming()
+        pController->pTileCache.reset(new CLTNavMeshTileCache());
+        if (!pController->pTileCache->Open(pFilename)) {
+            delete pController;
+            return false;
+        }
+    } else if (!pController->pNavData->LoadFromFile(pFilename)) {
+        // Map the compiled navmesh file; the polygon arrays are used in place
+        delete pController;
+        return false;
+    }
+    
+    if (pController->pNavData->GetPolyCount() > 0) {
+        pController->pClusters = std::make_shared<CLTNavMeshClusterGraph>();
+        pController->pClusters->Build(pController->pNavData);
+    }
+    
+    AddController(worldId, pController);
+    return true;
+}
+
+bool CLTNavMeshSystem::SetNavMeshData(const std::vector<NavMeshPoly>& polygons, uint32_t worldId)
+{
+    // Compile into flat storage
+    CLTNavMeshController* pController = new CLTNavMeshController();
+    if (!pController->pNavData->Build(polygons)) {
+        delete pController;
+        return false;
+    }
+    
+    // Precompute the cluster graph for hierarchical searches
+    pController->pClusters = std::make_shared<CLTNavMeshClusterGraph>();
+    pController->pClusters->Build(pController->pNavData);
+    
+    AddController(worldId, pController);
+    return true;
+}
+
+void CLTNavMeshSystem::AddController(uint32_t worldId, CLTNavMeshController* pController)
+{
+    // Replace any existing controller for this world
+    bool wasActive = false;
     auto it = m_controllers.find(worldId);
     if (it != m_controllers.end()) {
-        // Unload the existing controller
+        wasActive = (m_pActiveController == it->second);
         delete it->second;
         m_controllers.erase(it);
     }
     
-    // Create a new controller
-    CLTNavMeshController* pController = new CLTNavMeshController();
-    
-    // TODO: Load navigation mesh data from file
-    // In the original implementation, this would parse the NavMesh file format
-    // and populate the polygon data.
-    
-    // For this reconstructed version, we'll just create a dummy controller
     m_controllers[worldId] = pController;
     
     // Set as active controller if we don't have one yet
-    if (!m_pActiveController) {
-        m_pActiveController = pController;
+    if (!m_pActiveController || wasActive) {
+        SetActiveController(pController);
     }
+}
+
+void CLTNavMeshSystem::SetActiveController(CLTNavMeshController* pController)
+{
+    m_pActiveController = pController;
+    m_pNavData = pController ? pController->pNavData : std::make_shared<CLTNavMeshData>();
+    m_pClusters = pController ? pController->pClusters : std::shared_ptr<CLTNavMeshClusterGraph>();
     
-    return true;
+    // Cached corridors belong to the previous navmesh; tiled worlds invalidate by streaming tile
+    if (pController && pController->pTileCache) {
+        CLTNavMeshTileCache* pTileCache = pController->pTileCache.get();
+        m_pPathCache->SetTileGrid(pTileCache->GetTileSize(), pTileCache->GetOriginX(), pTileCache->GetOriginZ());
+    } else {
+        m_pPathCache->SetTileGrid(64.0f, 0.0f, 0.0f);
+    }
+    m_flowFields.clear();
+    UpdateBlockedTable();
 }
 
 bool CLTNavMeshSystem::UnloadNavMesh(uint32_t worldId)
@@ -143,7 +304,7 @@ bool CLTNavMeshSystem::UnloadNavMesh(uint32_t worldId)
     
     // If this is the active controller, clear it
     if (m_pActiveController == it->second) {
-        m_pActiveController = nullptr;
+        SetActiveController(nullptr);
     }
     
     // Delete the controller and remove from map
@@ -153,15 +314,81 @@ bool CLTNavMeshSystem::UnloadNavMesh(uint32_t worldId)
     return true;
 }
 
+void CLTNavMeshSystem::UpdateStreaming(const CLTVector* pAgentPositions, uint32_t count, uint32_t worldId)
+{
+    auto it = m_controllers.find(worldId);
+    if (it == m_controllers.end() || !it->second->pTileCache) {
+        return;  // Not loaded, or not tiled
+    }
+    
+    CLTNavMeshController* pController = it->second;
+    pController->pTileCache->Update(pAgentPositions, count);
+    
+    // Swap in the worker's latest snapshot; the old one is released here
+    std::shared_ptr<CLTNavMeshClusterGraph> pClusters;
+    std::vector<std::pair<int32_t, int32_t> > residentTiles;
+    std::shared_ptr<CLTNavMeshData> pNavData = pController->pTileCache->TakeUpdatedData(&pClusters, &residentTiles);
+    if (!pNavData) {
+        return;
+    }
+    
+    // Tiles that came or went; corridors around a new tile may now have a shortcut through it
+    std::vector<std::pair<int32_t, int32_t> > changedTiles;
+    std::set_symmetric_difference(pController->residentTiles.begin(), pController->residentTiles.end(),
+                                  residentTiles.begin(), residentTiles.end(),
+                                  std::back_inserter(changedTiles));
+    
+    pController->pNavData = pNavData;
+    pController->pClusters = pClusters;
+    pController->residentTiles.swap(residentTiles);
+    if (m_pActiveController == pController) {
+        m_pNavData = pController->pNavData;
+        m_pClusters = pController->pClusters;
+        UpdateBlockedTable();
+        for (const auto& tile : changedTiles) {
+            for (int32_t z = tile.second - 1; z <= tile.second + 1; ++z) {
+                for (int32_t x = tile.first - 1; x <= tile.first + 1; ++x) {
+                    m_pPathCache->InvalidateTile(x, z);
+                }
+            }
+        }
+    }
+}
+
+bool CLTNavMeshSystem::SetStreamingParams(uint32_t worldId, size_t memoryBudget, float streamingRadius)
+{
+    auto it = m_controllers.find(worldId);
+    if (it == m_controllers.end() || !it->second->pTileCache) {
+        return false;
+    }
+    
+    it->second->pTileCache->SetMemoryBudget(memoryBudget);
+    it->second->pTileCache->SetStreamingRadius(streamingRadius);
+    return true;
+}
+
+size_t CLTNavMeshSystem::GetResidentNavMeshBytes(uint32_t worldId) const
+{
+    auto it = m_controllers.find(worldId);
+    if (it == m_controllers.end()) {
+        return 0;
+    }
+    
+    if (it->second->pTileCache) {
+        return it->second->pTileCache->GetResidentBytes();
+    }
+    
+    size_t size;
+    it->second->pNavData->GetImage(&size);
+    return size;
+}
+
 CLTNavMeshSystem::PathFindResult CLTNavMeshSystem::FindPath(
     const CLTVector& start, const CLTVector& end,
     CLTNavMeshPath* pPath, const PathFindOptions* pOptions)
 {
     // Use default options if not provided
-    PathFindOptions options = pOptions ? *pOptions : m_defaultOptions;
-    
-    // Call the core path finding function
-    return FindPathToo(start, end, options.maxIterations, options.maxNodes, pPath);
+    return StartPath(start, end, pOptions ? *pOptions : m_defaultOptions, pPath);
 }
 
 CLTNavMeshSystem::PathFindResult CLTNavMeshSystem::FindPathToo(
@@ -176,436 +403,1856 @@ CLTNavMeshSystem::PathFindResult CLTNavMeshSystem::FindPathToo(
         //            maxIterations, maxNodeCount);
     }
     
-    // Clear existing data
-    m_openList.clear();
-    m_closedList.clear();
+    PathFindOptions options = m_defaultOptions;
+    options.maxIterations = maxIterations > 0 ? static_cast<uint32_t>(maxIterations) : 0;
+    if (maxNodeCount > 0) {
+        options.maxNodes = static_cast<uint32_t>(maxNodeCount);
+    }
+    
+    return StartPath(start, end, options, pPath);
+}
+
+CLTNavMeshSystem::PathFindResult CLTNavMeshSystem::StartPath(
+    const CLTVector& start, const CLTVector& end,
+    const PathFindOptions& options, CLTNavMeshPath* pPath)
+{
+    if (!pPath) {
+        return PATHFIND_ERROR;
+    }
+    pPath->Clear();
+    pPath->m_start = start;
+    pPath->m_end = end;
     
     // Find the polygons containing start and end points
-    uint32_t startPolyId = FindPolygon(start);
-    uint32_t endPolyId = FindPolygon(end);
+    uint32_t startIndex = FindPolygonIndex(start);
+    uint32_t endIndex = FindPolygonIndex(end);
     
     // Check if valid positions
-    if (startPolyId == 0) {
+    if (startIndex == CLTNavMeshData::INVALID_INDEX) {
         return PATHFIND_INVALID_START;
     }
     
-    if (endPolyId == 0) {
+    if (endIndex == CLTNavMeshData::INVALID_INDEX) {
         return PATHFIND_INVALID_END;
     }
     
-    // Initialize starting node
-    NavMeshPathNode* startNode = AllocateNode();
-    if (!startNode) {
-        return PATHFIND_OUT_OF_NODES;
+    if (FindCachedPath(startIndex, endIndex, options, pPath)) {
+        return PATHFIND_SUCCESS;
     }
     
-    startNode->position = start;
-    startNode->polyId = startPolyId;
-    startNode->cost = 0.0f;
-    startNode->heuristic = CalculateHeuristic(start, end);
-    startNode->totalCost = startNode->heuristic;
-    startNode->parent = nullptr;
-    
-    // Add start node to open list
-    m_openList.push_back(startNode);
-    
-    // A* main loop
-    int iterations = 0;
-    while (!m_openList.empty() && iterations < maxIterations) {
-        // Find the node with the lowest total cost
-        auto it = std::min_element(m_openList.begin(), m_openList.end(),
-            [](NavMeshPathNode* a, NavMeshPathNode* b) {
-                return a->totalCost < b->totalCost;
-            });
-        
-        NavMeshPathNode* current = *it;
-        
-        // Remove from open list and add to closed list
-        m_openList.erase(it);
-        m_closedList.push_back(current);
-        
-        // Check if we've reached the destination
-        if (current->polyId == endPolyId) {
-            // We found a path! Reconstruct and return it
-            *pPath = *ReconstructPath(current);
-            return PATHFIND_SUCCESS;
-        }
-        
-        // Get the polygon for the current node
-        NavMeshPoly currentPoly;
-        if (!GetPolygon(current->polyId, &currentPoly)) {
-            continue;  // Skip if polygon not found
-        }
-        
-        // Process neighbors
-        for (uint32_t neighborId : currentPoly.neighbors) {
-            // Skip if we've already processed this polygon
-            bool inClosedList = false;
-            for (NavMeshPathNode* node : m_closedList) {
-                if (node->polyId == neighborId) {
-                    inClosedList = true;
-                    break;
-                }
-            }
-            
-            if (inClosedList) {
-                continue;
-            }
-            
-            // Get neighbor polygon
-            NavMeshPoly neighborPoly;
-            if (!GetPolygon(neighborId, &neighborPoly)) {
-                continue;  // Skip if neighbor polygon not found
-            }
-            
-            // Calculate the new position and cost
-            CLTVector newPos = (current->position + neighborPoly.center) * 0.5f;
-            float newCost = current->cost + current->position.Distance(newPos);
-            
-            // Check if we already have this neighbor in the open list
-            NavMeshPathNode* existingNode = nullptr;
-            for (NavMeshPathNode* node : m_openList) {
-                if (node->polyId == neighborId) {
-                    existingNode = node;
-                    break;
-                }
-            }
-            
-            // If the neighbor is already in the open list with a lower cost, skip it
-            if (existingNode && existingNode->cost <= newCost) {
-                continue;
-            }
-            
-            // Create or update the neighbor node
-            NavMeshPathNode* neighborNode;
-            if (existingNode) {
-                neighborNode = existingNode;
-            } else {
-                neighborNode = AllocateNode();
-                if (!neighborNode) {
-                    return PATHFIND_OUT_OF_NODES;  // Out of nodes
-                }
-                m_openList.push_back(neighborNode);
-            }
-            
-            // Update node data
-            neighborNode->position = newPos;
-            neighborNode->polyId = neighborId;
-            neighborNode->cost = newCost;
-            neighborNode->heuristic = CalculateHeuristic(newPos, end);
-            neighborNode->totalCost = neighborNode->cost + neighborNode->heuristic;
-            neighborNode->parent = current;
-        }
-        
-        iterations++;
+    if (options.hierarchical && CanSearchClusters(options)) {
+        PathFindResult result = FindHierarchicalPath(startIndex, endIndex, options, pPath);
+        CachePath(pPath, options);
+        return result;
     }
     
-    // If we get here, we didn't find a complete path
-    if (!m_openList.empty()) {
-        // Find the best partial path (closest to destination)
-        *pPath = *GetBestPartialPath();
-        return PATHFIND_PARTIAL;
+    // The search runs on the context's reusable query; only an unfinished
+    // search stays with the path, so it can be resumed
+    CLTNavMeshQuery* pQuery = m_pSearchContext->AcquireQuery();
+    PathFindResult result = pQuery->Init(m_pNavData, m_pAreaCostTable, m_pBlockedTable, start, end, startIndex, endIndex, options);
+    if (result != PATHFIND_PARTIAL) {
+        m_pSearchContext->ReleaseQuery(pQuery);
+        return result;
     }
     
-    return PATHFIND_NO_PATH;
+    pPath->m_pQuery = pQuery;
+    return RunQuery(pPath, options.maxIterations);
 }
 
-CLTNavMeshSystem::PathFindResult CLTNavMeshSystem::ContinuePath(
-    CLTNavMeshPath* pPath, int maxIterations, int maxNodeCount)
+CLTNavMeshSystem::PathFindResult CLTNavMeshSystem::FindHierarchicalPath(
+    uint32_t startIndex, uint32_t endIndex,
+    const PathFindOptions& options, CLTNavMeshPath* pPath)
 {
-    // In the original implementation, this would continue path finding
-    // from a previous partial result.
+    std::vector<uint32_t> corridor;
+    switch (m_pClusters->FindCorridor(startIndex, endIndex, options.maxNodes, &corridor)) {
+    case CLTNavMeshClusterGraph::SEARCH_NO_PATH:
+        return PATHFIND_NO_PATH;
+    case CLTNavMeshClusterGraph::SEARCH_OUT_OF_NODES:
+        return PATHFIND_OUT_OF_NODES;
+    default:
+        break;
+    }
     
-    // For this reconstructed version, we'll just return a placeholder result
-    return PATHFIND_NO_PATH;
+    SetCorridorPath(corridor, options, pPath);
+    return PATHFIND_SUCCESS;
 }
 
-bool CLTNavMeshSystem::FindNearestValidPosition(
-    const CLTVector& position, float maxDistance, CLTVector* pResult)
+void CLTNavMeshSystem::SetCorridorPath(const std::vector<uint32_t>& corridor, const PathFindOptions& options,
+                                       CLTNavMeshPath* pPath)
 {
-    // Find the nearest polygon
-    uint32_t polyId = FindPolygon(position, maxDistance);
-    if (polyId == 0) {
-        return false;  // No valid position found
+    // Same waypoints as the A* query: each step heads halfway to the next polygon center
+    CLTVector position = pPath->m_start;
+    for (size_t i = 0; i < corridor.size(); ++i) {
+        if (i > 0) {
+            position = (position + m_pNavData->GetCenter(corridor[i])) * 0.5f;
+        }
+        pPath->m_waypoints.push_back(position);
+        pPath->m_polygons.push_back(m_pNavData->GetId(corridor[i]));
     }
+    pPath->m_corridor = pPath->m_polygons;
+    pPath->m_waypoints.push_back(pPath->m_end);
+    pPath->m_polygons.push_back(m_pNavData->GetId(corridor.back()));
+    pPath->m_complete = true;
     
-    // Get the polygon
-    NavMeshPoly poly;
-    if (!GetPolygon(polyId, &poly)) {
-        return false;  // Polygon not found (shouldn't happen)
+    if (options.optimizePath) {
+        OptimizePath(pPath, *m_pNavData, options.straightPathTolerance);
+    }
+}
+
+bool CLTNavMeshSystem::FindCachedPath(uint32_t startIndex, uint32_t endIndex, const PathFindOptions& options,
+                                      CLTNavMeshPath* pPath)
+{
+    // Repeat requests rebuild the cached corridor, as long as all of its polygons are still passable
+    NavMeshPathCacheKey key = { m_pNavData->GetId(startIndex), m_pNavData->GetId(endIndex),
+                                options.areaFlags, options.excludedAreaFlags, options.hierarchical };
+    const std::vector<uint32_t>* pCached = m_pPathCache->Find(key);
+    if (!pCached) {
+        return false;
     }
     
-    // Project the position onto the polygon
-    *pResult = position;
-    pResult->y = poly.height;  // Set to polygon height
+    std::vector<uint32_t> corridor;
+    corridor.reserve(pCached->size());
+    for (uint32_t polyId : *pCached) {
+        uint32_t polyIndex = m_pNavData->GetIndex(polyId);
+        if (!IsPolygonUsable(polyIndex)) {
+            m_pPathCache->Remove(key);
+            return false;
+        }
+        corridor.push_back(polyIndex);
+    }
     
+    SetCorridorPath(corridor, options, pPath);
     return true;
 }
 
-bool CLTNavMeshSystem::IsPositionValid(const CLTVector& position, uint32_t* polyId)
+void CLTNavMeshSystem::CachePath(const CLTNavMeshPath* pPath, const PathFindOptions& options)
 {
-    // Find the polygon containing the position
-    uint32_t foundPolyId = FindPolygon(position);
-    
-    // Store the polygon ID if requested
-    if (polyId) {
-        *polyId = foundPolyId;
+    if (!pPath->m_complete || pPath->m_corridor.empty()) {
+        return;
     }
     
-    return foundPolyId != 0;
+    NavMeshPathCacheKey key = { pPath->m_corridor.front(), pPath->m_corridor.back(),
+                                options.areaFlags, options.excludedAreaFlags, options.hierarchical };
+    m_pPathCache->Insert(key, pPath->m_corridor, *m_pNavData);
 }
 
-bool CLTNavMeshSystem::IsIndoors(const CLTVector& position)
+CLTNavMeshSystem::PathFindResult CLTNavMeshSystem::SearchPath(
+    uint32_t startIndex, uint32_t endIndex, const PathFindOptions& options,
+    CLTNavMeshSearchContext* pContext, CLTNavMeshPath* pPath, uint32_t* pNodeCount)
 {
-    // This is a reconstructed implementation based on radare2 analysis
-    // of the original function at address 0x621729a0
+    // Touches nothing but the path, the context and read-only navmesh data,
+    // so batch threads can run it side by side
+    *pNodeCount = 0;
+    if (options.hierarchical && CanSearchClusters(options)) {
+        return FindHierarchicalPath(startIndex, endIndex, options, pPath);
+    }
     
-    // Find the polygon containing the position
-    uint32_t polyId = FindPolygon(position);
-    if (polyId == 0) {
-        return false;  // Not on the NavMesh
+    CLTNavMeshQuery* pQuery = pContext->AcquireQuery();
+    PathFindResult result = pQuery->Init(m_pNavData, m_pAreaCostTable, m_pBlockedTable, pPath->m_start, pPath->m_end, startIndex, endIndex, options);
+    if (result != PATHFIND_PARTIAL) {
+        pContext->ReleaseQuery(pQuery);
+        return result;
     }
     
-    // Get the polygon
-    NavMeshPoly poly;
-    if (!GetPolygon(polyId, &poly)) {
-        return false;  // Polygon not found (shouldn't happen)
+    result = pQuery->Update(pContext, options.maxIterations);
+    *pNodeCount = pQuery->GetNodeCount();
+    pQuery->GetPath(pPath);
+    if (options.optimizePath) {
+        OptimizePath(pPath, *m_pNavData, options.straightPathTolerance);
     }
     
-    // Check if the polygon has the indoor flag
-    return (poly.area & AREA_INDOORS) != 0;
+    if (result == PATHFIND_PARTIAL) {
+        pPath->m_pQuery = pQuery;
+    } else {
+        pContext->ReleaseQuery(pQuery);
+    }
+    
+    return result;
 }
 
-bool CLTNavMeshSystem::RayCast(
-    const CLTVector& start, const CLTVector& end, RayCastResult* pResult)
+void CLTNavMeshSystem::FindPathsBatch(const PathRequest* pRequests, uint32_t count,
+                                      CLTNavMeshPath* pPaths, PathFindResult* pResults)
 {
-    // In the original implementation, this would trace a ray against the NavMesh
-    // to find the first intersection.
+    if (!pRequests || !pPaths || !pResults) {
+        return;
+    }
     
-    // For this reconstructed version, we'll just return a placeholder result
-    if (pResult) {
-        pResult->hit = false;
-        pResult->position = end;
-        pResult->normal = CLTVector(0, 1, 0);
-        pResult->distance = start.Distance(end);
-        pResult->polyId = 0;
+    struct BatchItem {
+        uint32_t request;       // Index into the request arrays
+        uint32_t startIndex;    // Dense index of the start polygon
+        uint32_t endIndex;      // Dense index of the end polygon
+        uint32_t nodeCount;     // Path nodes the search used
+    };
+    
+    // Crowds share goals, so identical positions are looked up once
+    std::map<PositionKey, uint32_t> lookups;
+    auto lookup = [&](const CLTVector& position) {
+        PositionKey key = { position.x, position.y, position.z };
+        auto it = lookups.find(key);
+        if (it == lookups.end()) {
+            it = lookups.insert(std::make_pair(key, FindPolygonIndex(position))).first;
+        }
+        return it->second;
+    };
+    
+    // Lookups, failures and cache hits happen here, in request order
+    std::vector<BatchItem> items;
+    items.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const PathRequest& request = pRequests[i];
+        const PathFindOptions& options = request.pOptions ? *request.pOptions : m_defaultOptions;
+        CLTNavMeshPath* pPath = &pPaths[i];
+        pPath->Clear();
+        pPath->m_start = request.start;
+        pPath->m_end = request.end;
+        
+        BatchItem item = { i, lookup(request.start), lookup(request.end), 0 };
+        if (item.startIndex == CLTNavMeshData::INVALID_INDEX) {
+            pResults[i] = PATHFIND_INVALID_START;
+        } else if (item.endIndex == CLTNavMeshData::INVALID_INDEX) {
+            pResults[i] = PATHFIND_INVALID_END;
+        } else if (FindCachedPath(item.startIndex, item.endIndex, options, pPath)) {
+            pResults[i] = PATHFIND_SUCCESS;
+        } else {
+            items.push_back(item);
+        }
     }
     
-    return false;
-}
-
-bool CLTNavMeshSystem::GetRandomPosition(
-    const CLTVector& center, float radius, CLTVector* pResult)
-{
-    // Get polygons in the region
-    std::vector<NavMeshPoly> polygons;
-    uint32_t numPolys = GetPolygonsInRegion(center, radius, &polygons);
+    // Searches towards the same goal from nearby starts touch the same polygons
+    std::sort(items.begin(), items.end(), [](const BatchItem& a, const BatchItem& b) {
+        if (a.endIndex != b.endIndex) return a.endIndex < b.endIndex;
+        if (a.startIndex != b.startIndex) return a.startIndex < b.startIndex;
+        return a.request < b.request;
+    });
     
-    if (numPolys == 0) {
-        return false;  // No polygons in range
+    uint32_t threadCount = m_batchThreadCount > 0 ? m_batchThreadCount : std::thread::hardware_concurrency();
+    threadCount = std::max(1u, std::min(threadCount, static_cast<uint32_t>(items.size())));
+    while (m_batchContexts.size() + 1 < threadCount) {
+        m_batchContexts.push_back(new CLTNavMeshSearchContext());
     }
     
-    // Pick a random polygon
-    int randomIndex = rand() % numPolys;
-    const NavMeshPoly& poly = polygons[randomIndex];
+    // Threads claim searches in sorted order. Searches ignore the time limit,
+    // which would make the result depend on thread count and machine load;
+    // maxIterations and maxNodes bound them instead.
+    std::atomic<uint32_t> nextItem(0);
+    auto worker = [&](CLTNavMeshSearchContext* pContext) {
+        for (uint32_t i = nextItem++; i < items.size(); i = nextItem++) {
+            BatchItem& item = items[i];
+            const PathRequest& request = pRequests[item.request];
+            PathFindOptions options = request.pOptions ? *request.pOptions : m_defaultOptions;
+            options.timeout = 0.0f;
+            pResults[item.request] = SearchPath(item.startIndex, item.endIndex, options, pContext,
+                                                &pPaths[item.request], &item.nodeCount);
+        }
+    };
     
-    // Pick a random point within the polygon
-    // For simplicity, we'll just use the center in this reconstructed version
-    *pResult = poly.center;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 1; t < threadCount; ++t) {
+        threads.push_back(std::thread(worker, m_batchContexts[t - 1]));
+    }
+    worker(m_pSearchContext);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
     
-    return true;
+    // Bookkeeping in request order, so the cache ends up the same for any thread count
+    std::sort(items.begin(), items.end(), [](const BatchItem& a, const BatchItem& b) {
+        return a.request < b.request;
+    });
+    for (const BatchItem& item : items) {
+        const PathRequest& request = pRequests[item.request];
+        m_nodeHighWater = std::max(m_nodeHighWater, item.nodeCount);
+        if (pResults[item.request] == PATHFIND_SUCCESS) {
+            CachePath(&pPaths[item.request], request.pOptions ? *request.pOptions : m_defaultOptions);
+        }
+    }
 }
 
-bool CLTNavMeshSystem::GetPolygon(uint32_t polyId, NavMeshPoly* pPoly)
+CLTNavMeshSystem::PathFindResult CLTNavMeshSystem::ContinuePath(
+    CLTNavMeshPath* pPath, int maxIterations, int maxNodeCount)
 {
-    // Find the polygon
-    auto it = m_polygons.find(polyId);
-    if (it == m_polygons.end()) {
-        return false;  // Not found
+    if (!pPath || !pPath->m_pQuery) {
+        return PATHFIND_ERROR;  // Nothing to continue
     }
     
-    // Copy the data
-    *pPoly = it->second;
+    if (maxNodeCount > 0) {
+        pPath->m_pQuery->SetMaxNodes(static_cast<uint32_t>(maxNodeCount));
+    }
     
-    return true;
+    return RunQuery(pPath, maxIterations > 0 ? static_cast<uint32_t>(maxIterations) : 0);
 }
 
-uint32_t CLTNavMeshSystem::GetPolygonsInRegion(
-    const CLTVector& center, float radius, std::vector<NavMeshPoly>* pPolygons)
+CLTNavMeshSystem::PathFindResult CLTNavMeshSystem::RunQuery(CLTNavMeshPath* pPath, uint32_t maxIterations)
 {
-    pPolygons->clear();
+    CLTNavMeshQuery* pQuery = pPath->m_pQuery;
+    PathFindResult result = pQuery->Update(m_pSearchContext, maxIterations);
+    m_nodeHighWater = std::max(m_nodeHighWater, pQuery->GetNodeCount());
     
-    // Calculate squared radius for faster distance checks
-    float radiusSq = radius * radius;
-    
-    // Check each polygon
-    for (const auto& pair : m_polygons) {
-        const NavMeshPoly& poly = pair.second;
-        
-        // Check if the polygon's center is within range
-        if (poly.center.DistanceSquared(center) <= radiusSq) {
-            pPolygons->push_back(poly);
-        }
+    // Complete or best partial path so far; only unfinished searches are kept
+    FinishPath(pQuery, pPath);
+    if (result != PATHFIND_PARTIAL) {
+        m_pSearchContext->ReleaseQuery(pQuery);
+        pPath->m_pQuery = nullptr;
     }
     
-    return pPolygons->size();
+    return result;
 }
 
-uint32_t CLTNavMeshSystem::AddTrigger(CLTNavMeshTrigger* pTrigger)
+bool CLTNavMeshSystem::SetPolygonBlocked(uint32_t polyId, bool blocked)
 {
-    // Assign a new trigger ID
-    uint32_t triggerId = m_nextTriggerId++;
-    
-    // Store the trigger
-    m_triggers[triggerId] = pTrigger;
+    if (!m_pActiveController || polyId == 0) {
+        return false;
+    }
     
-    return triggerId;
-}
-
-bool CLTNavMeshSystem::RemoveTrigger(uint32_t triggerId)
-{
-    // Find the trigger
-    auto it = m_triggers.find(triggerId);
-    if (it == m_triggers.end()) {
-        return false;  // Not found
+    std::set<uint32_t>& blockedPolys = m_pActiveController->blockedPolys;
+    bool changed = blocked ? blockedPolys.insert(polyId).second : blockedPolys.erase(polyId) > 0;
+    if (!changed) {
+        return false;
     }
     
-    // Delete the trigger and remove from map
-    delete it->second;
-    m_triggers.erase(it);
+    UpdateBlockedTable();
     
+    // Corridors through a new obstacle are invalid; ones near a removed obstacle may have a shortcut
+    uint32_t polyIndex = m_pNavData->GetIndex(polyId);
+    if (polyIndex != CLTNavMeshData::INVALID_INDEX) {
+        const float* bounds = m_pNavData->GetBounds(polyIndex);
+        m_pPathCache->InvalidateRegion(bounds[0], bounds[1], bounds[2], bounds[3]);
+    }
+    m_flowFields.clear();
     return true;
 }
 
-void CLTNavMeshSystem::UpdateTriggers()
-{
-    // In the original implementation, this would check if any characters
-    // have entered or exited trigger volumes.
-    
-    // For this reconstructed version, we'll just leave it empty
-}
-
-void CLTNavMeshSystem::DrawNavMesh(bool bDraw)
-{
-    m_drawNavMesh = bDraw;
-}
-
-void CLTNavMeshSystem::SetNavMeshParams(float checkBottom, float checkTop)
-{
-    m_checkNavMeshBottom = checkBottom;
-    m_checkNavMeshTop = checkTop;
-}
-
-CLTNavMeshController* CLTNavMeshSystem::GetNavMeshController() const
+bool CLTNavMeshSystem::IsPolygonBlocked(uint32_t polyId) const
 {
-    return m_pActiveController;
+    return m_pActiveController && m_pActiveController->blockedPolys.count(polyId) > 0;
 }
 
-NavMeshPathNode* CLTNavMeshSystem::AllocateNode()
+void CLTNavMeshSystem::UpdateBlockedTable()
 {
-    // Find an unused node in the pool
-    for (NavMeshPathNode* node : m_nodePool) {
-        if (node->parent == nullptr) {
-            return node;
+    // Queries keep the table they started with, so a change makes a new one
+    std::vector<uint8_t> table;
+    if (m_pActiveController) {
+        for (uint32_t polyId : m_pActiveController->blockedPolys) {
+            uint32_t polyIndex = m_pNavData->GetIndex(polyId);
+            if (polyIndex == CLTNavMeshData::INVALID_INDEX) {
+                continue;  // In a tile that is not loaded
+            }
+            
+            if (table.empty()) {
+                table.resize(m_pNavData->GetPolyCount(), 0);
+            }
+            table[polyIndex] = 1;
         }
     }
     
-    // If we get here, all nodes are in use
-    return nullptr;
+    m_pBlockedTable = table.empty() ? std::shared_ptr<const std::vector<uint8_t> >()
+                                    : std::make_shared<const std::vector<uint8_t> >(table);
 }
 
-void CLTNavMeshSystem::FreeNode(NavMeshPathNode* pNode)
+bool CLTNavMeshSystem::IsPolygonUsable(uint32_t polyIndex) const
 {
-    if (pNode) {
-        pNode->parent = nullptr;
-    }
+    return polyIndex != CLTNavMeshData::INVALID_INDEX && !(m_pBlockedTable && (*m_pBlockedTable)[polyIndex]);
 }
 
-uint32_t CLTNavMeshSystem::FindPolygon(const CLTVector& position, float maxDistance)
+CLTNavMeshSystem::PathFindResult CLTNavMeshSystem::RepairPath(
+    CLTNavMeshPath* pPath, const CLTVector& position, const PathFindOptions* pOptions)
 {
-    // In the original implementation, this would use spatial partitioning
-    // to quickly find polygons near the position.
+    if (!pPath) {
+        return PATHFIND_ERROR;
+    }
+    if (pPath->m_pQuery) {
+        return PATHFIND_PARTIAL;  // Repair once the search has finished
+    }
     
-    // For this reconstructed version, we'll just check all polygons
-    uint32_t bestPolyId = 0;
-    float bestDistanceSq = maxDistance * maxDistance;
+    const PathFindOptions& options = pOptions ? *pOptions : m_defaultOptions;
+    const CLTVector end = pPath->m_end;
+    if (!pPath->m_complete || pPath->m_corridor.empty()) {
+        return StartPath(position, end, options, pPath);
+    }
     
-    for (const auto& pair : m_polygons) {
-        const NavMeshPoly& poly = pair.second;
+    // The corridor on the current navmesh, from the agent's polygon onwards
+    std::vector<uint32_t> corridor(pPath->m_corridor.size());
+    for (size_t i = 0; i < corridor.size(); ++i) {
+        corridor[i] = m_pNavData->GetIndex(pPath->m_corridor[i]);
+    }
+    
+    uint32_t positionIndex = FindPolygonIndex(position);
+    auto current = std::find(corridor.begin(), corridor.end(), positionIndex);
+    if (positionIndex == CLTNavMeshData::INVALID_INDEX || current == corridor.end()) {
+        return StartPath(position, end, options, pPath);  // Off the corridor
+    }
+    corridor.erase(corridor.begin(), current);
+    
+    // First polygon ahead the agent can no longer pass
+    size_t blocked = 1;
+    while (blocked < corridor.size() && IsPolygonUsable(corridor[blocked])) {
+        blocked++;
+    }
+    if (blocked == corridor.size()) {
+        return PATHFIND_SUCCESS;
+    }
+    
+    // Rejoin at the first usable polygon past the obstacle
+    size_t rejoin = blocked + 1;
+    while (rejoin < corridor.size() && !IsPolygonUsable(corridor[rejoin])) {
+        rejoin++;
+    }
+    if (rejoin == corridor.size()) {
+        return StartPath(position, end, options, pPath);  // The goal itself is blocked
+    }
+    
+    // Local search around the obstacle, from the last polygon before it
+    PathFindOptions localOptions = options;
+    localOptions.maxNodes = std::min(options.maxNodes, REPAIR_MAX_NODES);
+    uint32_t fromIndex = corridor[blocked - 1];
+    uint32_t toIndex = corridor[rejoin];
+    CLTVector from = blocked == 1 ? position : m_pNavData->GetCenter(fromIndex);
+    
+    CLTNavMeshQuery* pQuery = m_pSearchContext->AcquireQuery();
+    PathFindResult result = pQuery->Init(m_pNavData, m_pAreaCostTable, m_pBlockedTable, from,
+                                         m_pNavData->GetCenter(toIndex), fromIndex, toIndex, localOptions);
+    if (result == PATHFIND_PARTIAL) {
+        result = pQuery->Update(m_pSearchContext, REPAIR_MAX_NODES);
+        m_nodeHighWater = std::max(m_nodeHighWater, pQuery->GetNodeCount());
+    }
+    CLTNavMeshPath detour;
+    if (result == PATHFIND_SUCCESS) {
+        pQuery->GetPath(&detour);
+    }
+    m_pSearchContext->ReleaseQuery(pQuery);
+    if (result != PATHFIND_SUCCESS) {
+        return StartPath(position, end, options, pPath);  // No short detour
+    }
+    
+    // Splice the detour in place of the blocked stretch
+    std::vector<uint32_t> repaired(corridor.begin(), corridor.begin() + (blocked - 1));
+    for (uint32_t polyId : detour.m_corridor) {
+        repaired.push_back(m_pNavData->GetIndex(polyId));
+    }
+    repaired.insert(repaired.end(), corridor.begin() + rejoin + 1, corridor.end());
+    
+    pPath->Clear();
+    pPath->m_start = position;
+    pPath->m_end = end;
+    SetCorridorPath(repaired, options, pPath);
+    return PATHFIND_SUCCESS;
+}
+
+uint32_t CLTNavMeshSystem::RequestPath(const CLTVector& start, const CLTVector& end,
+                                       PathPriority priority, const PathFindOptions* pOptions)
+{
+    const PathFindOptions& options = pOptions ? *pOptions : m_defaultOptions;
+    if (priority < PATH_PRIORITY_HIGH || priority >= PATH_PRIORITY_COUNT) {
+        priority = PATH_PRIORITY_NORMAL;
+    }
+    
+    if (m_pPathQueue->GetWorkerCount() == 0) {
+        m_pPathQueue->Start(m_pathWorkerCount > 0 ? m_pathWorkerCount : 1);
+    }
+    
+    // Polygon lookups are cheap and use system settings, so they run here
+    uint32_t startIndex = FindPolygonIndex(start);
+    if (startIndex == CLTNavMeshData::INVALID_INDEX) {
+        return m_pPathQueue->SubmitResult(PATHFIND_INVALID_START);
+    }
+    
+    uint32_t endIndex = FindPolygonIndex(end);
+    if (endIndex == CLTNavMeshData::INVALID_INDEX) {
+        return m_pPathQueue->SubmitResult(PATHFIND_INVALID_END);
+    }
+    
+    CLTNavMeshQuery* pQuery = new CLTNavMeshQuery();
+    PathFindResult result = pQuery->Init(m_pNavData, m_pAreaCostTable, m_pBlockedTable, start, end, startIndex, endIndex, options);
+    if (result != PATHFIND_PARTIAL) {
+        delete pQuery;
+        return m_pPathQueue->SubmitResult(result);
+    }
+    
+    return m_pPathQueue->Submit(pQuery, priority, options.maxIterations);
+}
+
+void CLTNavMeshSystem::FinishPath(const CLTNavMeshQuery* pQuery, CLTNavMeshPath* pPath)
+{
+    pQuery->GetPath(pPath);
+    
+    const PathFindOptions& options = pQuery->GetOptions();
+    if (options.optimizePath) {
+        OptimizePath(pPath, pQuery->GetNavData(), options.straightPathTolerance);
+    }
+    
+    // Only paths found on the current navmesh are worth remembering
+    if (&pQuery->GetNavData() == m_pNavData.get()) {
+        CachePath(pPath, options);
+    }
+}
+
+CLTNavMeshSystem::PathFindResult CLTNavMeshSystem::GetPathResult(uint32_t ticket, CLTNavMeshPath* pPath)
+{
+    CLTNavMeshQuery* pQuery;
+    PathFindResult result = m_pPathQueue->Fetch(ticket, pPath ? &pQuery : nullptr);
+    if (result == PATHFIND_PENDING || !pPath) {
+        return result;
+    }
+    
+    pPath->Clear();
+    if (pQuery) {
+        FinishPath(pQuery, pPath);
+        m_nodeHighWater = std::max(m_nodeHighWater, pQuery->GetNodeCount());
+        
+        // Out of iterations: hand the search to the path so it can be continued
+        if (result == PATHFIND_PARTIAL) {
+            pPath->m_pQuery = pQuery;
+        } else {
+            m_pSearchContext->ReleaseQuery(pQuery);
+        }
+    }
+    
+    return result;
+}
+
+bool CLTNavMeshSystem::CancelPathRequest(uint32_t ticket)
+{
+    return m_pPathQueue->Cancel(ticket);
+}
+
+void CLTNavMeshSystem::SetPathWorkerCount(uint32_t count)
+{
+    m_pathWorkerCount = count;
+    m_pPathQueue->Start(count);
+}
+
+bool CLTNavMeshSystem::FindNearestValidPosition(
+    const CLTVector& position, float maxDistance, CLTVector* pResult)
+{
+    // Find the nearest polygon
+    uint32_t polyIndex = FindPolygonIndex(position, maxDistance);
+    if (polyIndex == CLTNavMeshData::INVALID_INDEX) {
+        return false;  // No valid position found
+    }
+    
+    // Project the position onto the polygon
+    *pResult = position;
+    pResult->y = m_pNavData->GetHeight(polyIndex);  // Set to polygon height
+    
+    return true;
+}
+
+bool CLTNavMeshSystem::IsPositionValid(const CLTVector& position, uint32_t* polyId)
+{
+    // Find the polygon containing the position
+    uint32_t foundPolyId = FindPolygon(position);
+    
+    // Store the polygon ID if requested
+    if (polyId) {
+        *polyId = foundPolyId;
+    }
+    
+    return foundPolyId != 0;
+}
+
+bool CLTNavMeshSystem::IsIndoors(const CLTVector& position)
+{
+    // This is a reconstructed implementation based on radare2 analysis
+    // of the original function at address 0x621729a0
+    
+    // Find the polygon containing the position
+    uint32_t polyIndex = FindPolygonIndex(position);
+    if (polyIndex == CLTNavMeshData::INVALID_INDEX) {
+        return false;  // Not on the NavMesh
+    }
+    
+    // Check if the polygon has the indoor flag
+    return (m_pNavData->GetArea(polyIndex) & AREA_INDOORS) != 0;
+}
+
+// Squared XZ distance from p to the segment a-b
+static float DistanceSquaredToSegment(const CLTVector& p, const CLTVector& a, const CLTVector& b)
+{
+    float ex = b.x - a.x;
+    float ez = b.z - a.z;
+    float lenSq = ex * ex + ez * ez;
+    float s = lenSq > 0.0f ? ((p.x - a.x) * ex + (p.z - a.z) * ez) / lenSq : 0.0f;
+    s = std::max(0.0f, std::min(1.0f, s));
+    float dx = a.x + ex * s - p.x;
+    float dz = a.z + ez * s - p.z;
+    return dx * dx + dz * dz;
+}
+
+bool CLTNavMeshSystem::IsIndoors(const CLTVector& position, NavMeshLocation* pLocation)
+{
+    return (GetAreaFlags(position, pLocation) & AREA_INDOORS) != 0;
+}
+
+uint8_t CLTNavMeshSystem::GetAreaFlags(const CLTVector& position, NavMeshLocation* pLocation)
+{
+    uint32_t polyIndex = LocatePolygonIndex(position, pLocation);
+    return polyIndex != CLTNavMeshData::INVALID_INDEX ? m_pNavData->GetArea(polyIndex) : 0;
+}
+
+uint32_t CLTNavMeshSystem::LocatePolygon(const CLTVector& position, NavMeshLocation* pLocation)
+{
+    uint32_t polyIndex = LocatePolygonIndex(position, pLocation);
+    return polyIndex != CLTNavMeshData::INVALID_INDEX ? m_pNavData->GetId(polyIndex) : 0;
+}
+
+void CLTNavMeshSystem::GetLocationCacheStats(uint64_t* pHits, uint64_t* pMisses) const
+{
+    if (pHits) {
+        *pHits = m_locationHits;
+    }
+    if (pMisses) {
+        *pMisses = m_locationMisses;
+    }
+}
+
+uint32_t CLTNavMeshSystem::LocatePolygonIndex(const CLTVector& position, NavMeshLocation* pLocation)
+{
+    if (!pLocation) {
+        return FindPolygonIndex(position);
+    }
+    
+    // The cached index is only trusted on the same snapshot; the ID check
+    // guards against a new snapshot reusing the old one's address
+    const CLTNavMeshData& navData = *m_pNavData;
+    uint32_t lastIndex = CLTNavMeshData::INVALID_INDEX;
+    if (pLocation->polyId != 0) {
+        if (pLocation->pNavData == &navData && pLocation->polyIndex < navData.GetPolyCount() &&
+            navData.GetId(pLocation->polyIndex) == pLocation->polyId) {
+            lastIndex = pLocation->polyIndex;
+        } else {
+            lastIndex = navData.GetIndex(pLocation->polyId);
+        }
+    }
+    
+    // Still inside the same polygon, or stepped into a neighbour
+    uint32_t polyIndex = CLTNavMeshData::INVALID_INDEX;
+    if (lastIndex != CLTNavMeshData::INVALID_INDEX) {
+        if (IsWithinHeightBand(position, lastIndex) && navData.ContainsPoint(lastIndex, position.x, position.z)) {
+            polyIndex = lastIndex;
+        } else {
+            uint32_t neighborCount;
+            const uint32_t* neighbors = navData.GetNeighbors(lastIndex, &neighborCount);
+            for (uint32_t n = 0; n < neighborCount; ++n) {
+                if (IsWithinHeightBand(position, neighbors[n]) &&
+                    navData.ContainsPoint(neighbors[n], position.x, position.z)) {
+                    polyIndex = neighbors[n];
+                    break;
+                }
+            }
+        }
+    }
+    
+    if (polyIndex != CLTNavMeshData::INVALID_INDEX) {
+        m_locationHits++;
+    } else {
+        m_locationMisses++;
+        polyIndex = FindPolygonIndex(position);
+    }
+    
+    pLocation->pNavData = &navData;
+    pLocation->polyIndex = polyIndex;
+    pLocation->polyId = polyIndex != CLTNavMeshData::INVALID_INDEX ? navData.GetId(polyIndex) : 0;
+    return polyIndex;
+}
+
+bool CLTNavMeshSystem::RayCast(
+    const CLTVector& start, const CLTVector& end, RayCastResult* pResult)
+{
+    RayCastResult result;
+    bool hit = RayCastFrom(FindPolygonIndex(start), start, end, &result);
+    if (pResult) {
+        *pResult = result;
+    }
+    
+    return hit;
+}
+
+uint32_t CLTNavMeshSystem::RayCastBatch(const RayCastRequest* pRays, uint32_t count, RayCastResult* pResults)
+{
+    if (!pRays || !pResults) {
+        return 0;
+    }
+    
+    // Sensing passes cast many rays from one observer, so starts repeat
+    std::map<PositionKey, uint32_t> lookups;
+    uint32_t hitCount = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        const CLTVector& start = pRays[i].start;
+        PositionKey key = { start.x, start.y, start.z };
+        auto it = lookups.find(key);
+        if (it == lookups.end()) {
+            it = lookups.insert(std::make_pair(key, FindPolygonIndex(start))).first;
+        }
+        
+        if (RayCastFrom(it->second, start, pRays[i].end, &pResults[i])) {
+            hitCount++;
+        }
+    }
+    
+    return hitCount;
+}
+
+// XZ distance within which a ray point lies on a portal
+static const float RAY_PORTAL_EPSILON = 0.01f;
+
+// How far past a boundary point a ray is probed to see which polygon it enters
+static const float RAY_PROBE_DISTANCE = 0.01f;
+
+// Polygons around a boundary point searched for the one a ray enters
+static const uint32_t MAX_RAY_FAN = 32;
+
+// Polygon a ray continues in from a point on the boundary of fromIndex,
+// such as a corner where the ray runs along an edge. Candidates are the
+// polygons linked to fromIndex, directly or around the point, through
+// portals the point lies on; the one holding the probe, a little further
+// along the ray, wins, else the one closest to it within the tolerance.
+// INVALID_INDEX if the ray leaves the mesh at the point. The tolerance
+// only covers rounding, so a ray clipping a wall corner still stops there.
+static uint32_t FindRayContinuation(const CLTNavMeshData& navData, uint32_t fromIndex,
+                                    const CLTVector& point, const CLTVector& probe)
+{
+    const float POINT_EPSILON = 1.0e-5f * (1.0f + std::max(std::fabs(point.x), std::fabs(point.z)));
+
+    uint32_t fan[MAX_RAY_FAN];
+    uint32_t fanCount = 1;
+    fan[0] = fromIndex;
+    uint32_t bestIndex = CLTNavMeshData::INVALID_INDEX;
+    float bestDistSq = POINT_EPSILON * POINT_EPSILON;
+    for (uint32_t f = 0; f < fanCount; ++f) {
+        uint32_t neighborCount;
+        const uint32_t* neighbors = navData.GetNeighbors(fan[f], &neighborCount);
+        for (uint32_t n = 0; n < neighborCount; ++n) {
+            const uint32_t next = neighbors[n];
+            if (std::find(fan, fan + fanCount, next) != fan + fanCount || fanCount == MAX_RAY_FAN) {
+                continue;
+            }
+            CLTVector left, right;
+            if (!navData.GetPortal(fan[f], next, &left, &right) ||
+                DistanceSquaredToSegment(point, left, right) > POINT_EPSILON * POINT_EPSILON) {
+                continue;
+            }
+            fan[fanCount++] = next;
+
+            if (navData.ContainsPoint(next, probe.x, probe.z)) {
+                return next;
+            }
+            float distSq = navData.DistanceSquaredToEdges(next, probe.x, probe.z);
+            if (distSq <= bestDistSq) {
+                bestDistSq = distSq;
+                bestIndex = next;
+            }
+        }
+    }
+    return bestIndex;
+}
+
+bool CLTNavMeshSystem::RayCastFrom(uint32_t startIndex, const CLTVector& start, const CLTVector& end,
+                                   RayCastResult* pResult) const
+{
+    // Parameter tolerance for exits at the same point, e.g. through a vertex
+    const float T_EPSILON = 1.0e-5f;
+    const float PORTAL_EPSILON = RAY_PORTAL_EPSILON;
+    
+    pResult->hit = true;
+    pResult->position = start;
+    pResult->normal = CLTVector(0, 1, 0);
+    pResult->distance = 0.0f;
+    pResult->polyId = 0;
+    if (startIndex == CLTNavMeshData::INVALID_INDEX) {
+        return true;  // Off the navmesh everything is blocked
+    }
+    
+    const CLTVector delta = end - start;
+    const float lengthXZ = std::sqrt(delta.x * delta.x + delta.z * delta.z);
+    const float probeT = lengthXZ > 0.0f ? RAY_PROBE_DISTANCE / lengthXZ : 0.0f;
+    uint32_t polyIndex = startIndex;
+    float t = 0.0f;
+    
+    // A start on the boundary, such as a path corner, may lie in several
+    // polygons; begin in the one the ray heads into
+    if (probeT > 0.0f) {
+        const CLTVector probe = start + delta * std::min(probeT, 1.0f);
+        if (!m_pNavData->ContainsPoint(polyIndex, probe.x, probe.z)) {
+            uint32_t entered = FindRayContinuation(*m_pNavData, polyIndex, start, probe);
+            if (entered != CLTNavMeshData::INVALID_INDEX) {
+                polyIndex = entered;
+            }
+        }
+    }
+    
+    // Exit parameters by edge; loading caps the vertex count
+    float edgeExits[CLTNavMeshData::MAX_POLY_VERTICES];
+    
+    // Each step leaves the current polygon through the nearest edge the ray
+    // crosses outwards; the step limit guards against cycling on bad data
+    for (uint32_t step = 0; step <= m_pNavData->GetPolyCount(); ++step) {
+        uint32_t vertexCount;
+        const CLTVector* vertices = m_pNavData->GetVertices(polyIndex, &vertexCount);
+        
+        // Winding decides which side of an edge is inside
+        float area = 0.0f;
+        for (uint32_t i = 0, j = vertexCount - 1; i < vertexCount; j = i++) {
+            area += vertices[j].x * vertices[i].z - vertices[i].x * vertices[j].z;
+        }
+        
+        // Exit parameter of each edge the ray leaves through, FLT_MAX for the rest
+        float exitT = FLT_MAX;
+        std::fill(edgeExits, edgeExits + vertexCount, FLT_MAX);
+        for (uint32_t i = 0, j = vertexCount - 1; i < vertexCount; j = i++) {
+            const CLTVector& a = vertices[j];
+            const CLTVector& b = vertices[i];
+            float ex = b.x - a.x;
+            float ez = b.z - a.z;
+            float denom = ex * delta.z - ez * delta.x;
+            if (denom * area >= 0.0f) {
+                continue;  // Parallel, or crossing inwards
+            }
+            
+            float edgeT = (ex * (a.z - start.z) - ez * (a.x - start.x)) / denom;
+            if (edgeT < t - T_EPSILON) {
+                continue;
+            }
+            
+            // Concave polygons: the crossing must be on the edge, not its extension
+            float lenSq = ex * ex + ez * ez;
+            float px = start.x + delta.x * edgeT - a.x;
+            float pz = start.z + delta.z * edgeT - a.z;
+            float s = (px * ex + pz * ez) / lenSq;
+            float slack = PORTAL_EPSILON / std::sqrt(lenSq);
+            if (s >= -slack && s <= 1.0f + slack) {
+                edgeExits[i] = edgeT;
+                exitT = std::min(exitT, edgeT);
+            }
+        }
+        
+        if (exitT >= 1.0f) {
+            // The end lies inside this polygon
+            pResult->hit = false;
+            pResult->position = end;
+            pResult->distance = start.Distance(end);
+            pResult->polyId = m_pNavData->GetId(polyIndex);
+            return false;
+        }
+        
+        t = std::max(t, exitT);
+        const CLTVector exitPoint = start + delta * t;
+        
+        // Cross into a neighbour whose portal lies on an exit edge and holds
+        // the exit point. Through a vertex both edges are exits, so a ray
+        // can pass between two polygons that only touch at a corner.
+        uint32_t nextIndex = CLTNavMeshData::INVALID_INDEX;
+        uint32_t wallEdge = vertexCount;
+        for (uint32_t i = 0, j = vertexCount - 1; i < vertexCount; j = i++) {
+            if (edgeExits[i] > exitT + T_EPSILON) {
+                continue;
+            }
+            wallEdge = i;
+            
+            const CLTVector& a = vertices[j];
+            const CLTVector& b = vertices[i];
+            uint32_t neighborCount;
+            const uint32_t* neighbors = m_pNavData->GetNeighbors(polyIndex, &neighborCount);
+            for (uint32_t n = 0; n < neighborCount; ++n) {
+                CLTVector left, right;
+                if (m_pNavData->GetPortal(polyIndex, neighbors[n], &left, &right) &&
+                    DistanceSquaredToSegment(left, a, b) <= PORTAL_EPSILON * PORTAL_EPSILON &&
+                    DistanceSquaredToSegment(right, a, b) <= PORTAL_EPSILON * PORTAL_EPSILON &&
+                    DistanceSquaredToSegment(exitPoint, left, right) <= PORTAL_EPSILON * PORTAL_EPSILON) {
+                    nextIndex = neighbors[n];
+                    break;
+                }
+            }
+            
+            if (nextIndex != CLTNavMeshData::INVALID_INDEX) {
+                break;
+            }
+        }
+        
+        if (nextIndex == CLTNavMeshData::INVALID_INDEX && probeT > 0.0f) {
+            // No portal holds the exit point, but a ray leaving through a
+            // corner or running along a portal edge may still go on in a
+            // polygon around the point
+            const CLTVector probe = start + delta * std::min(t + probeT, 1.0f);
+            nextIndex = FindRayContinuation(*m_pNavData, polyIndex, exitPoint, probe);
+        }
+        
+        if (nextIndex == CLTNavMeshData::INVALID_INDEX) {
+            // A wall; its inward normal faces back along the ray
+            const CLTVector& a = vertices[(wallEdge + vertexCount - 1) % vertexCount];
+            const CLTVector& b = vertices[wallEdge];
+            float ex = b.x - a.x;
+            float ez = b.z - a.z;
+            float len = std::sqrt(ex * ex + ez * ez);
+            float sign = area > 0.0f ? 1.0f : -1.0f;
+            
+            pResult->position = exitPoint;
+            pResult->normal = CLTVector(-ez * sign / len, 0.0f, ex * sign / len);
+            pResult->distance = start.Distance(exitPoint);
+            pResult->polyId = m_pNavData->GetId(polyIndex);
+            return true;
+        }
+        
+        polyIndex = nextIndex;
+    }
+    
+    // Gave up walking: report the furthest point reached as a hit
+    pResult->position = start + delta * t;
+    pResult->distance = start.Distance(pResult->position);
+    pResult->polyId = m_pNavData->GetId(polyIndex);
+    return true;
+}
+
+namespace {
+
+// Most vertices a polygon clipped to a square can have
+const uint32_t MAX_CLIPPED_VERTICES = CLTNavMeshData::MAX_POLY_VERTICES + 4;
+
+// Clips an outline to the half-plane where the coordinate on the given
+// axis (0 for X, 2 for Z) times sign is at most limit; returns the count
+uint32_t ClipOutline(const CLTVector* pIn, uint32_t count, int axis, float sign, float limit, CLTVector* pOut)
+{
+    uint32_t outCount = 0;
+    for (uint32_t i = 0, j = count - 1; i < count; j = i++) {
+        const CLTVector& a = pIn[j];
+        const CLTVector& b = pIn[i];
+        float da = sign * (axis == 0 ? a.x : a.z) - limit;
+        float db = sign * (axis == 0 ? b.x : b.z) - limit;
+        if ((da <= 0.0f) != (db <= 0.0f)) {
+            pOut[outCount++] = a + (b - a) * (da / (da - db));
+        }
+        if (db <= 0.0f) {
+            pOut[outCount++] = b;
+        }
+    }
+    return outCount;
+}
+
+// Draws random positions from the polygons overlapping a sphere, for
+// GetRandomPosition() where floors overlap. Each polygon is clipped to
+// the XZ square around the sphere's cross-section at its nearest height
+// and weighted by the clipped area, so little of the weight lies outside
+// the sphere however large the polygons are.
+struct LayeredSampler {
+    const CLTNavMeshData* pNavData;
+    CLTVector center;
+    float radiusSq;
+    double totalArea;                   ///< Clipped area of every polygon visited
+    double target;                      ///< Area left to skip before the picked polygon
+    uint32_t polyIndex;                 ///< Picked polygon, or INVALID_INDEX
+
+    // Outline of a polygon within the square; returns its XZ area
+    float Clip(const NavMeshPolyView& poly, CLTVector* pOutline, uint32_t* pCount) const {
+        *pCount = 0;
+        if (poly.vertexCount < 3) {
+            return 0.0f;
+        }
+        float minY = poly.vertices[0].y, maxY = minY;
+        for (uint32_t i = 1; i < poly.vertexCount; ++i) {
+            minY = std::min(minY, poly.vertices[i].y);
+            maxY = std::max(maxY, poly.vertices[i].y);
+        }
+        float dy = std::max(0.0f, std::max(minY - center.y, center.y - maxY));
+        if (dy * dy > radiusSq) {
+            return 0.0f;
+        }
+        const float half = std::sqrt(radiusSq - dy * dy);
+
+        CLTVector buffer[MAX_CLIPPED_VERTICES];
+        uint32_t count = ClipOutline(poly.vertices, poly.vertexCount, 0, 1.0f, center.x + half, buffer);
+        count = count > 0 ? ClipOutline(buffer, count, 0, -1.0f, half - center.x, pOutline) : 0;
+        count = count > 0 ? ClipOutline(pOutline, count, 2, 1.0f, center.z + half, buffer) : 0;
+        count = count > 0 ? ClipOutline(buffer, count, 2, -1.0f, half - center.z, pOutline) : 0;
+        *pCount = count;
+
+        float area = 0.0f;
+        for (uint32_t i = 0, j = count - 1; i < count; j = i++) {
+            area += pOutline[j].x * pOutline[i].z - pOutline[i].x * pOutline[j].z;
+        }
+        return std::fabs(area) * 0.5f;
+    }
+
+    static bool Sum(const NavMeshPolyView& poly, void* pUserData) {
+        LayeredSampler* pSampler = static_cast<LayeredSampler*>(pUserData);
+        CLTVector outline[MAX_CLIPPED_VERTICES];
+        uint32_t count;
+        pSampler->totalArea += pSampler->Clip(poly, outline, &count);
+        return true;
+    }
+
+    static bool Pick(const NavMeshPolyView& poly, void* pUserData) {
+        LayeredSampler* pSampler = static_cast<LayeredSampler*>(pUserData);
+        CLTVector outline[MAX_CLIPPED_VERTICES];
+        uint32_t count;
+        float area = pSampler->Clip(poly, outline, &count);
+        if (!(area > 0.0f)) {
+            return true;
+        }
+        // Rounding may leave the target a hair past the last polygon
+        pSampler->polyIndex = poly.index;
+        pSampler->target -= area;
+        return pSampler->target >= 0.0;
+    }
+
+    // Uniform point by XZ area on the picked polygon's clipped outline
+    bool Sample(CLTVector* pPoint) const {
+        CLTVector outline[MAX_CLIPPED_VERTICES];
+        uint32_t count;
+        float area = Clip(pNavData->GetPoly(polyIndex), outline, &count);
+        if (!(area > 0.0f)) {
+            return false;
+        }
+
+        // The clipped outline is convex, so fan it from its first vertex
+        float target = RandomFloat() * area;
+        uint32_t k = 2;
+        for (; k + 1 < count; ++k) {
+            const CLTVector& a = outline[0];
+            const CLTVector& b = outline[k - 1];
+            const CLTVector& c = outline[k];
+            target -= std::fabs((b.x - a.x) * (c.z - a.z) - (b.z - a.z) * (c.x - a.x)) * 0.5f;
+            if (target < 0.0f) {
+                break;
+            }
+        }
+        float s = std::sqrt(RandomFloat());
+        float r = RandomFloat();
+        *pPoint = outline[0] * (1.0f - s) + outline[k - 1] * (s * (1.0f - r)) + outline[k] * (s * r);
+        pPoint->y = pNavData->GetPointHeight(polyIndex, pPoint->x, pPoint->z);
+        return true;
+    }
+};
+
+} // namespace
+
+bool CLTNavMeshSystem::GetRandomPosition(
+    const CLTVector& center, float radius, CLTVector* pResult) const
+{
+    const CLTNavMeshData& navData = *m_pNavData;
+    if (navData.GetPolyCount() == 0 || !(radius >= 0.0f)) {
+        return false;
+    }
+    
+    // Cells whose polygons can reach the sphere's XZ square
+    const float reach = radius + navData.GetSampleReach();
+    int x0, z0, x1, z1;
+    navData.GetCellCoords(center.x - reach, center.z - reach, &x0, &z0);
+    navData.GetCellCoords(center.x + reach, center.z + reach, &x1, &z1);
+    x0 = std::max(x0, 0);
+    z0 = std::max(z0, 0);
+    x1 = std::min(x1, navData.GetGridWidth() - 1);
+    z1 = std::min(z1, navData.GetGridHeight() - 1);
+    if (x0 > x1 || z0 > z1) {
+        return false;  // No polygons in range
+    }
+    
+    const double meshArea = navData.GetSampleArea(x0, z0, x1, z1);
+    if (!(meshArea > 0.0)) {
+        return false;
+    }
+    
+    // All strategies draw points uniformly by XZ area and keep those inside
+    // the sphere. Drawing from the polygons in range wastes fewer samples
+    // when the mesh near the sphere is smaller than its cross-section;
+    // otherwise points are drawn in the disc and dropped onto the mesh
+    // below them. A disc point counts once however many floors lie below
+    // it, so where polygons overlap points are drawn from the polygons
+    // overlapping the sphere, clipped to it.
+    const float radiusSq = radius * radius;
+    LayeredSampler layered = { &navData, center, radiusSq, 0.0, 0.0, CLTNavMeshData::INVALID_INDEX };
+    const NavMeshRegion sphere = NavMeshRegion::Sphere(center, radius);
+    if (navData.HasOverlappingPolys(x0, z0, x1, z1)) {
+        navData.QueryPolygons(sphere, &LayeredSampler::Sum, &layered);
+        if (!(layered.totalArea > 0.0)) {
+            return false;
+        }
+    }
+    const bool sampleMesh = meshArea <= 3.14159265 * radiusSq;
+    for (int attempt = 0; attempt < MAX_RANDOM_ATTEMPTS; ++attempt) {
+        CLTVector point;
+        if (layered.totalArea > 0.0) {
+            layered.target = RandomDouble() * layered.totalArea;
+            layered.polyIndex = CLTNavMeshData::INVALID_INDEX;
+            navData.QueryPolygons(sphere, &LayeredSampler::Pick, &layered);
+            if (layered.polyIndex == CLTNavMeshData::INVALID_INDEX || !layered.Sample(&point)) {
+                continue;
+            }
+        } else if (sampleMesh) {
+            uint32_t polyIndex = navData.PickPolygon(x0, z0, x1, z1, RandomDouble() * meshArea);
+            if (polyIndex == CLTNavMeshData::INVALID_INDEX) {
+                continue;
+            }
+            float r0 = RandomFloat();
+            float r1 = RandomFloat();
+            point = navData.GetPointInPoly(polyIndex, r0, r1, RandomFloat());
+        } else {
+            float angle = RandomFloat() * 6.28318531f;
+            float distance = radius * std::sqrt(RandomFloat());
+            point.x = center.x + distance * std::cos(angle);
+            point.z = center.z + distance * std::sin(angle);
+            
+            int cellX, cellZ;
+            if (!navData.GetCellCoords(point.x, point.z, &cellX, &cellZ)) {
+                continue;
+            }
+            
+            // A point on a shared edge lies in both polygons; pick one
+            uint32_t polyCount;
+            const uint32_t* polys = navData.GetCellPolys(cellX, cellZ, &polyCount);
+            uint32_t found = 0;
+            float y = 0.0f;
+            for (uint32_t i = 0; i < polyCount; ++i) {
+                if (!navData.ContainsPoint(polys[i], point.x, point.z)) {
+                    continue;
+                }
+                float height = navData.GetPointHeight(polys[i], point.x, point.z);
+                float dx = point.x - center.x;
+                float dy = height - center.y;
+                float dz = point.z - center.z;
+                if (dx * dx + dy * dy + dz * dz <= radiusSq && NextRandom() % ++found == 0) {
+                    y = height;
+                }
+            }
+            if (found == 0) {
+                continue;
+            }
+            point.y = y;
+        }
+        
+        if (point.DistanceSquared(center) <= radiusSq) {
+            *pResult = point;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+void CLTNavMeshSystem::SeedRandom(uint64_t seed)
+{
+    s_randomState = seed;
+}
+
+bool CLTNavMeshSystem::GetPolygon(uint32_t polyId, NavMeshPoly* pPoly)
+{
+    // Find the polygon
+    uint32_t polyIndex = m_pNavData->GetIndex(polyId);
+    if (polyIndex == CLTNavMeshData::INVALID_INDEX) {
+        return false;  // Not found
+    }
+    
+    // Copy the data
+    m_pNavData->CopyPoly(polyIndex, pPoly);
+    
+    return true;
+}
+
+bool CLTNavMeshSystem::GetPolygonView(uint32_t polyId, NavMeshPolyView* pView) const
+{
+    uint32_t polyIndex = m_pNavData->GetIndex(polyId);
+    if (polyIndex == CLTNavMeshData::INVALID_INDEX) {
+        return false;  // Not found
+    }
+    
+    *pView = m_pNavData->GetPoly(polyIndex);
+    return true;
+}
+
+namespace {
+
+// Collects the polygons whose center lies within a radius, for GetPolygonsInRegion()
+struct CenterCollector {
+    CLTVector center;
+    float radiusSq;
+    const CLTNavMeshData* pNavData;
+    std::vector<NavMeshPoly>* pPolygons;
+    std::vector<NavMeshPolyView>* pViews;
+
+    static bool Visit(const NavMeshPolyView& poly, void* pUserData) {
+        CenterCollector* pCollector = static_cast<CenterCollector*>(pUserData);
+        if (poly.center.DistanceSquared(pCollector->center) > pCollector->radiusSq) {
+            return true;
+        }
+        if (pCollector->pViews) {
+            pCollector->pViews->push_back(poly);
+        } else {
+            pCollector->pPolygons->push_back(NavMeshPoly());
+            pCollector->pNavData->CopyPoly(poly.index, &pCollector->pPolygons->back());
+        }
+        return true;
+    }
+};
+
+// Fills a caller's array of views, counting past its end, for QueryPolygons()
+struct ViewCollector {
+    NavMeshPolyView* pPolygons;
+    uint32_t maxCount;
+    uint32_t count;
+
+    static bool Visit(const NavMeshPolyView& poly, void* pUserData) {
+        ViewCollector* pCollector = static_cast<ViewCollector*>(pUserData);
+        if (pCollector->count < pCollector->maxCount) {
+            pCollector->pPolygons[pCollector->count] = poly;
+        }
+        ++pCollector->count;
+        return true;
+    }
+};
+
+} // namespace
+
+uint32_t CLTNavMeshSystem::GetPolygonsInRegion(
+    const CLTVector& center, float radius, std::vector<NavMeshPoly>* pPolygons)
+{
+    pPolygons->clear();
+    
+    // Polygon centers lie inside their bounds, so the grid finds every candidate
+    CenterCollector collector = { center, radius * radius, m_pNavData.get(), pPolygons, nullptr };
+    m_pNavData->QueryBounds(center.x - radius, center.z - radius, center.x + radius, center.z + radius,
+                            &CenterCollector::Visit, &collector);
+    
+    return pPolygons->size();
+}
+
+uint32_t CLTNavMeshSystem::GetPolygonsInRegion(
+    const CLTVector& center, float radius, std::vector<NavMeshPolyView>* pPolygons) const
+{
+    pPolygons->clear();
+    
+    // Views only allocate if the caller's vector has to grow
+    CenterCollector collector = { center, radius * radius, m_pNavData.get(), nullptr, pPolygons };
+    m_pNavData->QueryBounds(center.x - radius, center.z - radius, center.x + radius, center.z + radius,
+                            &CenterCollector::Visit, &collector);
+    
+    return pPolygons->size();
+}
+
+uint32_t CLTNavMeshSystem::QueryPolygons(
+    const NavMeshRegion& region, NavMeshPolyView* pPolygons, uint32_t maxCount) const
+{
+    ViewCollector collector = { pPolygons, maxCount, 0 };
+    m_pNavData->QueryPolygons(region, &ViewCollector::Visit, &collector);
+    return collector.count;
+}
+
+uint32_t CLTNavMeshSystem::QueryPolygons(
+    const NavMeshRegion& region, NavMeshPolyVisitor pVisitor, void* pUserData) const
+{
+    if (!pVisitor) {
+        return 0;
+    }
+    
+    return m_pNavData->QueryPolygons(region, pVisitor, pUserData);
+}
+
+uint32_t CLTNavMeshSystem::AddTrigger(CLTNavMeshTrigger* pTrigger)
+{
+    if (!pTrigger) {
+        return 0;
+    }
+    
+    // Assign a new trigger ID
+    uint32_t triggerId = m_nextTriggerId++;
+    
+    // Store the trigger
+    m_triggers[triggerId] = pTrigger;
+    RegisterTrigger(triggerId, pTrigger, true);
+    
+    // Actors may already be standing inside; adding triggers is rare, so retest everyone
+    for (auto& pair : m_triggerActors) {
+        if (!pair.second.dirty) {
+            pair.second.dirty = true;
+            m_dirtyActors.push_back(pair.first);
+        }
+    }
+    
+    return triggerId;
+}
+
+bool CLTNavMeshSystem::RemoveTrigger(uint32_t triggerId)
+{
+    // Find the trigger
+    auto it = m_triggers.find(triggerId);
+    if (it == m_triggers.end()) {
+        return false;  // Not found
+    }
+    
+    // Delete the trigger and remove from map; actors drop the ID when they next move
+    RegisterTrigger(triggerId, it->second, false);
+    delete it->second;
+    m_triggers.erase(it);
+    
+    return true;
+}
+
+CLTNavMeshTrigger* CLTNavMeshSystem::GetTrigger(uint32_t triggerId) const
+{
+    auto it = m_triggers.find(triggerId);
+    return it != m_triggers.end() ? it->second : nullptr;
+}
+
+void CLTNavMeshSystem::RegisterTrigger(uint32_t triggerId, const CLTNavMeshTrigger* pTrigger, bool add)
+{
+    int32_t minX = TriggerCell(pTrigger->GetMin().x);
+    int32_t minZ = TriggerCell(pTrigger->GetMin().z);
+    int32_t maxX = TriggerCell(pTrigger->GetMax().x);
+    int32_t maxZ = TriggerCell(pTrigger->GetMax().z);
+    int64_t cellCount = (static_cast<int64_t>(maxX) - minX + 1) * (static_cast<int64_t>(maxZ) - minZ + 1);
+    
+    if (cellCount > MAX_TRIGGER_CELLS) {
+        if (add) {
+            m_largeTriggers.push_back(triggerId);
+        } else {
+            m_largeTriggers.erase(std::remove(m_largeTriggers.begin(), m_largeTriggers.end(), triggerId),
+                                  m_largeTriggers.end());
+        }
+        return;
+    }
+    
+    for (int32_t z = minZ; z <= maxZ; ++z) {
+        for (int32_t x = minX; x <= maxX; ++x) {
+            if (add) {
+                m_triggerCells[TriggerCellKey(x, z)].push_back(triggerId);
+                continue;
+            }
+            
+            auto cell = m_triggerCells.find(TriggerCellKey(x, z));
+            if (cell == m_triggerCells.end()) {
+                continue;
+            }
+            std::vector<uint32_t>& triggers = cell->second;
+            triggers.erase(std::remove(triggers.begin(), triggers.end(), triggerId), triggers.end());
+            if (triggers.empty()) {
+                m_triggerCells.erase(cell);
+            }
+        }
+    }
+}
+
+void CLTNavMeshSystem::SetTriggerActorPosition(uint32_t actorId, const CLTVector& position)
+{
+    auto it = m_triggerActors.find(actorId);
+    if (it == m_triggerActors.end()) {
+        TriggerActor actor;
+        actor.position = position;
+        actor.dirty = true;
+        m_triggerActors.insert(std::make_pair(actorId, actor));
+        m_dirtyActors.push_back(actorId);
+        return;
+    }
+    
+    TriggerActor& actor = it->second;
+    if (actor.position.x == position.x && actor.position.y == position.y && actor.position.z == position.z) {
+        return;  // Standing still costs nothing
+    }
+    
+    actor.position = position;
+    if (!actor.dirty) {
+        actor.dirty = true;
+        m_dirtyActors.push_back(actorId);
+    }
+}
+
+bool CLTNavMeshSystem::RemoveTriggerActor(uint32_t actorId)
+{
+    auto it = m_triggerActors.find(actorId);
+    if (it == m_triggerActors.end()) {
+        return false;
+    }
+    
+    for (uint32_t triggerId : it->second.triggers) {
+        if (CLTNavMeshTrigger* pTrigger = GetTrigger(triggerId)) {
+            pTrigger->PushEvent(actorId, false);
+        }
+    }
+    
+    // A stale entry in m_dirtyActors is skipped by UpdateTriggers()
+    m_triggerActors.erase(it);
+    return true;
+}
+
+void CLTNavMeshSystem::UpdateTriggers()
+{
+    std::vector<uint32_t> inside;
+    std::vector<uint32_t> changed;
+    for (uint32_t actorId : m_dirtyActors) {
+        auto it = m_triggerActors.find(actorId);
+        if (it == m_triggerActors.end() || !it->second.dirty) {
+            continue;  // Removed, or already handled
+        }
+        
+        TriggerActor& actor = it->second;
+        actor.dirty = false;
         
-        // Check height bounds
-        if (position.y < poly.height + m_checkNavMeshBottom ||
-            position.y > poly.height + m_checkNavMeshTop) {
-            continue;
+        // Narrow phase against the triggers sharing the actor's cell
+        inside.clear();
+        auto test = [&](uint32_t triggerId) {
+            CLTNavMeshTrigger* pTrigger = GetTrigger(triggerId);
+            if (pTrigger && pTrigger->Contains(actor.position)) {
+                inside.push_back(triggerId);
+            }
+        };
+        auto cell = m_triggerCells.find(TriggerCellKey(TriggerCell(actor.position.x), TriggerCell(actor.position.z)));
+        if (cell != m_triggerCells.end()) {
+            std::for_each(cell->second.begin(), cell->second.end(), test);
+        }
+        std::for_each(m_largeTriggers.begin(), m_largeTriggers.end(), test);
+        std::sort(inside.begin(), inside.end());
+        
+        // Triggers left; removed triggers simply drop out
+        changed.clear();
+        std::set_difference(actor.triggers.begin(), actor.triggers.end(), inside.begin(), inside.end(),
+                            std::back_inserter(changed));
+        for (uint32_t triggerId : changed) {
+            if (CLTNavMeshTrigger* pTrigger = GetTrigger(triggerId)) {
+                pTrigger->PushEvent(actorId, false);
+            }
         }
         
-        // Calculate distance to polygon center (ignoring Y)
-        CLTVector flatPos(position.x, 0, position.z);
-        CLTVector flatCenter(poly.center.x, 0, poly.center.z);
-        float distanceSq = flatPos.DistanceSquared(flatCenter);
+        // Triggers entered
+        changed.clear();
+        std::set_difference(inside.begin(), inside.end(), actor.triggers.begin(), actor.triggers.end(),
+                            std::back_inserter(changed));
+        for (uint32_t triggerId : changed) {
+            GetTrigger(triggerId)->PushEvent(actorId, true);
+        }
         
-        // If this is closer than our current best, check if the position is inside
-        if (distanceSq < bestDistanceSq) {
-            if (IsPositionInPolygon(position, poly)) {
-                bestPolyId = pair.first;
-                bestDistanceSq = 0.0f;  // Inside, so distance is 0
-            } else if (bestPolyId == 0) {
-                // If we don't have a polygon yet, use this one
-                bestPolyId = pair.first;
-                bestDistanceSq = distanceSq;
+        actor.triggers.swap(inside);
+    }
+    
+    m_dirtyActors.clear();
+}
+
+void CLTNavMeshSystem::DrawNavMesh(bool bDraw)
+{
+    m_drawNavMesh = bDraw;
+}
+
+void CLTNavMeshSystem::SetNavMeshParams(float checkBottom, float checkTop)
+{
+    m_checkNavMeshBottom = checkBottom;
+    m_checkNavMeshTop = checkTop;
+}
+
+CLTNavMeshController* CLTNavMeshSystem::GetNavMeshController() const
+{
+    return m_pActiveController;
+}
+
+bool CLTNavMeshSystem::SetAreaCost(uint32_t areaFlag, float cost)
+{
+    // Exactly one of the eight area bits
+    if (areaFlag == 0 || areaFlag > AREA_RESTRICTED || (areaFlag & (areaFlag - 1)) != 0 || !(cost >= 1.0f)) {
+        return false;
+    }
+    
+    uint32_t bit = 0;
+    while ((1u << bit) != areaFlag) {
+        bit++;
+    }
+    m_areaCosts[bit] = cost;
+    
+    // Queries keep the table they started with, so a changed table is a new one
+    std::vector<float> table(256, 1.0f);
+    bool uniform = true;
+    for (uint32_t area = 0; area < 256; ++area) {
+        for (uint32_t b = 0; b < 8; ++b) {
+            if (area & (1u << b)) {
+                table[area] = std::max(table[area], m_areaCosts[b]);
             }
         }
+        uniform = uniform && table[area] == 1.0f;
+    }
+    m_pAreaCostTable = uniform ? std::shared_ptr<const std::vector<float> >()
+                               : std::make_shared<const std::vector<float> >(table);
+    
+    // Cached corridors and flow fields were found with the old costs
+    m_pPathCache->Clear();
+    m_flowFields.clear();
+    return true;
+}
+
+float CLTNavMeshSystem::GetAreaCost(uint32_t areaFlag) const
+{
+    for (uint32_t bit = 0; bit < 8; ++bit) {
+        if (areaFlag == (1u << bit)) {
+            return m_areaCosts[bit];
+        }
+    }
+    
+    return 1.0f;
+}
+
+bool CLTNavMeshSystem::CanSearchClusters(const PathFindOptions& options) const
+{
+    // The cluster graph knows nothing of area costs, filters and obstacles
+    if (!m_pClusters || m_pAreaCostTable || m_pBlockedTable) {
+        return false;
+    }
+    
+    // Conservative: every area on the mesh must be accepted outright
+    uint32_t areaMask = m_pClusters->GetAreaMask();
+    return (areaMask & options.excludedAreaFlags) == 0 && (areaMask & ~options.areaFlags) == 0;
+}
+
+void CLTNavMeshSystem::SetPathCacheCapacity(uint32_t capacity)
+{
+    m_pPathCache->SetCapacity(capacity);
+}
+
+void CLTNavMeshSystem::GetPathCacheStats(uint64_t* pHits, uint64_t* pMisses) const
+{
+    if (pHits) {
+        *pHits = m_pPathCache->GetHitCount();
+    }
+    if (pMisses) {
+        *pMisses = m_pPathCache->GetMissCount();
+    }
+}
+
+std::shared_ptr<const CLTNavMeshFlowField> CLTNavMeshSystem::GetFlowField(const CLTVector& goal, float reuseDistance,
+                                                                         const PathFindOptions* pOptions)
+{
+    uint32_t goalIndex = FindPolygonIndex(goal);
+    if (goalIndex == CLTNavMeshData::INVALID_INDEX) {
+        return std::shared_ptr<const CLTNavMeshFlowField>();
+    }
+    
+    const PathFindOptions& options = pOptions ? *pOptions : m_defaultOptions;
+    
+    // Reuse a field for the same snapshot and filter whose goal has not moved far
+    for (size_t i = 0; i < m_flowFields.size(); ++i) {
+        std::shared_ptr<const CLTNavMeshFlowField> pField = m_flowFields[i];
+        if (pField->GetNavData() == m_pNavData && pField->GetGoalIndex() == goalIndex &&
+            pField->GetAreaFlags() == options.areaFlags &&
+            pField->GetExcludedAreaFlags() == options.excludedAreaFlags &&
+            pField->GetGoal().Distance(goal) <= reuseDistance) {
+            m_flowFields.erase(m_flowFields.begin() + i);
+            m_flowFields.insert(m_flowFields.begin(), pField);
+            return pField;
+        }
+    }
+    
+    std::shared_ptr<CLTNavMeshFlowField> pField = std::make_shared<CLTNavMeshFlowField>();
+    if (!pField->Build(m_pNavData, goal, goalIndex, options.areaFlags, options.excludedAreaFlags,
+                       m_pAreaCostTable.get(), m_pBlockedTable.get())) {
+        return std::shared_ptr<const CLTNavMeshFlowField>();
+    }
+    
+    // Fields for older snapshots can never be reused, so they go first
+    m_flowFields.erase(std::remove_if(m_flowFields.begin(), m_flowFields.end(),
+        [this](const std::shared_ptr<const CLTNavMeshFlowField>& pOld) {
+            return pOld->GetNavData() != m_pNavData;
+        }), m_flowFields.end());
+    if (m_flowFields.size() >= MAX_FLOW_FIELDS) {
+        m_flowFields.pop_back();
     }
+    m_flowFields.insert(m_flowFields.begin(), pField);
     
-    return bestPolyId;
+    return pField;
 }
 
-bool CLTNavMeshSystem::IsPositionInPolygon(const CLTVector& position, const NavMeshPoly& poly)
+bool CLTNavMeshSystem::GetFlowDirection(const CLTNavMeshFlowField& field, const CLTVector& position,
+                                        CLTVector* pDirection)
 {
-    // This is a simplified implementation
-    // The original would do proper point-in-polygon testing
+    if (!pDirection || field.GetNavData() != m_pNavData) {
+        return false;
+    }
+    
+    uint32_t polyIndex = FindPolygonIndex(position);
+    if (polyIndex == CLTNavMeshData::INVALID_INDEX || !field.IsReachable(polyIndex)) {
+        return false;
+    }
     
-    // For this reconstructed version, we'll just check the distance to the center
-    // and assume the polygon is roughly circular
-    CLTVector flatPos(position.x, 0, position.z);
-    CLTVector flatCenter(poly.center.x, 0, poly.center.z);
+    CLTVector direction = field.GetTarget(polyIndex) - position;
+    direction.y = 0.0f;
     
-    // Assume average radius of 2.0 units
-    const float POLY_RADIUS = 2.0f;
+    // A position on a portal can still count as the polygon behind it; head on to the next portal
+    for (uint32_t hops = 0; hops < 4 && direction.LengthSquared() < FLOW_ARRIVE_DISTANCE * FLOW_ARRIVE_DISTANCE; ++hops) {
+        polyIndex = field.GetNextPolygon(polyIndex);
+        if (polyIndex == CLTNavMeshData::INVALID_INDEX) {
+            break;
+        }
+        direction = field.GetTarget(polyIndex) - position;
+        direction.y = 0.0f;
+    }
     
-    return flatPos.DistanceSquared(flatCenter) <= (POLY_RADIUS * POLY_RADIUS);
+    *pDirection = direction.Normalize();
+    return true;
+}
+
+uint32_t CLTNavMeshSystem::GetNodePoolHighWaterMark() const
+{
+    return m_nodeHighWater;
 }
 
-float CLTNavMeshSystem::CalculateHeuristic(const CLTVector& position, const CLTVector& goal)
+uint32_t CLTNavMeshSystem::FindPolygon(const CLTVector& position, float maxDistance)
 {
-    // Use straight-line distance as the heuristic
-    return position.Distance(goal);
+    uint32_t polyIndex = FindPolygonIndex(position, maxDistance);
+    return polyIndex != CLTNavMeshData::INVALID_INDEX ? m_pNavData->GetId(polyIndex) : 0;
 }
 
-CLTNavMeshPath* CLTNavMeshSystem::ReconstructPath(NavMeshPathNode* pEndNode)
+uint32_t CLTNavMeshSystem::FindPolygonIndex(const CLTVector& position, float maxDistance)
 {
-    // Create a new path
-    CLTNavMeshPath* pPath = new CLTNavMeshPath();
+    // The original implementation used spatial partitioning here as well;
+    // the compiled navmesh carries a uniform grid over the XZ plane.
+    if (m_pNavData->GetPolyCount() == 0) {
+        return CLTNavMeshData::INVALID_INDEX;
+    }
     
-    // TODO: In the original implementation, this would reconstruct the path
-    // by following the parent pointers from the end node back to the start.
+    // Only polygons overlapping the point's cell can contain the point
+    int cellX, cellZ;
+    if (m_pNavData->GetCellCoords(position.x, position.z, &cellX, &cellZ)) {
+        uint32_t bestIndex = CLTNavMeshData::INVALID_INDEX;
+        float bestHeightDiff = FLT_MAX;
+        
+        // Candidates that pass the cheap height and bounds checks are
+        // gathered into a small stack buffer and tested as a batch
+        const uint32_t BATCH_SIZE = 64;
+        uint32_t candidates[BATCH_SIZE];
+        uint8_t inside[BATCH_SIZE];
+        
+        uint32_t count;
+        const uint32_t* polys = m_pNavData->GetCellPolys(cellX, cellZ, &count);
+        uint32_t k = 0;
+        while (k < count) {
+            uint32_t numCandidates = 0;
+            for (; k < count && numCandidates < BATCH_SIZE; ++k) {
+                uint32_t i = polys[k];
+                const float* bounds = m_pNavData->GetBounds(i);
+                if (position.x < bounds[0] || position.z < bounds[1] ||
+                    position.x > bounds[2] || position.z > bounds[3]) {
+                    continue;
+                }
+                if (IsWithinHeightBand(position, i)) {
+                    candidates[numCandidates++] = i;
+                }
+            }
+            
+            if (m_pNavData->ContainsPointBatch(position.x, position.z, candidates, numCandidates, inside) == 0) {
+                continue;
+            }
+            
+            // On stacked floors, prefer the polygon closest in height
+            for (uint32_t c = 0; c < numCandidates; ++c) {
+                if (!inside[c]) {
+                    continue;
+                }
+                float heightDiff = std::fabs(position.y - m_pNavData->GetHeight(candidates[c]));
+                if (heightDiff < bestHeightDiff) {
+                    bestIndex = candidates[c];
+                    bestHeightDiff = heightDiff;
+                }
+            }
+        }
+        
+        if (bestIndex != CLTNavMeshData::INVALID_INDEX) {
+            return bestIndex;
+        }
+    }
     
-    return pPath;
+    // Not inside any polygon; fall back to the closest one within range
+    return FindNearestPolygonIndex(position, maxDistance);
 }
 
-CLTNavMeshPath* CLTNavMeshSystem::GetBestPartialPath()
+uint32_t CLTNavMeshSystem::FindNearestPolygonIndex(const CLTVector& position, float maxDistance)
 {
-    // Create a new path
-    CLTNavMeshPath* pPath = new CLTNavMeshPath();
+    uint32_t bestIndex = CLTNavMeshData::INVALID_INDEX;
+    float bestDistanceSq = maxDistance * maxDistance;
+    
+    const float cellSize = m_pNavData->GetCellSize();
+    const int gridWidth = m_pNavData->GetGridWidth();
+    const int gridHeight = m_pNavData->GetGridHeight();
     
-    // TODO: In the original implementation, this would find the node
-    // in the open list that's closest to the destination.
+    int cellX, cellZ;
+    m_pNavData->GetCellCoords(position.x, position.z, &cellX, &cellZ);
+    
+    // Rings past the grid edge, or further away than maxDistance, hold nothing
+    int maxRing = std::max(std::max(cellX, gridWidth - 1 - cellX),
+                           std::max(cellZ, gridHeight - 1 - cellZ));
+    float distanceRings = maxDistance / cellSize + 1.0f;
+    if (distanceRings < static_cast<float>(maxRing)) {
+        maxRing = static_cast<int>(distanceRings);
+    }
+    
+    // Visit square rings of cells outward from the point's cell
+    for (int ring = 0; ring <= maxRing; ++ring) {
+        // Every cell in this ring is at least (ring - 1) cells away
+        float ringDistance = (ring - 1) * cellSize;
+        if (ring > 1 && ringDistance * ringDistance > bestDistanceSq) {
+            break;
+        }
+        
+        for (int cz = cellZ - ring; cz <= cellZ + ring; ++cz) {
+            if (cz < 0 || cz >= gridHeight) {
+                continue;
+            }
+            
+            // Inner rows only contribute their first and last cell
+            bool fullRow = (cz == cellZ - ring || cz == cellZ + ring);
+            int step = (fullRow || ring == 0) ? 1 : ring * 2;
+            
+            for (int cx = cellX - ring; cx <= cellX + ring; cx += step) {
+                if (cx < 0 || cx >= gridWidth) {
+                    continue;
+                }
+                
+                uint32_t count;
+                const uint32_t* polys = m_pNavData->GetCellPolys(cx, cz, &count);
+                for (uint32_t k = 0; k < count; ++k) {
+                    uint32_t i = polys[k];
+                    if (!IsWithinHeightBand(position, i)) {
+                        continue;
+                    }
+                    
+                    float distanceSq = m_pNavData->DistanceSquaredToEdges(i, position.x, position.z);
+                    if (distanceSq < bestDistanceSq) {
+                        bestIndex = i;
+                        bestDistanceSq = distanceSq;
+                    }
+                }
+            }
+        }
+    }
     
-    return pPath;
+    return bestIndex;
+}
+
+bool CLTNavMeshSystem::IsWithinHeightBand(const CLTVector& position, uint32_t polyIndex) const
+{
+    float height = m_pNavData->GetHeight(polyIndex);
+    return position.y >= height + m_checkNavMeshBottom &&
+           position.y <= height + m_checkNavMeshTop;
+}
+
+bool CLTNavMeshSystem::IsPositionInPolygon(const CLTVector& position, const NavMeshPolyView& poly)
+{
+    // Exact test against the polygon outline in the XZ plane
+    return CLTNavMeshData::PointInPolygon(poly.vertices, poly.vertexCount, position.x, position.z);
 }
 
-void CLTNavMeshSystem::OptimizePath(CLTNavMeshPath* pPath)
+// Twice the signed XZ area of triangle a, b, c; positive if c is left of a->b
+static float TriArea2(const CLTVector& a, const CLTVector& b, const CLTVector& c)
 {
-    // TODO: In the original implementation, this would optimize the path
-    // by removing unnecessary waypoints.
+    return (b.x - a.x) * (c.z - a.z) - (b.z - a.z) * (c.x - a.x);
+}
+
+static bool SamePointXZ(const CLTVector& a, const CLTVector& b)
+{
+    const float EPSILON_SQ = 1.0e-6f;
+    float dx = a.x - b.x;
+    float dz = a.z - b.z;
+    return dx * dx + dz * dz < EPSILON_SQ;
+}
+
+void CLTNavMeshSystem::OptimizePath(CLTNavMeshPath* pPath, const CLTNavMeshData& navData, float tolerance)
+{
+    const std::vector<uint32_t>& corridor = pPath->m_corridor;
+    if (corridor.empty() || pPath->m_waypoints.size() < 2) {
+        return;
+    }
+    
+    // Portals between consecutive corridor polygons, framed by the start
+    // and end points as zero-width portals
+    const CLTVector start = pPath->m_waypoints.front();
+    const CLTVector end = pPath->m_waypoints.back();
+    std::vector<CLTVector> left, right;
+    left.reserve(corridor.size() + 1);
+    right.reserve(corridor.size() + 1);
+    left.push_back(start);
+    right.push_back(start);
+    
+    uint32_t prevIndex = navData.GetIndex(corridor[0]);
+    for (size_t i = 1; i < corridor.size(); ++i) {
+        uint32_t index = navData.GetIndex(corridor[i]);
+        CLTVector l, r;
+        if (prevIndex == CLTNavMeshData::INVALID_INDEX || index == CLTNavMeshData::INVALID_INDEX ||
+            !navData.GetPortal(prevIndex, index, &l, &r)) {
+            return;  // Polygons do not share an edge; keep the unoptimized path
+        }
+        left.push_back(l);
+        right.push_back(r);
+        prevIndex = index;
+    }
+    left.push_back(end);
+    right.push_back(end);
+    
+    // Simple stupid funnel: narrow the funnel portal by portal and emit a
+    // corner whenever one side crosses over the other
+    std::vector<CLTVector> waypoints;
+    std::vector<uint32_t> polygons;
+    waypoints.push_back(start);
+    polygons.push_back(corridor.front());
+    
+    const size_t portalCount = left.size();
+    CLTVector apex = start, funnelLeft = start, funnelRight = start;
+    size_t apexIndex = 0, leftIndex = 0, rightIndex = 0;
+    
+    for (size_t i = 1; i < portalCount; ++i) {
+        const CLTVector& l = left[i];
+        const CLTVector& r = right[i];
+        
+        // Tighten the right side
+        if (TriArea2(apex, funnelRight, r) >= 0.0f) {
+            if (SamePointXZ(apex, funnelRight) || TriArea2(apex, funnelLeft, r) < 0.0f) {
+                funnelRight = r;
+                rightIndex = i;
+            } else {
+                // Right crossed left: the left point is a corner
+                apex = funnelLeft;
+                apexIndex = leftIndex;
+                waypoints.push_back(apex);
+                polygons.push_back(corridor[std::min(apexIndex, corridor.size() - 1)]);
+                funnelLeft = funnelRight = apex;
+                leftIndex = rightIndex = apexIndex;
+                i = apexIndex;
+                continue;
+            }
+        }
+        
+        // Tighten the left side
+        if (TriArea2(apex, funnelLeft, l) <= 0.0f) {
+            if (SamePointXZ(apex, funnelLeft) || TriArea2(apex, funnelRight, l) > 0.0f) {
+                funnelLeft = l;
+                leftIndex = i;
+            } else {
+                // Left crossed right: the right point is a corner
+                apex = funnelRight;
+                apexIndex = rightIndex;
+                waypoints.push_back(apex);
+                polygons.push_back(corridor[std::min(apexIndex, corridor.size() - 1)]);
+                funnelLeft = funnelRight = apex;
+                leftIndex = rightIndex = apexIndex;
+                i = apexIndex;
+                continue;
+            }
+        }
+    }
+    
+    if (!SamePointXZ(waypoints.back(), end) || waypoints.size() == 1) {
+        waypoints.push_back(end);
+        polygons.push_back(corridor.back());
+    }
+    
+    // Drop corners that deviate less than the tolerance from a straight line
+    if (tolerance > 0.0f) {
+        size_t kept = 1;
+        for (size_t i = 1; i + 1 < waypoints.size(); ++i) {
+            const CLTVector& a = waypoints[kept - 1];
+            const CLTVector& c = waypoints[i + 1];
+            float lenSq = (c.x - a.x) * (c.x - a.x) + (c.z - a.z) * (c.z - a.z);
+            float area = std::fabs(TriArea2(a, c, waypoints[i]));
+            if (area * area >= tolerance * tolerance * lenSq) {
+                waypoints[kept] = waypoints[i];
+                polygons[kept] = polygons[i];
+                ++kept;
+            }
+        }
+        waypoints[kept] = waypoints.back();
+        polygons[kept] = polygons.back();
+        waypoints.resize(kept + 1);
+        polygons.resize(kept + 1);
+    }
+    
+    pPath->m_waypoints.swap(waypoints);
+    pPath->m_polygons.swap(polygons);
 }
\ No newline at end of file
@@ -0,0 +1,487 @@
+#include "../../include/gameplay/CLTNavMeshTileCache.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+static_assert(sizeof(NavMeshTileManifestHeader) == 32, "NavMeshTileManifestHeader layout changed");
+static_assert(sizeof(NavMeshTileEntry) == 16, "NavMeshTileEntry layout changed");
+
+CLTNavMeshTileCache::CLTNavMeshTileCache()
+    : m_tileSize(1.0f)
+    , m_originX(0.0f)
+    , m_originZ(0.0f)
+    , m_minTileX(0)
+    , m_minTileZ(0)
+    , m_maxTileX(-1)
+    , m_maxTileZ(-1)
+    , m_memoryBudget(64 * 1024 * 1024)
+    , m_streamingRadius(128.0f)
+    , m_tick(0)
+    , m_targetChanged(false)
+    , m_stop(false)
+    , m_publishedChanged(false)
+    , m_residentBytes(0)
+    , m_residentPolys(0)
+{
+}
+
+CLTNavMeshTileCache::~CLTNavMeshTileCache()
+{
+    Close();
+}
+
+bool CLTNavMeshTileCache::IsManifest(const char* pFilename)
+{
+    if (!pFilename) {
+        return false;
+    }
+
+    FILE* pFile = fopen(pFilename, "rb");
+    if (!pFile) {
+        return false;
+    }
+
+    uint32_t magic = 0;
+    bool ok = fread(&magic, sizeof(magic), 1, pFile) == 1 && magic == MANIFEST_MAGIC;
+    fclose(pFile);
+    return ok;
+}
+
+bool CLTNavMeshTileCache::WriteTiles(const std::vector<NavMeshPoly>& polygons, float tileSize,
+                                     const char* pManifestFile, uint32_t landmarkCount)
+{
+    if (!pManifestFile || !(tileSize > 0.0f) || tileSize > FLT_MAX) {
+        return false;
+    }
+
+    // Tile (0, 0) starts at the smallest polygon center
+    float originX = 0.0f, originZ = 0.0f;
+    if (!polygons.empty()) {
+        originX = FLT_MAX;
+        originZ = FLT_MAX;
+        for (const NavMeshPoly& poly : polygons) {
+            originX = std::min(originX, poly.center.x);
+            originZ = std::min(originZ, poly.center.z);
+        }
+    }
+
+    // Landmarks are measured on the whole world, so every tile carries
+    // rows for the same landmarks and joined tiles keep them
+    CLTNavMeshData world;
+    if (!world.Build(polygons, landmarkCount)) {
+        return false;
+    }
+
+    // Group polygons by the tile containing their center
+    std::map<uint64_t, std::vector<uint32_t> > groups;
+    for (uint32_t i = 0; i < world.GetPolyCount(); ++i) {
+        const CLTVector& center = world.GetCenter(i);
+        int32_t x = CLTNavMeshData::GridCoord(center.x, originX, tileSize);
+        int32_t z = CLTNavMeshData::GridCoord(center.z, originZ, tileSize);
+        groups[TileKey(x, z)].push_back(i);
+    }
+
+    std::vector<NavMeshTileEntry> entries;
+    for (auto& group : groups) {
+        NavMeshTileEntry entry;
+        entry.tileX = static_cast<int32_t>(static_cast<uint32_t>(group.first));
+        entry.tileZ = static_cast<int32_t>(static_cast<uint32_t>(group.first >> 32));
+
+        // Links to other tiles end up as external links in the tile image
+        std::vector<CLTNavMeshData::JoinSource> sources(1);
+        sources[0].pData = &world;
+        sources[0].pIndices = group.second.data();
+        sources[0].count = static_cast<uint32_t>(group.second.size());
+        CLTNavMeshData tile;
+        if (!tile.Join(sources) ||
+            !tile.SaveToFile(TileFilename(pManifestFile, entry.tileX, entry.tileZ).c_str())) {
+            return false;
+        }
+
+        size_t imageSize;
+        tile.GetImage(&imageSize);
+        entry.imageSize = static_cast<uint32_t>(imageSize);
+        entry.polyCount = tile.GetPolyCount();
+        entries.push_back(entry);
+    }
+
+    NavMeshTileManifestHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MANIFEST_MAGIC;
+    header.version = MANIFEST_VERSION;
+    header.tileCount = static_cast<uint32_t>(entries.size());
+    header.tileSize = tileSize;
+    header.originX = originX;
+    header.originZ = originZ;
+
+    FILE* pFile = fopen(pManifestFile, "wb");
+    if (!pFile) {
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, pFile) == 1;
+    if (ok && !entries.empty()) {
+        ok = fwrite(entries.data(), sizeof(NavMeshTileEntry), entries.size(), pFile) == entries.size();
+    }
+    ok = (fclose(pFile) == 0) && ok;
+    return ok;
+}
+
+bool CLTNavMeshTileCache::Open(const char* pManifestFile)
+{
+    Close();
+    if (!pManifestFile) {
+        return false;
+    }
+
+    FILE* pFile = fopen(pManifestFile, "rb");
+    if (!pFile) {
+        return false;
+    }
+
+    NavMeshTileManifestHeader header;
+    std::vector<NavMeshTileEntry> entries;
+    bool ok = fread(&header, sizeof(header), 1, pFile) == 1 &&
+              header.magic == MANIFEST_MAGIC && header.version >= 1 && header.version <= MANIFEST_VERSION &&
+              header.tileSize > 0.0f && header.tileSize <= FLT_MAX &&
+              std::fabs(header.originX) <= FLT_MAX && std::fabs(header.originZ) <= FLT_MAX;
+    if (ok) {
+        // Read entries in chunks so a corrupt count cannot force a huge allocation
+        const uint32_t CHUNK = 1024;
+        for (uint32_t read = 0; ok && read < header.tileCount; read += CHUNK) {
+            uint32_t n = std::min(CHUNK, header.tileCount - read);
+            size_t first = entries.size();
+            entries.resize(first + n);
+            ok = fread(&entries[first], sizeof(NavMeshTileEntry), n, pFile) == n;
+        }
+    }
+    fclose(pFile);
+    if (!ok) {
+        return false;
+    }
+
+    m_manifestFile = pManifestFile;
+    m_tileSize = header.tileSize;
+    m_originX = header.originX;
+    m_originZ = header.originZ;
+
+    for (const NavMeshTileEntry& entry : entries) {
+        uint32_t index = static_cast<uint32_t>(m_tiles.size());
+        if (!m_tileLookup.insert(std::make_pair(TileKey(entry.tileX, entry.tileZ), index)).second) {
+            Close();
+            return false;  // Duplicate tile
+        }
+
+        Tile tile;
+        tile.x = entry.tileX;
+        tile.z = entry.tileZ;
+        tile.imageSize = entry.imageSize;
+        tile.polyCount = entry.polyCount;
+        tile.lastUsed = 0;
+        m_tiles.push_back(tile);
+
+        if (index == 0) {
+            m_minTileX = m_maxTileX = tile.x;
+            m_minTileZ = m_maxTileZ = tile.z;
+        } else {
+            m_minTileX = std::min(m_minTileX, tile.x);
+            m_minTileZ = std::min(m_minTileZ, tile.z);
+            m_maxTileX = std::max(m_maxTileX, tile.x);
+            m_maxTileZ = std::max(m_maxTileZ, tile.z);
+        }
+    }
+
+    m_stop = false;
+    m_worker = std::thread(&CLTNavMeshTileCache::WorkerMain, this);
+    return true;
+}
+
+void CLTNavMeshTileCache::Close()
+{
+    if (m_worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_worker.join();
+    }
+
+    m_manifestFile.clear();
+    m_tiles.clear();
+    m_tileLookup.clear();
+    m_minTileX = m_minTileZ = 0;
+    m_maxTileX = m_maxTileZ = -1;
+    m_tick = 0;
+    m_requested.clear();
+
+    m_target.clear();
+    m_targetChanged = false;
+    m_pPublished.reset();
+    m_pPublishedClusters.reset();
+    m_publishedChanged = false;
+    m_resident.clear();
+    m_residentBytes = 0;
+    m_residentPolys = 0;
+}
+
+void CLTNavMeshTileCache::Update(const CLTVector* pPositions, uint32_t count)
+{
+    if (m_tiles.empty()) {
+        return;
+    }
+
+    ++m_tick;
+
+    // Tiles within the streaming radius of any agent are required
+    std::vector<uint32_t> target;
+    for (uint32_t i = 0; i < count; ++i) {
+        const CLTVector& pos = pPositions[i];
+        int32_t x0 = std::max(m_minTileX, CLTNavMeshData::GridCoord(pos.x - m_streamingRadius, m_originX, m_tileSize));
+        int32_t z0 = std::max(m_minTileZ, CLTNavMeshData::GridCoord(pos.z - m_streamingRadius, m_originZ, m_tileSize));
+        int32_t x1 = std::min(m_maxTileX, CLTNavMeshData::GridCoord(pos.x + m_streamingRadius, m_originX, m_tileSize));
+        int32_t z1 = std::min(m_maxTileZ, CLTNavMeshData::GridCoord(pos.z + m_streamingRadius, m_originZ, m_tileSize));
+
+        for (int32_t z = z0; z <= z1; ++z) {
+            for (int32_t x = x0; x <= x1; ++x) {
+                uint32_t tile = FindTile(x, z);
+                if (tile != CLTNavMeshData::INVALID_INDEX) {
+                    m_tiles[tile].lastUsed = m_tick;
+                    target.push_back(tile);
+                }
+            }
+        }
+    }
+
+    std::sort(target.begin(), target.end());
+    target.erase(std::unique(target.begin(), target.end()), target.end());
+
+    // Tiles are charged at the bytes per polygon measured on the latest
+    // snapshot; the file size stands in until there is one
+    size_t bytesPerPoly = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_residentPolys > 0) {
+            bytesPerPoly = (m_residentBytes + m_residentPolys - 1) / m_residentPolys;
+        }
+    }
+    auto tileBytes = [this, bytesPerPoly](uint32_t tile) -> size_t {
+        return bytesPerPoly > 0 ? m_tiles[tile].polyCount * bytesPerPoly : m_tiles[tile].imageSize;
+    };
+
+    size_t bytes = 0;
+    for (uint32_t tile : target) {
+        bytes += tileBytes(tile);
+    }
+
+    // Idle tiles stay resident while they fit in the budget, most recently
+    // used first; whatever is left over is evicted
+    std::vector<uint32_t> idle;
+    for (uint32_t tile : m_requested) {
+        if (!std::binary_search(target.begin(), target.end(), tile)) {
+            idle.push_back(tile);
+        }
+    }
+    std::sort(idle.begin(), idle.end(), [this](uint32_t a, uint32_t b) {
+        return m_tiles[a].lastUsed > m_tiles[b].lastUsed;
+    });
+
+    size_t required = target.size();
+    for (uint32_t tile : idle) {
+        if (bytes + tileBytes(tile) <= m_memoryBudget) {
+            bytes += tileBytes(tile);
+            target.push_back(tile);
+        }
+    }
+
+    // The target is compared with the last one and binary searched by the
+    // worker, so the kept idle tiles go back into index order
+    std::sort(target.begin() + required, target.end());
+    std::inplace_merge(target.begin(), target.begin() + required, target.end());
+
+    if (target == m_requested) {
+        return;
+    }
+
+    m_requested = target;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_target.swap(target);
+        m_targetChanged = true;
+    }
+    m_wake.notify_one();
+}
+
+std::shared_ptr<CLTNavMeshData> CLTNavMeshTileCache::TakeUpdatedData(std::shared_ptr<CLTNavMeshClusterGraph>* pClusters,
+                                                                     std::vector<std::pair<int32_t, int32_t> >* pResidentTiles)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_publishedChanged) {
+        return std::shared_ptr<CLTNavMeshData>();
+    }
+
+    m_publishedChanged = false;
+    if (pClusters) {
+        *pClusters = m_pPublishedClusters;
+    }
+    if (pResidentTiles) {
+        pResidentTiles->clear();
+        for (uint32_t tile : m_resident) {
+            pResidentTiles->push_back(std::make_pair(m_tiles[tile].x, m_tiles[tile].z));
+        }
+        std::sort(pResidentTiles->begin(), pResidentTiles->end());
+    }
+    return m_pPublished;
+}
+
+uint32_t CLTNavMeshTileCache::GetResidentTileCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<uint32_t>(m_resident.size());
+}
+
+size_t CLTNavMeshTileCache::GetResidentBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_residentBytes;
+}
+
+std::string CLTNavMeshTileCache::TileFilename(const std::string& manifest, int32_t x, int32_t z)
+{
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%d_%d", x, z);
+    return manifest + suffix;
+}
+
+uint32_t CLTNavMeshTileCache::FindTile(int32_t x, int32_t z) const
+{
+    auto it = m_tileLookup.find(TileKey(x, z));
+    return it != m_tileLookup.end() ? it->second : CLTNavMeshData::INVALID_INDEX;
+}
+
+void CLTNavMeshTileCache::WorkerMain()
+{
+    std::shared_ptr<CLTNavMeshData> pCurrent = std::make_shared<CLTNavMeshData>();
+    std::shared_ptr<CLTNavMeshClusterGraph> pCurrentClusters;
+    std::vector<uint32_t> resident;
+
+    for (;;) {
+        std::vector<uint32_t> target;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_stop || m_targetChanged; });
+            if (m_stop) {
+                return;
+            }
+            target = m_target;
+            m_targetChanged = false;
+        }
+
+        if (target == resident) {
+            continue;
+        }
+
+        std::vector<uint32_t> kept;
+        std::vector<std::unique_ptr<CLTNavMeshData> > images;
+        std::vector<std::vector<uint32_t> > owned;
+        std::vector<uint32_t> loaded;
+        if (!LoadTiles(target, *pCurrent, resident, &kept, &images, &owned, &loaded)) {
+            continue;  // Shutting down, or superseded by a newer target
+        }
+
+        // Join the kept part of the current snapshot with the new tile
+        // images; external links between resident tiles become ordinary
+        // neighbours again
+        std::vector<CLTNavMeshData::JoinSource> sources;
+        CLTNavMeshData::JoinSource source = { pCurrent.get(), kept.data(), static_cast<uint32_t>(kept.size()) };
+        sources.push_back(source);
+        for (size_t i = 0; i < images.size(); ++i) {
+            CLTNavMeshData::JoinSource tileSource = { images[i].get(), owned[i].data(),
+                                                      static_cast<uint32_t>(owned[i].size()) };
+            sources.push_back(tileSource);
+        }
+
+        std::shared_ptr<CLTNavMeshData> pNext = std::make_shared<CLTNavMeshData>();
+        if (!pNext->Join(sources)) {
+            continue;  // Tiles disagree on polygon IDs; keep the previous snapshot
+        }
+        images.clear();
+
+        // The cluster graph is part of loading, so hierarchical searches
+        // never wait for it; clusters away from the changed tiles are reused
+        std::shared_ptr<CLTNavMeshClusterGraph> pClusters = std::make_shared<CLTNavMeshClusterGraph>();
+        pClusters->Build(pNext, 32.0f, pCurrentClusters.get());
+
+        pCurrent = pNext;
+        pCurrentClusters = pClusters;
+        resident = loaded;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pPublished = pNext;
+        m_pPublishedClusters = pClusters;
+        m_publishedChanged = true;
+        m_resident = resident;
+        m_residentBytes = pNext->GetMemoryUsage() + pClusters->GetMemoryUsage();
+        m_residentPolys = pNext->GetPolyCount();
+    }
+}
+
+bool CLTNavMeshTileCache::LoadTiles(const std::vector<uint32_t>& target, const CLTNavMeshData& current,
+                                    const std::vector<uint32_t>& resident, std::vector<uint32_t>* pKept,
+                                    std::vector<std::unique_ptr<CLTNavMeshData> >* pImages,
+                                    std::vector<std::vector<uint32_t> >* pOwned, std::vector<uint32_t>* pLoaded)
+{
+    // Polygons of tiles that stay resident are taken from the current snapshot
+    const uint32_t polyCount = current.GetPolyCount();
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        const CLTVector& center = current.GetCenter(i);
+        uint32_t tile = FindTile(CLTNavMeshData::GridCoord(center.x, m_originX, m_tileSize),
+                                 CLTNavMeshData::GridCoord(center.z, m_originZ, m_tileSize));
+        if (std::binary_search(target.begin(), target.end(), tile)) {
+            pKept->push_back(i);
+        }
+    }
+    for (uint32_t tile : resident) {
+        if (std::binary_search(target.begin(), target.end(), tile)) {
+            pLoaded->push_back(tile);
+        }
+    }
+
+    // Map newly required tiles from disk
+    for (uint32_t tile : target) {
+        if (std::binary_search(resident.begin(), resident.end(), tile)) {
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stop || m_targetChanged) {
+                return false;
+            }
+        }
+
+        std::unique_ptr<CLTNavMeshData> pData(new CLTNavMeshData());
+        if (!pData->LoadFromFile(TileFilename(m_manifestFile, m_tiles[tile].x, m_tiles[tile].z).c_str())) {
+            continue;  // Missing or corrupt tile; retried on the next target change
+        }
+
+        // Only polygons the tile actually owns, so eviction can find them again
+        std::vector<uint32_t> owned;
+        for (uint32_t i = 0; i < pData->GetPolyCount(); ++i) {
+            const CLTVector& center = pData->GetCenter(i);
+            if (CLTNavMeshData::GridCoord(center.x, m_originX, m_tileSize) == m_tiles[tile].x &&
+                CLTNavMeshData::GridCoord(center.z, m_originZ, m_tileSize) == m_tiles[tile].z) {
+                owned.push_back(i);
+            }
+        }
+        pImages->push_back(std::move(pData));
+        pOwned->push_back(std::move(owned));
+        pLoaded->push_back(tile);
+    }
+
+    std::sort(pLoaded->begin(), pLoaded->end());
+    return true;
+}
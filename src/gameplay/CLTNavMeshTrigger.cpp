@@ -0,0 +1,22 @@
+#include "../../include/gameplay/CLTNavMeshTrigger.h"
+#include <algorithm>
+
+CLTNavMeshTrigger::CLTNavMeshTrigger(const CLTVector& boxMin, const CLTVector& boxMax)
+    : m_min(std::min(boxMin.x, boxMax.x), std::min(boxMin.y, boxMax.y), std::min(boxMin.z, boxMax.z))
+    , m_max(std::max(boxMin.x, boxMax.x), std::max(boxMin.y, boxMax.y), std::max(boxMin.z, boxMax.z))
+{
+}
+
+uint32_t CLTNavMeshTrigger::DrainEvents(NavMeshTriggerEvent* pEvents, uint32_t maxEvents)
+{
+    uint32_t count = std::min(maxEvents, static_cast<uint32_t>(m_events.size()));
+    std::copy(m_events.begin(), m_events.begin() + count, pEvents);
+    m_events.erase(m_events.begin(), m_events.begin() + count);
+    return count;
+}
+
+void CLTNavMeshTrigger::PushEvent(uint32_t actorId, bool entered)
+{
+    NavMeshTriggerEvent event = { actorId, entered };
+    m_events.push_back(event);
+}
@@ -0,0 +1,218 @@
+/*
+ * Tiled build regression test for CLTNavMeshBuilder
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -pthread tests/gameplay/CLTNavMeshBuilderTest.cpp \
+ *       src/gameplay/CLTNavMeshBuilder.cpp src/gameplay/CLTNavMeshData.cpp \
+ *       -o navmesh_builder_test
+ *   ./navmesh_builder_test
+ *
+ * A 20x10 floor spans two 10-unit tiles. A wall across the middle leaves
+ * gaps at both ends, a low step sits in the second tile and a platform
+ * too high to climb in the first. The built mesh must link polygons
+ * across the tile seam both ways, leave the platform unreachable from
+ * the floor and the step reachable, and connect the two ends of the
+ * world around the wall. After the step moves and only its tile is
+ * rebuilt, the other tile's polygons must keep their IDs.
+ */
+
+#include "../../include/gameplay/CLTNavMeshBuilder.h"
+#include "../../include/gameplay/CLTNavMeshData.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+static const float TILE_SIZE = 10.0f;
+static const float STEP_HEIGHT = 0.4f;
+static const float PLATFORM_HEIGHT = 1.5f;
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* pWhat)
+{
+    if (!condition) {
+        printf("FAIL: %s\n", pWhat);
+        ++s_failures;
+    }
+}
+
+struct Geometry {
+    std::vector<CLTVector> vertices;
+    std::vector<uint32_t> indices;
+
+    void AddQuad(const CLTVector& a, const CLTVector& b, const CLTVector& c, const CLTVector& d) {
+        const uint32_t first = static_cast<uint32_t>(vertices.size());
+        vertices.push_back(a);
+        vertices.push_back(b);
+        vertices.push_back(c);
+        vertices.push_back(d);
+        const uint32_t corners[] = { 0, 1, 2, 0, 2, 3 };
+        for (uint32_t corner : corners) {
+            indices.push_back(first + corner);
+        }
+    }
+
+    // Top and sides of a box standing on the floor
+    void AddBox(float x0, float z0, float x1, float z1, float height) {
+        AddQuad(CLTVector(x0, height, z0), CLTVector(x0, height, z1), CLTVector(x1, height, z1), CLTVector(x1, height, z0));
+        AddQuad(CLTVector(x0, 0.0f, z0), CLTVector(x0, height, z0), CLTVector(x1, height, z0), CLTVector(x1, 0.0f, z0));
+        AddQuad(CLTVector(x0, 0.0f, z1), CLTVector(x0, height, z1), CLTVector(x1, height, z1), CLTVector(x1, 0.0f, z1));
+        AddQuad(CLTVector(x0, 0.0f, z0), CLTVector(x0, height, z0), CLTVector(x0, height, z1), CLTVector(x0, 0.0f, z1));
+        AddQuad(CLTVector(x1, 0.0f, z0), CLTVector(x1, height, z0), CLTVector(x1, height, z1), CLTVector(x1, 0.0f, z1));
+    }
+};
+
+static Geometry BuildWorld(float stepX)
+{
+    Geometry geometry;
+    geometry.AddQuad(CLTVector(0.0f, 0.0f, 0.0f), CLTVector(0.0f, 0.0f, 10.0f),
+                     CLTVector(20.0f, 0.0f, 10.0f), CLTVector(20.0f, 0.0f, 0.0f));
+    geometry.AddBox(3.0f, 4.75f, 17.0f, 5.25f, 3.0f);
+    geometry.AddBox(stepX, 7.0f, stepX + 3.0f, 10.0f, STEP_HEIGHT);
+    geometry.AddBox(4.0f, 7.0f, 7.0f, 10.0f, PLATFORM_HEIGHT);
+    return geometry;
+}
+
+static uint32_t TileOf(uint32_t id)
+{
+    return id >> 16;
+}
+
+static bool Links(const NavMeshPoly& poly, uint32_t id)
+{
+    return std::find(poly.neighbors.begin(), poly.neighbors.end(), id) != poly.neighbors.end();
+}
+
+// Polygon containing an XZ point at about the given height; a step merges
+// into the floor around it, so its polygons may lie anywhere in between
+static const NavMeshPoly* FindPoly(const std::vector<NavMeshPoly>& polygons, float x, float y, float z)
+{
+    for (const NavMeshPoly& poly : polygons) {
+        if (std::fabs(poly.center.y - y) < STEP_HEIGHT + 0.1f &&
+            CLTNavMeshData::PointInPolygon(poly.vertices.data(), static_cast<uint32_t>(poly.vertices.size()), x, z)) {
+            return &poly;
+        }
+    }
+    return nullptr;
+}
+
+// Checks links across the seam and between heights, and the end to end path
+static void CheckMesh(const std::vector<NavMeshPoly>& polygons, float stepX)
+{
+    std::map<uint32_t, const NavMeshPoly*> byId;
+    for (const NavMeshPoly& poly : polygons) {
+        Check(byId.insert(std::make_pair(poly.id, &poly)).second, "polygon IDs unique");
+        Check((poly.id & 0xFFFF) != 0 && (poly.id & 0xFFFF) <= CLTNavMeshBuilder::MAX_TILE_POLYS, "polygon ID in tile range");
+    }
+
+    uint32_t seamLinks = 0;
+    for (const NavMeshPoly& poly : polygons) {
+        for (uint32_t id : poly.neighbors) {
+            auto it = byId.find(id);
+            Check(it != byId.end(), "link to a polygon of the mesh");
+            if (it == byId.end()) {
+                continue;
+            }
+            const NavMeshPoly& other = *it->second;
+            Check(Links(other, poly.id), "link one way only");
+            if (TileOf(id) != TileOf(poly.id)) {
+                ++seamLinks;
+            }
+            Check(std::fabs(other.center.y - poly.center.y) < PLATFORM_HEIGHT - 0.3f, "platform linked to the floor");
+        }
+    }
+    Check(seamLinks >= 4, "too few links across the tile seam");
+
+    // The platform and step tops are there, and the step keeps its tile
+    const NavMeshPoly* pPlatform = FindPoly(polygons, 5.5f, PLATFORM_HEIGHT, 8.5f);
+    const NavMeshPoly* pStep = FindPoly(polygons, stepX + 1.5f, STEP_HEIGHT, 8.5f);
+    Check(pPlatform != nullptr, "platform top missing");
+    Check(pStep != nullptr && TileOf(pStep->id) == (stepX < TILE_SIZE ? 0u : 1u), "step top missing");
+
+    // Walk the links from one end of the world to the other, around the wall
+    const NavMeshPoly* pStart = FindPoly(polygons, 1.5f, 0.0f, 1.5f);
+    const NavMeshPoly* pEnd = FindPoly(polygons, 18.5f, 0.0f, 8.5f);
+    Check(pStart && pEnd, "end polygons missing");
+    if (!pStart || !pEnd) {
+        return;
+    }
+    std::map<uint32_t, bool> seen;
+    std::vector<const NavMeshPoly*> stack(1, pStart);
+    seen[pStart->id] = true;
+    while (!stack.empty()) {
+        const NavMeshPoly* pPoly = stack.back();
+        stack.pop_back();
+        for (uint32_t id : pPoly->neighbors) {
+            auto it = byId.find(id);
+            if (it != byId.end() && !seen[id]) {
+                seen[id] = true;
+                stack.push_back(it->second);
+            }
+        }
+    }
+    Check(seen[pEnd->id], "no path from one end of the world to the other");
+    Check(!pPlatform || !seen[pPlatform->id], "platform reachable from the floor");
+    Check(!pStep || seen[pStep->id], "step not reachable from the floor");
+}
+
+int main()
+{
+    NavMeshBuildConfig config;
+    config.cellSize = 0.25f;
+    config.cellHeight = 0.1f;
+    config.tileSize = static_cast<int>(TILE_SIZE / config.cellSize);
+    config.agentRadius = 0.5f;
+    config.maxEdgeError = 0.5f;     // The platform top is too small to keep at the default
+    config.threadCount = 2;
+
+    CLTNavMeshBuilder builder;
+    Check(builder.SetConfig(config), "config accepted");
+    Geometry world = BuildWorld(12.0f);
+    Check(builder.SetGeometry(world.vertices.data(), static_cast<uint32_t>(world.vertices.size()),
+                              world.indices.data(), static_cast<uint32_t>(world.indices.size() / 3)),
+          "geometry accepted");
+    Check(builder.GetTilesX() == 2 && builder.GetTilesZ() == 1, "two tiles");
+
+    std::vector<NavMeshPoly> before;
+    Check(builder.Build(&before), "build");
+    CheckMesh(before, 12.0f);
+    CLTNavMeshData navData;
+    Check(navData.Build(before), "polygons compile");
+
+    // Move the step within the second tile and rebuild only that tile
+    Geometry moved = BuildWorld(14.0f);
+    Check(builder.SetGeometry(moved.vertices.data(), static_cast<uint32_t>(moved.vertices.size()),
+                              moved.indices.data(), static_cast<uint32_t>(moved.indices.size() / 3)),
+          "moved geometry accepted");
+    Check(builder.BuildTiles(1, 0, 1, 0), "rebuild");
+    std::vector<NavMeshPoly> after;
+    builder.GetPolygons(&after);
+    CheckMesh(after, 14.0f);
+
+    std::map<uint32_t, const NavMeshPoly*> afterById;
+    for (const NavMeshPoly& poly : after) {
+        afterById[poly.id] = &poly;
+    }
+    uint32_t kept = 0;
+    for (const NavMeshPoly& poly : before) {
+        if (TileOf(poly.id) != 0) {
+            continue;
+        }
+        auto it = afterById.find(poly.id);
+        Check(it != afterById.end() && it->second->vertices.size() == poly.vertices.size() &&
+              std::equal(poly.vertices.begin(), poly.vertices.end(), it->second->vertices.begin(),
+                         [](const CLTVector& a, const CLTVector& b) { return a.x == b.x && a.y == b.y && a.z == b.z; }),
+              "polygon of the untouched tile changed");
+        ++kept;
+    }
+    Check(kept > 0, "first tile empty");
+
+    if (s_failures == 0) {
+        printf("PASS\n");
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,137 @@
+/*
+ * One-way link regression test for CLTNavMeshClusterGraph
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 tests/gameplay/CLTNavMeshClusterGraphTest.cpp \
+ *       src/gameplay/CLTNavMeshData.cpp src/gameplay/CLTNavMeshClusterGraph.cpp \
+ *       -o cluster_graph_test
+ *   ./cluster_graph_test
+ *
+ * Hierarchical corridors must only follow links in the direction they
+ * exist. A one-way chain must not be walked backwards, and on a mesh
+ * mixing one-way and two-way links FindCorridor() must find a corridor
+ * exactly when one exists, made only of real links.
+ */
+
+#include "../../include/gameplay/CLTNavMeshClusterGraph.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+#include "CLTNavMeshTestGrid.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+static const float CLUSTER_SIZE = 2.0f;
+static const int ROW_LENGTH = 8;
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* pWhat, uint32_t start, uint32_t end)
+{
+    if (!condition) {
+        printf("FAIL %u -> %u: %s\n", start, end, pWhat);
+        ++s_failures;
+    }
+}
+
+// Chain 1 -> 2 -> 3 -> 4 of one-way links along X
+static std::vector<NavMeshPoly> BuildChain()
+{
+    return BuildGrid(4, 1, std::vector<bool>(), [](int x, int, int toX, int) { return toX > x; });
+}
+
+// Two rows: the lower one runs one-way east, the upper one both ways.
+// Even columns lead up, odd columns lead down.
+static std::vector<NavMeshPoly> BuildLanes()
+{
+    return BuildGrid(ROW_LENGTH, 2, std::vector<bool>(), [](int x, int z, int toX, int toZ) {
+        return toZ == z ? z == 1 || toX > x : (x % 2 == 0) == (z == 0);
+    });
+}
+
+// Polygons reachable from start over outgoing links
+static std::vector<bool> Reachable(const CLTNavMeshData& navData, uint32_t start)
+{
+    std::vector<bool> seen(navData.GetPolyCount(), false);
+    std::vector<uint32_t> stack(1, start);
+    seen[start] = true;
+    while (!stack.empty()) {
+        uint32_t poly = stack.back();
+        stack.pop_back();
+        uint32_t neighborCount;
+        const uint32_t* neighbors = navData.GetNeighbors(poly, &neighborCount);
+        for (uint32_t n = 0; n < neighborCount; ++n) {
+            if (!seen[neighbors[n]]) {
+                seen[neighbors[n]] = true;
+                stack.push_back(neighbors[n]);
+            }
+        }
+    }
+    return seen;
+}
+
+static void CheckAllPairs(const std::vector<NavMeshPoly>& polygons)
+{
+    std::shared_ptr<CLTNavMeshData> pNavData(new CLTNavMeshData());
+    CLTNavMeshClusterGraph graph;
+    if (!pNavData->Build(polygons) || !graph.Build(pNavData, CLUSTER_SIZE)) {
+        Check(false, "build", 0, 0);
+        return;
+    }
+
+    const CLTNavMeshData& navData = *pNavData;
+    std::vector<uint32_t> corridor;
+    for (uint32_t start = 0; start < navData.GetPolyCount(); ++start) {
+        std::vector<bool> reachable = Reachable(navData, start);
+        for (uint32_t end = 0; end < navData.GetPolyCount(); ++end) {
+            CLTNavMeshClusterGraph::SearchResult result = graph.FindCorridor(start, end, 1024, &corridor);
+            uint32_t startId = navData.GetId(start);
+            uint32_t endId = navData.GetId(end);
+            if (!reachable[end]) {
+                Check(result == CLTNavMeshClusterGraph::SEARCH_NO_PATH, "corridor to an unreachable polygon",
+                      startId, endId);
+                continue;
+            }
+
+            Check(result == CLTNavMeshClusterGraph::SEARCH_FOUND, "no corridor to a reachable polygon",
+                  startId, endId);
+            if (result != CLTNavMeshClusterGraph::SEARCH_FOUND) {
+                continue;
+            }
+            Check(!corridor.empty() && corridor.front() == start && corridor.back() == end,
+                  "corridor does not join start and end", startId, endId);
+            for (size_t i = 1; i < corridor.size(); ++i) {
+                uint32_t neighborCount;
+                const uint32_t* neighbors = navData.GetNeighbors(corridor[i - 1], &neighborCount);
+                Check(std::find(neighbors, neighbors + neighborCount, corridor[i]) != neighbors + neighborCount,
+                      "corridor step against a link", startId, endId);
+            }
+        }
+    }
+}
+
+int main()
+{
+    // The chain by itself: forwards only
+    std::shared_ptr<CLTNavMeshData> pChain(new CLTNavMeshData());
+    CLTNavMeshClusterGraph chainGraph;
+    pChain->Build(BuildChain());
+    chainGraph.Build(pChain, CLUSTER_SIZE);
+
+    std::vector<uint32_t> corridor;
+    Check(chainGraph.FindCorridor(1, 0, 1024, &corridor) == CLTNavMeshClusterGraph::SEARCH_NO_PATH,
+          "chain walked backwards inside the end cluster", 2, 1);
+    Check(chainGraph.FindCorridor(3, 0, 1024, &corridor) == CLTNavMeshClusterGraph::SEARCH_NO_PATH,
+          "chain walked backwards across clusters", 4, 1);
+    Check(chainGraph.FindCorridor(0, 3, 1024, &corridor) == CLTNavMeshClusterGraph::SEARCH_FOUND &&
+          corridor.size() == 4, "chain not walked forwards", 1, 4);
+
+    CheckAllPairs(BuildChain());
+    CheckAllPairs(BuildLanes());
+
+    if (s_failures == 0) {
+        printf("PASS\n");
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,317 @@
+/*
+ * Loader fuzz test for CLTNavMeshData
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O1 -g -fsanitize=address,undefined \
+ *       tests/gameplay/CLTNavMeshDataFuzzTest.cpp src/gameplay/CLTNavMeshData.cpp \
+ *       -o navmesh_fuzz_test
+ *   ./navmesh_fuzz_test [iterations] [scratch directory]
+ *
+ * Valid images of every supported file version are mutated (bit flips,
+ * random bytes, boundary values written over header, section table and
+ * data, truncation and trailing garbage) and handed to AttachMemory(),
+ * and every 16th one to LoadFromFile(). Rejection is fine; an image that
+ * is accepted must keep every index in range, and every accessor is then
+ * called on every polygon and grid cell, so run it under the sanitizers.
+ * The sequence is fixed, so failures reproduce.
+ */
+
+#include "../../include/gameplay/CLTNavMeshData.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+#include "CLTNavMeshTestGrid.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static const int GRID_SIZE = 6;
+static const int DEFAULT_ITERATIONS = 20000;
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* pWhat, int iteration)
+{
+    if (!condition) {
+        printf("FAIL iteration %d: %s\n", iteration, pWhat);
+        ++s_failures;
+    }
+}
+
+// A floor of unit quads with a smaller floor stacked above its middle, so
+// the layered cell tables are not empty. The last quad links to a polygon
+// outside the mesh.
+static std::vector<NavMeshPoly> BuildPolys(bool externalLink)
+{
+    std::vector<NavMeshPoly> polygons = BuildGrid(GRID_SIZE, GRID_SIZE);
+    for (NavMeshPoly poly : BuildGrid(2, 2)) {
+        poly.id += 999;
+        for (uint32_t& neighbor : poly.neighbors) {
+            neighbor += 999;
+        }
+        for (CLTVector& vertex : poly.vertices) {
+            vertex += CLTVector(2.0f, 3.0f, 2.0f);
+        }
+        poly.center += CLTVector(2.0f, 3.0f, 2.0f);
+        poly.height = 3.0f;
+        poly.area = CLTNavMeshSystem::AREA_INDOORS;
+        polygons.push_back(poly);
+    }
+    if (externalLink) {
+        polygons.back().neighbors.push_back(5000);
+    }
+    return polygons;
+}
+
+// Valid images to start from: the current version, and the layouts older
+// versions accept (their extra sections are ignored)
+static std::vector<std::vector<uint8_t> > BuildSeeds()
+{
+    std::vector<std::vector<uint8_t> > seeds;
+    const struct {
+        uint32_t version;
+        bool externalLink;
+        uint32_t landmarkCount;
+    } variants[] = {
+        { CLTNavMeshData::FILE_VERSION, true, 4 },
+        { 4, true, 4 },
+        { 3, true, 0 },
+        { 2, true, 0 },
+        { 1, false, 0 },
+    };
+    for (const auto& variant : variants) {
+        CLTNavMeshData navData;
+        navData.Build(BuildPolys(variant.externalLink), variant.landmarkCount);
+        size_t size;
+        const uint8_t* pImage = static_cast<const uint8_t*>(navData.GetImage(&size));
+        std::vector<uint8_t> seed(pImage, pImage + size);
+        NavMeshFileHeader header;
+        memcpy(&header, seed.data(), sizeof(header));
+        header.version = variant.version;
+        if (variant.version < CLTNavMeshData::FILE_VERSION) {
+            header.sampleReach = 0.0f;
+        }
+        memcpy(seed.data(), &header, sizeof(header));
+        seeds.push_back(seed);
+    }
+
+    CLTNavMeshData empty;
+    size_t size;
+    const uint8_t* pImage = static_cast<const uint8_t*>(empty.GetImage(&size));
+    seeds.push_back(std::vector<uint8_t>(pImage, pImage + size));
+    return seeds;
+}
+
+static void Mutate(std::mt19937& rng, std::vector<uint8_t>* pImage)
+{
+    static const uint32_t INTERESTING[] = {
+        0, 1, 2, 3, 4, 7, 8, 15, 16, 0x7F, 0x80, 0xFF, 0x100, 0xFFFF, 0x10000,
+        0x7FFFFFFF, 0x80000000, 0xFFFFFFFE, 0xFFFFFFFF,
+        0x7F800000 /* +inf */, 0xFF800000 /* -inf */, 0x7FC00000 /* NaN */, 0x4B800000 /* 2^24 */
+    };
+    const size_t headerEnd = sizeof(NavMeshFileHeader) + CLTNavMeshData::SECTION_COUNT * sizeof(NavMeshFileSection);
+
+    std::vector<uint8_t>& image = *pImage;
+    const int mutations = 1 + static_cast<int>(rng() % 8);
+    for (int m = 0; m < mutations && !image.empty(); ++m) {
+        // Half of the mutations hit the header and section table
+        const size_t limit = rng() % 2 == 0 ? std::min(headerEnd, image.size()) : image.size();
+        const size_t at = rng() % limit;
+        switch (rng() % 6) {
+        case 0:
+            image[at] ^= static_cast<uint8_t>(1u << (rng() % 8));
+            break;
+        case 1:
+            image[at] = static_cast<uint8_t>(rng());
+            break;
+        case 2:
+        case 3: {
+            uint32_t value = INTERESTING[rng() % (sizeof(INTERESTING) / sizeof(INTERESTING[0]))];
+            if (rng() % 4 == 0) {
+                value = static_cast<uint32_t>(image.size() + (rng() % 64)) - 32;
+            }
+            const size_t word = (at & ~static_cast<size_t>(3));
+            if (word + sizeof(value) <= image.size()) {
+                memcpy(&image[word], &value, sizeof(value));
+            }
+            break;
+        }
+        case 4: {
+            // Truncate, and sometimes make the header agree with the new size
+            image.resize(rng() % image.size());
+            if (rng() % 2 == 0 && image.size() >= sizeof(NavMeshFileHeader)) {
+                const uint32_t size = static_cast<uint32_t>(image.size());
+                memcpy(&image[offsetof(NavMeshFileHeader, fileSize)], &size, sizeof(size));
+            }
+            break;
+        }
+        default:
+            for (uint32_t i = rng() % 64; i > 0; --i) {
+                image.push_back(static_cast<uint8_t>(rng()));
+            }
+            break;
+        }
+    }
+}
+
+static bool CountVisit(const NavMeshPolyView& poly, void* pUserData)
+{
+    *static_cast<uint32_t*>(pUserData) += poly.vertexCount;
+    return true;
+}
+
+// Calls every accessor on an accepted mesh and checks the indices it hands out
+static void Exercise(const CLTNavMeshData& navData, int iteration)
+{
+    const uint32_t polyCount = navData.GetPolyCount();
+    volatile float sink = 0.0f;
+    uint32_t visited = 0;
+
+    size_t imageSize;
+    Check(navData.GetImage(&imageSize) != nullptr && imageSize == navData.GetMemoryUsage(),
+          "image size", iteration);
+
+    uint32_t externalLinks = 0;
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        Check(navData.GetIndex(navData.GetId(i)) == i, "ID lookup", iteration);
+
+        NavMeshPolyView view = navData.GetPoly(i);
+        NavMeshPoly copy;
+        navData.CopyPoly(i, &copy);
+        Check(copy.vertices.size() == view.vertexCount, "copied vertices", iteration);
+        Check(view.vertexCount <= CLTNavMeshData::MAX_POLY_VERTICES, "vertex limit", iteration);
+        for (uint32_t n = 0; n < view.neighborCount; ++n) {
+            Check(view.neighbors[n] < polyCount, "neighbour in range", iteration);
+        }
+
+        uint32_t linkCount;
+        navData.GetExternalLinks(i, &linkCount);
+        externalLinks += linkCount;
+
+        const float* bounds = navData.GetBounds(i);
+        const CLTVector& center = navData.GetCenter(i);
+        sink = sink + bounds[0] + bounds[3] + navData.GetHeight(i) + navData.GetFlags(i) + navData.GetArea(i);
+        sink = sink + navData.DistanceSquaredToEdges(i, center.x, center.z);
+        sink = sink + (navData.ContainsPoint(i, center.x, center.z) ? 1.0f : 0.0f);
+        sink = sink + navData.GetPolyArea(i);
+        sink = sink + navData.GetPointInPoly(i, 0.25f, 0.5f, 0.75f).y;
+        sink = sink + navData.GetPointHeight(i, center.x, center.z);
+        for (uint32_t n = 0; n < view.neighborCount; ++n) {
+            CLTVector left, right;
+            navData.GetPortal(i, view.neighbors[n], &left, &right);
+        }
+
+        uint8_t inside[2];
+        uint32_t pair[2] = { i, polyCount - 1 - i };
+        navData.ContainsPointBatch(center.x, center.z, pair, 2, inside);
+
+        if (navData.GetLandmarkCount() > 0) {
+            sink = sink + navData.GetLandmarkBound(navData.GetLandmarkDistances(i),
+                                                   navData.GetLandmarkDistances(pair[1]));
+        }
+        navData.QueryPolygons(NavMeshRegion::Sphere(center, 1.5f), CountVisit, &visited);
+        navData.QueryBounds(bounds[0], bounds[1], bounds[2], bounds[3], CountVisit, &visited);
+    }
+    Check(externalLinks == navData.GetExternalLinkCount(), "external link count", iteration);
+    for (uint32_t l = 0; l < navData.GetLandmarkCount(); ++l) {
+        sink = sink + static_cast<float>(navData.GetLandmarkId(l));
+    }
+
+    // Grid cells and sampling tables
+    const int width = navData.GetGridWidth();
+    const int height = navData.GetGridHeight();
+    for (int cz = 0; cz < height; ++cz) {
+        for (int cx = 0; cx < width; ++cx) {
+            uint32_t count;
+            const uint32_t* polys = navData.GetCellPolys(cx, cz, &count);
+            for (uint32_t p = 0; p < count; ++p) {
+                Check(polys[p] < polyCount, "cell polygon in range", iteration);
+            }
+            double area = navData.GetSampleArea(cx, cz, cx, cz);
+            sink = sink + (navData.HasOverlappingPolys(0, 0, cx, cz) ? 1.0f : 0.0f);
+            uint32_t picked = navData.PickPolygon(cx, cz, cx, cz, area * 0.5);
+            Check(picked == CLTNavMeshData::INVALID_INDEX || picked < polyCount, "picked polygon in range", iteration);
+        }
+    }
+    if (width > 0 && height > 0) {
+        double area = navData.GetSampleArea(0, 0, width - 1, height - 1);
+        for (int i = 0; i <= 8; ++i) {
+            uint32_t picked = navData.PickPolygon(0, 0, width - 1, height - 1, area * i / 8.0);
+            Check(picked == CLTNavMeshData::INVALID_INDEX || picked < polyCount, "picked polygon in range", iteration);
+        }
+    }
+    int cellX, cellZ;
+    navData.GetCellCoords(0.5f, 0.5f, &cellX, &cellZ);
+    navData.GetCellCoords(-1.0e30f, 1.0e30f, &cellX, &cellZ);
+    navData.QueryPolygons(NavMeshRegion::Box(CLTVector(-1.0e6f, -1.0e6f, -1.0e6f), CLTVector(1.0e6f, 1.0e6f, 1.0e6f)),
+                          CountVisit, &visited);
+    sink = sink + navData.GetSampleReach() + navData.GetCellSize() + static_cast<float>(visited);
+
+    // Joining copies straight out of the image
+    std::vector<uint32_t> all(polyCount);
+    for (uint32_t i = 0; i < polyCount; ++i) {
+        all[i] = i;
+    }
+    CLTNavMeshData::JoinSource source = { &navData, all.data(), polyCount };
+    CLTNavMeshData joined;
+    if (joined.Join(std::vector<CLTNavMeshData::JoinSource>(1, source))) {
+        Check(joined.GetPolyCount() == polyCount, "joined polygon count", iteration);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    const std::string scratch = std::string(argc > 2 ? argv[2] : ".") + "/navmesh_fuzz_test.nav";
+
+    const std::vector<std::vector<uint8_t> > seeds = BuildSeeds();
+    for (size_t s = 0; s < seeds.size(); ++s) {
+        std::vector<uint64_t> aligned((seeds[s].size() + 7) / 8);
+        memcpy(aligned.data(), seeds[s].data(), seeds[s].size());
+        CLTNavMeshData navData;
+        Check(navData.AttachMemory(aligned.data(), seeds[s].size()), "unmodified seed is accepted", -static_cast<int>(s) - 1);
+        Exercise(navData, -static_cast<int>(s) - 1);
+    }
+
+    std::mt19937 rng(12345);
+    int accepted = 0;
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        std::vector<uint8_t> image = seeds[rng() % seeds.size()];
+        Mutate(rng, &image);
+
+        // Copy into 8-byte aligned memory, as a mapping would be
+        std::vector<uint64_t> aligned((image.size() + 7) / 8 + 1);
+        memcpy(aligned.data(), image.data(), image.size());
+
+        CLTNavMeshData navData;
+        if (navData.AttachMemory(aligned.data(), image.size())) {
+            ++accepted;
+            Exercise(navData, iteration);
+        }
+
+        if (iteration % 16 == 0) {
+            FILE* pFile = fopen(scratch.c_str(), "wb");
+            if (!pFile) {
+                printf("FAIL: could not write %s\n", scratch.c_str());
+                return 1;
+            }
+            fwrite(image.data(), 1, image.size(), pFile);
+            fclose(pFile);
+
+            CLTNavMeshData loaded;
+            if (loaded.LoadFromFile(scratch.c_str())) {
+                Exercise(loaded, iteration);
+            }
+        }
+    }
+    remove(scratch.c_str());
+
+    printf("%d of %d mutated images accepted\n", accepted, iterations);
+    if (s_failures == 0) {
+        printf("PASS\n");
+    }
+    return s_failures == 0 ? 0 : 1;
+}
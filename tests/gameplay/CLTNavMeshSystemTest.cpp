@@ -0,0 +1,660 @@
+/*
+ * System-level regression tests for CLTNavMeshSystem
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -pthread tests/gameplay/CLTNavMeshSystemTest.cpp \
+ *       src/gameplay/CLTNavMeshSystem.cpp src/gameplay/CLTNavMeshData.cpp \
+ *       src/gameplay/CLTNavMeshQuery.cpp src/gameplay/CLTNavMeshPath.cpp \
+ *       src/gameplay/CLTNavMeshNodeQueue.cpp src/gameplay/CLTNavMeshNodePool.cpp \
+ *       src/gameplay/CLTNavMeshClusterGraph.cpp src/gameplay/CLTNavMeshPathCache.cpp \
+ *       src/gameplay/CLTNavMeshPathQueue.cpp src/gameplay/CLTNavMeshFlowField.cpp \
+ *       src/gameplay/CLTNavMeshTileCache.cpp src/gameplay/CLTNavMeshTrigger.cpp \
+ *       src/core/CLTBaseClass.cpp -o navmesh_system_test
+ *   ./navmesh_system_test
+ *
+ * Each test sets up a small world through the public interface and checks
+ * what a caller would see. Random positions use a fixed seed, so failures
+ * reproduce.
+ */
+
+#include "../../include/gameplay/CLTNavMeshData.h"
+#include "../../include/gameplay/CLTNavMeshFlowField.h"
+#include "../../include/gameplay/CLTNavMeshPath.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+#include "../../include/gameplay/CLTNavMeshTrigger.h"
+#include "CLTNavMeshTestGrid.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* pTest, const char* pWhat)
+{
+    if (!condition) {
+        printf("FAIL %s: %s\n", pTest, pWhat);
+        ++s_failures;
+    }
+}
+
+// The engine's console variables; the navmesh system only reads debug switches
+float GetParameter(const char* pName, float defaultValue)
+{
+    return defaultValue;
+}
+
+// Options for exact searches: no limits, and corners kept where they are
+static CLTNavMeshSystem::PathFindOptions ExactOptions()
+{
+    CLTNavMeshSystem::PathFindOptions options;
+    options.maxIterations = 0xFFFFFFFF;
+    options.maxNodes = 0xFFFFFFFF;
+    options.maxDistance = 0.0f;
+    options.straightPathTolerance = 0.0f;
+    options.optimizePath = true;
+    options.areaFlags = CLTNavMeshSystem::AREA_ALL;
+    options.excludedAreaFlags = 0;
+    options.timeout = 0.0f;
+    options.hierarchical = false;
+    return options;
+}
+
+static NavMeshPoly MakeRect(uint32_t id, float x0, float z0, float x1, float z1, float y)
+{
+    NavMeshPoly poly;
+    poly.id = id;
+    poly.vertices.push_back(CLTVector(x0, y, z0));
+    poly.vertices.push_back(CLTVector(x0, y, z1));
+    poly.vertices.push_back(CLTVector(x1, y, z1));
+    poly.vertices.push_back(CLTVector(x1, y, z0));
+    poly.center = CLTVector((x0 + x1) * 0.5f, y, (z0 + z1) * 0.5f);
+    poly.height = y;
+    poly.flags = 0;
+    poly.area = CLTNavMeshSystem::AREA_WALKABLE;
+    return poly;
+}
+
+// A floor of 20x20 polygons with a bridge 4 units up over x 40 to 50.
+// Where floors overlap, random positions must still be found next to
+// the bridge however small the radius, and split evenly between floors
+// the sphere reaches equally.
+static void TestRandomPositionNearBridge()
+{
+    const char* pTest = "random position near a bridge";
+    std::vector<NavMeshPoly> polygons;
+    for (int z = 0; z < 3; ++z) {
+        for (int x = 0; x < 5; ++x) {
+            polygons.push_back(MakeRect(static_cast<uint32_t>(z * 5 + x + 1),
+                                        x * 20.0f, z * 20.0f, x * 20.0f + 20.0f, z * 20.0f + 20.0f, 0.0f));
+        }
+    }
+    polygons.push_back(MakeRect(100, 40.0f, 0.0f, 50.0f, 60.0f, 4.0f));
+
+    CLTNavMeshSystem system;
+    system.Init();
+    Check(system.SetNavMeshData(polygons), pTest, "mesh builds");
+    CLTNavMeshSystem::SeedRandom(1);
+
+    const CLTVector beside(35.0f, 0.0f, 30.0f);
+    const float radii[] = { 0.5f, 1.0f, 2.0f, 6.0f };
+    for (float radius : radii) {
+        int found = 0, inside = 0;
+        for (int i = 0; i < 1000; ++i) {
+            CLTVector pos;
+            if (system.GetRandomPosition(beside, radius, &pos)) {
+                ++found;
+                inside += pos.Distance(beside) <= radius + 1.0e-4f && pos.y == 0.0f;
+            }
+        }
+        Check(found == 1000, pTest, "position not found beside the bridge");
+        Check(inside == found, pTest, "position outside the sphere or off the floor");
+    }
+
+    // Halfway between the floor and the bridge both get the same area
+    const CLTVector between(45.0f, 2.0f, 30.0f);
+    int onBridge = 0, found = 0;
+    for (int i = 0; i < 4000; ++i) {
+        CLTVector pos;
+        if (system.GetRandomPosition(between, 3.0f, &pos)) {
+            ++found;
+            onBridge += pos.y == 4.0f;
+        }
+    }
+    Check(found == 4000, pTest, "position not found under the bridge");
+    Check(std::fabs(onBridge / 4000.0 - 0.5) < 0.04, pTest, "floors not sampled evenly");
+}
+
+// One large polygon beside sixteen small ones of the same total area:
+// positions must be spread by area, not by polygon, both over the whole
+// mesh and within a sphere cutting through both halves
+static void TestRandomPositionUniform()
+{
+    const char* pTest = "random position spread by area";
+    std::vector<NavMeshPoly> polygons;
+    polygons.push_back(MakeRect(1, 0.0f, 0.0f, 8.0f, 8.0f, 0.0f));
+    for (int z = 0; z < 4; ++z) {
+        for (int x = 0; x < 4; ++x) {
+            polygons.push_back(MakeRect(static_cast<uint32_t>(2 + z * 4 + x), 8.0f + x * 2.0f, z * 2.0f,
+                                        10.0f + x * 2.0f, z * 2.0f + 2.0f, 0.0f));
+        }
+    }
+    CLTNavMeshSystem system;
+    system.Init();
+    Check(system.SetNavMeshData(polygons), pTest, "mesh builds");
+    CLTNavMeshSystem::SeedRandom(3);
+
+    const CLTVector center(8.0f, 0.0f, 4.0f);
+    const float radii[] = { 20.0f, 3.0f };
+    for (float radius : radii) {
+        int found = 0, left = 0, outside = 0;
+        for (int i = 0; i < 4000; ++i) {
+            CLTVector pos;
+            if (system.GetRandomPosition(center, radius, &pos)) {
+                ++found;
+                left += pos.x < 8.0f;
+                outside += pos.Distance(center) > radius + 1.0e-4f;
+            }
+        }
+        Check(found == 4000, pTest, "position not found");
+        Check(outside == 0, pTest, "position outside the sphere");
+        Check(std::fabs(left / 4000.0 - 0.5) < 0.04, pTest, "positions not spread by area");
+    }
+}
+
+// Funnelled paths on a grid with walls turn at wall corners, where the
+// waypoints lie on several polygons and consecutive legs run along edges.
+// Every leg must still be in line of sight, and a leg into a wall not.
+static void TestRayCastAlongPaths()
+{
+    const char* pTest = "ray cast along funnelled paths";
+    const int size = 40;
+    const std::vector<bool> open = MakeGridWalls(size, size, 99);
+    CLTNavMeshSystem system;
+    system.Init();
+    Check(system.SetNavMeshData(BuildGrid(size, size, open)), pTest, "mesh builds");
+
+    const CLTNavMeshSystem::PathFindOptions options = ExactOptions();
+    uint32_t seed = 5;
+    int legs = 0, blocked = 0;
+    for (int q = 0; q < 300; ++q) {
+        int cells[2];
+        for (int& cell : cells) {
+            seed = seed * 1664525u + 1013904223u;
+            cell = static_cast<int>((seed >> 8) % (size * size));
+        }
+        if (!open[cells[0]] || !open[cells[1]]) {
+            continue;
+        }
+        CLTVector start(cells[0] % size + 0.5f, 0.0f, cells[0] / size + 0.5f);
+        CLTVector end(cells[1] % size + 0.5f, 0.0f, cells[1] / size + 0.5f);
+        CLTNavMeshPath path;
+        if (system.FindPath(start, end, &path, &options) != CLTNavMeshSystem::PATHFIND_SUCCESS) {
+            continue;
+        }
+        for (uint32_t i = 1; i < path.GetWaypointCount(); ++i) {
+            CLTNavMeshSystem::RayCastResult result;
+            ++legs;
+            blocked += system.RayCast(path.GetWaypoint(i - 1), path.GetWaypoint(i), &result);
+        }
+    }
+    Check(legs > 500, pTest, "too few path legs");
+    Check(blocked == 0, pTest, "path leg not in line of sight");
+
+    // Along the edge of a wall cell from its corner, then into it
+    int wall = 0;
+    while (open[wall] || wall % size == 0 || wall % size == size - 1 || !open[wall - 1]) {
+        ++wall;
+    }
+    const CLTVector corner(wall % size, 0.0f, wall / size);
+    CLTNavMeshSystem::RayCastResult result;
+    Check(!system.RayCast(corner, corner + CLTVector(0.0f, 0.0f, 1.0f), &result), pTest,
+          "ray along a wall edge blocked");
+    Check(system.RayCast(corner, corner + CLTVector(0.5f, 0.0f, 0.5f), &result) && result.distance < 1.0e-3f,
+          pTest, "ray into a wall cell not blocked at its corner");
+}
+
+// Batches must give the same paths for any thread count, even with a time
+// limit far too short to finish a search, which batches ignore
+static void TestBatchIgnoresTimeout()
+{
+    const char* pTest = "batch ignores the time limit";
+    const int size = 60;
+    CLTNavMeshSystem system;
+    system.Init();
+    Check(system.SetNavMeshData(BuildGrid(size, size, MakeGridWalls(size, size, 7))), pTest, "mesh builds");
+    system.SetPathCacheCapacity(0);
+
+    CLTNavMeshSystem::PathFindOptions options = ExactOptions();
+    options.timeout = 1.0e-9f;
+    const int REQUESTS = 64;
+    std::vector<CLTNavMeshSystem::PathRequest> requests;
+    for (int i = 0; i < REQUESTS; ++i) {
+        CLTNavMeshSystem::PathRequest request;
+        request.start = CLTVector(0.5f, 0.0f, 0.5f);
+        request.end = CLTVector(size - 0.5f - i % 8, 0.0f, size - 0.5f - i / 8);
+        request.pOptions = &options;
+        requests.push_back(request);
+    }
+
+    const uint32_t threadCounts[] = { 1, 4 };
+    CLTNavMeshPath paths[2][REQUESTS];
+    CLTNavMeshSystem::PathFindResult results[2][REQUESTS];
+    for (int run = 0; run < 2; ++run) {
+        system.SetBatchThreadCount(threadCounts[run]);
+        system.FindPathsBatch(requests.data(), REQUESTS, paths[run], results[run]);
+    }
+
+    int timedOut = 0, differ = 0;
+    for (int i = 0; i < REQUESTS; ++i) {
+        timedOut += results[0][i] == CLTNavMeshSystem::PATHFIND_TIMEOUT || results[1][i] == CLTNavMeshSystem::PATHFIND_TIMEOUT;
+        bool same = results[0][i] == results[1][i] &&
+                    paths[0][i].GetWaypointCount() == paths[1][i].GetWaypointCount();
+        for (uint32_t w = 0; same && w < paths[0][i].GetWaypointCount(); ++w) {
+            same = paths[0][i].GetWaypoint(w).Distance(paths[1][i].GetWaypoint(w)) == 0.0f;
+        }
+        differ += !same;
+    }
+    Check(timedOut == 0, pTest, "batch search timed out");
+    Check(differ == 0, pTest, "paths depend on the thread count");
+}
+
+// Drains a trigger's events into "+id" / "-id" entries
+static std::vector<int> DrainTrigger(CLTNavMeshSystem& system, uint32_t triggerId)
+{
+    std::vector<int> events;
+    NavMeshTriggerEvent buffer[8];
+    CLTNavMeshTrigger* pTrigger = system.GetTrigger(triggerId);
+    while (uint32_t count = pTrigger ? pTrigger->DrainEvents(buffer, 8) : 0) {
+        for (uint32_t i = 0; i < count; ++i) {
+            int actor = static_cast<int>(buffer[i].actorId);
+            events.push_back(buffer[i].entered ? actor : -actor);
+        }
+    }
+    return events;
+}
+
+// Actors entering and leaving a small trigger, one straddling hash cells at
+// negative coordinates and one too large for the hash; each crossing gives
+// exactly one event, and staying or moving within a volume gives none
+static void TestTriggerEvents()
+{
+    const char* pTest = "trigger enter and exit events";
+    CLTNavMeshSystem system;
+    system.Init();
+    const uint32_t small = system.AddTrigger(new CLTNavMeshTrigger(CLTVector(2.0f, -1.0f, 2.0f), CLTVector(4.0f, 3.0f, 4.0f)));
+    const uint32_t straddling = system.AddTrigger(new CLTNavMeshTrigger(CLTVector(-20.0f, -1.0f, -4.0f), CLTVector(20.0f, 3.0f, 4.0f)));
+    const uint32_t large = system.AddTrigger(new CLTNavMeshTrigger(CLTVector(-1000.0f, -1.0f, -1000.0f), CLTVector(1000.0f, 3.0f, 1000.0f)));
+    Check(small != 0 && straddling != 0 && large != 0 && small != straddling, pTest, "trigger IDs");
+
+    // Actor 1 walks into the small trigger, across it and out again
+    system.SetTriggerActorPosition(1, CLTVector(0.0f, 0.0f, 10.0f));
+    system.UpdateTriggers();
+    Check(DrainTrigger(system, large) == std::vector<int>(1, 1), pTest, "no enter event for the large trigger");
+    Check(DrainTrigger(system, small).empty() && DrainTrigger(system, straddling).empty(), pTest, "event outside a trigger");
+
+    system.SetTriggerActorPosition(1, CLTVector(3.0f, 0.0f, 3.0f));
+    system.UpdateTriggers();
+    Check(DrainTrigger(system, small) == std::vector<int>(1, 1), pTest, "no enter event for the small trigger");
+    Check(DrainTrigger(system, straddling) == std::vector<int>(1, 1), pTest, "no enter event for the straddling trigger");
+
+    system.SetTriggerActorPosition(1, CLTVector(3.5f, 0.0f, 3.5f));
+    system.UpdateTriggers();
+    system.UpdateTriggers();
+    Check(DrainTrigger(system, small).empty(), pTest, "event while staying inside");
+
+    system.SetTriggerActorPosition(1, CLTVector(6.0f, 0.0f, 3.5f));
+    system.UpdateTriggers();
+    Check(DrainTrigger(system, small) == std::vector<int>(1, -1), pTest, "no exit event for the small trigger");
+    Check(DrainTrigger(system, straddling).empty(), pTest, "event while moving within a trigger");
+
+    // Across hash cells and the origin within the straddling trigger
+    const float xs[] = { 17.0f, -1.0f, -17.0f, 15.0f };
+    for (float x : xs) {
+        system.SetTriggerActorPosition(1, CLTVector(x, 0.0f, -2.0f));
+        system.UpdateTriggers();
+    }
+    Check(DrainTrigger(system, straddling).empty(), pTest, "event when crossing hash cells inside a trigger");
+
+    // Leaving two volumes in one step, then a second actor entering
+    system.SetTriggerActorPosition(1, CLTVector(-25.0f, 0.0f, 0.0f));
+    system.SetTriggerActorPosition(2, CLTVector(-18.0f, 0.0f, 0.0f));
+    system.UpdateTriggers();
+    std::vector<int> events = DrainTrigger(system, straddling);
+    std::sort(events.begin(), events.end());
+    Check(events.size() == 2 && events[0] == -1 && events[1] == 2, pTest, "events of two actors in one update");
+
+    // Removing an actor leaves every volume it was in; removing a trigger
+    // drops it without events
+    DrainTrigger(system, large);
+    Check(system.RemoveTriggerActor(2), pTest, "actor removed");
+    Check(DrainTrigger(system, straddling) == std::vector<int>(1, -2) &&
+          DrainTrigger(system, large) == std::vector<int>(1, -2), pTest, "no exit event when the actor is removed");
+    Check(system.RemoveTrigger(small) && system.GetTrigger(small) == nullptr, pTest, "trigger removed");
+    system.SetTriggerActorPosition(1, CLTVector(3.0f, 0.0f, 3.0f));
+    system.UpdateTriggers();
+    Check(DrainTrigger(system, straddling) == std::vector<int>(1, 1), pTest, "no enter event after removing a trigger");
+}
+
+// Whether each polygon of a grid corridor is next to the one before
+static bool CorridorConnected(const std::vector<uint32_t>& corridor, int width)
+{
+    for (size_t i = 1; i < corridor.size(); ++i) {
+        const int from = static_cast<int>(corridor[i - 1]) - 1, to = static_cast<int>(corridor[i]) - 1;
+        if (std::abs(from % width - to % width) + std::abs(from / width - to / width) != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A corridor across an open grid is repaired around a polygon blocked
+// ahead of the agent, keeping the corridor beyond the detour. A wall of
+// blocked polygons leaves no path, and unblocking restores one.
+static void TestRepairPathAroundBlock()
+{
+    const char* pTest = "repair path around a blocked polygon";
+    const int size = 20;
+    CLTNavMeshSystem system;
+    system.Init();
+    Check(system.SetNavMeshData(BuildGrid(size, size)), pTest, "mesh builds");
+
+    const CLTNavMeshSystem::PathFindOptions options = ExactOptions();
+    const CLTVector start(0.5f, 0.0f, 10.5f), end(19.5f, 0.0f, 10.5f);
+    CLTNavMeshPath path;
+    Check(system.FindPath(start, end, &path, &options) == CLTNavMeshSystem::PATHFIND_SUCCESS, pTest, "path found");
+    const std::vector<uint32_t> before = path.GetCorridor();
+    Check(before.size() >= 20, pTest, "corridor too short");
+    if (before.size() < 20) {
+        return;
+    }
+
+    // Nothing blocked ahead: the path stays as it is
+    Check(system.RepairPath(&path, start, &options) == CLTNavMeshSystem::PATHFIND_SUCCESS &&
+          path.GetCorridor() == before, pTest, "unblocked path changed");
+
+    const uint32_t blocked = before[before.size() / 2];
+    Check(system.SetPolygonBlocked(blocked, true), pTest, "polygon blocked");
+    Check(system.RepairPath(&path, start, &options) == CLTNavMeshSystem::PATHFIND_SUCCESS, pTest, "repair failed");
+    const std::vector<uint32_t>& after = path.GetCorridor();
+    Check(std::find(after.begin(), after.end(), blocked) == after.end(), pTest, "corridor still crosses the block");
+    Check(CorridorConnected(after, size), pTest, "repaired corridor not connected");
+    Check(!after.empty() && after.front() == before.front() && after.back() == before.back(), pTest,
+          "repaired corridor ends moved");
+    Check(after.size() >= 2 && std::equal(before.end() - 2, before.end(), after.end() - 2), pTest,
+          "corridor beyond the detour not kept");
+    Check(path.GetWaypoint(path.GetWaypointCount() - 1).Distance(end) < 1.0e-4f, pTest, "repaired path end moved");
+
+    // A full wall of blocks across the grid leaves no way through
+    for (int z = 0; z < size; ++z) {
+        system.SetPolygonBlocked(static_cast<uint32_t>(z * size + 16), true);
+    }
+    Check(system.RepairPath(&path, start, &options) == CLTNavMeshSystem::PATHFIND_NO_PATH, pTest, "path through a wall");
+    for (int z = 0; z < size; ++z) {
+        system.SetPolygonBlocked(static_cast<uint32_t>(z * size + 16), false);
+    }
+    Check(system.FindPath(start, end, &path, &options) == CLTNavMeshSystem::PATHFIND_SUCCESS, pTest,
+          "no path once the wall is gone");
+    Check(std::find(path.GetCorridor().begin(), path.GetCorridor().end(), blocked) == path.GetCorridor().end(),
+          pTest, "new path crosses the block");
+}
+
+// An object walking over a grid with a bridge is located from its cache
+// while it stays inside its polygon or steps into a neighbour, and agrees
+// with a plain lookup everywhere but on the bridge, where it keeps its
+// floor. A new snapshot with other dense indices must not return stale IDs.
+static void TestLocationCache()
+{
+    const char* pTest = "location cache";
+    const int size = 10;
+    std::vector<NavMeshPoly> polygons = BuildGrid(size, size);
+    polygons.push_back(MakeRect(1000, 3.0f, 0.0f, 7.0f, 10.0f, 3.0f));
+    polygons.back().area = CLTNavMeshSystem::AREA_INDOORS;
+    CLTNavMeshSystem system;
+    system.Init();
+    Check(system.SetNavMeshData(polygons), pTest, "mesh builds");
+
+    // Along the floor and under the bridge, one step at a time
+    NavMeshLocation location;
+    uint64_t hits, misses;
+    int wrong = 0;
+    for (int i = 0; i < 90; ++i) {
+        const CLTVector position(0.25f + i * 0.1f, 0.0f, 1.5f);
+        uint32_t expected = 0;
+        system.IsPositionValid(position, &expected);
+        wrong += system.LocatePolygon(position, &location) != expected;
+    }
+    system.GetLocationCacheStats(&hits, &misses);
+    Check(wrong == 0, pTest, "cached polygon differs from the lookup");
+    Check(misses == 1 && hits == 89, pTest, "steps into neighbours not served by the cache");
+
+    // Climbing onto the bridge, then sinking below half way keeps the bridge
+    NavMeshLocation onBridge;
+    Check(system.LocatePolygon(CLTVector(5.0f, 3.0f, 5.0f), &onBridge) == 1000, pTest, "bridge not found");
+    Check(system.LocatePolygon(CLTVector(5.5f, 1.2f, 5.0f), &onBridge) == 1000, pTest, "object fell off the bridge");
+    Check(system.GetAreaFlags(CLTVector(5.5f, 1.2f, 5.0f), &onBridge) == CLTNavMeshSystem::AREA_INDOORS &&
+          system.IsIndoors(CLTVector(5.5f, 1.2f, 5.0f), &onBridge), pTest, "bridge area not reported");
+    Check(system.LocatePolygon(CLTVector(8.5f, 1.2f, 5.0f), &onBridge) == 5 * size + 8 + 1, pTest,
+          "object off the bridge not on the floor");
+    Check(system.LocatePolygon(CLTVector(20.0f, 0.0f, 5.0f), &onBridge) == 0 && onBridge.polyId == 0, pTest,
+          "position off the mesh located");
+
+    // A new snapshot with a wall column shifts every dense index after it
+    std::vector<bool> open(size * size, true);
+    for (int z = 0; z < size; ++z) {
+        open[z * size] = false;
+    }
+    Check(system.SetNavMeshData(BuildGrid(size, size, open)), pTest, "second mesh builds");
+    const CLTVector position(0.25f + 89 * 0.1f, 0.0f, 1.5f);
+    uint32_t expected = 0;
+    system.IsPositionValid(position, &expected);
+    Check(expected != 0 && system.LocatePolygon(position, &location) == expected, pTest,
+          "stale polygon after a new snapshot");
+    location.polyId = 5 * size + 1;   // Cached before the column was removed
+    location.polyIndex = 5 * size;
+    system.IsPositionValid(CLTVector(0.5f, 0.0f, 5.5f), &expected);
+    Check(system.LocatePolygon(CLTVector(0.5f, 0.0f, 5.5f), &location) == expected && expected != 5 * size + 1, pTest,
+          "removed polygon located");
+}
+
+// On a grid with walls, a flow field's distances must match breadth-first
+// hop counts, its next hops must lead to the goal, and agents steering by
+// it must arrive. Fields are reused while the goal stays in its polygon
+// and rebuilt when a polygon is blocked.
+static void TestFlowField()
+{
+    const char* pTest = "flow field";
+    const int size = 30;
+    const std::vector<bool> open = MakeGridWalls(size, size, 3);
+    CLTNavMeshSystem system;
+    system.Init();
+    Check(system.SetNavMeshData(BuildGrid(size, size, open)), pTest, "mesh builds");
+
+    const CLTVector goal(size - 0.5f, 0.0f, size - 0.5f);
+    std::shared_ptr<const CLTNavMeshFlowField> pField = system.GetFlowField(goal, 0.25f);
+    Check(pField != nullptr, pTest, "no field");
+    if (!pField) {
+        return;
+    }
+    const CLTNavMeshData& navData = *pField->GetNavData();
+
+    // Hops from the goal cell over open neighbours
+    std::vector<int> hops(size * size, -1);
+    std::vector<int> queue(1, size * size - 1);
+    hops[size * size - 1] = 0;
+    for (size_t q = 0; q < queue.size(); ++q) {
+        const int cell = queue[q], x = cell % size, z = cell / size;
+        const int next[] = { x > 0 ? cell - 1 : -1, x < size - 1 ? cell + 1 : -1,
+                             z > 0 ? cell - size : -1, z < size - 1 ? cell + size : -1 };
+        for (int n : next) {
+            if (n >= 0 && open[n] && hops[n] < 0) {
+                hops[n] = hops[cell] + 1;
+                queue.push_back(n);
+            }
+        }
+    }
+
+    int wrongDistance = 0, wrongHop = 0, reachable = 0;
+    for (int cell = 0; cell < size * size; ++cell) {
+        if (!open[cell]) {
+            continue;
+        }
+        const uint32_t index = navData.GetIndex(static_cast<uint32_t>(cell + 1));
+        if (pField->IsReachable(index) != (hops[cell] >= 0)) {
+            ++wrongDistance;
+            continue;
+        }
+        if (hops[cell] < 0) {
+            continue;
+        }
+        ++reachable;
+        wrongDistance += std::fabs(pField->GetDistance(index) - hops[cell]) > 1.0e-3f;
+        if (hops[cell] > 0) {
+            const uint32_t next = pField->GetNextPolygon(index);
+            const int nextCell = next != CLTNavMeshData::INVALID_INDEX ? static_cast<int>(navData.GetId(next)) - 1 : -1;
+            wrongHop += nextCell < 0 || hops[nextCell] != hops[cell] - 1;
+        }
+    }
+    Check(reachable > size * size / 2, pTest, "too few reachable cells");
+    Check(wrongDistance == 0, pTest, "distance differs from the hop count");
+    Check(wrongHop == 0, pTest, "next polygon not one hop closer");
+
+    // Agents from a few reachable cells steer to the goal
+    int arrived = 0, agents = 0;
+    for (int cell = 0; cell < size * size && agents < 20; cell += 37) {
+        if (!open[cell] || hops[cell] < 0) {
+            continue;
+        }
+        ++agents;
+        CLTVector position(cell % size + 0.5f, 0.0f, cell / size + 0.5f);
+        for (int step = 0; step < 40 * hops[cell] + 10; ++step) {
+            CLTVector direction;
+            if (!system.GetFlowDirection(*pField, position, &direction) || direction.Length() == 0.0f) {
+                break;
+            }
+            position = position + direction * 0.05f;
+        }
+        arrived += position.Distance(goal) < 0.1f;
+    }
+    Check(agents > 10 && arrived == agents, pTest, "agent did not arrive");
+
+    // Reused within the goal polygon and distance, rebuilt otherwise
+    Check(system.GetFlowField(goal + CLTVector(-0.2f, 0.0f, 0.0f), 0.25f) == pField, pTest, "field not reused");
+    Check(system.GetFlowField(goal + CLTVector(-0.4f, 0.0f, 0.0f), 0.25f) != pField, pTest, "field reused too far away");
+    pField = system.GetFlowField(goal, 0.25f);
+    const uint32_t blocked = static_cast<uint32_t>(size * size - 1);    // Next to the goal cell
+    Check(system.SetPolygonBlocked(blocked, true), pTest, "polygon blocked");
+    std::shared_ptr<const CLTNavMeshFlowField> pBlockedField = system.GetFlowField(goal, 0.25f);
+    Check(pBlockedField && pBlockedField != pField, pTest, "field not rebuilt after blocking");
+    if (pBlockedField) {
+        const uint32_t blockedIndex = pBlockedField->GetNavData()->GetIndex(blocked);
+        Check(!pBlockedField->IsReachable(blockedIndex), pTest, "blocked polygon reaches the goal");
+    }
+
+    // A field for an older navmesh is refused
+    Check(system.SetNavMeshData(BuildGrid(size, size)), pTest, "second mesh builds");
+    CLTVector direction;
+    Check(!system.GetFlowDirection(*pField, CLTVector(0.5f, 0.0f, 0.5f), &direction), pTest, "old field followed");
+}
+
+// Waits for an asynchronous request, for up to ten seconds
+static CLTNavMeshSystem::PathFindResult WaitForPath(CLTNavMeshSystem& system, uint32_t ticket, CLTNavMeshPath* pPath)
+{
+    CLTNavMeshSystem::PathFindResult result = CLTNavMeshSystem::PATHFIND_PENDING;
+    for (int wait = 0; wait < 10000 && result == CLTNavMeshSystem::PATHFIND_PENDING; ++wait) {
+        result = system.GetPathResult(ticket, pPath);
+        if (result == CLTNavMeshSystem::PATHFIND_PENDING) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    return result;
+}
+
+static bool SameWaypoints(const CLTNavMeshPath& a, const CLTNavMeshPath& b)
+{
+    return a.GetWaypoints().size() == b.GetWaypoints().size() &&
+           std::equal(a.GetWaypoints().begin(), a.GetWaypoints().end(), b.GetWaypoints().begin(),
+                      [](const CLTVector& p, const CLTVector& q) { return p.Distance(q) == 0.0f; });
+}
+
+// Requests of every priority on worker threads give the same paths as
+// FindPath, on the navmesh as it was when they were made. Cancelled and
+// collected tickets are gone.
+static void TestAsyncRequestPath()
+{
+    const char* pTest = "asynchronous path requests";
+    const int size = 40;
+    const std::vector<bool> open = MakeGridWalls(size, size, 11);
+    CLTNavMeshSystem system;
+    system.Init();
+    Check(system.SetNavMeshData(BuildGrid(size, size, open)), pTest, "mesh builds");
+    system.SetPathCacheCapacity(0);
+    system.SetPathWorkerCount(3);
+
+    const CLTNavMeshSystem::PathFindOptions options = ExactOptions();
+    const int REQUESTS = 60;
+    CLTVector starts[REQUESTS], ends[REQUESTS];
+    uint32_t tickets[REQUESTS];
+    uint32_t seed = 17;
+    for (int i = 0; i < REQUESTS; ++i) {
+        int cells[2];
+        for (int& cell : cells) {
+            do {
+                seed = seed * 1664525u + 1013904223u;
+                cell = static_cast<int>((seed >> 8) % (size * size));
+            } while (!open[cell]);
+        }
+        starts[i] = CLTVector(cells[0] % size + 0.5f, 0.0f, cells[0] / size + 0.5f);
+        ends[i] = CLTVector(cells[1] % size + 0.5f, 0.0f, cells[1] / size + 0.5f);
+        tickets[i] = system.RequestPath(starts[i], ends[i],
+                                        static_cast<CLTNavMeshSystem::PathPriority>(i % CLTNavMeshSystem::PATH_PRIORITY_COUNT),
+                                        &options);
+    }
+
+    // Replacing the navmesh must not affect requests already made
+    const uint32_t cancelled = system.RequestPath(starts[0], ends[0], CLTNavMeshSystem::PATH_PRIORITY_LOW, &options);
+    CLTNavMeshSystem reference;
+    reference.Init();
+    reference.SetNavMeshData(BuildGrid(size, size, open));
+    Check(system.SetNavMeshData(BuildGrid(size, size)), pTest, "second mesh builds");
+    Check(system.CancelPathRequest(cancelled), pTest, "request not cancelled");
+
+    int differ = 0, found = 0;
+    for (int i = 0; i < REQUESTS; ++i) {
+        CLTNavMeshPath async, sync;
+        CLTNavMeshSystem::PathFindResult result = WaitForPath(system, tickets[i], &async);
+        CLTNavMeshSystem::PathFindResult expected = reference.FindPath(starts[i], ends[i], &sync, &options);
+        found += result == CLTNavMeshSystem::PATHFIND_SUCCESS;
+        differ += result != expected || !SameWaypoints(async, sync);
+        Check(system.GetPathResult(tickets[i], &async) == CLTNavMeshSystem::PATHFIND_ERROR, pTest,
+              "ticket still valid after collecting");
+    }
+    Check(found > REQUESTS / 2, pTest, "too few paths found");
+    Check(differ == 0, pTest, "asynchronous path differs from FindPath");
+
+    CLTNavMeshPath path;
+    Check(system.GetPathResult(cancelled, &path) == CLTNavMeshSystem::PATHFIND_ERROR, pTest, "cancelled ticket valid");
+    Check(!system.CancelPathRequest(cancelled), pTest, "request cancelled twice");
+}
+
+int main()
+{
+    TestRandomPositionNearBridge();
+    TestRandomPositionUniform();
+    TestRayCastAlongPaths();
+    TestBatchIgnoresTimeout();
+    TestTriggerEvents();
+    TestRepairPathAroundBlock();
+    TestLocationCache();
+    TestFlowField();
+    TestAsyncRequestPath();
+
+    if (s_failures == 0) {
+        printf("PASS\n");
+        return 0;
+    }
+    return 1;
+}
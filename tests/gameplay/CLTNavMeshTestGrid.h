@@ -0,0 +1,96 @@
+#ifndef _CLT_NAVMESH_TEST_GRID_H_
+#define _CLT_NAVMESH_TEST_GRID_H_
+
+/*
+ * Grid fixtures shared by the navmesh tests and benchmarks
+ *
+ * Header only; include it from a test or benchmark and build as usual.
+ *
+ * Worlds are grids of unit quads on the XZ plane. The quad of cell (x, z)
+ * has its corner at (x, y, z) and ID z * width + x + 1, so IDs stay the
+ * same whichever cells are left out. Links join edge-adjacent cells that
+ * are both open; a link filter can drop some of them, in one direction or
+ * both.
+ */
+
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+#include <vector>
+
+/**
+ * @brief Walkable unit quad with its corner at (x, y, z) and no links
+ */
+inline NavMeshPoly MakeGridQuad(uint32_t id, int x, int z, float y = 0.0f)
+{
+    NavMeshPoly poly;
+    poly.id = id;
+    poly.vertices.push_back(CLTVector(x, y, z));
+    poly.vertices.push_back(CLTVector(x, y, z + 1.0f));
+    poly.vertices.push_back(CLTVector(x + 1.0f, y, z + 1.0f));
+    poly.vertices.push_back(CLTVector(x + 1.0f, y, z));
+    poly.center = CLTVector(x + 0.5f, y, z + 0.5f);
+    poly.height = y;
+    poly.flags = 0;
+    poly.area = CLTNavMeshSystem::AREA_WALKABLE;
+    return poly;
+}
+
+/**
+ * @brief Open cells of a width x depth grid with about a quarter walled off
+ *
+ * The first and last cells are always open. The same seed gives the same walls.
+ */
+inline std::vector<bool> MakeGridWalls(int width, int depth, uint32_t seed = 12345)
+{
+    std::vector<bool> open(width * depth, true);
+    for (size_t i = 0; i < open.size(); ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        open[i] = (seed >> 24) >= 64;
+    }
+    open.front() = open.back() = true;
+    return open;
+}
+
+/** @brief Link filter keeping every link */
+struct GridLinkAll {
+    bool operator()(int, int, int, int) const { return true; }
+};
+
+/**
+ * @brief Grid of unit quads
+ *
+ * @param open Open cells, z-major; empty for all open
+ * @param linked Called as linked(x, z, toX, toZ) for each link between
+ *               open cells; the link is kept when it returns true
+ */
+template <typename LinkFilter>
+inline std::vector<NavMeshPoly> BuildGrid(int width, int depth, const std::vector<bool>& open, LinkFilter linked)
+{
+    auto isOpen = [&](int x, int z) {
+        return x >= 0 && z >= 0 && x < width && z < depth && (open.empty() || open[z * width + x]);
+    };
+
+    std::vector<NavMeshPoly> polygons;
+    polygons.reserve(width * depth);
+    for (int z = 0; z < depth; ++z) {
+        for (int x = 0; x < width; ++x) {
+            if (!isOpen(x, z)) {
+                continue;
+            }
+            NavMeshPoly poly = MakeGridQuad(static_cast<uint32_t>(z * width + x + 1), x, z);
+            if (isOpen(x - 1, z) && linked(x, z, x - 1, z)) poly.neighbors.push_back(poly.id - 1);
+            if (isOpen(x + 1, z) && linked(x, z, x + 1, z)) poly.neighbors.push_back(poly.id + 1);
+            if (isOpen(x, z - 1) && linked(x, z, x, z - 1)) poly.neighbors.push_back(poly.id - width);
+            if (isOpen(x, z + 1) && linked(x, z, x, z + 1)) poly.neighbors.push_back(poly.id + width);
+            polygons.push_back(poly);
+        }
+    }
+    return polygons;
+}
+
+/** @brief Grid of unit quads, linked wherever both cells are open */
+inline std::vector<NavMeshPoly> BuildGrid(int width, int depth, const std::vector<bool>& open = std::vector<bool>())
+{
+    return BuildGrid(width, depth, open, GridLinkAll());
+}
+
+#endif // _CLT_NAVMESH_TEST_GRID_H_
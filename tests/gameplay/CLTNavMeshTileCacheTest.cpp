@@ -0,0 +1,131 @@
+/*
+ * Tile streaming regression test for CLTNavMeshTileCache
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -pthread tests/gameplay/CLTNavMeshTileCacheTest.cpp \
+ *       src/gameplay/CLTNavMeshTileCache.cpp src/gameplay/CLTNavMeshData.cpp \
+ *       src/gameplay/CLTNavMeshClusterGraph.cpp -o tile_cache_test
+ *   ./tile_cache_test [scratch directory]
+ *
+ * A 512x512 grid of unit quads is split into 16-unit tiles. An agent walks
+ * across the world and stands still after each move while Update() keeps
+ * being called. The cache must settle on exactly the tiles near every
+ * position visited so far (the budget keeps them all), publish a snapshot
+ * holding all of their polygons, and then stop republishing.
+ */
+
+#include "../../include/gameplay/CLTNavMeshTileCache.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+#include "CLTNavMeshTestGrid.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static const int GRID_SIZE = 512;
+static const float TILE_SIZE = 16.0f;
+static const float STREAMING_RADIUS = 64.0f;
+static const uint32_t POLYS_PER_TILE = 16 * 16;
+
+typedef std::set<std::pair<int32_t, int32_t> > TileSet;
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* pWhat, int step)
+{
+    if (!condition) {
+        printf("FAIL step %d: %s\n", step, pWhat);
+        ++s_failures;
+    }
+}
+
+// Tiles within the streaming radius of a position, as Update() computes them
+static void AddNearbyTiles(const CLTNavMeshTileCache& cache, const CLTVector& pos, TileSet* pTiles)
+{
+    const int32_t tileCount = static_cast<int32_t>(GRID_SIZE / TILE_SIZE);
+    const float size = cache.GetTileSize();
+    int32_t x0 = static_cast<int32_t>(std::floor((pos.x - STREAMING_RADIUS - cache.GetOriginX()) / size));
+    int32_t z0 = static_cast<int32_t>(std::floor((pos.z - STREAMING_RADIUS - cache.GetOriginZ()) / size));
+    int32_t x1 = static_cast<int32_t>(std::floor((pos.x + STREAMING_RADIUS - cache.GetOriginX()) / size));
+    int32_t z1 = static_cast<int32_t>(std::floor((pos.z + STREAMING_RADIUS - cache.GetOriginZ()) / size));
+    for (int32_t z = std::max(z0, 0); z <= std::min(z1, tileCount - 1); ++z) {
+        for (int32_t x = std::max(x0, 0); x <= std::min(x1, tileCount - 1); ++x) {
+            pTiles->insert(std::make_pair(x, z));
+        }
+    }
+}
+
+static void RemoveTiles(const std::string& manifest)
+{
+    const int32_t tileCount = static_cast<int32_t>(GRID_SIZE / TILE_SIZE);
+    char suffix[32];
+    for (int32_t z = 0; z < tileCount; ++z) {
+        for (int32_t x = 0; x < tileCount; ++x) {
+            snprintf(suffix, sizeof(suffix), ".%d_%d", x, z);
+            remove((manifest + suffix).c_str());
+        }
+    }
+    remove(manifest.c_str());
+}
+
+int main(int argc, char** argv)
+{
+    const std::string manifest = std::string(argc > 1 ? argv[1] : ".") + "/tile_cache_test.nav";
+    if (!CLTNavMeshTileCache::WriteTiles(BuildGrid(GRID_SIZE, GRID_SIZE), TILE_SIZE, manifest.c_str())) {
+        printf("FAIL: could not write tiles to %s\n", manifest.c_str());
+        return 1;
+    }
+
+    {
+        CLTNavMeshTileCache cache;
+        Check(cache.Open(manifest.c_str()), "manifest opens", -1);
+        cache.SetStreamingRadius(STREAMING_RADIUS);
+        cache.SetMemoryBudget(static_cast<size_t>(-1));
+
+        TileSet expected;
+        for (int step = 0; step < 6; ++step) {
+            CLTVector pos(100.0f + step * 20.0f, 0.0f, 200.0f);
+            AddNearbyTiles(cache, pos, &expected);
+
+            // Stand still, polling like a game loop, until the right tiles are published
+            std::shared_ptr<CLTNavMeshData> pData;
+            std::vector<std::pair<int32_t, int32_t> > resident;
+            bool settled = false;
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (!settled && std::chrono::steady_clock::now() < deadline) {
+                cache.Update(&pos, 1);
+                std::vector<std::pair<int32_t, int32_t> > tiles;
+                std::shared_ptr<CLTNavMeshData> pNext = cache.TakeUpdatedData(nullptr, &tiles);
+                if (pNext) {
+                    pData = pNext;
+                    resident.swap(tiles);
+                    settled = TileSet(resident.begin(), resident.end()) == expected;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+            }
+
+            Check(settled, "snapshot settles on the tiles near every visited position", step);
+            Check(resident.size() == expected.size(), "no duplicate resident tiles", step);
+            Check(pData && pData->GetPolyCount() == expected.size() * POLYS_PER_TILE,
+                  "snapshot holds every polygon of the resident tiles", step);
+
+            // Once settled, a still agent must not cause further snapshots
+            for (int i = 0; i < 20; ++i) {
+                cache.Update(&pos, 1);
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+            }
+            Check(!cache.TakeUpdatedData(), "a still agent does not republish", step);
+        }
+    }
+
+    RemoveTiles(manifest);
+    if (s_failures == 0) {
+        printf("PASS\n");
+    }
+    return s_failures == 0 ? 0 : 1;
+}
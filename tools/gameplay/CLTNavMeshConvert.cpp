@@ -0,0 +1,179 @@
+/*
+ * Offline converter producing binary navmesh files
+ *
+ * Build from the repository root:
+ *   g++ -std=c++11 -O2 -pthread tools/gameplay/CLTNavMeshConvert.cpp \
+ *       src/gameplay/CLTNavMeshBuilder.cpp src/gameplay/CLTNavMeshData.cpp \
+ *       -o navmesh_convert
+ *
+ * Usage:
+ *   ./navmesh_convert [-landmarks N] [-cell SIZE] [-radius R] input output
+ *
+ * The input is either a Wavefront OBJ file of world collision triangles,
+ * which is built into polygons with CLTNavMeshBuilder, or a navmesh file
+ * of any supported version, which is upgraded to the current one. With
+ * -landmarks the mesh is compiled again with that many ALT landmarks.
+ * -cell and -radius set the voxel size and agent radius of OBJ builds.
+ * The result is written with CLTNavMeshData::SaveToFile(), ready to be
+ * mapped by LoadNavMesh.
+ */
+
+#include "../../include/gameplay/CLTNavMeshBuilder.h"
+#include "../../include/gameplay/CLTNavMeshData.h"
+#include "../../include/gameplay/CLTNavMeshSystem.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static bool IsNavMeshFile(const char* pFilename)
+{
+    FILE* pFile = fopen(pFilename, "rb");
+    if (!pFile) {
+        return false;
+    }
+    uint32_t magic = 0;
+    bool isNavMesh = fread(&magic, sizeof(magic), 1, pFile) == 1 && magic == CLTNavMeshData::FILE_MAGIC;
+    fclose(pFile);
+    return isNavMesh;
+}
+
+// Reads vertices and faces; faces with more than three corners are fanned
+static bool ReadObj(const char* pFilename, std::vector<CLTVector>* pVertices, std::vector<uint32_t>* pIndices)
+{
+    FILE* pFile = fopen(pFilename, "r");
+    if (!pFile) {
+        return false;
+    }
+
+    char line[1024];
+    int lineNumber = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), pFile)) {
+        ++lineNumber;
+        if (line[0] == 'v' && line[1] == ' ') {
+            CLTVector v;
+            if (sscanf(line + 2, "%f %f %f", &v.x, &v.y, &v.z) != 3) {
+                printf("%s:%d: bad vertex\n", pFilename, lineNumber);
+                ok = false;
+            }
+            pVertices->push_back(v);
+        } else if (line[0] == 'f' && line[1] == ' ') {
+            // Corners are "v", "v/vt", "v//vn" or "v/vt/vn"; negative indices count back from the end
+            std::vector<uint32_t> corners;
+            char* pCursor = line + 2;
+            while (ok) {
+                char* pEnd;
+                long index = strtol(pCursor, &pEnd, 10);
+                if (pEnd == pCursor) {
+                    break;
+                }
+                long resolved = index < 0 ? static_cast<long>(pVertices->size()) + index : index - 1;
+                if (index == 0 || resolved < 0 || resolved >= static_cast<long>(pVertices->size())) {
+                    printf("%s:%d: bad face index %ld\n", pFilename, lineNumber, index);
+                    ok = false;
+                }
+                corners.push_back(static_cast<uint32_t>(resolved));
+                pCursor = pEnd;
+                while (*pCursor && *pCursor != ' ' && *pCursor != '\t') {
+                    ++pCursor;
+                }
+            }
+            for (size_t i = 2; ok && i < corners.size(); ++i) {
+                pIndices->push_back(corners[0]);
+                pIndices->push_back(corners[i - 1]);
+                pIndices->push_back(corners[i]);
+            }
+        }
+    }
+
+    fclose(pFile);
+    return ok;
+}
+
+static void PrintUsage()
+{
+    printf("usage: navmesh_convert [-landmarks N] [-cell SIZE] [-radius R] input output\n"
+           "  input is a Wavefront OBJ file or a navmesh file of any supported version\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t landmarkCount = 0;
+    bool setLandmarks = false;
+    NavMeshBuildConfig config;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-landmarks") == 0 && i + 1 < argc) {
+            landmarkCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+            setLandmarks = true;
+        } else if (strcmp(argv[i], "-cell") == 0 && i + 1 < argc) {
+            config.cellSize = static_cast<float>(atof(argv[++i]));
+        } else if (strcmp(argv[i], "-radius") == 0 && i + 1 < argc) {
+            config.agentRadius = static_cast<float>(atof(argv[++i]));
+        } else if (argv[i][0] == '-') {
+            PrintUsage();
+            return 1;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.size() != 2 || landmarkCount > CLTNavMeshData::MAX_LANDMARKS) {
+        PrintUsage();
+        return 1;
+    }
+
+    const auto began = std::chrono::steady_clock::now();
+    CLTNavMeshData navData;
+    std::vector<NavMeshPoly> polygons;
+    if (IsNavMeshFile(paths[0])) {
+        if (!navData.LoadFromFile(paths[0])) {
+            printf("%s: not a valid navmesh file\n", paths[0]);
+            return 1;
+        }
+        if (setLandmarks) {
+            // Landmarks are picked at build time, so compile the polygons again
+            polygons.resize(navData.GetPolyCount());
+            for (uint32_t i = 0; i < navData.GetPolyCount(); ++i) {
+                navData.CopyPoly(i, &polygons[i]);
+            }
+        }
+    } else {
+        std::vector<CLTVector> vertices;
+        std::vector<uint32_t> indices;
+        if (!ReadObj(paths[0], &vertices, &indices)) {
+            printf("%s: could not read OBJ geometry\n", paths[0]);
+            return 1;
+        }
+
+        CLTNavMeshBuilder builder;
+        if (!builder.SetConfig(config)) {
+            printf("invalid build parameters\n");
+            return 1;
+        }
+        if (!builder.SetGeometry(vertices.data(), static_cast<uint32_t>(vertices.size()), indices.data(),
+                                 static_cast<uint32_t>(indices.size() / 3)) ||
+            !builder.Build(&polygons)) {
+            printf("%s: navmesh build failed\n", paths[0]);
+            return 1;
+        }
+        setLandmarks = true;
+    }
+
+    if (setLandmarks && !navData.Build(polygons, landmarkCount)) {
+        printf("navmesh compile failed\n");
+        return 1;
+    }
+    if (!navData.SaveToFile(paths[1])) {
+        printf("%s: could not write navmesh file\n", paths[1]);
+        return 1;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - began).count();
+    printf("%s: version %u, %u polygons, %u external links, %u landmarks, %zu bytes (%.2f s)\n",
+           paths[1], CLTNavMeshData::FILE_VERSION, navData.GetPolyCount(), navData.GetExternalLinkCount(),
+           navData.GetLandmarkCount(), navData.GetMemoryUsage(), seconds);
+    return 0;
+}